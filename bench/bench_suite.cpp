@@ -0,0 +1,434 @@
+/**
+ * @file bench_suite.cpp
+ * @brief 全模块基准：DAO / 写入队列 / 统计 / XP / 热力图 / 提醒 / 守护进程 RPC
+ *
+ * 先按参数生成一份带项目、任务、完成历史和提醒的数据库，然后逐项测量
+ * 吞吐量和延迟分位数，终端打印表格，同时写出 JSON 便于做回归对比。
+ *
+ * 用法: ./bin/bench_suite [--tasks N] [--projects N] [--reminders N]
+ *                         [--history-days N] [--iterations N]
+ *                         [--db FILE] [--json FILE] [--trace FILE]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sqlite3.h>
+#include "database/DatabaseManager.h"
+#include "database/QueryProfiler.h"
+#include "database/WriteQueue.h"
+#include "trace/Tracer.h"
+#include "database/DAO/TaskDAO.h"
+#include "task/TagIndex.h"
+#include "database/DAO/ProjectDAO.h"
+#include "database/DAO/ReminderDAO.h"
+#include "statistics/StatisticsAnalyzer.h"
+#include "gamification/XPSystem.h"
+#include "gamification/XPLedger.h"
+#include "HeatmapVisualizer/HeatmapVisualizer.h"
+#include "reminder/ReminderSystem.h"
+#include "workload/WorkloadGenerator.h"
+#include "rpc/RpcServer.h"
+#include "rpc/RpcClient.h"
+
+namespace {
+
+struct BenchConfig {
+    int tasks = 5000;
+    int projects = 50;
+    int reminders = 2000;
+    int historyDays = 365;
+    int iterations = 200;
+    std::string dbPath = "bench_suite.db";
+    std::string jsonPath = "bench_results.json";
+    std::string tracePath;  // 非空时开启追踪并导出 Chrome trace JSON
+};
+
+struct BenchResult {
+    std::string name;
+    int iterations = 0;
+    double opsPerSec = 0.0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+};
+
+// 被测代码大量往 cout 打日志，计时期间吞掉，避免终端 IO 混进结果
+class CoutSilencer {
+    std::streambuf* saved;
+    std::ostringstream sink;
+public:
+    CoutSilencer() : saved(std::cout.rdbuf(sink.rdbuf())) {}
+    ~CoutSilencer() { std::cout.rdbuf(saved); }
+};
+
+void removeDatabaseFiles(const std::string& path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/**
+ * @brief 计时 iterations 次 op；setup 在每次计时前执行，不计入结果
+ */
+BenchResult measure(const std::string& name, int iterations,
+                    const std::function<void(int)>& op,
+                    const std::function<void(int)>& setup = nullptr) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    {
+        CoutSilencer silence;
+        for (int i = 0; i < iterations; ++i) {
+            if (setup) setup(i);
+            auto start = std::chrono::steady_clock::now();
+            op(i);
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    if (samples.empty()) return result;
+
+    double total = std::accumulate(samples.begin(), samples.end(), 0.0);
+    std::sort(samples.begin(), samples.end());
+    result.meanUs = total / samples.size();
+    result.opsPerSec = total > 0 ? samples.size() * 1e6 / total : 0.0;
+    result.p50Us = percentile(samples, 0.50);
+    result.p90Us = percentile(samples, 0.90);
+    result.p99Us = percentile(samples, 0.99);
+    result.maxUs = samples.back();
+
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.opsPerSec
+              << std::setw(10) << result.meanUs
+              << std::setw(10) << result.p50Us
+              << std::setw(10) << result.p90Us
+              << std::setw(10) << result.p99Us
+              << std::setw(12) << result.maxUs << std::endl;
+    return result;
+}
+
+// === 数据生成 ===
+
+bool seedMainDatabase(DatabaseManager& db, const BenchConfig& config) {
+    WorkloadConfig workload;
+    workload.tasks = config.tasks;
+    workload.projects = config.projects;
+    workload.historyDays = config.historyDays;
+    return WorkloadGenerator(workload).generate(db);
+}
+
+// 提醒在独立的 reminders 库里：一半已到期，一半在未来
+bool seedReminders(const std::string& path, const BenchConfig& config) {
+    auto dao = createReminderDAO(path);
+    if (!dao) return false;
+
+    auto now = std::chrono::system_clock::now();
+    CoutSilencer silence;
+    for (int r = 0; r < config.reminders; ++r) {
+        Reminder reminder;
+        reminder.title = "reminder_" + std::to_string(r);
+        reminder.message = "bench";
+        int offsetMinutes = (r % 2 == 0 ? -1 : 1) * (1 + r % 1440);
+        reminder.triggerTime = now + std::chrono::minutes(offsetMinutes);
+        reminder.recurrenceRule = "once";
+        if (!dao->insertReminder(reminder)) return false;
+    }
+    return true;
+}
+
+void resetReminderStatus(sqlite3* conn) {
+    sqlite3_exec(conn, "UPDATE reminders SET status = 0;", nullptr, nullptr, nullptr);
+}
+
+// === JSON 输出 ===
+
+void writeJson(const std::string& path, const BenchConfig& config,
+               const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "无法写入 " << path << std::endl;
+        return;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"suite\": \"bench_suite\",\n";
+    out << "  \"timestamp\": " << std::time(nullptr) << ",\n";
+    out << "  \"config\": {\"tasks\": " << config.tasks
+        << ", \"projects\": " << config.projects
+        << ", \"reminders\": " << config.reminders
+        << ", \"history_days\": " << config.historyDays
+        << ", \"iterations\": " << config.iterations << "},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"ops_per_sec\": " << r.opsPerSec
+            << ", \"mean_us\": " << r.meanUs
+            << ", \"p50_us\": " << r.p50Us
+            << ", \"p90_us\": " << r.p90Us
+            << ", \"p99_us\": " << r.p99Us
+            << ", \"max_us\": " << r.maxUs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "参数缺少取值: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--tasks") config.tasks = std::atoi(value.c_str());
+        else if (arg == "--projects") config.projects = std::atoi(value.c_str());
+        else if (arg == "--reminders") config.reminders = std::atoi(value.c_str());
+        else if (arg == "--history-days") config.historyDays = std::atoi(value.c_str());
+        else if (arg == "--iterations") config.iterations = std::atoi(value.c_str());
+        else if (arg == "--db") config.dbPath = value;
+        else if (arg == "--json") config.jsonPath = value;
+        else if (arg == "--trace") config.tracePath = value;
+        else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return false;
+        }
+    }
+    config.iterations = std::max(1, config.iterations);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) return 1;
+
+    const std::string reminderPath = config.dbPath + ".reminders";
+    removeDatabaseFiles(config.dbPath);
+    removeDatabaseFiles(reminderPath);
+
+    auto& db = DatabaseManager::getInstance();
+    if (!db.initialize(config.dbPath)) return 1;
+
+    std::mt19937 rng(42);
+    auto seedStart = std::chrono::steady_clock::now();
+    if (!seedMainDatabase(db, config) || !seedReminders(reminderPath, config)) {
+        DatabaseManager::destroyInstance();
+        return 1;
+    }
+    double seedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - seedStart).count();
+
+    std::cout << "\n种子数据: " << config.tasks << " 任务, " << config.projects << " 项目, "
+              << config.reminders << " 提醒, " << config.historyDays << " 天历史 ("
+              << std::fixed << std::setprecision(0) << seedMs << " ms)\n\n";
+    std::cout << std::left << std::setw(34) << "benchmark" << std::right
+              << std::setw(12) << "ops/s" << std::setw(10) << "mean" << std::setw(10) << "p50"
+              << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(12) << "max(us)"
+              << std::endl;
+
+    std::vector<BenchResult> results;
+    const int n = config.iterations;
+    if (!config.tracePath.empty()) {
+        Tracer::setEnabled(true);
+        TRACE_THREAD_NAME("bench");
+    }
+    std::uniform_int_distribution<int> taskIdDist(1, std::max(1, config.tasks));
+
+    // --- TaskDAOImpl CRUD 与查询 ---
+    TaskDAOImpl taskDAO(config.dbPath);
+    std::vector<int> insertedIds;
+    results.push_back(measure("task_dao.insert", n, [&](int i) {
+        insertedIds.push_back(taskDAO.insertTask(Task("bench_insert_" + std::to_string(i), "bench")));
+    }));
+    results.push_back(measure("task_dao.get_by_id", n, [&](int) {
+        taskDAO.getTaskById(taskIdDist(rng));
+    }));
+    results.push_back(measure("task_dao.update", n, [&](int i) {
+        Task task(insertedIds[i % insertedIds.size()], "bench_updated", "bench", i % 2 == 0);
+        taskDAO.updateTask(task);
+    }));
+    results.push_back(measure("task_dao.get_all", std::max(1, n / 10), [&](int) {
+        taskDAO.getAllTasks();
+    }));
+    results.push_back(measure("task_dao.get_by_status", std::max(1, n / 10), [&](int i) {
+        taskDAO.getTasksByStatus(i % 2 == 0);
+    }));
+    results.push_back(measure("task_dao.get_by_project", n, [&](int i) {
+        taskDAO.getTasksByProject(1 + i % std::max(1, config.projects));
+    }));
+    results.push_back(measure("task_dao.count_completed", n, [&](int) {
+        taskDAO.countCompletedTasks();
+    }));
+    results.push_back(measure("task_dao.delete", n, [&](int i) {
+        taskDAO.deleteTask(insertedIds[i % insertedIds.size()]);
+    }));
+
+    // --- 标签过滤：tasks.tags LIKE 全表扫描 vs 内存位图索引 ---
+    results.push_back(measure("tags.like_scan", std::max(1, n / 10), [&](int) {
+        db.executeQuery("SELECT id FROM tasks WHERE tags LIKE '%work%' AND tags LIKE '%urgent%' "
+                        "AND tags NOT LIKE '%meeting%' AND completed = 0 AND deleted = 0;",
+                        [](sqlite3_stmt*) { return true; });
+    }));
+    TagIndex tagIndex;
+    {
+        std::vector<std::pair<int, std::string>> tags;
+        std::vector<TaggedTask> tagged;
+        taskDAO.loadTagIndex(tags, tagged);
+        tagIndex.build(tags, tagged);
+    }
+    TagQuery tagQuery;
+    tagQuery.all = {"work", "urgent"};
+    tagQuery.none = {"meeting"};
+    tagQuery.completed = false;
+    results.push_back(measure("tags.bitmap_query", n, [&](int) {
+        tagIndex.query(tagQuery).toVector();
+    }));
+    TagQuery projectQuery;
+    projectQuery.any = {"coding", "review", "study"};
+    projectQuery.projectId = 1;
+    results.push_back(measure("tags.bitmap_any_project", n, [&](int) {
+        tagIndex.query(projectQuery).toVector();
+    }));
+
+    // --- 写入队列：每轮 64 条插入，逐条自动提交 vs 合并为一个事务提交 ---
+    const int burst = 64;
+    const std::string burstInsert = "INSERT INTO tasks (title, description) VALUES (?, 'bench');";
+    results.push_back(measure("db.insert_autocommit_x64", std::max(1, n / 10), [&](int i) {
+        for (int k = 0; k < burst; ++k) {
+            db.executeParameterized(burstInsert, {"bench_sync_" + std::to_string(i * burst + k)});
+        }
+    }));
+    WriteQueue& writeQueue = WriteQueue::getInstance();
+    writeQueue.start();
+    results.push_back(measure("write_queue.insert_x64", std::max(1, n / 10), [&](int i) {
+        std::vector<std::future<bool>> pending;
+        pending.reserve(burst);
+        for (int k = 0; k < burst; ++k) {
+            pending.push_back(writeQueue.submit(burstInsert, {"bench_queued_" + std::to_string(i * burst + k)}));
+        }
+        for (auto& done : pending) done.get();
+    }));
+    results.push_back(measure("write_queue.submit", n, [&](int i) {
+        writeQueue.submit(burstInsert, {"bench_submit_" + std::to_string(i)});
+    }));
+    writeQueue.flush();
+    WriteQueue::destroyInstance();
+
+    // --- ProjectDAO ---
+    ProjectDAO projectDAO(config.dbPath);
+    results.push_back(measure("project_dao.select_all", std::max(1, n / 10), [&](int) {
+        for (Project* project : projectDAO.selectAll()) delete project;
+    }));
+
+    // --- StatisticsAnalyzer 报表 ---
+    StatisticsAnalyzer analyzer;
+    results.push_back(measure("stats.daily_report", n, [&](int) {
+        analyzer.generateDailyReport();
+    }));
+    results.push_back(measure("stats.weekly_report", n, [&](int) {
+        analyzer.generateWeeklyReport();
+    }));
+    results.push_back(measure("stats.monthly_report", n, [&](int) {
+        analyzer.generateMonthlyReport();
+    }));
+    results.push_back(measure("stats.summary", n, [&](int) {
+        analyzer.generateSummary();
+    }));
+
+    // --- XPSystem ---
+    XPSystem xpSystem;
+    results.push_back(measure("xp.award_xp", n, [&](int i) {
+        xpSystem.awardXP(5 + i % 20, "bench");
+    }));
+
+    // --- HeatmapVisualizer ---
+    HeatmapVisualizer heatmap(config.dbPath);
+    results.push_back(measure("heatmap.generate_90d", std::max(1, n / 10), [&](int) {
+        heatmap.generateHeatmap(90);
+    }));
+
+    // --- ReminderSystem：每轮前把状态复位，保证每次都有一半提醒到期 ---
+    sqlite3* reminderConn = nullptr;
+    sqlite3_open(reminderPath.c_str(), &reminderConn);
+    std::unique_ptr<ReminderSystem> reminderSystem;
+    {
+        CoutSilencer silence;  // 构造时会打印加载信息
+        reminderSystem = std::make_unique<ReminderSystem>(createReminderDAO(reminderPath));
+    }
+    results.push_back(measure("reminder.check_due", std::max(1, n / 10),
+        [&](int) { reminderSystem->checkDueReminders(); },
+        [&](int) { resetReminderStatus(reminderConn); }));
+    reminderSystem.reset();
+    sqlite3_close(reminderConn);
+
+    // --- 守护进程 RPC：同进程起服务端，经 Unix 套接字往返；x64 为一次发出 64 个请求的流水线 ---
+    RpcServerOptions rpcOptions;
+    rpcOptions.address = "unix:" + config.dbPath + ".sock";
+    RpcClient rpcClient;
+    if (RpcServer::getInstance().start(rpcOptions) && rpcClient.connect(rpcOptions.address) &&
+        rpcClient.login()) {
+        RpcResponse response;
+        results.push_back(measure("rpc.ping", n, [&](int) {
+            rpcClient.call(RpcOp::Ping, std::string(), response);
+        }));
+        results.push_back(measure("rpc.get_by_id", n, [&](int) {
+            rpcClient.call(RpcOp::TaskGet, RpcWriter().i32(taskIdDist(rng)).data(), response);
+        }));
+        results.push_back(measure("rpc.ping_x64", std::max(1, n / 10), [&](int) {
+            for (int k = 0; k < 64; ++k) rpcClient.send(RpcOp::Ping);
+            rpcClient.flush();
+            for (int k = 0; k < 64; ++k) rpcClient.receive(response);
+        }));
+        results.push_back(measure("rpc.get_by_id_x64", std::max(1, n / 10), [&](int) {
+            for (int k = 0; k < 64; ++k) {
+                rpcClient.send(RpcOp::TaskGet, RpcWriter().i32(taskIdDist(rng)).data());
+            }
+            rpcClient.flush();
+            for (int k = 0; k < 64; ++k) rpcClient.receive(response);
+        }));
+    } else {
+        std::cerr << "RPC 基准跳过: " << rpcClient.getLastError() << std::endl;
+    }
+    rpcClient.close();
+    RpcServer::destroyInstance();
+
+    writeJson(config.jsonPath, config, results);
+    std::cout << "\nJSON 结果已写入 " << config.jsonPath << std::endl;
+    db.dumpSlowestStatements(std::cout, 5);
+    if (!config.tracePath.empty() && Tracer::writeChromeTrace(config.tracePath)) {
+        std::cout << "追踪数据已写入 " << config.tracePath << " (" << Tracer::eventCount() << " 个事件)" << std::endl;
+    }
+
+    XPLedger::destroyInstance();
+    DatabaseManager::destroyInstance();
+    QueryProfiler::destroyInstance();
+    removeDatabaseFiles(config.dbPath);
+    removeDatabaseFiles(reminderPath);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file multi_user_bench.cpp
+ * @brief 多用户分区基准：验证按 user_id 查询的延迟不随用户数增长
+ *
+ * 对 10 / 100 / 1000 / 10000 个用户分别建库，每个用户写入固定数量的任务，
+ * 然后随机抽样用户执行 DAO / 统计 / XP 的单用户查询，输出平均延迟。
+ * 复合索引 (user_id, ...) 生效时，各列的数值应基本持平。
+ *
+ * 用法: ./bin/multi_user_bench [每用户任务数=20] [抽样次数=500]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <sqlite3.h>
+#include "database/DatabaseManager.h"
+#include "database/DAO/TaskDAO.h"
+#include "statistics/StatisticsAnalyzer.h"
+#include "gamification/XPSystem.h"
+
+namespace {
+
+const char* BENCH_DB = "bench_multi_user.db";
+
+void removeDatabaseFiles() {
+    std::remove(BENCH_DB);
+    std::remove((std::string(BENCH_DB) + "-wal").c_str());
+    std::remove((std::string(BENCH_DB) + "-shm").c_str());
+}
+
+// 直接走预编译语句批量写入，避免种子数据本身成为瓶颈
+bool seedUsers(DatabaseManager& db, int userCount, int tasksPerUser) {
+    sqlite3* conn = db.getRawConnection();
+    sqlite3_stmt* userStmt = nullptr;
+    sqlite3_stmt* statsStmt = nullptr;
+    sqlite3_stmt* taskStmt = nullptr;
+
+    sqlite3_prepare_v2(conn, "INSERT OR IGNORE INTO users (id, username) VALUES (?, ?);", -1, &userStmt, nullptr);
+    sqlite3_prepare_v2(conn, "INSERT OR IGNORE INTO user_stats (user_id, total_xp, level, current_streak) "
+                             "VALUES (?, ?, 1, ?);", -1, &statsStmt, nullptr);
+    // project_id 显式写 NULL：列默认值 0 会触发 projects 外键约束
+    sqlite3_prepare_v2(conn, "INSERT INTO tasks (title, completed, completed_date, user_id, project_id) "
+                             "VALUES (?, ?, datetime('now', ?), ?, NULL);", -1, &taskStmt, nullptr);
+    if (!userStmt || !statsStmt || !taskStmt) {
+        std::cerr << "准备种子语句失败: " << sqlite3_errmsg(conn) << std::endl;
+        return false;
+    }
+
+    db.beginTransaction();
+    for (int user = 1; user <= userCount; ++user) {
+        const std::string name = "user_" + std::to_string(user);
+        sqlite3_bind_int(userStmt, 1, user);
+        sqlite3_bind_text(userStmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(userStmt);
+        sqlite3_reset(userStmt);
+
+        sqlite3_bind_int(statsStmt, 1, user);
+        sqlite3_bind_int(statsStmt, 2, user * 7 % 5000);
+        sqlite3_bind_int(statsStmt, 3, user % 30);
+        sqlite3_step(statsStmt);
+        sqlite3_reset(statsStmt);
+
+        for (int t = 0; t < tasksPerUser; ++t) {
+            const std::string title = "Task " + std::to_string(t);
+            const std::string offset = "-" + std::to_string(t % 14) + " days";
+            sqlite3_bind_text(taskStmt, 1, title.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(taskStmt, 2, t % 3 == 0 ? 1 : 0);
+            sqlite3_bind_text(taskStmt, 3, offset.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(taskStmt, 4, user);
+            sqlite3_step(taskStmt);
+            sqlite3_reset(taskStmt);
+        }
+    }
+    db.commitTransaction();
+
+    sqlite3_finalize(userStmt);
+    sqlite3_finalize(statsStmt);
+    sqlite3_finalize(taskStmt);
+    return true;
+}
+
+template <typename Fn>
+double averageMicros(const std::vector<int>& users, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int user : users) {
+        fn(user);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / users.size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const int tasksPerUser = argc > 1 ? std::atoi(argv[1]) : 20;
+    const int samples = argc > 2 ? std::atoi(argv[2]) : 500;
+    const std::vector<int> userCounts = {10, 100, 1000, 10000};
+
+    std::cout << "\n多用户分区基准 (每用户 " << tasksPerUser << " 个任务, 每组抽样 "
+              << samples << " 次)\n";
+    std::cout << std::left
+              << std::setw(8) << "users" << std::setw(10) << "tasks"
+              << std::setw(16) << "dao_pending_us" << std::setw(16) << "stats_done_us"
+              << std::setw(16) << "stats_week_us" << std::setw(16) << "streak_us"
+              << std::setw(12) << "xp_us" << "\n";
+
+    std::mt19937 rng(42);
+    volatile long sink = 0;
+
+    for (int userCount : userCounts) {
+        removeDatabaseFiles();
+        DatabaseManager& db = DatabaseManager::getInstance();
+        if (!db.initialize(BENCH_DB) || !seedUsers(db, userCount, tasksPerUser)) {
+            return 1;
+        }
+
+        std::uniform_int_distribution<int> pick(1, userCount);
+        std::vector<int> users(samples);
+        for (int& u : users) u = pick(rng);
+
+        TaskDAOImpl dao(BENCH_DB);
+        StatisticsAnalyzer stats;
+        XPSystem xp;
+
+        double daoUs = averageMicros(users, [&](int user) {
+            dao.setUserId(user);
+            sink += dao.getTasksByStatus(false).size();
+        });
+        double doneUs = averageMicros(users, [&](int user) {
+            stats.setCurrentUserId(user);
+            sink += stats.getTotalTasksCompleted();
+        });
+        double weekUs = averageMicros(users, [&](int user) {
+            stats.setCurrentUserId(user);
+            sink += stats.getTasksCompletedThisWeek();
+        });
+        double streakUs = averageMicros(users, [&](int user) {
+            stats.invalidateCache(user);  // 测量未命中缓存的路径
+            stats.setCurrentUserId(user);
+            sink += stats.getCurrentStreak();
+        });
+        double xpUs = averageMicros(users, [&](int user) {
+            xp.invalidateCache(user);
+            sink += xp.getTotalXP(user);
+        });
+
+        std::cout << std::left << std::fixed << std::setprecision(1)
+                  << std::setw(8) << userCount << std::setw(10) << (userCount * tasksPerUser)
+                  << std::setw(16) << daoUs << std::setw(16) << doneUs
+                  << std::setw(16) << weekUs << std::setw(16) << streakUs
+                  << std::setw(12) << xpUs << "\n";
+
+        DatabaseManager::destroyInstance();
+    }
+
+    removeDatabaseFiles();
+    return sink < 0 ? 1 : 0;
+}
@@ -61,11 +61,13 @@ struct BaseEntity {
 };
 
 /**
- * @brief 任务实体 - 核心业务对象
+ * @brief 任务实体 - tasks 表的完整行结构
  * 
  * 负责人: Kuang Wenqing (任务管理模块)
+ * 注意: 业务对象 class Task 定义在 include/task/task.h，
+ * 这里命名为 TaskRecord 以免两者同时被包含时重定义
  */
-struct Task : BaseEntity {
+struct TaskRecord : BaseEntity {
     std::string title;                   // 任务标题
     std::string description;             // 任务描述
     int priority = 1;                    // 优先级 (0:低, 1:中, 2:高)
@@ -78,8 +80,8 @@ struct Task : BaseEntity {
     std::string completed_date;          // 完成时间
     std::string reminder_time;           // 提醒时间
     
-    Task() = default;
-    Task(const std::string& t, const std::string& desc = "", int prio = 1) 
+    TaskRecord() = default;
+    TaskRecord(const std::string& t, const std::string& desc = "", int prio = 1) 
         : title(t), description(desc), priority(prio) {}
 };
 
@@ -4,7 +4,10 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <memory>
 #include <sqlite3.h>
+#include "database/ChangeFeed.h"
+#include "database/DatabaseManager.h"
 
 using namespace std;
 
@@ -12,6 +15,13 @@ class HeatmapVisualizer {
 private:
     sqlite3* db;
     string dbPath;
+    int currentUserId;  // 只统计该用户的任务
+    
+    // 按天数缓存每日完成数；tasks 有提交或跨过 UTC 日期时作废
+    // （task_rollups 是 WITHOUT ROWID 表不产生事件，但归档总是伴随 tasks 的删除）
+    map<int, map<string, int>> dailyCountsCache;
+    string dailyCountsDay;
+    unique_ptr<ChangeSubscription> taskChanges;
     
     bool openDatabase();
     void closeDatabase();
@@ -23,9 +33,13 @@ private:
     
 public:
     HeatmapVisualizer();
-    HeatmapVisualizer(string dbPath);
+    explicit HeatmapVisualizer(string dbPath, int userId = DatabaseManager::DEFAULT_USER_ID);
     ~HeatmapVisualizer();
     
+    // === 多用户 ===
+    void setCurrentUserId(int userId);
+    int getCurrentUserId() const;
+    
     bool initialize();
     
     string generateHeatmap(int days = 90);
@@ -0,0 +1,192 @@
+#ifndef POMODORO_ENGINE_H
+#define POMODORO_ENGINE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+
+struct sqlite3;
+
+/**
+ * @brief 番茄钟阶段 / 状态
+ */
+enum class PomodoroPhase { Work, ShortBreak, LongBreak };
+enum class PomodoroState { Running, Paused, Finished, Interrupted };
+
+/**
+ * @brief 番茄钟时长配置
+ */
+struct PomodoroDurations {
+    std::chrono::seconds work{std::chrono::minutes(25)};
+    std::chrono::seconds shortBreak{std::chrono::minutes(5)};
+    std::chrono::seconds longBreak{std::chrono::minutes(15)};
+    int longBreakEvery = 4;     // 每完成几个工作番茄进入一次长休息
+    bool autoStartBreak = true; // 工作结束后自动进入休息
+};
+
+/**
+ * @brief 会话快照（对外只读）
+ */
+struct PomodoroSessionInfo {
+    int id = 0;
+    int userId = 0;
+    int taskId = 0;
+    PomodoroPhase phase = PomodoroPhase::Work;
+    PomodoroState state = PomodoroState::Running;
+    int completedCycles = 0;
+    std::chrono::seconds remaining{0};
+};
+
+/**
+ * @brief 一个阶段结束（完成或中断）的记录，既用于落库也用于发放奖励
+ */
+struct PomodoroRecord {
+    int sessionId = 0;
+    int userId = 0;
+    int taskId = 0;
+    PomodoroPhase phase = PomodoroPhase::Work;
+    bool completed = false;
+    bool interrupted = false;
+    std::string reason;
+    std::string startTime;   // UTC "YYYY-MM-DD HH:MM:SS"
+    std::string endTime;
+    int durationMinutes = 0;
+};
+
+/**
+ * @brief 事件循环驱动的番茄钟引擎
+ *
+ * 单个后台线程管理任意数量的会话：每个会话是一个状态机，截止时间用
+ * steady_clock 记录，线程只在最近的截止时间或下一次批量写入时醒来。
+ * 阶段结束的记录按批写入 pomodoro_sessions，并累加 tasks.pomodoro_count
+ * 和 user_stats.total_pomodoros；完成的工作番茄另外排队，由 UI 线程
+ * 通过 drainCompletions() 取走后发放经验值（XPSystem 不是线程安全的）。
+ *
+ * 批量写入走引擎自己的连接和事务，不占用 DatabaseManager 的共享连接，
+ * 其他线程在共享连接上的语句不会落进这批写入里。
+ */
+class PomodoroEngine {
+private:
+    struct Session {
+        int id = 0;
+        int userId = 0;
+        int taskId = 0;
+        PomodoroPhase phase = PomodoroPhase::Work;
+        PomodoroState state = PomodoroState::Running;
+        PomodoroDurations durations;
+        int completedCycles = 0;
+        unsigned generation = 0;  // 暂停/恢复后递增，使堆里的旧截止时间失效
+        std::chrono::steady_clock::time_point phaseStart;
+        std::chrono::steady_clock::time_point deadline;
+        std::chrono::steady_clock::duration remaining{0};  // 暂停时剩余时长
+        std::string phaseStartTime;
+    };
+
+    struct Deadline {
+        std::chrono::steady_clock::time_point when;
+        int sessionId;
+        unsigned generation;
+        bool operator>(const Deadline& other) const { return when > other.when; }
+    };
+
+    static std::unique_ptr<PomodoroEngine> instance;
+    static std::mutex instanceMutex;
+
+    mutable std::mutex engineMutex;
+    std::condition_variable wakeup;
+    std::thread loopThread;
+    bool running = false;
+
+    std::map<int, Session> sessions;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+    int nextSessionId = 1;
+    PomodoroDurations defaultDurations;
+
+    // 待落库记录与待发放奖励
+    std::vector<PomodoroRecord> pendingWrites;
+    std::vector<PomodoroRecord> completions;
+    std::map<int, int> completedWorkByUser;  // 本次运行内完成的工作番茄数
+    size_t batchSize = 16;
+    std::chrono::seconds flushInterval{2};
+    std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+
+    // 落库专用连接，第一次写入时打开，stop() 时关闭
+    std::mutex writerMutex;
+    sqlite3* writer = nullptr;
+    std::string writerPath;
+
+    void loop();
+    void scheduleLocked(Session& session);
+    void beginPhaseLocked(Session& session, PomodoroPhase phase);
+    void onDeadlineLocked(Session& session, std::chrono::steady_clock::time_point now);
+    void recordLocked(const Session& session, bool completed, bool interrupted,
+                      const std::string& reason);
+    // 返回 false 表示整批需要重试（打不开连接、锁冲突、提交失败）；单行的其他错误记录后丢弃
+    bool writeBatch(const std::vector<PomodoroRecord>& batch);
+    bool openWriterLocked(const std::string& dbPath);
+    void closeWriter();
+    PomodoroSessionInfo toInfo(const Session& session,
+                               std::chrono::steady_clock::time_point now) const;
+    std::chrono::seconds phaseLength(const Session& session, PomodoroPhase phase) const;
+
+    static std::string currentTimestamp();
+
+public:
+    PomodoroEngine() = default;
+    ~PomodoroEngine();
+    PomodoroEngine(const PomodoroEngine&) = delete;
+    PomodoroEngine& operator=(const PomodoroEngine&) = delete;
+
+    static PomodoroEngine& getInstance();
+    static void destroyInstance();
+
+    // === 生命周期 ===
+
+    void start();
+    /**
+     * @brief 停止事件循环并写入剩余记录；仍在进行的会话按中断处理
+     */
+    void stop();
+    bool isRunning() const;
+
+    void setDefaultDurations(const PomodoroDurations& durations);
+    void setBatchPolicy(size_t maxRecords, std::chrono::seconds interval);
+
+    // === 会话控制（均为非阻塞） ===
+
+    /**
+     * @brief 开始一个会话，返回会话ID；taskId 为 0 表示不关联任务
+     */
+    int startSession(int userId, int taskId, PomodoroPhase phase = PomodoroPhase::Work);
+    int startSession(int userId, int taskId, PomodoroPhase phase, const PomodoroDurations& durations);
+    bool pause(int sessionId);
+    bool resume(int sessionId);
+    bool interrupt(int sessionId, const std::string& reason = "");
+
+    // === 查询 ===
+
+    bool getSession(int sessionId, PomodoroSessionInfo& info) const;
+    std::vector<PomodoroSessionInfo> listSessions(int userId) const;
+    size_t activeSessionCount() const;
+    int getCompletedWorkCount(int userId) const;
+
+    /**
+     * @brief 取走自上次调用以来完成的工作番茄（在 UI 线程发放经验值）
+     */
+    std::vector<PomodoroRecord> drainCompletions();
+
+    /**
+     * @brief 立即写入所有待落库记录
+     */
+    bool flush();
+
+    static std::string phaseName(PomodoroPhase phase);
+};
+
+#endif // POMODORO_ENGINE_H
@@ -1,20 +1,36 @@
 #ifndef POMODORO_H
 #define POMODORO_H
 
+#include "Pomodoro/PomodoroEngine.h"
+
+/**
+ * @brief 单个用户的番茄钟句柄
+ *
+ * 计时交给 PomodoroEngine 的事件循环，这里的方法都会立即返回。
+ */
 class Pomodoro {
 private:
     int workDuration;       // minutes
     int breakDuration;      // minutes
     int longBreakDuration;  // minutes
-    int cycleCount;
+    int userId;
+    int currentSessionId;
+
+    PomodoroDurations durations() const;
+    int startPhase(PomodoroPhase phase, int taskId);
 
 public:
-    Pomodoro(int work = 25, int brk = 5, int longBrk = 15);
+    Pomodoro(int work = 25, int brk = 5, int longBrk = 15, int userId = 1);
+
+    int startWork(int taskId = 0);
+    int startBreak();
+    int startLongBreak();
 
-    void startWork();
-    void startBreak();
-    void startLongBreak();
+    bool pause();
+    bool resume();
+    bool interrupt(const std::string& reason = "");
 
+    int getCurrentSessionId() const;
     int getCycleCount() const;
 };
 
@@ -0,0 +1,102 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iosfwd>
+#include <streambuf>
+
+class DatabaseManager;
+class TaskDAOImpl;
+class TaskManager;
+class XPSystem;
+
+/**
+ * @brief 无界面的批处理命令行，供脚本和定时任务调用
+ *
+ * 带参数启动 task_manager 时进入此模式：不播放启动动画、不等待回车，
+ * 只有真正需要读写数据时才打开数据库。
+ *
+ *   task_manager [--db FILE] [--user N] [--verbose] <命令> [参数...]
+ *
+ * 命令: add, complete, delete, list, report, import, export, batch, backup, restore, maintain,
+ *       depend, ready, critical-path, next, tag, tagged, check-plans, help
+ *
+ * batch 从标准输入（或文件）逐行读取上述命令，全部放在一个事务里执行，
+ * 适合一次写入大量任务。各模块自己打印到 std::cout 的提示信息在此模式下
+ * 默认丢弃，只保留命令本身的输出，--verbose 可恢复。
+ */
+class CommandLine {
+public:
+    CommandLine();
+    ~CommandLine();
+    CommandLine(const CommandLine&) = delete;
+    CommandLine& operator=(const CommandLine&) = delete;
+
+    /**
+     * @brief 以 main 的参数运行，返回进程退出码
+     */
+    int run(int argc, char* argv[]);
+
+    /**
+     * @brief 按 shell 规则拆分一行命令（支持单/双引号和反斜杠转义）
+     */
+    static std::vector<std::string> tokenize(const std::string& line);
+
+private:
+    // 丢弃写入内容的 streambuf，用于屏蔽模块的提示输出
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int ch) override { return ch; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    std::string dbPath = "task_manager.db";
+    int userId;
+    bool verbose = false;
+    bool inBatch = false;
+    bool serving = false;    // serve：通知器既发送也接收
+
+    NullBuffer nullBuffer;
+    std::streambuf* savedCoutBuffer = nullptr;
+    std::unique_ptr<std::ostream> out;     // 命令输出，始终指向真正的标准输出
+
+    DatabaseManager* db = nullptr;
+    std::unique_ptr<TaskDAOImpl> taskDao;
+    std::unique_ptr<TaskManager> taskManager;
+    std::unique_ptr<XPSystem> xpSystem;
+
+    bool openDatabase();
+    void shutdown();
+
+    int dispatch(const std::vector<std::string>& args);
+    int cmdAdd(const std::vector<std::string>& args);
+    int cmdComplete(const std::vector<std::string>& args);
+    int cmdDelete(const std::vector<std::string>& args);
+    int cmdList(const std::vector<std::string>& args);
+    int cmdReport(const std::vector<std::string>& args);
+    int cmdImport(const std::vector<std::string>& args);
+    int cmdExport(const std::vector<std::string>& args);
+    int cmdBatch(const std::vector<std::string>& args);
+    int cmdBackup(const std::vector<std::string>& args);
+    int cmdRestore(const std::vector<std::string>& args);
+    int cmdMaintain(const std::vector<std::string>& args);
+    int cmdDepend(const std::vector<std::string>& args);
+    int cmdReady(const std::vector<std::string>& args);
+    int cmdCriticalPath(const std::vector<std::string>& args);
+    int cmdNext(const std::vector<std::string>& args);
+    int cmdTag(const std::vector<std::string>& args);
+    int cmdTagged(const std::vector<std::string>& args);
+    int cmdCheckPlans(const std::vector<std::string>& args);
+    int cmdServe(const std::vector<std::string>& args);
+    void printUsage(std::ostream& os) const;
+
+    // 包住一条写多行的命令（import），失败时只撤销这条命令
+    bool beginWork();
+    bool finishWork(bool commit);
+    int importRows(std::istream& in);
+    int runBatch(std::istream& in, bool atomic, long long commitEvery);
+};
+
+#endif // COMMAND_LINE_H
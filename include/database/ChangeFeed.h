@@ -0,0 +1,179 @@
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+#include <thread>
+#include <sqlite3.h>
+
+enum class ChangeOp { Insert, Update, Delete };
+
+/**
+ * @brief 一行数据的变更（只记录 main 库中有 rowid 的表；WITHOUT ROWID 表和临时表不触发）
+ */
+struct RowChange {
+    ChangeOp op = ChangeOp::Update;
+    std::string table;
+    sqlite3_int64 rowid = 0;
+};
+
+/**
+ * @brief 一次提交中的全部变更，按发生顺序
+ */
+struct ChangeBatch {
+    std::vector<RowChange> changes;
+    std::vector<std::string> truncatedTables;   // 这些表有变更但不知道是哪些行
+    bool truncated = false;     // 积压太多被丢弃明细，按"订阅的表都变了"处理
+    bool remote = false;        // 来自其他进程（ChangeNotifier），不再向外转发
+
+    bool touches(const std::string& table) const;
+    std::vector<sqlite3_int64> rowids(const std::string& table) const;   // 去重、升序
+};
+
+/**
+ * @brief 基于 SQLite 钩子的变更流
+ *
+ * attach() 之后，该连接上 main 库的每次行写入由 update_hook 记入待提交列表，
+ * commit_hook 把它们移入已提交列表，rollback_hook 丢弃；提交完成、写锁释放后
+ * SQLite 调用 wal_hook，此时把这一批发布给订阅者。DAO 直接 prepare/step
+ * 原始连接的写入同样会被捕获。
+ *
+ * - 回调在提交所在的线程上同步执行，持有订阅表的锁：只应记录失效信息，不能写库，
+ *   也不能在回调里订阅/退订；重活留给自己的线程（见 ChangeSubscription）
+ * - ROLLBACK TO 不触发 rollback_hook，被回滚的保存点里的变更仍会随外层事务发布；
+ *   事件只能当作"可能变了"的失效提示，不能当作变更的权威记录
+ * - wal_hook 与 wal_autocheckpoint 共用同一个槽位，挂上之后自动检查点由本类代做，
+ *   阈值通过 setAutocheckpoint() 设置；不要再对已挂载的连接执行 PRAGMA wal_autocheckpoint
+ * - 只在 WAL 模式下发布（DatabaseManager 打开的库总是 WAL）
+ */
+class ChangeFeed {
+public:
+    using Listener = std::function<void(const ChangeBatch&)>;
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t rolledBack = 0;   // 被整体回滚丢弃的行
+        std::uint64_t remoteBatches = 0;
+    };
+
+private:
+    static std::unique_ptr<ChangeFeed> instance;
+    static std::mutex instanceMutex;
+
+    // 每个连接各自的缓冲；钩子只在该连接执行语句的线程上调用
+    struct Connection {
+        ChangeFeed* feed = nullptr;
+        sqlite3* db = nullptr;
+        std::vector<RowChange> pending;
+        std::vector<RowChange> committed;
+        int autocheckpointPages = 1000;   // SQLite 的默认值
+    };
+    std::unordered_map<sqlite3*, std::unique_ptr<Connection>> connections;
+    mutable std::mutex connectionsMutex;
+
+    std::vector<std::pair<int, Listener>> listeners;
+    int nextListenerId = 1;
+    mutable std::mutex listenersMutex;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    static void updateHook(void* self, int op, const char* dbName, const char* table, sqlite3_int64 rowid);
+    static int commitHook(void* self);
+    static void rollbackHook(void* self);
+    static int walHook(void* self, sqlite3* db, const char* dbName, int frames);
+
+    void publish(Connection& conn);
+
+public:
+    ChangeFeed() = default;
+    ~ChangeFeed() = default;
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    static ChangeFeed& getInstance();
+    static void destroyInstance();
+
+    void attach(sqlite3* db);
+    void detach(sqlite3* db);
+
+    /**
+     * @brief 已挂载连接的自动检查点阈值（页），<= 0 关闭
+     */
+    void setAutocheckpoint(sqlite3* db, int pages);
+
+    /**
+     * @brief 订阅所有已挂载连接的提交
+     * @return 订阅 ID，供 unsubscribe() 使用
+     */
+    int subscribe(Listener listener);
+    void unsubscribe(int id);
+
+    /**
+     * @brief 发布一个 truncated 批次：恢复备份等不经过行钩子的整库替换之后调用
+     */
+    void notifyAllChanged();
+
+    /**
+     * @brief 把其他进程提交的变更发布给本进程的订阅者（标记为 remote）
+     */
+    void publishRemote(ChangeBatch batch);
+
+    Stats getStats() const;
+};
+
+/**
+ * @brief 只关心若干张表的订阅：回调线程里只把变更攒起来，由持有者在自己的线程上取走
+ *
+ * 供非线程安全的缓存（XPSystem、StatisticsAnalyzer 等）使用，析构时自动退订。
+ */
+class ChangeSubscription {
+private:
+    static constexpr size_t MAX_PENDING = 4096;   // 超过后只保留 truncated 标记
+
+    std::vector<std::string> tables;
+    int id = 0;
+    mutable std::mutex mutex;
+    ChangeBatch collected;
+    std::thread::id mutedThread;   // 该线程上提交的批次不收集
+
+public:
+    /**
+     * @brief 作用域内当前线程提交的变更不收集
+     *
+     * 持有者自己的写入已经同步更新了缓存，回声不必再让缓存失效。回调在提交线程上
+     * 同步执行，所以只会跳过作用域内本线程的提交；作用域内开始、结束后才提交的
+     * 外层事务照常收集。可以嵌套。
+     */
+    class Mute {
+    private:
+        ChangeSubscription& subscription;
+        std::thread::id previous;
+
+    public:
+        explicit Mute(ChangeSubscription& subscription);
+        ~Mute();
+        Mute(const Mute&) = delete;
+        Mute& operator=(const Mute&) = delete;
+    };
+
+    explicit ChangeSubscription(std::vector<std::string> tables);
+    ~ChangeSubscription();
+    ChangeSubscription(const ChangeSubscription&) = delete;
+    ChangeSubscription& operator=(const ChangeSubscription&) = delete;
+
+    bool hasChanges() const;
+
+    /**
+     * @brief 取走订阅以来（或上次取走以来）的变更
+     */
+    ChangeBatch take();
+};
+
+#endif // CHANGE_FEED_H
@@ -0,0 +1,114 @@
+#ifndef CHANGE_NOTIFIER_H
+#define CHANGE_NOTIFIER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sqlite3.h>
+#include "database/ChangeFeed.h"
+
+/**
+ * @brief 跨进程变更通知的参数
+ */
+struct ChangeNotifierOptions {
+    std::chrono::milliseconds pollInterval{1000};   // data_version 兜底检查、重新扫描其他进程的周期
+    bool receive = true;                            // false：只把本进程的提交发出去（命令行一次性进程）
+    size_t maxDatagramBytes = 16 * 1024;            // 超过后只发表名，不发 rowid
+};
+
+/**
+ * @brief 同一个数据库文件上多个进程之间的变更通知
+ *
+ * 每个接收方进程在 <db>-notify/ 目录下绑定 <pid>.sock（Unix 数据报套接字）。
+ * 本进程 ChangeFeed 发布的每一批提交按表汇总成一条文本数据报，发给目录里的
+ * 其他套接字；收到的数据报由后台线程经 ChangeFeed::publishRemote() 交给本进程
+ * 的订阅者，于是 XPSystem 等缓存只作废真正变了的表和行。
+ *
+ *     TMCF1
+ *     R <表> <rowid> <rowid> ...     行级变更
+ *     T <表>                         表有变更，行未知（批次过大）
+ *     *                              整库可能都变了（恢复备份）
+ *     H                              新进程上线，把发送方加入对端列表
+ *
+ * 兜底：后台线程在专用只读连接上记下 PRAGMA data_version，每次收到通知或
+ * 本进程提交后立即重新取基线；每个 pollInterval 再读一次，版本变了却没有对应的
+ * 通知（sqlite3 命令行、没有启用通知的进程、缓冲区满被丢弃的数据报），就发布
+ * 一个 truncated 批次让所有订阅者整体失效。紧跟在一次已通知提交之后、重新取
+ * 基线之前（通常不到 1 毫秒）的外部提交会被合并进去而漏掉。
+ *
+ * 发送在提交线程的 ChangeFeed 回调里完成，使用 MSG_DONTWAIT，不会阻塞提交；
+ * 对端套接字已无人监听（进程崩溃）时删除其文件。
+ */
+class ChangeNotifier {
+public:
+    struct Stats {
+        std::uint64_t sent = 0;             // 发出的数据报
+        std::uint64_t received = 0;         // 收到并发布的批次
+        std::uint64_t dropped = 0;          // 对端缓冲区满而丢弃的数据报
+        std::uint64_t fallbackInvalidations = 0;   // data_version 兜底触发的整体失效
+        size_t peers = 0;
+    };
+
+private:
+    static std::unique_ptr<ChangeNotifier> instance;
+    static std::mutex instanceMutex;
+
+    ChangeNotifierOptions options;
+    std::string dirPath;
+    std::string socketPath;             // 只发送时为空
+    int sockFd = -1;
+    int wakePipe[2] = {-1, -1};
+    sqlite3* versionConn = nullptr;
+    int listenerId = 0;
+
+    mutable std::mutex lifecycleMutex;
+    std::thread receiver;
+    std::atomic<bool> running{false};
+
+    mutable std::mutex peersMutex;
+    std::vector<std::string> peers;
+
+    // 本进程提交 + 收到的通知数，兜底检查据此判断 data_version 的变化是否已有解释
+    std::atomic<std::uint64_t> activity{0};
+    long long lastDataVersion = -1;
+    std::uint64_t lastActivity = 0;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void run();
+    void scanPeers();
+    void broadcast(const std::string& message);
+    void handleDatagram(const std::string& message, const std::string& sender);
+    void syncDataVersion();
+    void checkDataVersion();
+    long long readDataVersion();
+
+    std::string encode(const ChangeBatch& batch) const;
+    static bool decode(const std::string& message, ChangeBatch& batch, bool& hello);
+
+public:
+    ChangeNotifier() = default;
+    ~ChangeNotifier();
+    ChangeNotifier(const ChangeNotifier&) = delete;
+    ChangeNotifier& operator=(const ChangeNotifier&) = delete;
+
+    static ChangeNotifier& getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 开始在 dbPath 对应的通知目录上收发
+     */
+    bool start(const std::string& dbPath, const ChangeNotifierOptions& opts = ChangeNotifierOptions());
+    void stop();
+    bool isRunning() const { return running; }
+
+    Stats getStats() const;
+};
+
+#endif // CHANGE_NOTIFIER_H
@@ -2,6 +2,7 @@
 #define PROJECT_DAO_H
 
 #include "../../project/Project.h"
+#include "../DatabaseManager.h"
 #include <vector>
 #include <string>
 #include <sqlite3.h>
@@ -12,13 +13,14 @@ class ProjectDAO {
 private:
     sqlite3* db;
     string dbPath;
+    int userId;     // 只读写该用户的项目
     
     bool openDatabase();
     void closeDatabase();
 
 public:
     ProjectDAO();
-    ProjectDAO(string dbPath);
+    ProjectDAO(string dbPath, int userId = DatabaseManager::DEFAULT_USER_ID);
     ~ProjectDAO();
     
     bool createTable();
@@ -6,6 +6,7 @@
 #include <optional>
 #include <chrono>
 #include <string>
+#include <memory>
 
 class ReminderDAO {
 public:
@@ -56,6 +57,9 @@ public:
     virtual int getOverdueReminderCount() = 0;
 };
 
+// 创建 SQLite 实现（独立的 reminders.db），初始化失败返回 nullptr
+std::unique_ptr<ReminderDAO> createReminderDAO(const std::string& dbPath = "reminders.db");
+
 #endif // REMINDER_DAO_H
 
 
@@ -5,6 +5,11 @@
 #include <optional>
 #include <string>
 #include "task/task.h"
+#include "task/DependencyGraph.h"
+#include "task/TaskScheduler.h"
+#include "task/TagIndex.h"
+#include "database/DatabaseManager.h"
+#include "database/QueryPlanChecker.h"
 
 class TaskDAO {
 public:
@@ -17,6 +22,7 @@ public:
     virtual int insertTask(const Task& task) = 0;
     virtual std::optional<Task> getTaskById(int id) = 0;
     virtual std::vector<Task> getAllTasks() = 0;
+    virtual std::vector<Task> getTasksByIds(const std::vector<int>& ids) = 0;  // 不存在的 ID 不出现在结果中
     virtual bool updateTask(const Task& task) = 0;
     virtual bool deleteTask(int id) = 0;
     
@@ -36,25 +42,57 @@ public:
     // 番茄钟
     virtual bool incrementPomodoro(int taskId) = 0;
     virtual int getPomodoroCount(int taskId) = 0;
+    
+    // 任务依赖：dependsOn 完成后 taskId 才能开始
+    virtual bool addDependency(int taskId, int dependsOn) = 0;
+    virtual bool removeDependency(int taskId, int dependsOn) = 0;
+    // 读取未删除任务的调度属性和它们之间的依赖，edges 为 (taskId, dependsOn)
+    virtual bool loadDependencyGraph(std::vector<DependencyNode>& nodes,
+                                     std::vector<std::pair<int, int>>& edges) = 0;
+    
+    // 排程：未完成任务的优先级、截止日期、番茄进度及项目 target_date
+    virtual bool loadScheduleEntries(std::vector<ScheduleEntry>& entries) = 0;
+    virtual std::optional<ScheduleEntry> getScheduleEntry(int taskId) = 0;  // 已完成/删除时为空
+    
+    // 标签：tags 先规范化（去首尾空白、转小写、去重），再整体替换任务的标签并同步 tasks.tags；
+    // interned 返回落库后的 (标签ID, 名称)，新名称会插入 tags 表
+    virtual bool setTaskTags(int taskId, const std::vector<std::string>& tags,
+                             std::vector<std::pair<int, std::string>>& interned) = 0;
+    virtual std::vector<std::string> getTaskTags(int taskId) = 0;
+    // 读取标签字典及未删除任务的状态、项目、标签
+    virtual bool loadTagIndex(std::vector<std::pair<int, std::string>>& tags,
+                              std::vector<TaggedTask>& tasks) = 0;
 };
 
 // SQLite具体实现类
 class TaskDAOImpl : public TaskDAO {
 private:
     std::string databasePath;
+    int userId;            // 多用户：所有查询都限定在该用户的分区内
+    sqlite3* connection = nullptr;  // 非空时使用调用方提供的连接，而不是 DatabaseManager 的共享连接
     
     // 数据库连接辅助方法
     sqlite3* getDatabaseConnection();
     bool executeSQL(const std::string& sql);
     
 public:
-    TaskDAOImpl(const std::string& dbPath = "task_manager.db");
+    TaskDAOImpl(const std::string& dbPath = "task_manager.db",
+                int userId = DatabaseManager::DEFAULT_USER_ID);
+    // 绑定到调用方管理生命周期的连接（如只读连接），不建表
+    TaskDAOImpl(sqlite3* connection, int userId);
     virtual ~TaskDAOImpl() = default;
     
+    // 本类执行的语句（参数保留为 ?），供 check-plans 检查执行计划
+    static std::vector<PlannedQuery> queryCatalog();
+    
+    int getUserId() const { return userId; }
+    void setUserId(int id) { userId = id; }
+    
     bool createTable() override;
     int insertTask(const Task& task) override;
     std::optional<Task> getTaskById(int id) override;
     std::vector<Task> getAllTasks() override;
+    std::vector<Task> getTasksByIds(const std::vector<int>& ids) override;
     bool updateTask(const Task& task) override;
     bool deleteTask(int id) override;
     
@@ -70,6 +108,20 @@ public:
     
     bool incrementPomodoro(int taskId) override;
     int getPomodoroCount(int taskId) override;
+    
+    bool addDependency(int taskId, int dependsOn) override;
+    bool removeDependency(int taskId, int dependsOn) override;
+    bool loadDependencyGraph(std::vector<DependencyNode>& nodes,
+                             std::vector<std::pair<int, int>>& edges) override;
+    
+    bool loadScheduleEntries(std::vector<ScheduleEntry>& entries) override;
+    std::optional<ScheduleEntry> getScheduleEntry(int taskId) override;
+    
+    bool setTaskTags(int taskId, const std::vector<std::string>& tags,
+                     std::vector<std::pair<int, std::string>>& interned) override;
+    std::vector<std::string> getTaskTags(int taskId) override;
+    bool loadTagIndex(std::vector<std::pair<int, std::string>>& tags,
+                      std::vector<TaggedTask>& tasks) override;
 };
 
 #endif // TASKDAO_H
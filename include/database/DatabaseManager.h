@@ -8,6 +8,8 @@
 #include <functional>
 #include <mutex>
 #include <atomic>
+#include <thread>
+#include <iosfwd>
 #include <sqlite3.h>
 
 // 前置声明
@@ -27,6 +29,17 @@ struct SQLiteDeleter {
     }
 };
 
+/**
+ * @brief DatabaseManager::backupDatabase / restoreDatabase 的参数
+ */
+struct BackupOptions {
+    int pagesPerStep = 256;      // 每步复制的页数，步与步之间释放锁
+    int pauseMillis = 2;         // 每步之后让出的时间，供写入者插入
+    bool compact = false;        // 用 VACUUM INTO 输出整理后的紧凑文件（不分步）
+    // 每步之后回调（剩余页数, 总页数），返回 false 取消
+    std::function<bool(int remaining, int total)> progress;
+};
+
 class DatabaseManager {
 private:
     static std::unique_ptr<DatabaseManager> instance;
@@ -38,26 +51,34 @@ private:
     std::atomic<long> totalQueryCount{0};
     std::atomic<long> failedQueryCount{0};
     
-    mutable std::mutex dbMutex;
+    // 递归锁：initialize()/close() 持锁期间会再调用 execute()
+    mutable std::recursive_mutex dbMutex;
+    
+    // 后台完整性检查：独立的只读连接，不占用 dbMutex
+    std::thread integrityThread;
+    sqlite3* integrityDb = nullptr;
+    std::atomic<int> integrityStatus{0};
     
     // 预编译语句缓存
     std::unordered_map<std::string, sqlite3_stmt*> preparedStatements;
     std::mutex stmtMutex;  // ✅ 新增：预编译语句的互斥锁
     
-    // 私有方法
-    bool createProjectTable();
-    bool createTaskTable();
-    bool createChallengeTable();
-    bool createReminderTable();
-    bool createAchievementTable();
-    bool createUserStatsTable();
-    bool createUserSettingsTable();
-    bool createPomodoroTable();  // ✅ 新增：Pomodoro表
-    
     // 清理预编译语句
     void cleanupPreparedStatements();
+    
+    // 中断并等待后台完整性检查结束
+    void stopBackgroundIntegrityCheck();
+    
+    // backupDatabase() 的两种实现：分步复制页面 / VACUUM INTO
+    bool copyPagesTo(const std::string& path, const BackupOptions& options);
+    bool vacuumInto(const std::string& path);
 
 public:
+    // 单用户时代遗留的默认用户，所有 user_id 列的默认值
+    static constexpr int DEFAULT_USER_ID = 1;
+    
+    enum class IntegrityStatus { NotRun, Running, Ok, Failed };
+    
     DatabaseManager();
     ~DatabaseManager();
     
@@ -92,17 +113,27 @@ public:
     bool isInTransaction() const;
     
     // 数据库维护
-    bool backupDatabase(const std::string& backupPath);
-    bool restoreDatabase(const std::string& backupPath);
+    bool backupDatabase(const std::string& backupPath, const BackupOptions& options = BackupOptions());
+    bool restoreDatabase(const std::string& backupPath, const BackupOptions& options = BackupOptions());
     bool vacuumDatabase();
+    // WAL 自动检查点阈值（页）：连接挂着 ChangeFeed 的 wal_hook，不能再用 PRAGMA wal_autocheckpoint
+    void setWalAutocheckpoint(int pages);
     bool checkDatabaseIntegrity();
+    bool quickCheckIntegrity();              // PRAGMA quick_check：不校验索引内容，快得多
+    bool startBackgroundIntegrityCheck();    // 在后台线程做完整检查，结果用下面的方法查询
+    IntegrityStatus getBackgroundIntegrityStatus() const;
     
     // 表管理
-    bool createTables();
+    bool createTables();                     // 执行 SchemaMigrator 中未完成的迁移
     bool dropTables();
     bool tableExists(const std::string& tableName);
+    int getSchemaVersion();
     std::vector<std::string> getAllTableNames();
     
+    // 用户管理：确保 users / user_stats 中存在该用户的行
+    bool ensureUser(int userId, const std::string& username = "");
+    std::vector<int> getAllUserIds();
+    
     // 错误处理
     std::string getLastErrorMessage() const;
     int getLastErrorCode() const;
@@ -114,9 +145,17 @@ public:
     double getSuccessRate() const;  // ✅ 新增：成功率
     void resetStatistics();
     
+    // 语句级剖析（见 QueryProfiler，连接打开时自动挂载）
+    void setSlowQueryThreshold(double milliseconds);
+    void setSlowQueryLog(const std::string& path);
+    void dumpSlowestStatements(std::ostream& out, size_t topN = 10) const;
+    
     // 获取原始连接（谨慎使用）
     sqlite3* getRawConnection();
     
+    // 后台线程执行多条语句的批量写入时持有，避免与前台语句交错进同一事务
+    std::unique_lock<std::recursive_mutex> lockConnection();
+    
     std::string getDatabasePath() const;
     
     // ✅ 新增：预编译语句管理
@@ -0,0 +1,137 @@
+#ifndef MAINTENANCE_SCHEDULER_H
+#define MAINTENANCE_SCHEDULER_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sqlite3.h>
+#include "database/TaskArchiver.h"
+
+/**
+ * @brief 后台维护线程的预算与周期
+ */
+struct MaintenanceOptions {
+    std::chrono::milliseconds tickInterval{1000};       // 检查间隔
+    std::chrono::milliseconds idleAfter{2000};          // 多久没有读写算空闲
+    std::chrono::milliseconds stepBudget{50};           // 单个维护语句的最长执行时间，超出即中断
+
+    long long truncateWalBytes = 16LL * 1024 * 1024;    // 空闲时 WAL 超过此大小则 TRUNCATE
+    int walAutocheckpointPages = 10000;                 // 运行期间主连接自动检查点的兜底阈值
+
+    std::chrono::seconds optimizeInterval{3600};        // PRAGMA optimize 周期
+    std::chrono::seconds analyzeInterval{1800};         // 检查统计信息是否过期的周期
+    double staleRatio = 0.25;                           // 行数变化超过该比例视为过期
+    int analysisLimit = 1000;                           // ANALYZE 每个索引最多采样的行数
+
+    int vacuumPagesPerStep = 256;                       // 每次 incremental_vacuum 释放的页数
+    int vacuumMinFreePages = 1024;                      // 空闲页少于此数不回收
+
+    bool archiveEnabled = true;                         // 空闲时把旧任务移到 tasks_archive
+    ArchivePolicy archive;                              // 归档条件与每批行数
+    int archiveChunksPerTick = 8;                       // 每个周期最多归档的批数
+};
+
+/**
+ * @brief 数据库后台维护：检查点、统计信息、增量回收
+ *
+ * 使用独立连接，不占用 DatabaseManager 的 dbMutex，busy_timeout 为 0：
+ * 遇到写锁直接放弃、下个周期再试，写入永远不会排在维护之后。
+ *
+ * - 每个周期做一次 PASSIVE 检查点（不阻塞读写），主连接的自动检查点
+ *   调高为兜底阈值，不再落在写事务的提交路径上
+ * - 空闲且 WAL 已全部回写时 TRUNCATE，把 WAL 文件截断为 0
+ * - 空闲时按周期执行 PRAGMA optimize，并对行数明显变化的表 ANALYZE
+ *   （受 analysis_limit 限制）
+ * - auto_vacuum=INCREMENTAL 的库在空闲时分步 incremental_vacuum
+ * - 空闲时由 TaskArchiver 分批归档早已完成/已删除的任务；某批超出预算被中断时
+ *   批量减半，成功后再逐步加回
+ *
+ * 每条维护语句都装有进度回调，超过 stepBudget 即中断，下次再做。
+ */
+class MaintenanceScheduler {
+public:
+    struct Stats {
+        std::uint64_t passiveCheckpoints = 0;
+        std::uint64_t truncateCheckpoints = 0;
+        std::uint64_t optimizeRuns = 0;
+        std::uint64_t tablesAnalyzed = 0;
+        std::uint64_t pagesVacuumed = 0;
+        std::uint64_t tasksArchived = 0;
+        std::uint64_t skippedBusy = 0;      // 遇到写锁放弃的次数
+        std::uint64_t interrupted = 0;      // 超出预算被中断的次数
+        long long walBytes = 0;             // 最近一次观察到的 WAL 大小
+    };
+
+private:
+    static std::unique_ptr<MaintenanceScheduler> instance;
+    static std::mutex instanceMutex;
+
+    MaintenanceOptions options;
+    std::string dbPath;
+    sqlite3* conn = nullptr;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    mutable std::mutex workerMutex;
+    std::condition_variable wakeup;
+    bool stopRequested = false;
+    bool runRequested = false;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    // 空闲判断：DatabaseManager 的语句计数 + data_version（其他连接的提交）
+    long lastQueryCount = -1;
+    long long lastDataVersion = -1;
+    std::chrono::steady_clock::time_point lastActivity;
+    std::chrono::steady_clock::time_point lastOptimize;
+    std::chrono::steady_clock::time_point lastAnalyzeCheck;
+    std::chrono::steady_clock::time_point deadline;
+    int archiveChunkRows = 0;       // 当前的归档批量，被中断后减半
+
+    void run();
+    void tick(bool forced);
+    bool isIdle();
+
+    void checkpoint(bool idle);
+    void optimize();
+    void analyzeStaleTables();
+    void incrementalVacuum();
+    void archiveTasks(bool forced);
+
+    // 在预算内执行；SQLITE_BUSY/中断返回 false 并计数
+    bool execBudgeted(const std::string& sql);
+    long long queryInt(const std::string& sql);
+    long long queryInt(const std::string& sql, std::chrono::milliseconds budget);  // 失败或超时返回 -1
+    static int progressCallback(void* self);
+
+public:
+    MaintenanceScheduler() = default;
+    ~MaintenanceScheduler();
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    static MaintenanceScheduler& getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 打开维护连接并启动后台线程；dbPath 为 DatabaseManager 当前打开的库
+     */
+    bool start(const MaintenanceOptions& opts = MaintenanceOptions());
+    void stop();
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief 不等空闲、立即做一轮完整维护（检查点、optimize、过期统计、归档全部候选、回收）
+     */
+    void runNow();
+
+    Stats getStats() const;
+};
+
+#endif // MAINTENANCE_SCHEDULER_H
@@ -0,0 +1,56 @@
+#ifndef QUERY_PLAN_CHECKER_H
+#define QUERY_PLAN_CHECKER_H
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <sqlite3.h>
+
+/**
+ * @brief 一条需要检查执行计划的 DAO 语句
+ */
+struct PlannedQuery {
+    std::string name;        // 如 "TaskDAO::getTasksByStatus"
+    std::string sql;         // 与 DAO 实际执行的语句相同，参数保留为 ?
+    bool hot = true;         // false：一次性全量加载，只报告计划，不判失败
+};
+
+/**
+ * @brief 单条语句的检查结果
+ */
+struct PlanCheckResult {
+    PlannedQuery query;
+    std::vector<std::string> plan;        // EXPLAIN QUERY PLAN 的节点，已按层级缩进
+    std::vector<std::string> problems;    // 全表/全索引扫描、临时 B 树排序、无法准备
+    bool passed() const { return problems.empty() || !query.hot; }
+};
+
+/**
+ * @brief 执行计划回归检查
+ *
+ * 对每条语句做 EXPLAIN QUERY PLAN（只准备不执行，参数不必绑定），
+ * 热点语句出现以下节点即判为失败：
+ * - SCAN ...：没有可用的索引前缀，读整张表或整个索引
+ * - USE TEMP B-TREE ...：ORDER BY / GROUP BY / DISTINCT 需要额外排序
+ *
+ * 计划依赖当前库的索引和 sqlite_stat1，检查结果以传入的连接为准。
+ */
+class QueryPlanChecker {
+private:
+    sqlite3* db;
+
+public:
+    explicit QueryPlanChecker(sqlite3* db) : db(db) {}
+
+    PlanCheckResult check(const PlannedQuery& query) const;
+
+    /**
+     * @brief 检查全部语句并把计划写到 report
+     * @param verbose 为 false 时通过的语句只输出一行
+     * @return 所有热点语句都通过时返回 true
+     */
+    bool checkAll(const std::vector<PlannedQuery>& queries, std::ostream& report,
+                  bool verbose = false) const;
+};
+
+#endif // QUERY_PLAN_CHECKER_H
@@ -0,0 +1,155 @@
+#ifndef QUERY_PROFILER_H
+#define QUERY_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <sqlite3.h>
+
+/**
+ * @brief 对数-线性分桶的延迟直方图（HDR 风格，单位微秒）
+ *
+ * 每个 2 的幂区间再均分为 8 个子桶，相对误差不超过 12.5%，
+ * 覆盖 0 到约 38 小时，固定 304 个桶，记录一次只是一次数组自增。
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    void record(std::uint64_t micros);
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief 分位数（p 取 0-100），返回所在桶的上界
+     */
+    std::uint64_t percentile(double p) const;
+    std::uint64_t getCount() const { return count; }
+
+    static int bucketFor(std::uint64_t micros);
+    static std::uint64_t bucketUpperBound(int bucket);
+
+private:
+    std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+    std::uint64_t count = 0;
+};
+
+/**
+ * @brief 单条语句指纹（字面量替换为 ? 后的 SQL）的统计
+ */
+struct QueryStats {
+    std::string fingerprint;
+    std::uint64_t calls = 0;
+    std::uint64_t rows = 0;
+    std::uint64_t totalMicros = 0;
+    std::uint64_t maxMicros = 0;
+    LatencyHistogram histogram;
+
+    double meanMicros() const { return calls ? static_cast<double>(totalMicros) / calls : 0.0; }
+};
+
+/**
+ * @brief 慢查询记录
+ */
+struct SlowQuery {
+    std::string timestamp;   // UTC "YYYY-MM-DD HH:MM:SS"
+    std::string sql;         // 展开绑定参数后的 SQL
+    std::string fingerprint;
+    std::uint64_t micros = 0;
+    std::uint64_t rows = 0;
+    std::string plan;        // EXPLAIN QUERY PLAN 输出，每行一个节点
+};
+
+/**
+ * @brief 基于 sqlite3_trace_v2 的查询剖析器
+ *
+ * attach() 之后，该连接上执行的每条语句（无论经由 DatabaseManager 的
+ * execute/executeQuery，还是 DAO 直接拿原始连接 prepare/step）都会在结束
+ * 时回调一次：按指纹累计次数、返回行数和延迟直方图；超过慢查询阈值的
+ * 语句另外记入慢查询日志，并在独立的只读连接上抓取 EXPLAIN QUERY PLAN
+ * （同一指纹只抓一次，避免在回调里反复开连接）。
+ *
+ * 回调在执行语句的线程上运行，内部以互斥锁保护；被剖析的连接关闭前
+ * 应先 detach()。
+ */
+class QueryProfiler {
+private:
+    static std::unique_ptr<QueryProfiler> instance;
+    static std::mutex instanceMutex;
+
+    mutable std::mutex profilerMutex;
+    std::unordered_map<std::string, QueryStats> statsByFingerprint;
+    std::unordered_map<std::string, std::string> planByFingerprint;
+    std::deque<SlowQuery> slowQueries;
+    std::string slowLogPath;
+
+    std::atomic<bool> enabled{true};
+    std::atomic<std::uint64_t> slowThresholdMicros{50000};
+    size_t maxSlowQueries = 200;
+    size_t maxFingerprints = 2000;  // 超出后归入 "<other>"，防止拼接 SQL 撑爆内存
+
+    static int traceCallback(unsigned type, void* context, void* p, void* x);
+    void onStatementFinished(sqlite3_stmt* stmt, std::uint64_t nanos, std::uint64_t rows);
+    std::string explain(sqlite3* conn, const std::string& sql) const;
+    void appendToSlowLog(const SlowQuery& entry) const;
+
+public:
+    QueryProfiler() = default;
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    static QueryProfiler& getInstance();
+    static void destroyInstance();
+
+    // === 连接挂载 ===
+
+    bool attach(sqlite3* conn);
+    void detach(sqlite3* conn);
+
+    // === 配置 ===
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    void setSlowQueryThreshold(double milliseconds);
+    double getSlowQueryThreshold() const;
+    /**
+     * @brief 慢查询同时追加写入该文件；空串表示只保留在内存中
+     */
+    void setSlowQueryLog(const std::string& path);
+    void setMaxSlowQueries(size_t maxEntries);
+
+    // === 查询 ===
+
+    /**
+     * @brief 按累计耗时排序的前 N 条语句
+     */
+    std::vector<QueryStats> getTopStatements(size_t n) const;
+    /**
+     * @brief 按单次最大耗时排序的前 N 条语句
+     */
+    std::vector<QueryStats> getSlowestStatements(size_t n) const;
+    std::vector<SlowQuery> getSlowQueries() const;
+    LatencyHistogram getOverallHistogram() const;
+
+    /**
+     * @brief 打印前 N 条最慢语句及其延迟分位数和查询计划
+     */
+    void dump(std::ostream& out, size_t topN = 10) const;
+    void reset();
+
+    /**
+     * @brief 去掉字面量与多余空白，得到语句指纹
+     */
+    static std::string fingerprint(const char* sql);
+};
+
+#endif // QUERY_PROFILER_H
@@ -0,0 +1,94 @@
+#ifndef SCHEMA_MIGRATOR_H
+#define SCHEMA_MIGRATOR_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <sqlite3.h>
+
+class SchemaMigrator;
+
+/**
+ * @brief 一个 schema 版本步骤，version 从 1 开始连续递增
+ */
+struct Migration {
+    int version;
+    std::string description;
+    std::function<bool(SchemaMigrator&)> apply;
+    // false：步骤自己分块提交（大表重写），完成后再写入版本号；步骤必须可重入
+    bool transactional = true;
+};
+
+/**
+ * @brief 基于 PRAGMA user_version 的 schema 迁移引擎
+ *
+ * 所有建表、加列、建索引、表结构调整都登记为有序的 Migration，
+ * DatabaseManager、ProjectDAO、HeatmapVisualizer 和 SQLiteReminderDAO
+ * 打开连接后统一调用 migrate()，不再各自维护 CREATE TABLE 语句。
+ *
+ * 普通步骤与版本号写入同一个事务，失败整体回滚。大表重写走
+ * rewriteTable()：建影子表 + 触发器同步增量，按 rowid 分块复制，
+ * 每块一个短事务，最后一个短事务完成换表；索引在换表后逐个建立。
+ * 迁移期间其他连接（包括其他进程）只在各个短事务上等待。
+ *
+ * 已在事务中调用这些辅助方法时不再分块，直接在当前事务里完成。
+ */
+class SchemaMigrator {
+public:
+    explicit SchemaMigrator(sqlite3* db);
+
+    static int latestVersion();
+    static const std::vector<Migration>& migrations();
+
+    int currentVersion();
+
+    /**
+     * @brief 依次执行 currentVersion() 之后的步骤
+     * @param targetVersion 目标版本，-1 表示最新
+     */
+    bool migrate(int targetVersion = -1);
+
+    // 每个复制事务搬运的行数
+    void setChunkRows(int rows) { chunkRows = rows > 0 ? rows : 1; }
+
+    // === 供迁移步骤使用 ===
+
+    bool exec(const std::string& sql);
+    bool tableExists(const std::string& table);
+    bool columnExists(const std::string& table, const std::string& column);
+    std::vector<std::string> columns(const std::string& table);
+
+    // 列不存在时执行 ALTER TABLE ADD COLUMN
+    bool ensureColumn(const std::string& table, const std::string& column,
+                      const std::string& definition);
+
+    // 单独一个短事务建索引（CREATE INDEX IF NOT EXISTS ...）
+    bool createIndex(const std::string& sql);
+
+    /**
+     * @brief 在线重写表结构
+     * @param createSql 新表的 CREATE TABLE 语句，表名写作 $TABLE
+     * @param expressions 新列 -> 取值表达式（基于旧表的列）；未列出的同名列直接复制，
+     *                    旧表没有的列取新表默认值
+     * @param indexes 换表后要建立的索引
+     *
+     * 要求表以 INTEGER PRIMARY KEY 作为 rowid。表不存在时直接按新结构创建。
+     */
+    bool rewriteTable(const std::string& table, const std::string& createSql,
+                      const std::map<std::string, std::string>& expressions,
+                      const std::vector<std::string>& indexes);
+
+private:
+    sqlite3* db;
+    int chunkRows = 5000;
+
+    bool inTransaction() const;
+    bool begin();
+    bool commit();
+    void rollback();
+    bool setVersion(int version);
+    long long queryInt(const std::string& sql);
+};
+
+#endif // SCHEMA_MIGRATOR_H
@@ -0,0 +1,56 @@
+#ifndef TASK_ARCHIVER_H
+#define TASK_ARCHIVER_H
+
+#include <sqlite3.h>
+#include <vector>
+#include "database/QueryPlanChecker.h"
+
+/**
+ * @brief 哪些任务可以归档
+ */
+struct ArchivePolicy {
+    int completedAfterDays = 30;    // 完成超过这么多天；< 0 不归档已完成任务
+    int deletedAfterDays = 7;       // 软删除超过这么多天；< 0 不归档已删除任务
+    int chunkSize = 500;            // 每个事务搬运的任务数
+};
+
+/**
+ * @brief 把早已完成或已软删除的任务移出 tasks
+ *
+ * 每一批在一个 SAVEPOINT 中完成：先把任务按 (用户, 完成状态, 完成日期) 累加进
+ * task_rollups，再整行复制到 tasks_archive，最后从 tasks 删除。删除依赖外键的级联：
+ * 标签、依赖边、提醒随之删除，番茄钟记录的 task_id 置空，因此连接必须开启 foreign_keys。
+ *
+ * 统计通过 task_history 视图读取活跃任务与汇总行之和，归档前后结果不变；
+ * TaskDAO 的列表查询本来就只看未删除任务，已完成任务归档后不再出现在列表中。
+ */
+class TaskArchiver {
+private:
+    sqlite3* db;
+    int lastCode = SQLITE_OK;
+
+    bool exec(const char* sql);
+
+public:
+    explicit TaskArchiver(sqlite3* db) : db(db) {}
+
+    /**
+     * @brief 归档一批
+     * @return 移走的任务数，0 表示没有可归档的任务；失败返回 -1 并回滚这一批
+     *         （遇到写锁或被进度回调中断时不输出错误，由 lastErrorCode() 区分）
+     */
+    int archiveChunk(const ArchivePolicy& policy);
+
+    /**
+     * @brief 反复归档直到没有候选
+     * @return 移走的任务总数；中途失败时返回 -1，已提交的批次保留
+     */
+    long long archiveAll(const ArchivePolicy& policy);
+
+    int lastErrorCode() const { return lastCode; }
+
+    // 选取归档候选的语句，供 check-plans 检查执行计划
+    static std::vector<PlannedQuery> queryCatalog();
+};
+
+#endif // TASK_ARCHIVER_H
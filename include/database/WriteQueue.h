@@ -0,0 +1,141 @@
+#ifndef WRITE_QUEUE_H
+#define WRITE_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+struct sqlite3;
+
+/**
+ * @brief 单次写入的持久化要求
+ */
+enum class WriteDurability {
+    GroupCommit,   // 与同一窗口内的其他写入合并提交（synchronous = NORMAL）
+    Immediate      // 立即结束当前窗口提交，并以 synchronous = FULL 落盘
+};
+
+/**
+ * @brief 写入队列的批量窗口与背压
+ */
+struct WriteQueueOptions {
+    std::chrono::milliseconds batchWindow{5};   // 第一条写入到达后最多再等多久
+    size_t maxBatchOps = 512;                   // 单批最多合并的写入数
+    size_t maxQueueDepth = 65536;               // 队列满时 submit 阻塞等待
+};
+
+/**
+ * @brief 异步写入队列（write-behind）
+ *
+ * 一个写线程消费队列，把批量窗口内到达的写入合并进同一个事务提交，
+ * 提交成本由整批分摊；调用方拿到 std::future<bool>，在事务提交后兑现。
+ *
+ * - 写线程使用 start() 时打开的专用连接，批事务为 BEGIN IMMEDIATE，
+ *   与共享连接和其他进程之间靠 SQLite 的写锁排队，别人的语句不会落进这一批
+ * - 回调形式的写入在自己的 SAVEPOINT 里执行，单条失败只回滚这一条；
+ *   单条 SQL 依赖 SQLite 的语句级回滚，省掉两次 SAVEPOINT 往返
+ * - 整批提交失败时，这一批所有 future 都为 false
+ * - Immediate 写入会提前结束当前窗口，并让这一批以 synchronous = FULL 提交
+ * - 专用连接挂在 ChangeFeed 上，提交的行照常通知订阅者
+ *
+ * 回调形式的写入运行在写线程上、处于批事务之内，拿到的是专用连接，
+ * 内部需要事务时请用 SAVEPOINT。未启动时 submit 在调用线程上、持有
+ * DatabaseManager::lockConnection() 对共享连接同步执行，并返回已就绪的 future。
+ */
+class WriteQueue {
+public:
+    using Work = std::function<bool(sqlite3*)>;
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t ops = 0;
+        std::uint64_t failedOps = 0;
+        std::uint64_t failedCommits = 0;
+        std::uint64_t immediateBatches = 0;
+        size_t maxBatch = 0;
+        size_t depth = 0;
+    };
+
+private:
+    struct Command {
+        Work work;
+        WriteDurability durability;
+        std::uint64_t sequence = 0;
+        bool savepoint = true;   // 单条语句失败时 SQLite 自己回滚该语句，不必再包一层
+        std::promise<bool> done;
+    };
+
+    static std::unique_ptr<WriteQueue> instance;
+    static std::mutex instanceMutex;
+
+    WriteQueueOptions options;
+    sqlite3* conn = nullptr;     // 写线程专用，start() 打开、stop() 关闭
+
+    std::thread writer;
+    std::atomic<bool> running{false};
+    mutable std::mutex queueMutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::condition_variable drained;
+    std::deque<Command> queue;
+    size_t immediatePending = 0;
+    std::uint64_t submittedSequence = 0;
+    std::uint64_t completedSequence = 0;   // 已兑现的最大序号（按 FIFO 提交）
+    bool stopRequested = false;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void run();
+    void commitBatch(std::vector<Command>& batch);
+    std::future<bool> enqueue(Work work, WriteDurability durability, bool savepoint);
+
+public:
+    WriteQueue() = default;
+    ~WriteQueue();
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+
+    static WriteQueue& getInstance();
+    static void destroyInstance();
+
+    bool start(const WriteQueueOptions& opts = WriteQueueOptions());
+
+    /**
+     * @brief 停止接收新写入，提交队列中剩余的全部写入后退出写线程
+     */
+    void stop();
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief 提交一条参数化写语句（参数按文本绑定，与 DatabaseManager::executeParameterized 一致）
+     */
+    std::future<bool> submit(const std::string& sql,
+                             const std::vector<std::string>& params = {},
+                             WriteDurability durability = WriteDurability::GroupCommit);
+
+    /**
+     * @brief 提交一段写逻辑，在写线程上、批事务之内执行
+     */
+    std::future<bool> submit(Work work,
+                             WriteDurability durability = WriteDurability::GroupCommit);
+
+    /**
+     * @brief 阻塞到此刻之前提交的写入全部提交完成
+     */
+    void flush();
+
+    size_t depth() const;
+    Stats getStats() const;
+};
+
+#endif // WRITE_QUEUE_H
@@ -0,0 +1,107 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include "entities.h"
+
+class ChangeSubscription;
+
+/**
+ * @brief 经验值排行榜 - 游戏化系统
+ *
+ * 在内存中维护一棵按 (total_xp 降序, user_id 升序) 排序的顺序统计树（treap，
+ * 每个节点记录子树大小），XPSystem::awardXP 每次更新时同步调整。
+ * 支持 O(log n) 的名次查询、第 k 名查询，以及 O(k + log n) 的前 K 名。
+ *
+ * 树只存在于内存中，数据源仍是 user_stats：启动时（或第一次使用时）rebuild()
+ * 从数据库重建，之后不写回数据库。重建后订阅 user_stats / users 的提交，
+ * 其他连接或进程改过的用户在 isLoaded() 时逐个重读；恢复备份等整库替换
+ * 则丢弃整棵树，由调用方重新 rebuild()。
+ */
+class Leaderboard {
+private:
+    struct Node {
+        int totalXP;
+        int userId;
+        unsigned priority;
+        int size = 1;
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+
+        Node(int xp, int id, unsigned prio) : totalXP(xp), userId(id), priority(prio) {}
+    };
+
+    struct Entry {
+        int totalXP = 0;
+        int level = 1;
+        std::string username;
+    };
+
+    static std::unique_ptr<Leaderboard> instance;
+    static std::mutex instanceMutex;
+
+    mutable std::mutex treeMutex;
+    std::unique_ptr<Node> root;
+    std::unordered_map<int, Entry> entries;
+    std::mt19937 rng{20240601u};
+    bool loaded = false;
+    std::unique_ptr<ChangeSubscription> changes;
+
+    // 排序规则：XP 高者在前，XP 相同按 user_id 升序
+    static bool before(int xpA, int idA, int xpB, int idB);
+    static int sizeOf(const std::unique_ptr<Node>& node);
+    static void update(Node* node);
+
+    // treap 基本操作（调用方持有 treeMutex）
+    static void split(std::unique_ptr<Node> node, int xp, int id,
+                      std::unique_ptr<Node>& left, std::unique_ptr<Node>& right);
+    static std::unique_ptr<Node> merge(std::unique_ptr<Node> left, std::unique_ptr<Node> right);
+    void insertNode(int xp, int id);
+    void eraseNode(int xp, int id);
+    int rankOf(int xp, int id) const;         // 1-based
+    const Node* nodeAt(int rank) const;        // 1-based
+    UserRanking toRanking(const Node* node, int rank) const;
+    void collectTop(const Node* node, int& remaining, std::vector<UserRanking>& out) const;
+
+    void applyChanges();
+    void clearLocked();
+
+public:
+    Leaderboard();
+    ~Leaderboard();
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    static Leaderboard& getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 从 user_stats 重建整棵树（启动时调用）
+     */
+    bool rebuild();
+
+    /**
+     * @brief 先应用订阅到的外部提交；整库被替换过时清空并返回 false
+     */
+    bool isLoaded();
+
+    /**
+     * @brief 用户经验值变化后调用，O(log n)
+     */
+    void updateUser(int userId, int totalXP, int level);
+    void removeUser(int userId);
+
+    // === 查询 ===
+
+    std::vector<UserRanking> getTopK(int k) const;
+    int getRank(int userId) const;  // 0 表示用户不在榜上
+    std::vector<UserRanking> getNeighbors(int userId, int radius = 2) const;
+    int size() const;
+};
+
+#endif // LEADERBOARD_H
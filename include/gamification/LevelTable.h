@@ -0,0 +1,136 @@
+#ifndef LEVEL_TABLE_H
+#define LEVEL_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <climits>
+
+/**
+ * @brief 编译期等级表
+ *
+ * 前 20 级沿用原来手工配置的阈值和称号；编译时定义 XP_MAX_LEVEL（例如
+ * -DXP_MAX_LEVEL=100）可把曲线延长，超出部分按公式在编译期生成：
+ * 每级所需增量在上一级基础上再加 LEVEL_STEP_GROWTH。
+ * 所有查询都是 constexpr，不做任何堆分配。
+ */
+
+#ifndef XP_MAX_LEVEL
+#define XP_MAX_LEVEL 20
+#endif
+
+namespace LevelTable {
+
+struct LevelInfo {
+    int requiredXP;
+    const char* title;
+};
+
+// 手工配置的基础等级（下标 0 对应 1 级）
+inline constexpr std::array<LevelInfo, 20> BASE_LEVELS = {{
+    {0,     "新手"},
+    {100,   "初学者"},
+    {250,   "学徒"},
+    {500,   "实践者"},
+    {1000,  "熟练者"},
+    {1750,  "资深者"},
+    {2750,  "精英"},
+    {4000,  "专家"},
+    {5500,  "大师"},
+    {7500,  "宗师"},
+    {10000, "传奇"},
+    {13000, "史诗"},
+    {16500, "神话"},
+    {20500, "不朽"},
+    {25000, "永恒"},
+    {30000, "至尊"},
+    {36000, "主宰"},
+    {43000, "神圣"},
+    {51000, "超凡"},
+    {60000, "传说"},
+}};
+
+inline constexpr int BASE_MAX_LEVEL = static_cast<int>(BASE_LEVELS.size());
+inline constexpr int LEVEL_STEP_GROWTH = 1000;
+inline constexpr int MAX_LEVEL = XP_MAX_LEVEL;
+
+static_assert(MAX_LEVEL >= BASE_MAX_LEVEL, "XP_MAX_LEVEL 不能小于基础等级数 20");
+
+/**
+ * @brief 生成 1..N 级的阈值数组（下标 0 对应 1 级）
+ */
+template <std::size_t N>
+constexpr std::array<int, N> makeThresholds() {
+    std::array<int, N> thresholds{};
+    for (std::size_t i = 0; i < N && i < BASE_LEVELS.size(); ++i) {
+        thresholds[i] = BASE_LEVELS[i].requiredXP;
+    }
+
+    for (std::size_t i = BASE_LEVELS.size(); i < N; ++i) {
+        int prevStep = thresholds[i - 1] - thresholds[i - 2];
+        thresholds[i] = thresholds[i - 1] + prevStep + LEVEL_STEP_GROWTH;
+    }
+    return thresholds;
+}
+
+template <std::size_t N>
+constexpr bool isStrictlyIncreasing(const std::array<int, N>& values) {
+    for (std::size_t i = 1; i < N; ++i) {
+        if (values[i] <= values[i - 1]) return false;  // 溢出回绕也会在这里被发现
+    }
+    return true;
+}
+
+inline constexpr std::array<int, MAX_LEVEL> THRESHOLDS = makeThresholds<MAX_LEVEL>();
+
+static_assert(THRESHOLDS[0] == 0, "1 级必须从 0 经验值开始");
+static_assert(isStrictlyIncreasing(THRESHOLDS), "等级阈值必须严格递增（检查 XP_MAX_LEVEL 是否导致溢出）");
+
+/**
+ * @brief 某等级所需的总经验值，超出范围时夹到 [1, MAX_LEVEL]
+ */
+constexpr int thresholdFor(int level) {
+    if (level < 1) level = 1;
+    if (level > MAX_LEVEL) level = MAX_LEVEL;
+    return THRESHOLDS[level - 1];
+}
+
+/**
+ * @brief 二分查找：满足 THRESHOLDS[level-1] <= totalXP 的最大等级
+ */
+constexpr int levelForXP(int totalXP) {
+    int lo = 0;
+    int len = MAX_LEVEL;
+    while (len > 1) {
+        int half = len / 2;
+        // 编译成 cmov，没有难预测的分支
+        lo = (THRESHOLDS[lo + half] <= totalXP) ? lo + half : lo;
+        len -= half;
+    }
+    return lo + 1;
+}
+
+/**
+ * @brief 等级称号，超出基础表的等级沿用最高称号
+ */
+constexpr const char* titleFor(int level) {
+    if (level < 1) return "未知";
+    if (level > BASE_MAX_LEVEL) level = BASE_MAX_LEVEL;
+    return BASE_LEVELS[level - 1].title;
+}
+
+constexpr const char* badgeFor(int level) {
+    if (level >= MAX_LEVEL) return "👑";
+    if (level >= 15) return "💎";
+    if (level >= 10) return "🏆";
+    if (level >= 5) return "⭐";
+    return "🌟";
+}
+
+static_assert(levelForXP(0) == 1, "levelForXP 下界错误");
+static_assert(levelForXP(99) == 1 && levelForXP(100) == 2, "levelForXP 边界错误");
+static_assert(levelForXP(60000) == 20, "levelForXP 基础满级错误");
+static_assert(levelForXP(INT_MAX) == MAX_LEVEL, "levelForXP 上界错误");
+
+} // namespace LevelTable
+
+#endif // LEVEL_TABLE_H
@@ -0,0 +1,93 @@
+#ifndef XP_LEDGER_H
+#define XP_LEDGER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include "entities.h"
+
+/**
+ * @brief 经验值流水账 - 只追加的 XP 事件日志
+ *
+ * 每次 awardXP 都记一条 xp_events；user_stats.total_xp 只是当前值的缓存。
+ * - append() 立即插入，由调用方把它和 user_stats 的更新放进同一个 SAVEPOINT，
+ *   流水与缓存值一起提交或一起回滚，崩溃后不会出现 user_stats 领先流水
+ * - 每个用户每追加 snapshotInterval 条事件检查一次，必要时写 xp_snapshots(总量, 截止事件ID)
+ * - 重建某个用户的总量 = 最近快照 + 快照之后的尾部事件，无需扫描整本账
+ * - 时间段查询走 (user_id, created_date) 索引
+ */
+class XPLedger {
+public:
+    /**
+     * @brief 快照 + 尾部重放的结果
+     */
+    struct ReplayResult {
+        int totalXP = 0;
+        long long lastEventId = 0;     // 已计入的最大事件ID
+        long long snapshotEventId = 0; // 起点快照的截止事件ID（0 表示无快照）
+        int replayedEvents = 0;        // 快照之后重放的事件数
+    };
+
+private:
+    static std::unique_ptr<XPLedger> instance;
+    static std::mutex instanceMutex;
+
+    mutable std::mutex ledgerMutex;
+
+    // 每个用户自上次快照检查以来追加的事件数
+    std::map<int, int> appendsSinceCheck;
+    int snapshotInterval = 200;
+
+    void snapshotIfDueLocked(int userId);
+    ReplayResult replayLocked(int userId);
+    bool writeSnapshotLocked(int userId, const ReplayResult& state);
+
+    static std::string currentTimestamp();
+
+public:
+    XPLedger() = default;
+    ~XPLedger();
+    XPLedger(const XPLedger&) = delete;
+    XPLedger& operator=(const XPLedger&) = delete;
+
+    static XPLedger& getInstance();
+    static void destroyInstance();
+
+    // === 写入 ===
+
+    /**
+     * @brief 追加一条经验值事件，立即写入当前连接（调用方负责事务边界）
+     */
+    bool append(int userId, int amount, const std::string& source,
+                const std::string& description = "");
+
+    /**
+     * @brief 为所有有事件的用户各写一次快照（关闭或维护时调用）
+     */
+    bool snapshotAll();
+
+    void setSnapshotInterval(int events);
+
+    // === 重建 ===
+
+    /**
+     * @brief 由最近快照 + 尾部事件计算用户总经验值
+     */
+    ReplayResult replay(int userId);
+
+    // === 查询 ===
+
+    std::vector<ExperienceRecord> getHistory(int userId, int limit = 50);
+
+    /**
+     * @brief 时间段内的事件 / 经验值合计，时间格式 "YYYY-MM-DD HH:MM:SS"（UTC，与 datetime('now') 一致）
+     */
+    std::vector<ExperienceRecord> getHistoryBetween(int userId, const std::string& from,
+                                                    const std::string& to);
+    int getXPBetween(int userId, const std::string& from, const std::string& to);
+    std::map<std::string, int> getXPBySource(int userId);
+};
+
+#endif // XP_LEDGER_H
@@ -3,7 +3,10 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <memory>
 #include "../database/DatabaseManager.h"
+#include "../database/ChangeFeed.h"
 
 using namespace std;
 
@@ -17,31 +20,59 @@ class XPSystem {
 private:
     DatabaseManager* dbManager;
     
-    // 等级配置：等级 -> 所需总经验值
-    map<int, int> levelThresholds;
+    // 当前操作的用户（多用户共享同一数据库）
+    int currentUserId;
     
-    // 等级称号
-    map<int, string> levelTitles;
+    // 每用户缓存：避免 HUD 每次刷新都回表查询 user_stats
+    struct UserXPState {
+        int totalXP = 0;
+        int level = 1;
+        sqlite3_int64 rowid = 0;   // user_stats 的行，0 表示未知（该表任何变更都会作废）
+    };
+    unordered_map<int, UserXPState> userCache;
+    
+    // user_stats 的提交变更（其他模块、其他连接的写入），读缓存前按行作废
+    unique_ptr<ChangeSubscription> userStatsChanges;
+    void applyChanges();
     
     /**
-     * @brief 根据总经验值计算等级
+     * @brief 根据总经验值计算等级（查编译期等级表，见 LevelTable.h）
      */
     int calculateLevel(int totalXP);
     
     /**
-     * @brief 初始化等级系统配置
+     * @brief 更新用户统计表中的等级和经验值
      */
-    void initializeLevelSystem();
+    bool updateUserStats(int userId, int totalXP, int level);
     
     /**
-     * @brief 更新用户统计表中的等级和经验值
+     * @brief 在数据库里累加经验值并回读该行，得到升级前后的等级
+     * 
+     * 用 total_xp = total_xp + ? 而不是写入本实例缓存算出的绝对值，
+     * 其他进程或其他 XPSystem 实例同时发放的经验值不会被覆盖。
      */
-    void updateUserStats(int totalXP, int level);
+    bool addUserXP(int userId, int amount, int& oldLevel, int& newTotal, int& newLevel);
+    
+    /**
+     * @brief 读取用户经验状态（优先命中缓存）
+     */
+    const UserXPState& loadUserState(int userId);
     
 public:
-    XPSystem();
+    explicit XPSystem(int userId = DatabaseManager::DEFAULT_USER_ID);
     ~XPSystem();
     
+    // === 多用户 ===
+    
+    void setCurrentUserId(int userId);
+    int getCurrentUserId() const;
+    
+    /**
+     * @brief 丢弃某个用户的缓存（其他模块直接改写 user_stats 后调用）
+     */
+    void invalidateCache(int userId);
+    void clearCache();
+    
     // === 经验值管理 ===
     
     /**
@@ -52,6 +83,16 @@ public:
      */
     bool awardXP(int amount, const string& source);
     
+    /**
+     * @brief 为指定用户奖励经验值
+     */
+    bool awardXP(int userId, int amount, const string& source);
+    
+    /**
+     * @brief 由经验值流水（快照 + 尾部重放）重算并覆盖 user_stats
+     */
+    bool rebuildFromLedger(int userId);
+    
     /**
      * @brief 获取当前经验值（当前等级进度）
      */
@@ -61,6 +102,7 @@ public:
      * @brief 获取总经验值
      */
     int getTotalXP();
+    int getTotalXP(int userId);
     
     // === 等级管理 ===
     
@@ -68,6 +110,7 @@ public:
      * @brief 获取当前等级
      */
     int getCurrentLevel();
+    int getCurrentLevel(int userId);
     
     /**
      * @brief 获取下一等级所需经验值
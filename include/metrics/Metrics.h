@@ -0,0 +1,153 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <iosfwd>
+
+/**
+ * @brief 单调递增计数器
+ */
+class MetricCounter {
+public:
+    void inc(std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+/**
+ * @brief 可增可减的瞬时值
+ */
+class MetricGauge {
+public:
+    void set(std::int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void add(std::int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::int64_t get() const { return value.load(std::memory_order_relaxed); }
+private:
+    std::atomic<std::int64_t> value{0};
+};
+
+/**
+ * @brief 固定桶的 Prometheus 直方图（桶上界升序，+Inf 自动追加）
+ */
+class MetricHistogram {
+public:
+    explicit MetricHistogram(std::vector<double> upperBounds);
+    void observe(double value);
+
+    const std::vector<double>& getBounds() const { return bounds; }
+    std::uint64_t getBucket(size_t i) const { return counts[i].load(std::memory_order_relaxed); }
+    std::uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    double getSum() const { return sum.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<double> bounds;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts;  // 非累计，导出时再累加
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<double> sum{0.0};
+};
+
+/**
+ * @brief 最近 60 秒的累加值（如每分钟发放的经验值）
+ *
+ * 每秒一个槽，写入时发现槽属于旧的那一秒就先清零；读取时只累加
+ * 最近 60 秒内的槽。
+ */
+class MetricWindow {
+public:
+    static constexpr int SLOTS = 60;
+    void add(std::int64_t n);
+    std::int64_t lastMinute() const;
+private:
+    struct Slot {
+        std::atomic<std::int64_t> second{-1};
+        std::atomic<std::int64_t> value{0};
+    };
+    Slot slots[SLOTS];
+};
+
+/**
+ * @brief 进程内指标注册表，按 Prometheus 文本格式导出
+ *
+ * 各模块在热路径上只做一次原子加：注册发生在第一次使用时（通常是
+ * 函数内的 static 引用），之后拿到的引用在进程生命周期内一直有效。
+ * 需要在抓取时才计算的值（数据库统计、RSS 等）通过 addCollector()
+ * 注册回调，只有在有人来抓取时才会执行。
+ *
+ * 因为各模块长期持有指标的引用，注册表随进程存在，不提供 destroyInstance()。
+ */
+class MetricsRegistry {
+private:
+    static std::unique_ptr<MetricsRegistry> instance;
+    static std::mutex instanceMutex;
+
+    enum class Kind { Counter, Gauge, Histogram, Window };
+
+    struct Series {
+        std::string labels;  // 形如 cache="xp",result="hit"，可为空
+        Kind kind;
+        void* metric;
+    };
+
+    struct Family {
+        std::string help;
+        Kind kind;
+        std::vector<Series> series;
+    };
+
+    mutable std::mutex registryMutex;
+    std::vector<std::string> familyOrder;
+    std::map<std::string, Family> families;
+    std::deque<MetricCounter> counters;
+    std::deque<MetricGauge> gauges;
+    std::deque<MetricHistogram> histograms;
+    std::deque<MetricWindow> windows;
+    std::vector<std::pair<std::string, std::function<void(std::ostream&)>>> collectors;
+
+    Series* findSeries(const std::string& name, const std::string& labels);
+    Family& family(const std::string& name, const std::string& help, Kind kind);
+
+public:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static MetricsRegistry& getInstance();
+
+    MetricCounter& counter(const std::string& name, const std::string& help,
+                           const std::string& labels = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help,
+                       const std::string& labels = "");
+    MetricHistogram& histogram(const std::string& name, const std::string& help,
+                               const std::vector<double>& upperBounds,
+                               const std::string& labels = "");
+    /**
+     * @brief 以 gauge 形式导出最近 60 秒的累加值
+     */
+    MetricWindow& window(const std::string& name, const std::string& help,
+                         const std::string& labels = "");
+
+    /**
+     * @brief 注册抓取时执行的回调；同名回调会被替换
+     */
+    void addCollector(const std::string& name, std::function<void(std::ostream&)> collector);
+    void removeCollector(const std::string& name);
+
+    void render(std::ostream& out) const;
+
+    // 供 collector 使用的格式化工具
+    static void writeHeader(std::ostream& out, const std::string& name,
+                            const std::string& help, const std::string& type);
+    static void writeSample(std::ostream& out, const std::string& name,
+                            const std::string& labels, double value);
+};
+
+#endif // METRICS_H
@@ -0,0 +1,59 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Unix 域套接字上的指标导出线程
+ *
+ * 线程平时阻塞在 poll() 上，没有抓取方连接时不消耗 CPU。每个连接
+ * 返回一份 MetricsRegistry 的文本快照后关闭，发送超过 1 秒的连接直接
+ * 放弃，连上不读的客户端不会拖住后续抓取；如果对方发来的是 HTTP
+ * 请求（例如 curl --unix-socket），会加上 HTTP/1.0 响应头，否则直接
+ * 返回文本（例如 socat - UNIX-CONNECT:path）。
+ *
+ * start() 时注册内置的采集回调：DatabaseManager 的查询计数、
+ * QueryProfiler 的整体延迟分位数、进程 RSS 和运行时长。
+ */
+class MetricsServer {
+private:
+    static std::unique_ptr<MetricsServer> instance;
+    static std::mutex instanceMutex;
+
+    mutable std::mutex serverMutex;
+    std::thread serverThread;
+    std::atomic<bool> running{false};
+    std::string socketPath;
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1};
+    std::atomic<std::uint64_t> scrapeCount{0};
+
+    void serve();
+    void handleClient(int clientFd);
+    void registerBuiltinCollectors();
+
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    static MetricsServer& getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 在 path 上监听；已存在的同名套接字文件会被替换
+     */
+    bool start(const std::string& path);
+    void stop();
+    bool isRunning() const { return running; }
+    std::string getSocketPath() const;
+    std::uint64_t getScrapeCount() const { return scrapeCount; }
+};
+
+#endif // METRICS_SERVER_H
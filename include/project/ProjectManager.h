@@ -14,7 +14,7 @@ private:
 
 public:
     ProjectManager();
-    ProjectManager(string dbPath);
+    ProjectManager(string dbPath, int userId = DatabaseManager::DEFAULT_USER_ID);
     ~ProjectManager();
     
     bool initialize();
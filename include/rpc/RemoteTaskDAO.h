@@ -0,0 +1,65 @@
+#ifndef REMOTE_TASK_DAO_H
+#define REMOTE_TASK_DAO_H
+
+#include "database/DAO/TaskDAO.h"
+#include "rpc/RpcClient.h"
+
+/**
+ * @brief 通过守护进程访问任务的 TaskDAO，交给 TaskManager 即可让界面在客户端模式下运行
+ *
+ * 每个方法对应一次同步 RPC，以 client 登录的用户执行；连接失败或服务端
+ * 报错时输出错误，并返回与 TaskDAOImpl 查询失败时相同的空结果（-1、false、空列表）。
+ * createTable() 是空操作，表由守护进程负责。
+ */
+class RemoteTaskDAO : public TaskDAO {
+private:
+    RpcClient& client;
+
+    // 状态为 Ok 时返回 true，response.payload 为结果
+    bool call(RpcOp op, const RpcWriter& args, RpcResponse& response);
+    std::vector<Task> callTasks(RpcOp op, const RpcWriter& args);
+    bool callBool(RpcOp op, const RpcWriter& args);
+    int callInt(RpcOp op, const RpcWriter& args, int failed);
+
+public:
+    explicit RemoteTaskDAO(RpcClient& client) : client(client) {}
+
+    int getUserId() const { return client.getUserId(); }
+
+    bool createTable() override { return true; }
+    int insertTask(const Task& task) override;
+    std::optional<Task> getTaskById(int id) override;
+    std::vector<Task> getAllTasks() override;
+    std::vector<Task> getTasksByIds(const std::vector<int>& ids) override;
+    bool updateTask(const Task& task) override;
+    bool deleteTask(int id) override;
+
+    std::vector<Task> getTasksByStatus(bool completed) override;
+    std::vector<Task> getTasksByProject(int projectId) override;
+    std::vector<Task> getOverdueTasks() override;
+    std::vector<Task> getTodayTasks() override;
+
+    int countAllTasks() override;
+    int countCompletedTasks() override;
+
+    bool assignTaskToProject(int taskId, int projectId) override;
+
+    bool incrementPomodoro(int taskId) override;
+    int getPomodoroCount(int taskId) override;
+
+    bool addDependency(int taskId, int dependsOn) override;
+    bool removeDependency(int taskId, int dependsOn) override;
+    bool loadDependencyGraph(std::vector<DependencyNode>& nodes,
+                             std::vector<std::pair<int, int>>& edges) override;
+
+    bool loadScheduleEntries(std::vector<ScheduleEntry>& entries) override;
+    std::optional<ScheduleEntry> getScheduleEntry(int taskId) override;
+
+    bool setTaskTags(int taskId, const std::vector<std::string>& names,
+                     std::vector<std::pair<int, std::string>>& interned) override;
+    std::vector<std::string> getTaskTags(int taskId) override;
+    bool loadTagIndex(std::vector<std::pair<int, std::string>>& tags,
+                      std::vector<TaggedTask>& tasks) override;
+};
+
+#endif // REMOTE_TASK_DAO_H
@@ -0,0 +1,64 @@
+#ifndef RPC_CLIENT_H
+#define RPC_CLIENT_H
+
+#include <string>
+#include <cstdint>
+#include "rpc/RpcProtocol.h"
+
+/**
+ * @brief 守护进程的客户端连接（单线程使用）
+ *
+ * connect() 之后先 login() 确定这条连接代表的用户。同步调用用 call()；
+ * 需要流水线时先多次 send() 把请求攒在缓冲区，flush() 一次写出，
+ * 再按发送顺序 receive() 取回响应。
+ */
+class RpcClient {
+private:
+    int fd = -1;
+    std::uint32_t nextRequestId = 1;
+    std::string outBuffer;
+    std::string inBuffer;
+    std::size_t inPos = 0;
+    std::string lastError;
+    int userId = 0;     // login() 成功后为服务端确认的用户
+
+    bool fail(const std::string& message);
+
+public:
+    RpcClient() = default;
+    ~RpcClient();
+    RpcClient(const RpcClient&) = delete;
+    RpcClient& operator=(const RpcClient&) = delete;
+
+    bool connect(const std::string& address);
+    void close();
+    bool isConnected() const { return fd >= 0; }
+
+    /**
+     * @brief 以 requestedUserId 登录（0 表示本机账号对应的默认用户）；
+     *        服务端按对端系统账号核对，无权时返回 false
+     */
+    bool login(int requestedUserId = 0);
+    int getUserId() const { return userId; }
+
+    /**
+     * @brief 把请求放进发送缓冲区，不做 IO
+     * @return 请求 ID
+     */
+    std::uint32_t send(RpcOp op, const std::string& payload = std::string());
+    bool flush();
+
+    /**
+     * @brief 阻塞读取下一个响应；连接断开或帧损坏时返回 false 并关闭连接
+     */
+    bool receive(RpcResponse& response);
+
+    /**
+     * @brief send + flush + receive；status 非 Ok 时返回 false，错误信息见 getLastError()
+     */
+    bool call(RpcOp op, const std::string& payload, RpcResponse& response);
+
+    const std::string& getLastError() const { return lastError; }
+};
+
+#endif // RPC_CLIENT_H
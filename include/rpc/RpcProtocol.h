@@ -0,0 +1,224 @@
+#ifndef RPC_PROTOCOL_H
+#define RPC_PROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <sys/types.h>
+#include "task/task.h"
+#include "task/DependencyGraph.h"
+#include "task/TaskScheduler.h"
+#include "task/TagIndex.h"
+
+/**
+ * @brief 守护进程与客户端之间的二进制协议
+ *
+ * 每帧以 4 字节长度开头（不含这 4 字节），整数一律小端：
+ *
+ *     请求: u32 长度 | u32 请求ID | u16 操作码 | 参数
+ *     响应: u32 长度 | u32 请求ID | u16 状态   | 结果（状态非 Ok 时为错误信息）
+ *
+ * 客户端可以连续发出多个请求再读响应（流水线），服务端按请求顺序逐个应答，
+ * 请求 ID 原样带回。字符串为 u32 长度 + 字节，列表为 u32 个数 + 元素。
+ *
+ * 请求里不带用户：连接建立后先发 Login，服务端根据对端的系统账号
+ * （rpcPeerUid）决定这条连接可以代表哪个用户，之后的请求都以该用户执行。
+ */
+enum class RpcOp : std::uint16_t {
+    Ping = 1,
+    Login,          // i32 用户ID（0 表示连接身份对应的默认用户）→ i32 实际用户ID
+
+    // TaskDAO，参数和结果与接口一一对应
+    TaskInsert = 10,
+    TaskGet,
+    TaskGetAll,
+    TaskGetByIds,
+    TaskUpdate,
+    TaskDelete,
+    TaskByStatus,
+    TaskByProject,
+    TaskOverdue,
+    TaskToday,
+    TaskCount,
+    TaskCountCompleted,
+    TaskAssignProject,
+    TaskIncrementPomodoro,
+    TaskPomodoroCount,
+    TaskAddDependency,
+    TaskRemoveDependency,
+    TaskDependencyGraph,
+    TaskScheduleEntries,
+    TaskScheduleEntry,
+    TaskSetTags,
+    TaskGetTags,
+    TaskTagIndex,
+
+    // 经验值；XPAward 只接受服务端能核实的奖励原因，数值由服务端决定
+    XPAward = 50,   // u8 RpcXPReason, i32 对象ID → i32 实际发放的经验值（已发放过为 0）
+    XPState,
+
+    // 统计报表
+    StatsReport = 60,
+
+    // 项目
+    ProjectList = 70,
+    ProjectCreate,
+    ProjectDelete,
+};
+
+enum class RpcStatus : std::uint16_t {
+    Ok = 0,
+    Error = 1,          // 操作执行失败
+    BadRequest = 2,     // 参数解码失败
+    UnknownOp = 3,
+    Forbidden = 4,      // 未登录，或连接身份无权代表该用户
+};
+
+// XPAward 的奖励原因。番茄钟经验值由运行番茄钟的进程在会话完成时发放，
+// 守护进程无法核实别处跑的会话，所以这里没有对应原因
+enum class RpcXPReason : std::uint8_t {
+    TaskCompleted = 0,  // 对象为任务ID：服务端把该用户的未完成任务标为完成并按完成任务发放
+};
+
+// StatsReport 的参数
+enum class RpcReportKind : std::uint8_t { Summary = 0, Daily, Weekly, Monthly };
+
+/**
+ * @brief ProjectList 的一行
+ */
+struct RpcProject {
+    int id = 0;
+    std::string name;
+    std::string description;
+    std::string colorLabel;
+    int totalTasks = 0;
+    int completedTasks = 0;
+    std::string targetDate;
+};
+
+/**
+ * @brief 一个完整的响应帧
+ */
+struct RpcResponse {
+    std::uint32_t requestId = 0;
+    RpcStatus status = RpcStatus::Ok;
+    std::string payload;
+};
+
+namespace RpcFrame {
+    constexpr std::size_t LENGTH_BYTES = 4;
+    constexpr std::size_t REQUEST_HEADER = 4 + 2;         // 长度之后的请求头
+    constexpr std::size_t RESPONSE_HEADER = 4 + 2;
+    constexpr std::uint32_t MAX_FRAME = 16 * 1024 * 1024;
+
+    std::string request(std::uint32_t requestId, RpcOp op, const std::string& payload);
+    std::string response(std::uint32_t requestId, RpcStatus status, const std::string& payload);
+    std::uint32_t readLength(const char* data);
+}
+
+/**
+ * @brief 参数/结果编码
+ */
+class RpcWriter {
+private:
+    std::string buffer;
+
+public:
+    RpcWriter& u8(std::uint8_t value);
+    RpcWriter& u16(std::uint16_t value);
+    RpcWriter& u32(std::uint32_t value);
+    RpcWriter& i32(int value) { return u32(static_cast<std::uint32_t>(value)); }
+    RpcWriter& boolean(bool value) { return u8(value ? 1 : 0); }
+    RpcWriter& str(const std::string& value);
+
+    RpcWriter& task(const Task& value);
+    RpcWriter& tasks(const std::vector<Task>& values);
+    RpcWriter& ints(const std::vector<int>& values);
+    RpcWriter& strings(const std::vector<std::string>& values);
+    RpcWriter& dependencyNode(const DependencyNode& value);
+    RpcWriter& scheduleEntry(const ScheduleEntry& value);
+    RpcWriter& taggedTask(const TaggedTask& value);
+    RpcWriter& project(const RpcProject& value);
+
+    // u32 个数 + 元素，元素由 write(*this, 元素) 逐个写入
+    template <typename T, typename Write>
+    RpcWriter& list(const std::vector<T>& values, Write write) {
+        u32(static_cast<std::uint32_t>(values.size()));
+        for (const auto& value : values) write(*this, value);
+        return *this;
+    }
+
+    const std::string& data() const { return buffer; }
+    std::string take() { return std::move(buffer); }
+};
+
+/**
+ * @brief 参数/结果解码；越界后 ok() 为 false，之后读到的都是默认值
+ */
+class RpcReader {
+private:
+    const char* pos;
+    const char* end;
+    bool valid = true;
+
+    bool need(std::size_t bytes);
+
+public:
+    RpcReader(const char* data, std::size_t size) : pos(data), end(data + size) {}
+    explicit RpcReader(const std::string& data) : RpcReader(data.data(), data.size()) {}
+
+    std::uint8_t u8();
+    std::uint16_t u16();
+    std::uint32_t u32();
+    int i32() { return static_cast<int>(u32()); }
+    bool boolean() { return u8() != 0; }
+    std::string str();
+
+    Task task();
+    std::vector<Task> tasks();
+    std::vector<int> ints();
+    std::vector<std::string> strings();
+    DependencyNode dependencyNode();
+    ScheduleEntry scheduleEntry();
+    TaggedTask taggedTask();
+    RpcProject project();
+
+    // u32 个数 + 元素，元素由 read() 逐个读出
+    template <typename T, typename Read>
+    std::vector<T> list(Read read) {
+        std::vector<T> values;
+        std::uint32_t count = u32();
+        // 每个元素至少占 1 字节，先挡住损坏帧导致的超大分配
+        if (!valid || count > static_cast<std::size_t>(end - pos)) {
+            valid = false;
+            return values;
+        }
+        values.reserve(count);
+        for (std::uint32_t i = 0; i < count && valid; ++i) {
+            values.push_back(read());
+        }
+        return values;
+    }
+
+    bool ok() const { return valid; }
+    bool atEnd() const { return valid && pos == end; }
+};
+
+/**
+ * @brief 地址格式："unix:PATH"、含 '/' 或以 .sock 结尾的路径（Unix 域套接字），
+ *        "tcp:HOST:PORT" 或 "HOST:PORT"（只接受 127.0.0.1、::1、localhost）
+ * @return 失败返回 -1，error 给出原因
+ */
+int rpcListen(const std::string& address, std::string& error);
+int rpcConnect(const std::string& address, std::string& error);
+
+/**
+ * @brief 已连接套接字对端进程的系统用户
+ *
+ * Unix 域套接字取 SO_PEERCRED；回环 TCP 在 /proc/net/tcp{,6} 里找到对端那一侧的
+ * 连接记录，取它的属主。查不到时返回 false，调用方应拒绝该连接。
+ */
+bool rpcPeerUid(int fd, uid_t& uid);
+
+#endif // RPC_PROTOCOL_H
@@ -0,0 +1,129 @@
+#ifndef RPC_SERVER_H
+#define RPC_SERVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <sys/types.h>
+#include "rpc/RpcProtocol.h"
+
+class TaskDAOImpl;
+class XPSystem;
+class StatisticsAnalyzer;
+class ProjectManager;
+class ReminderSystem;
+
+/**
+ * @brief 守护进程参数
+ */
+struct RpcServerOptions {
+    std::string address = "task_manager.sock";     // 见 rpcListen() 的地址格式
+    std::string reminderDbPath;                     // 非空时托管提醒检查
+    std::chrono::seconds reminderInterval{30};
+    size_t maxClients = 256;
+};
+
+/**
+ * @brief 守护进程：独占 DatabaseManager 与各模块的缓存，通过 RpcProtocol 提供服务
+ *
+ * 一个线程跑 poll() 事件循环，所有请求都在这个线程上执行，因此 TaskDAOImpl、
+ * XPSystem、StatisticsAnalyzer 这些非线程安全的模块可以直接使用，缓存在所有
+ * 客户端之间共享。每个连接读到多少完整帧就连续处理多少（客户端流水线），
+ * 响应攒在发送缓冲区里一次写出；写不完时等 POLLOUT，不阻塞其他连接。
+ *
+ * 身份：接受连接时用 rpcPeerUid 取对端的系统用户，连接必须先 Login。
+ * 与守护进程同一系统用户（或 root）的连接可以登录为任意用户；其他系统用户
+ * 只能登录为与其登录名同名的用户（不存在时创建），不能代表别人。
+ * 任务、项目、统计都按登录用户隔离；发放经验值只接受服务端能核实的原因。
+ *
+ * 每个用户一份 TaskDAOImpl、StatisticsAnalyzer 和 ProjectManager，第一次出现时
+ * ensureUser。设置了 reminderDbPath 时，在同一个循环里按周期检查到期提醒。
+ */
+class RpcServer {
+public:
+    struct Stats {
+        std::uint64_t requests = 0;
+        std::uint64_t errors = 0;           // 状态非 Ok 的响应
+        std::uint64_t rejected = 0;         // 取不到对端身份而拒绝的连接
+        std::uint64_t connections = 0;      // 累计接受的连接
+        size_t activeClients = 0;
+    };
+
+private:
+    static std::unique_ptr<RpcServer> instance;
+    static std::mutex instanceMutex;
+
+    struct Client {
+        int fd = -1;
+        uid_t peerUid = 0;
+        int userId = 0;         // Login 之前为 0
+        std::string inBuffer;
+        size_t inPos = 0;
+        std::string outBuffer;
+        size_t outPos = 0;
+    };
+
+    struct UserContext {
+        std::unique_ptr<TaskDAOImpl> tasks;
+        std::unique_ptr<StatisticsAnalyzer> stats;
+        std::unique_ptr<ProjectManager> projects;
+    };
+
+    RpcServerOptions options;
+    std::string dbPath;
+    uid_t ownerUid = 0;
+    int listenFd = -1;
+    int wakePipe[2] = {-1, -1};
+
+    mutable std::mutex serverMutex;
+    std::thread serverThread;
+    std::atomic<bool> running{false};
+
+    // 以下只在服务线程上访问
+    std::vector<Client> clients;
+    std::unordered_map<int, UserContext> users;
+    std::unique_ptr<XPSystem> xpSystem;
+    std::unique_ptr<ReminderSystem> reminderSystem;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void serve();
+    void acceptClients();
+    bool readClient(Client& client);        // 连接关闭或帧损坏时返回 false
+    bool writeClient(Client& client);
+    void handleFrame(Client& client, const char* frame, size_t length);
+
+    UserContext* userContext(int userId);
+    int accountUserId(uid_t uid);           // 系统用户对应的应用用户，按登录名查找或创建
+    RpcStatus login(Client& client, RpcReader& in, RpcWriter& out);
+    RpcStatus awardXP(int userId, RpcReader& in, RpcWriter& out);
+    RpcStatus dispatch(RpcOp op, Client& client, RpcReader& in, RpcWriter& out);
+    RpcStatus dispatchTask(RpcOp op, TaskDAOImpl& dao, RpcReader& in, RpcWriter& out);
+
+public:
+    RpcServer() = default;
+    ~RpcServer();
+    RpcServer(const RpcServer&) = delete;
+    RpcServer& operator=(const RpcServer&) = delete;
+
+    static RpcServer& getInstance();
+    static void destroyInstance();
+
+    /**
+     * @brief 在 options.address 上监听；DatabaseManager 必须已经打开
+     */
+    bool start(const RpcServerOptions& opts = RpcServerOptions());
+    void stop();
+    bool isRunning() const { return running; }
+
+    Stats getStats() const;
+};
+
+#endif // RPC_SERVER_H
@@ -4,7 +4,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <memory>
 #include "../database/DatabaseManager.h"
+#include "../database/ChangeFeed.h"
 
 using namespace std;
 
@@ -18,6 +21,26 @@ class StatisticsAnalyzer {
 private:
     DatabaseManager* dbManager;
     
+    // 当前统计的用户
+    int currentUserId;
+    
+    // 每用户 user_stats 行缓存（连续打卡等字段读多写少）
+    struct UserStatsRow {
+        int currentStreak = 0;
+        int longestStreak = 0;
+        int totalPomodoros = 0;
+        string lastActiveDate;
+        sqlite3_int64 rowid = 0;   // user_stats 的行，0 表示未知
+    };
+    unordered_map<int, UserStatsRow> userStatsCache;
+    
+    // user_stats 的提交变更：番茄钟、经验值等模块写入后按行作废，不必由调用方手动失效
+    unique_ptr<ChangeSubscription> userStatsChanges;
+    void applyChanges();
+    
+    const UserStatsRow& loadUserStats(int userId);
+    string userFilter() const;  // "user_id = N"
+    
     // 辅助方法
     int queryInt(const string& sql);
     double queryDouble(const string& sql);
@@ -26,9 +49,20 @@ private:
     string getMonthStartDate();
     
 public:
-    StatisticsAnalyzer();
+    explicit StatisticsAnalyzer(int userId = DatabaseManager::DEFAULT_USER_ID);
     ~StatisticsAnalyzer();
     
+    // === 多用户 ===
+    
+    void setCurrentUserId(int userId);
+    int getCurrentUserId() const;
+    
+    /**
+     * @brief 丢弃某个用户的 user_stats 缓存
+     */
+    void invalidateCache(int userId);
+    void clearCache();
+    
     // === 任务统计 ===
     
     /**
@@ -0,0 +1,209 @@
+#ifndef ASYNC_TASK_MANAGER_H
+#define ASYNC_TASK_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <optional>
+#include <atomic>
+#include <stdexcept>
+#include <any>
+#include <cstdint>
+#include <sqlite3.h>
+
+#include "task/task.h"
+#include "database/DAO/TaskDAO.h"
+
+/**
+ * @brief 取消标记：拷贝共享同一个标志，cancel() 后尚未开始执行的操作不再执行
+ */
+class CancellationToken {
+    std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+public:
+    void cancel() { flag->store(true); }
+    bool isCancelled() const { return flag->load(); }
+};
+
+/**
+ * @brief 操作在开始执行前被取消，或执行器已关闭；通过 future 抛给调用方
+ */
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("operation cancelled") {}
+};
+
+template <typename T>
+using AsyncResult = std::shared_future<T>;
+
+/**
+ * @brief 执行器配置
+ */
+struct AsyncTaskOptions {
+    int readers = 2;              // 读线程数，每个线程一条只读连接
+    size_t maxLookupBatch = 256;  // 一次 IN 查询最多合并的按 ID 读取
+};
+
+/**
+ * @brief TaskManager 的异步版本（C++17，基于 future）
+ *
+ * 接口与 TaskManager 一一对应，调用立即返回 AsyncResult，界面线程
+ * 用 wait_for(0) 轮询或在需要结果时 get()，不再在每次数据库调用上阻塞。
+ *
+ * - 读操作在读线程池上执行，每个读线程持有一条独立的只读连接（WAL 下
+ *   与写入互不阻塞）；无法打开只读连接（如内存库）时退化为共享连接
+ * - 写操作在单独的写线程上按提交顺序执行，使用 DatabaseManager 的共享连接
+ *   并持有 lockConnection()，与其他模块的语句不会交错
+ * - 尚未开始的相同读请求（同一查询、同一参数）合并为一次执行，共享结果；
+ *   排队中的 getTask(id) 合并成一条 WHERE id IN (...) 查询
+ * - 传入 CancellationToken 的操作在开始前被取消时，get() 抛出 OperationCancelled；
+ *   已开始执行的操作不会被打断。合并后的读请求要所有调用方都取消才会跳过
+ *
+ * 读写走不同连接，不保证两者之间的先后：需要读到自己写入的结果时先等写操作完成。
+ * 析构时排队中的写操作仍会执行完，排队中的读操作以 OperationCancelled 结束。
+ */
+class AsyncTaskManager {
+public:
+    struct Stats {
+        std::uint64_t reads = 0;            // 实际执行的读操作（合并后）
+        std::uint64_t coalescedReads = 0;   // 并入已排队请求的读调用
+        std::uint64_t lookupQueries = 0;    // 按 ID 读取实际发出的 IN 查询
+        std::uint64_t lookups = 0;          // 被这些查询满足的 getTask 调用
+        std::uint64_t writes = 0;
+        std::uint64_t cancelled = 0;
+    };
+
+private:
+    struct Job {
+        std::string key;                // 非空时可与相同 key 的读请求合并
+        int lookupId = 0;               // > 0：getTask(id)，可批量为 IN 查询
+        std::vector<CancellationToken> tokens;
+        std::any result;                // 合并读请求时复制出去的 AsyncResult<T>
+        std::function<void(TaskDAO&)> run;
+        std::function<void(const std::optional<Task>&)> deliver;   // lookup 的结果
+        std::function<void()> cancel;
+
+        bool cancelled() const;
+    };
+    using JobPtr = std::shared_ptr<Job>;
+
+    AsyncTaskOptions options;
+    std::string databasePath;
+    int userId;
+
+    std::mutex queueMutex;
+    std::condition_variable readReady;
+    std::condition_variable writeReady;
+    std::deque<JobPtr> readQueue;
+    std::deque<JobPtr> writeQueue;
+    std::unordered_map<std::string, JobPtr> pendingReads;
+    bool stopping = false;
+
+    std::vector<sqlite3*> readConnections;   // nullptr：该读线程使用共享连接
+    std::vector<std::thread> readers;
+    std::thread writer;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void readerLoop(size_t index);
+    void writerLoop();
+    void runLookups(TaskDAO& dao, std::vector<JobPtr>& batch);
+    void enqueueRead(const JobPtr& job);
+    void enqueueWrite(const JobPtr& job);
+    void countCancelled(size_t n);
+
+    template <typename T>
+    static std::pair<JobPtr, AsyncResult<T>> makeJob(std::function<T(TaskDAO&)> fn,
+                                                     const CancellationToken& token) {
+        auto job = std::make_shared<Job>();
+        auto promise = std::make_shared<std::promise<T>>();
+        AsyncResult<T> future = promise->get_future().share();
+        job->tokens.push_back(token);
+        job->result = future;
+        job->run = [promise, fn = std::move(fn)](TaskDAO& dao) {
+            try {
+                promise->set_value(fn(dao));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        };
+        job->cancel = [promise] {
+            promise->set_exception(std::make_exception_ptr(OperationCancelled()));
+        };
+        return {job, future};
+    }
+
+    template <typename T>
+    AsyncResult<T> submitRead(const std::string& key, std::function<T(TaskDAO&)> fn,
+                              const CancellationToken& token) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            auto it = pendingReads.find(key);
+            if (it != pendingReads.end()) {
+                it->second->tokens.push_back(token);
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.coalescedReads++;
+                return std::any_cast<AsyncResult<T>>(it->second->result);
+            }
+        }
+        auto [job, future] = makeJob<T>(std::move(fn), token);
+        job->key = key;
+        enqueueRead(job);
+        return future;
+    }
+
+    template <typename T>
+    AsyncResult<T> submitWrite(std::function<T(TaskDAO&)> fn, const CancellationToken& token) {
+        auto [job, future] = makeJob<T>(std::move(fn), token);
+        enqueueWrite(job);
+        return future;
+    }
+
+public:
+    explicit AsyncTaskManager(int userId = DatabaseManager::DEFAULT_USER_ID,
+                              const AsyncTaskOptions& opts = AsyncTaskOptions());
+    ~AsyncTaskManager();
+    AsyncTaskManager(const AsyncTaskManager&) = delete;
+    AsyncTaskManager& operator=(const AsyncTaskManager&) = delete;
+
+    // ===== CRUD =====
+    AsyncResult<int> createTask(const Task& task, const CancellationToken& token = CancellationToken());
+    AsyncResult<std::optional<Task>> getTask(int id, const CancellationToken& token = CancellationToken());
+    AsyncResult<std::vector<Task>> getAllTasks(const CancellationToken& token = CancellationToken());
+    AsyncResult<bool> updateTask(const Task& task, const CancellationToken& token = CancellationToken());
+    AsyncResult<bool> deleteTask(int id, const CancellationToken& token = CancellationToken());
+
+    // ===== 状态处理 =====
+    AsyncResult<bool> completeTask(int id, const CancellationToken& token = CancellationToken());
+    AsyncResult<std::vector<Task>> getTasksByCompletion(bool completed,
+                                                        const CancellationToken& token = CancellationToken());
+
+    // ===== 项目功能 =====
+    AsyncResult<std::vector<Task>> getTasksByProject(int projectId,
+                                                     const CancellationToken& token = CancellationToken());
+    AsyncResult<bool> assignTaskToProject(int taskId, int projectId,
+                                          const CancellationToken& token = CancellationToken());
+
+    // ===== 查询功能 =====
+    AsyncResult<std::vector<Task>> getOverdueTasks(const CancellationToken& token = CancellationToken());
+    AsyncResult<std::vector<Task>> getTodayTasks(const CancellationToken& token = CancellationToken());
+
+    // ===== 统计 =====
+    AsyncResult<int> getTaskCount(const CancellationToken& token = CancellationToken());
+    AsyncResult<int> getCompletedTaskCount(const CancellationToken& token = CancellationToken());
+
+    // ===== 番茄钟 =====
+    AsyncResult<bool> addPomodoro(int taskId, const CancellationToken& token = CancellationToken());
+    AsyncResult<int> getPomodoroCount(int taskId, const CancellationToken& token = CancellationToken());
+
+    Stats getStats() const;
+};
+
+#endif // ASYNC_TASK_MANAGER_H
@@ -0,0 +1,135 @@
+#ifndef DEPENDENCY_GRAPH_H
+#define DEPENDENCY_GRAPH_H
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 依赖图中一个任务的调度属性
+ */
+struct DependencyNode {
+    int taskId = 0;
+    int priority = 1;        // 0:低, 1:中, 2:高
+    int dueDate = 0;         // YYYYMMDD，0 表示没有截止日期
+    bool completed = false;
+    int projectId = 0;
+    int weight = 1;          // 关键路径上的工作量（预计番茄数，至少 1）
+};
+
+/**
+ * @brief 任务依赖 DAG：增量拓扑序、就绪队列、环检测、关键路径
+ *
+ * 边 dependsOn -> taskId 表示 taskId 要等 dependsOn 完成后才能开始。
+ *
+ * - 每个节点维护"未完成前置任务数"，完成/重开任务时只更新直接后继
+ * - 前置任务全部完成且自身未完成的任务进入就绪队列，按优先级降序、
+ *   截止日期升序（无截止日期排最后）、ID 升序排列，队首 O(1) 取得
+ * - 加边时用 Pearce-Kelly 算法维护拓扑序：只在受影响的序号区间内
+ *   做前向/后向搜索，前向搜索碰到起点即说明成环，拒绝该边
+ * - 关键路径按拓扑序做一次最长路 DP，只计项目内的边，已完成任务权重为 0
+ *
+ * 不加锁，由持有者（TaskManager）串行调用。
+ */
+class DependencyGraph {
+public:
+    struct CriticalPath {
+        std::vector<int> taskIds;   // 从最早开始的任务到最后一个
+        int length = 0;             // 路径上未完成任务的权重和
+    };
+
+private:
+    struct Node {
+        DependencyNode info;
+        bool alive = true;
+        bool ready = false;
+        int pending = 0;            // 未完成的前置任务数
+        int ord = 0;                // 拓扑序号：前置任务的序号总是更小
+        std::vector<int> out;       // 后继（依赖本任务的任务）
+        std::vector<int> in;        // 前置任务
+    };
+
+    // 就绪队列排序键
+    struct ReadyKey {
+        int priority;
+        int dueDate;                // 已把 0 换成最大值
+        int taskId;
+        bool operator<(const ReadyKey& other) const;
+    };
+
+    std::vector<Node> nodes;
+    std::unordered_map<int, int> indexOf;        // taskId -> nodes 下标
+    std::unordered_set<std::uint64_t> edgeSet;   // (from, to) 下标对，去重
+    std::set<ReadyKey> readyQueue;
+    size_t edges = 0;
+    int nextOrd = 0;
+
+    // Pearce-Kelly 搜索的访问标记
+    std::vector<std::uint32_t> mark;
+    std::uint32_t epoch = 0;
+
+    static std::uint64_t edgeKey(int from, int to);
+    ReadyKey readyKey(const Node& node) const;
+    void refreshReady(int index);
+    int find(int taskId) const;
+    void linkEdge(int from, int to);
+    void unlinkEdge(int from, int to);
+    bool reorder(int from, int to, std::vector<int>* cycle);
+    void nextEpoch();
+
+public:
+    /**
+     * @brief 一次性建图（从数据库加载），edges 为 (taskId, dependsOn)
+     *
+     * 端点不在 nodes 中的边忽略；库里已经成环的边按拓扑排序结果丢弃并告警。
+     */
+    void build(const std::vector<DependencyNode>& nodes,
+               const std::vector<std::pair<int, int>>& edges);
+    void clear();
+
+    // ===== 节点 =====
+    bool addTask(const DependencyNode& node);
+    bool removeTask(int taskId);
+    bool updateTask(const DependencyNode& node);   // 优先级/截止日期/项目/权重/完成状态
+    bool setCompleted(int taskId, bool completed);
+    bool setProject(int taskId, int projectId);
+    bool contains(int taskId) const;
+
+    // ===== 边 =====
+
+    /**
+     * @brief 添加依赖 dependsOn -> taskId
+     * @param cycle 非空且会成环时，写入环上的任务（从 taskId 出发回到 taskId）
+     * @return 已存在时返回 true；成环、自环或任务不存在时返回 false
+     */
+    bool addDependency(int taskId, int dependsOn, std::vector<int>* cycle = nullptr);
+    bool removeDependency(int taskId, int dependsOn);
+    bool hasDependency(int taskId, int dependsOn) const;
+    std::vector<int> getDependencies(int taskId) const;   // 前置任务
+    std::vector<int> getDependents(int taskId) const;     // 后继任务
+
+    // ===== 就绪队列 =====
+    std::optional<int> nextReady() const;
+    std::vector<int> readyTasks(size_t limit) const;
+    bool isReady(int taskId) const;
+    size_t readyCount() const { return readyQueue.size(); }
+
+    /**
+     * @brief 项目内剩余工作的关键路径（最长依赖链）
+     */
+    CriticalPath criticalPath(int projectId) const;
+
+    /**
+     * @brief 当前拓扑序（前置任务在前）
+     */
+    std::vector<int> topologicalOrder() const;
+
+    size_t taskCount() const { return indexOf.size(); }
+    size_t dependencyCount() const { return edges; }
+};
+
+#endif // DEPENDENCY_GRAPH_H
@@ -0,0 +1,88 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 压缩的 32 位整数集合（Roaring 风格），用于任务 ID 集合的交并差
+ *
+ * 按高 16 位分桶，每个桶（container）视基数选择表示方式：
+ * - 不超过 4096 个元素：有序的 uint16 数组（每个元素 2 字节）
+ * - 超过 4096 个：65536 位的位图（固定 8KB），交并差按 64 位字运算
+ *
+ * 两个集合运算时只处理高 16 位相同的桶，任务 ID 连续分配时
+ * 10 万个任务只占两个桶，AND/OR/NOT 都是几微秒的量级。
+ */
+class RoaringBitmap {
+private:
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t BITMAP_WORDS = 1024;
+
+    struct Container {
+        std::uint16_t key = 0;               // 高 16 位
+        std::vector<std::uint16_t> array;    // 数组表示
+        std::vector<std::uint64_t> bits;     // 位图表示，非空时 array 不用
+        std::uint32_t count = 0;
+
+        bool isBitmap() const { return !bits.empty(); }
+        bool contains(std::uint16_t low) const;
+        bool add(std::uint16_t low);
+        bool remove(std::uint16_t low);
+        void toBitmap();
+        void toArray();
+        void normalize();    // 运算后按基数重新选择表示方式
+    };
+
+    std::vector<Container> containers;       // 按 key 升序
+
+    Container* find(std::uint16_t key);
+    const Container* find(std::uint16_t key) const;
+
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+    static Container subtract(const Container& a, const Container& b);
+
+public:
+    bool add(std::uint32_t value);
+    bool remove(std::uint32_t value);
+    bool contains(std::uint32_t value) const;
+    void clear() { containers.clear(); }
+
+    size_t cardinality() const;
+    bool empty() const { return containers.empty(); }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator-=(const RoaringBitmap& other);   // AND NOT
+
+    friend RoaringBitmap operator&(RoaringBitmap a, const RoaringBitmap& b) { return a &= b; }
+    friend RoaringBitmap operator|(RoaringBitmap a, const RoaringBitmap& b) { return a |= b; }
+    friend RoaringBitmap operator-(RoaringBitmap a, const RoaringBitmap& b) { return a -= b; }
+
+    // 升序输出，limit 为 0 表示全部
+    std::vector<std::uint32_t> toVector(size_t limit = 0) const;
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (const auto& c : containers) {
+            const std::uint32_t high = static_cast<std::uint32_t>(c.key) << 16;
+            if (!c.isBitmap()) {
+                for (std::uint16_t low : c.array) fn(high | low);
+                continue;
+            }
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                std::uint64_t word = c.bits[w];
+                while (word) {
+                    fn(high | static_cast<std::uint32_t>(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+
+    size_t memoryBytes() const;
+};
+
+#endif // ROARING_BITMAP_H
@@ -0,0 +1,91 @@
+#ifndef TAG_INDEX_H
+#define TAG_INDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+
+#include "task/RoaringBitmap.h"
+
+/**
+ * @brief 建索引所需的任务属性（由 TaskDAO 从 tasks + task_tags 读出）
+ */
+struct TaggedTask {
+    int taskId = 0;
+    bool completed = false;
+    int projectId = 0;
+    std::vector<int> tagIds;
+};
+
+/**
+ * @brief 标签查询：all 全部包含、any 至少包含一个、none 都不包含，
+ *        再与完成状态、项目过滤取交集；条件为空表示不限
+ */
+struct TagQuery {
+    std::vector<std::string> all;
+    std::vector<std::string> any;
+    std::vector<std::string> none;
+    std::optional<bool> completed;
+    std::optional<int> projectId;
+};
+
+/**
+ * @brief 内存中的标签索引：标签字典 + 每个标签/状态/项目一个任务 ID 位图
+ *
+ * 标签 ID 就是 tags 表的主键，名称统一为去掉首尾空白的小写形式，
+ * 查询时先按名称查字典，再在位图上做 AND/OR/ANDNOT，不碰数据库。
+ * 集合按基数从小到大求交，结果只在最后一步展开成 ID 列表。
+ *
+ * 不加锁，由持有者（TaskManager）串行调用。
+ */
+class TagIndex {
+private:
+    std::unordered_map<std::string, int> tagIds;
+    std::unordered_map<int, std::string> tagNames;
+    std::unordered_map<int, RoaringBitmap> byTag;
+    std::unordered_map<int, RoaringBitmap> byProject;
+    RoaringBitmap allTasks;
+    RoaringBitmap completedTasks;
+
+    struct TaskInfo {
+        int projectId = 0;
+        std::vector<int> tagIds;
+    };
+    std::unordered_map<int, TaskInfo> tasks;
+
+    const RoaringBitmap* tagBitmap(const std::string& name) const;
+
+public:
+    /**
+     * @brief 标签名规范化：去掉首尾空白并转小写；逗号是 tasks.tags 的分隔符，不允许出现
+     * @return 规范化后为空或含逗号时返回空串
+     */
+    static std::string normalize(const std::string& name);
+
+    void build(const std::vector<std::pair<int, std::string>>& tags,
+               const std::vector<TaggedTask>& tasks);
+    void clear();
+
+    // ===== 任务 =====
+    void addTask(int taskId, bool completed, int projectId);
+    void removeTask(int taskId);
+    void setCompleted(int taskId, bool completed);
+    void setProject(int taskId, int projectId);
+    bool contains(int taskId) const { return tasks.count(taskId) > 0; }
+
+    // 替换任务的标签集合，tags 为已落库的 (标签ID, 名称)
+    void setTags(int taskId, const std::vector<std::pair<int, std::string>>& tags);
+    std::vector<std::string> tagsOf(int taskId) const;
+
+    // ===== 查询 =====
+    RoaringBitmap query(const TagQuery& query) const;
+    std::optional<int> tagId(const std::string& name) const;
+    std::vector<std::pair<std::string, size_t>> tagCounts() const;   // 标签名 -> 任务数，按名称排序
+
+    size_t taskCount() const { return tasks.size(); }
+    size_t tagCount() const { return tagNames.size(); }
+    size_t memoryBytes() const;
+};
+
+#endif // TAG_INDEX_H
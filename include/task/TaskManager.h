@@ -4,15 +4,38 @@
 #include <vector>
 #include <optional>
 #include <string>
+#include <memory>
 
 #include "task.h"
 #include "database/DAO/TaskDAO.h"
+#include "DependencyGraph.h"
+#include "TaskScheduler.h"
+#include "TagIndex.h"
+
+class ChangeSubscription;
 
 class TaskManager {
 private:
     TaskDAO* dao;          // 使用已完成的 TaskDAO
     bool ownDAO = false;   // 是否需要析构 DAO（防止重复 delete）
 
+    // 其他连接、线程或进程对任务的提交；自己的写入已同步到缓存，不收集
+    std::unique_ptr<ChangeSubscription> taskChanges;
+    void applyChanges();
+
+    // 依赖图在第一次使用依赖功能时从数据库加载，之后随增删改同步更新
+    std::unique_ptr<DependencyGraph> graph;
+    DependencyGraph* loadedGraph();
+
+    // 排程堆同样延迟加载；任务变化时只重读这一条并原地调整
+    std::unique_ptr<TaskScheduler> scheduler;
+    TaskScheduler* loadedScheduler();
+    void refreshScheduled(int taskId);
+
+    // 标签索引同样延迟加载，随任务增删改同步
+    std::unique_ptr<TagIndex> tagIndex;
+    TagIndex* loadedTagIndex();
+
 public:
     // 构造 & 析构
     TaskManager();
@@ -26,6 +49,7 @@ public:
     int createTask(const Task& task);
     std::optional<Task> getTask(int id);
     std::vector<Task> getAllTasks();
+    std::vector<Task> getTasksByIds(const std::vector<int>& ids);  // 不存在的 ID 不出现在结果中
 
     bool updateTask(const Task& task);
     bool deleteTask(int id);
@@ -50,6 +74,41 @@ public:
     // ===== 番茄钟 =====
     bool addPomodoro(int taskId);
     int getPomodoroCount(int taskId);
+
+    // ===== 任务依赖 =====
+    // dependsOnId 完成后 taskId 才能开始；会形成环时拒绝，cycle 给出环上的任务
+    bool addDependency(int taskId, int dependsOnId, std::vector<int>* cycle = nullptr);
+    bool removeDependency(int taskId, int dependsOnId);
+    std::vector<int> getDependencies(int taskId);
+
+    // 前置任务均已完成的未完成任务，按优先级、截止日期排序
+    std::optional<int> getNextReadyTask();
+    std::vector<int> getReadyTasks(size_t limit = 10);
+
+    DependencyGraph::CriticalPath getCriticalPath(int projectId);
+
+    // 丢弃内存中的依赖图，下次使用时重新加载（外部直接改了数据库时调用）
+    void reloadDependencies();
+
+    // ===== 排程 =====
+    // 综合优先级、截止日期、剩余番茄和项目目标日期，得分最高的 k 个可开始任务
+    std::vector<TaskScheduler::Scored> nextTasks(size_t k = 5);
+
+    // 丢弃排程堆，下次使用时重新加载（项目目标日期变化或外部改库时调用）
+    void reloadSchedule();
+
+    // ===== 标签 =====
+    // 整体替换任务的标签；名称去首尾空白并转小写，空名称和含逗号的名称被拒绝
+    bool setTaskTags(int taskId, const std::vector<std::string>& tags);
+    bool addTaskTags(int taskId, const std::vector<std::string>& tags);
+    bool removeTaskTags(int taskId, const std::vector<std::string>& tags);
+    std::vector<std::string> getTaskTags(int taskId);
+
+    // 按标签组合与状态/项目过滤，返回升序的任务 ID；limit 为 0 表示全部
+    std::vector<int> findTasksByTags(const TagQuery& query, size_t limit = 0);
+    std::vector<std::pair<std::string, size_t>> getTagCounts();
+
+    void reloadTags();
 };
 
 #endif // TASK_MANAGER_H
@@ -0,0 +1,150 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief 参与排程的未完成任务（由 TaskDAO 从 tasks + projects 读出）
+ */
+struct ScheduleEntry {
+    int taskId = 0;
+    int priority = 1;                 // 0:低, 1:中, 2:高
+    std::string dueDate;              // "YYYY-MM-DD"，空表示没有截止日期
+    std::string projectTargetDate;    // 所属项目的 target_date
+    int estimatedPomodoros = 0;
+    int pomodoroCount = 0;
+    int projectId = 0;
+};
+
+/**
+ * @brief 评分权重
+ *
+ * score = priority * priorityWeight
+ *       + 截止压力：逾期 overdueBase + overduePerDay * 逾期天数（最多 30 天），
+ *         否则 dueWeight / (剩余天数 + 1)
+ *       + 工作量压力：有截止日期且还剩 r 个番茄时 workWeight * r / (剩余天数 + 1)，上限 workCap
+ *       + 已开工（做过番茄但未做完）startedBonus
+ *
+ * 截止日期取任务 due_date 与项目 target_date 中较早的一个。
+ */
+struct SchedulerWeights {
+    double priorityWeight = 100.0;
+    double dueWeight = 300.0;
+    double overdueBase = 400.0;
+    double overduePerDay = 10.0;
+    double workWeight = 20.0;
+    double workCap = 200.0;
+    double startedBonus = 15.0;
+};
+
+/**
+ * @brief "下一步做什么"排程：未完成任务按得分组织成带索引的 4 叉堆
+ *
+ * - 堆中记录每个任务的位置，任务变化时 O(log n) 原地上浮/下沉，不重建
+ * - topK 不弹出元素：以堆顶为起点按得分做最佳优先展开（每取一个再放入
+ *   它的 4 个孩子），O(k log k)，n 再大也只触及约 4k 个节点
+ * - 得分依赖"今天"，日期变化后第一次查询时整体重算并 O(n) 建堆
+ *
+ * 不加锁，由持有者（TaskManager）串行调用。
+ */
+class TaskScheduler {
+public:
+    struct Scored {
+        int taskId;
+        double score;
+    };
+
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr int NO_DATE = 0x7fffffff;
+
+    struct Item {
+        int taskId;
+        int priority;
+        int deadline;           // 距 1970-01-01 的天数，NO_DATE 表示没有
+        int remaining;          // 剩余番茄数
+        bool started;
+        double score;
+    };
+
+    SchedulerWeights weights;
+    std::vector<Item> heap;
+    std::unordered_map<int, size_t> position;   // taskId -> heap 下标
+    int today = 0;
+    int observedDay = 0;    // 上次看到的真实日期，变化时才重算
+
+    static bool before(const Item& a, const Item& b);
+    double scoreOf(const Item& item) const;
+    Item makeItem(const ScheduleEntry& entry) const;
+    void place(size_t index, Item item);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void heapify();
+    void rebaseIfDayChanged();
+
+public:
+    explicit TaskScheduler(const SchedulerWeights& weights = SchedulerWeights());
+
+    /**
+     * @brief "YYYY-MM-DD[...]" 转为距 1970-01-01 的天数，无法解析返回 nullopt
+     */
+    static std::optional<int> dayNumber(const std::string& date);
+    static int currentDay();    // UTC，与 SQLite 的 date('now') 一致
+
+    void build(const std::vector<ScheduleEntry>& entries);
+    void clear();
+
+    // 插入或更新（已在堆中则重算得分并调整位置）
+    void upsert(const ScheduleEntry& entry);
+    bool remove(int taskId);
+    bool contains(int taskId) const { return position.count(taskId) > 0; }
+
+    /**
+     * @brief 得分最高的 k 个任务（从高到低），accept 返回 false 的任务跳过且不占名额
+     */
+    template <typename Accept>
+    std::vector<Scored> topK(size_t k, Accept accept);
+    std::vector<Scored> topK(size_t k) {
+        return topK(k, [](int) { return true; });
+    }
+
+    std::optional<double> scoreOf(int taskId) const;
+    size_t size() const { return heap.size(); }
+
+    // 测试/基准用：手动指定"今天"
+    void setToday(int day);
+};
+
+template <typename Accept>
+std::vector<TaskScheduler::Scored> TaskScheduler::topK(size_t k, Accept accept) {
+    rebaseIfDayChanged();
+
+    std::vector<Scored> result;
+    if (heap.empty() || k == 0) return result;
+    result.reserve(k);
+
+    // 候选集合是堆中的下标，按同样的顺序组织成一个小的二叉堆
+    std::vector<size_t> frontier{0};
+    auto worse = [this](size_t a, size_t b) { return before(heap[b], heap[a]); };
+    while (!frontier.empty() && result.size() < k) {
+        std::pop_heap(frontier.begin(), frontier.end(), worse);
+        size_t index = frontier.back();
+        frontier.pop_back();
+
+        if (accept(heap[index].taskId)) {
+            result.push_back({heap[index].taskId, heap[index].score});
+        }
+        for (size_t child = index * ARITY + 1; child <= index * ARITY + ARITY && child < heap.size(); ++child) {
+            frontier.push_back(child);
+            std::push_heap(frontier.begin(), frontier.end(), worse);
+        }
+    }
+    return result;
+}
+
+#endif // TASK_SCHEDULER_H
@@ -10,6 +10,7 @@ private:
     std::string description;
     int projectId;
     bool completed;
+    int userId;                // 多用户：任务所属用户
 
 public:
     // 构造函数
@@ -35,6 +36,10 @@ public:
     void setName(const std::string& name);
     void setDescription(const std::string& desc);
     void setProjectId(int projectId);
+
+    // 多用户
+    int getUserId() const;
+    void setUserId(int userId);
 };
 
 #endif // TASK_H
@@ -0,0 +1,117 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 一个已结束的区间（Chrome trace 的 "X" 事件）
+ *
+ * category / name 必须是字符串字面量之类生命周期足够长的指针；
+ * 动态内容（如 SQL）放进 detail，超长会被截断。
+ */
+struct TraceEvent {
+    static constexpr size_t DETAIL_SIZE = 80;
+
+    const char* category = nullptr;
+    const char* name = nullptr;
+    std::int64_t startNs = 0;
+    std::int64_t durationNs = 0;
+    char detail[DETAIL_SIZE];  // 以 '\0' 结尾；不做默认初始化，关闭追踪时区间不必清零它
+};
+
+/**
+ * @brief 热路径追踪
+ *
+ * 每个线程在追踪开启后第一次记录时才分配自己的环形缓冲区（默认 16384
+ * 个事件），写满后覆盖最旧的事件，所以长时间运行也只保留最近的一段；
+ * 只命名、从未记录过的线程只保存名字。记录只锁本线程缓冲区的互斥量，
+ * 除导出外不会有竞争。clear() 释放所有缓冲区。
+ *
+ * 运行时默认关闭，关闭时一个区间的开销只是一次原子读；编译时定义
+ * DISABLE_TRACING（make TRACING=0）则所有 TRACE_* 宏展开为空。
+ * writeChromeTrace() 导出 Chrome trace_event JSON，可以直接拖进
+ * chrome://tracing 或 Perfetto UI 查看。
+ */
+class Tracer {
+public:
+    static void setEnabled(bool on) { enabledFlag.store(on, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 之后分配的线程缓冲区的容量（事件数）
+     */
+    static void setBufferCapacity(size_t events);
+
+    /**
+     * @brief 为当前线程命名，导出时显示在轨道标题上
+     */
+    static void setThreadName(const std::string& name);
+
+    static void record(const TraceEvent& event);
+    static void copyDetail(TraceEvent& event, const char* detail);
+
+    /**
+     * @brief 单调时钟，单位纳秒，以进程内第一次调用为零点
+     */
+    static std::int64_t nowNs();
+
+    static bool writeChromeTrace(const std::string& path);
+    static size_t eventCount();
+    static void clear();
+
+private:
+    static std::atomic<bool> enabledFlag;
+};
+
+/**
+ * @brief RAII 区间：构造时记开始时间（detail 在此时复制），析构时写入当前线程的缓冲区
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name, const char* detail = nullptr)
+        : active(Tracer::isEnabled()) {
+        if (active) {
+            event.category = category;
+            event.name = name;
+            event.detail[0] = '\0';
+            if (detail) Tracer::copyDetail(event, detail);
+            event.startNs = Tracer::nowNs();
+        }
+    }
+
+    TraceSpan(const char* category, const char* name, const std::string& detail)
+        : TraceSpan(category, name, detail.c_str()) {}
+
+    ~TraceSpan() {
+        if (active) {
+            event.durationNs = Tracer::nowNs() - event.startNs;
+            Tracer::record(event);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    bool active;
+    TraceEvent event;
+};
+
+#ifndef DISABLE_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name) \
+    TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail) \
+    TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(category, name, detail)
+#define TRACE_THREAD_NAME(name) Tracer::setThreadName(name)
+#else
+#define TRACE_SCOPE(category, name) ((void)0)
+#define TRACE_SCOPE_DETAIL(category, name, detail) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACER_H
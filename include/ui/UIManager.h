@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <future>
+#include <memory>
+#include "task/task.h"
 
 // 前向声明，避免循环依赖
 class StatisticsAnalyzer;
@@ -11,6 +14,10 @@ class XPSystem;
 class HeatmapVisualizer;
 class ProjectManager;
 class TaskManager; 
+class AsyncTaskManager;
+class ChangeSubscription;
+class RpcClient;
+class RemoteTaskDAO;
 
 class UIManager {
 private:
@@ -20,6 +27,14 @@ private:
     HeatmapVisualizer* heatmap;
     ProjectManager* projectManager;
     TaskManager* taskManager; // ⭐ 新增：任务管理器
+    AsyncTaskManager* asyncTasks; // 后台读取，等待菜单输入时预取任务列表
+
+    std::shared_future<std::vector<Task>> taskListPrefetch;
+    std::unique_ptr<ChangeSubscription> taskChanges;  // 预取之后 tasks 有提交则丢弃预取结果
+
+    // 客户端模式（设置了 TASK_MANAGER_SERVER）：任务读写经守护进程完成
+    std::unique_ptr<RpcClient> rpcClient;
+    std::unique_ptr<RemoteTaskDAO> remoteTasks;
 
     bool running;
 
@@ -45,6 +60,7 @@ private:
     int getIntInput(const std::string& prompt);
     void pause();
     bool confirmAction(const std::string& prompt);
+    std::vector<Task> takeTaskList();  // 优先使用预取结果，用过即失效
 
     // === ⭐ 游戏化视觉特效 (UI增强) ===
     void displayHUD(); // 替代原有的 displayUserStatusBar
@@ -84,6 +100,8 @@ public:
     void updateTask();
     void deleteTask();
     void completeTask();
+    void showPomodoroMenu();
+    void processPomodoroCompletions();
 
     // 项目功能 (完整保留)
     void createProject();
@@ -103,6 +121,7 @@ public:
     void showXPAndLevel();
     void showAchievements();
     void showChallenges();
+    void showLeaderboard();
 
     // 设置功能 (完整保留)
     void viewSettings();
@@ -0,0 +1,85 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class DatabaseManager;
+
+/**
+ * @brief 合成数据配置
+ */
+struct WorkloadConfig {
+    std::uint64_t seed = 42;
+    std::int64_t anchorTime = 0;       // "现在"的 Unix 时间；0 表示取当前时间。固定它才能逐字节复现
+    int users = 1;
+    long long tasks = 10000;           // 所有用户合计
+    int projects = 50;
+    int historyDays = 365;             // 任务创建时间分布在最近 N 天内
+    double projectZipf = 1.1;          // 项目热度的 Zipf 指数
+    double completionRate = 0.6;
+    double dueDateRate = 0.7;
+    double meanPomodoros = 2.0;        // 每个已完成任务的平均番茄数
+    double interruptionRate = 0.1;
+    long long reminders = 0;           // 写入 reminderDbPath；为 0 或路径为空时不生成
+    double recurringReminderRate = 0.3;
+    std::string reminderDbPath;
+    long long batchSize = 20000;       // 每个事务写入的行数
+    bool rebuildIndexes = true;        // 先删二级索引，写完后统一重建
+};
+
+/**
+ * @brief 生成结果统计
+ */
+struct WorkloadStats {
+    long long users = 0;
+    long long projects = 0;
+    long long tasks = 0;
+    long long completedTasks = 0;
+    long long pomodoroSessions = 0;
+    long long reminders = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief 可复现的合成任务数据生成器
+ *
+ * 同一个 seed 和配置总是生成同样的数据：随机数只用 mt19937_64，
+ * 各种分布（Zipf / 日内时段 / 几何分布）都在这里自己实现，
+ * 不依赖标准库 distribution 在不同实现间的差异。
+ *
+ * - 项目热度服从 Zipf，少数项目占大部分任务
+ * - 完成时间集中在上午、下午和晚间几个时段，周末更少
+ * - 优先级 低/中/高 = 30% / 50% / 20%，标签从词表中按 Zipf 选 0-3 个
+ * - 已完成任务带有若干 pomodoro_sessions（部分被中断），tasks.pomodoro_count 与之一致
+ * - 可选地向 ReminderDAO 的独立库写入一次性和重复提醒
+ *
+ * 写入走预编译语句 + 大事务；rebuildIndexes 为 true 时先删除相关表的
+ * 二级索引，写完再按原定义重建，比逐行维护索引快得多。
+ */
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& config);
+
+    /**
+     * @brief 向已初始化的数据库追加数据
+     */
+    bool generate(DatabaseManager& db, WorkloadStats* stats = nullptr);
+
+    const WorkloadConfig& getConfig() const { return config; }
+
+private:
+    WorkloadConfig config;
+
+    struct SavedIndex {
+        std::string name;
+        std::string sql;
+    };
+
+    bool dropSecondaryIndexes(DatabaseManager& db, std::vector<SavedIndex>& saved);
+    bool restoreIndexes(DatabaseManager& db, const std::vector<SavedIndex>& saved);
+    bool generateReminders(long long firstTaskId, long long lastTaskId, WorkloadStats& stats);
+};
+
+#endif // WORKLOAD_GENERATOR_H
@@ -1,4 +1,6 @@
 #include "HeatmapVisualizer/HeatmapVisualizer.h"
+#include "database/QueryProfiler.h"
+#include "database/SchemaMigrator.h"
 #include <iostream>
 #include <sstream>
 #include <ctime>
@@ -7,28 +9,46 @@
 HeatmapVisualizer::HeatmapVisualizer() {
     dbPath = "task_manager.db";
     db = nullptr;
+    currentUserId = DatabaseManager::DEFAULT_USER_ID;
+    taskChanges = make_unique<ChangeSubscription>(vector<string>{"tasks"});
 }
 
-HeatmapVisualizer::HeatmapVisualizer(string dbPath) {
+HeatmapVisualizer::HeatmapVisualizer(string dbPath, int userId) {
     this->dbPath = dbPath;
     db = nullptr;
+    currentUserId = userId;
+    taskChanges = make_unique<ChangeSubscription>(vector<string>{"tasks"});
 }
 
 HeatmapVisualizer::~HeatmapVisualizer() {
     closeDatabase();
 }
 
+// === 多用户 ===
+
+void HeatmapVisualizer::setCurrentUserId(int userId) {
+    if (userId == currentUserId) return;
+    currentUserId = userId;
+    dailyCountsCache.clear();  // 缓存只属于上一个用户
+}
+
+int HeatmapVisualizer::getCurrentUserId() const {
+    return currentUserId;
+}
+
 bool HeatmapVisualizer::openDatabase() {
     int result = sqlite3_open(dbPath.c_str(), &db);
     if (result != SQLITE_OK) {
         cerr << "Cannot open database: " << sqlite3_errmsg(db) << endl;
         return false;
     }
+    QueryProfiler::getInstance().attach(db);
     return true;
 }
 
 void HeatmapVisualizer::closeDatabase() {
     if (db != nullptr) {
+        QueryProfiler::getInstance().detach(db);
         sqlite3_close(db);
         db = nullptr;
     }
@@ -37,20 +57,8 @@ void HeatmapVisualizer::closeDatabase() {
 bool HeatmapVisualizer::initialize() {
     if (!openDatabase()) return false;
     
-    const char* sql = 
-        "CREATE TABLE IF NOT EXISTS tasks ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "title TEXT NOT NULL, "
-        "completed INTEGER DEFAULT 0, "
-        "completed_date TEXT"
-        ");";
-    
-    char* errMsg = nullptr;
-    int result = sqlite3_exec(db, sql, nullptr, nullptr, &errMsg);
-    
-    if (result != SQLITE_OK) {
-        cerr << "Create table failed: " << errMsg << endl;
-        sqlite3_free(errMsg);
+    if (!SchemaMigrator(db).migrate()) {
+        cerr << "Create table failed" << endl;
         closeDatabase();
         return false;
     }
@@ -78,7 +86,8 @@ bool HeatmapVisualizer::initialize() {
         "('Task 19', 1, '2025-11-08'), "
         "('Task 20', 1, '2025-11-09');";
     
-    result = sqlite3_exec(db, insertSQL, nullptr, nullptr, &errMsg);
+    char* errMsg = nullptr;
+    int result = sqlite3_exec(db, insertSQL, nullptr, nullptr, &errMsg);
     
     if (result != SQLITE_OK) {
         sqlite3_free(errMsg);
@@ -89,16 +98,28 @@ bool HeatmapVisualizer::initialize() {
 }
 
 map<string, int> HeatmapVisualizer::getTaskDataFromDB(int days) {
+    // 与查询里的 DATE('now') 一致，用 UTC 日期
+    time_t now = time(0);
+    char today[16];
+    strftime(today, sizeof(today), "%Y-%m-%d", gmtime(&now));
+    if (taskChanges->hasChanges() || dailyCountsDay != today) {
+        taskChanges->take();
+        dailyCountsCache.clear();
+        dailyCountsDay = today;
+    }
+    auto cached = dailyCountsCache.find(days);
+    if (cached != dailyCountsCache.end()) return cached->second;
+    
     map<string, int> taskData;
     
     if (!openDatabase()) return taskData;
     
     stringstream sql;
-    sql << "SELECT DATE(completed_date) as date, COUNT(*) as count "
-        << "FROM tasks "
-        << "WHERE completed = 1 "
-        << "AND completed_date >= DATE('now', '-" << days << " days') "
-        << "GROUP BY DATE(completed_date);";
+    sql << "SELECT completed_day as date, SUM(task_count) as count "
+        << "FROM task_history "
+        << "WHERE user_id = ? AND completed = 1 "
+        << "AND completed_day >= DATE('now', '-" << days << " days') "
+        << "GROUP BY completed_day;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql.str().c_str(), -1, &stmt, nullptr);
@@ -107,6 +128,7 @@ map<string, int> HeatmapVisualizer::getTaskDataFromDB(int days) {
         closeDatabase();
         return taskData;
     }
+    sqlite3_bind_int(stmt, 1, currentUserId);
     
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         const char* dateStr = (const char*)sqlite3_column_text(stmt, 0);
@@ -119,6 +141,7 @@ map<string, int> HeatmapVisualizer::getTaskDataFromDB(int days) {
     sqlite3_finalize(stmt);
     closeDatabase();
     
+    dailyCountsCache[days] = taskData;
     return taskData;
 }
 
@@ -270,10 +293,11 @@ string HeatmapVisualizer::generateWeekView(string startDate) {
 int HeatmapVisualizer::getTotalTasks() {
     if (!openDatabase()) return 0;
     
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1;";
+    const char* sql = "SELECT SUM(task_count) FROM task_history WHERE user_id = ? AND completed = 1;";
     sqlite3_stmt* stmt;
     
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, currentUserId);
     int count = 0;
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -290,13 +314,14 @@ string HeatmapVisualizer::getMostActiveDay() {
     if (!openDatabase()) return "None";
     
     const char* sql = 
-        "SELECT DATE(completed_date) as date, COUNT(*) as count "
-        "FROM tasks WHERE completed = 1 "
-        "GROUP BY DATE(completed_date) "
+        "SELECT completed_day as date, SUM(task_count) as count "
+        "FROM task_history WHERE user_id = ? AND completed = 1 "
+        "GROUP BY completed_day "
         "ORDER BY count DESC LIMIT 1;";
     
     sqlite3_stmt* stmt;
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, currentUserId);
     
     string result = "None";
     
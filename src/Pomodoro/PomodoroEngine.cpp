@@ -0,0 +1,539 @@
+#include "Pomodoro/PomodoroEngine.h"
+#include "trace/Tracer.h"
+#include "database/DatabaseManager.h"
+#include "database/ChangeFeed.h"
+#include <iostream>
+#include <ctime>
+#include <sqlite3.h>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// 锁冲突是暂时的，整批留着下次再写；其他错误重试也不会好
+bool isTransientError(int rc) {
+    int primary = rc & 0xff;
+    return primary == SQLITE_BUSY || primary == SQLITE_LOCKED;
+}
+
+// 计数器是派生数据：非暂时性错误只记一笔，已写入的记录照常提交
+bool stepCounter(sqlite3* db, sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_DONE) return true;
+    if (isTransientError(rc)) return false;  // 调用方 ROLLBACK，整批重试
+    std::cerr << "❌ 番茄钟计数更新失败: " << sqlite3_errmsg(db) << std::endl;
+    return true;
+}
+
+}  // namespace
+
+// 静态成员初始化
+std::unique_ptr<PomodoroEngine> PomodoroEngine::instance = nullptr;
+std::mutex PomodoroEngine::instanceMutex;
+
+PomodoroEngine& PomodoroEngine::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<PomodoroEngine>();
+    }
+    return *instance;
+}
+
+void PomodoroEngine::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+PomodoroEngine::~PomodoroEngine() {
+    stop();
+}
+
+std::string PomodoroEngine::currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char buf[20];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &utc);
+    return buf;
+}
+
+std::string PomodoroEngine::phaseName(PomodoroPhase phase) {
+    switch (phase) {
+        case PomodoroPhase::Work: return "work";
+        case PomodoroPhase::ShortBreak: return "short_break";
+        case PomodoroPhase::LongBreak: return "long_break";
+    }
+    return "work";
+}
+
+// === 生命周期 ===
+
+void PomodoroEngine::start() {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    if (running) return;
+
+    running = true;
+    lastFlush = Clock::now();
+    loopThread = std::thread(&PomodoroEngine::loop, this);
+}
+
+void PomodoroEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        running = false;
+    }
+    wakeup.notify_all();
+    if (loopThread.joinable()) {
+        loopThread.join();
+    }
+
+    // 仍在进行的会话按中断处理，保证每个开始过的阶段都有记录
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        for (auto& entry : sessions) {
+            recordLocked(entry.second, false, true, "程序退出");
+        }
+        sessions.clear();
+        deadlines = {};
+    }
+    flush();
+    closeWriter();
+}
+
+bool PomodoroEngine::isRunning() const {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    return running;
+}
+
+void PomodoroEngine::setDefaultDurations(const PomodoroDurations& durations) {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    defaultDurations = durations;
+}
+
+void PomodoroEngine::setBatchPolicy(size_t maxRecords, std::chrono::seconds interval) {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    batchSize = maxRecords > 0 ? maxRecords : 1;
+    flushInterval = interval;
+}
+
+// === 事件循环 ===
+
+void PomodoroEngine::loop() {
+    TRACE_THREAD_NAME("pomodoro-engine");
+    std::unique_lock<std::mutex> lock(engineMutex);
+
+    while (running) {
+        auto now = Clock::now();
+
+        // 处理所有到期的截止时间；generation 不匹配的是暂停前留下的旧条目
+        while (!deadlines.empty() && deadlines.top().when <= now) {
+            Deadline due = deadlines.top();
+            deadlines.pop();
+
+            auto it = sessions.find(due.sessionId);
+            if (it == sessions.end() || it->second.generation != due.generation ||
+                it->second.state != PomodoroState::Running) {
+                continue;
+            }
+
+            onDeadlineLocked(it->second, now);
+            if (it->second.state == PomodoroState::Finished) {
+                sessions.erase(it);
+            }
+        }
+
+        // 攒够一批或超时后落库，写库期间释放引擎锁，不阻塞会话控制
+        if (!pendingWrites.empty() &&
+            (pendingWrites.size() >= batchSize || now - lastFlush >= flushInterval)) {
+            std::vector<PomodoroRecord> batch;
+            batch.swap(pendingWrites);
+            lastFlush = now;
+
+            lock.unlock();
+            bool ok = writeBatch(batch);
+            lock.lock();
+
+            // 只有暂时性失败才会整批放回；坏行在 writeBatch 里已经丢弃
+            if (!ok) {
+                pendingWrites.insert(pendingWrites.begin(), batch.begin(), batch.end());
+            }
+            continue;
+        }
+
+        auto wakeAt = deadlines.empty() ? now + std::chrono::hours(1) : deadlines.top().when;
+        if (!pendingWrites.empty()) {
+            wakeAt = std::min(wakeAt, lastFlush + flushInterval);
+        }
+        wakeup.wait_until(lock, wakeAt);
+    }
+}
+
+std::chrono::seconds PomodoroEngine::phaseLength(const Session& session, PomodoroPhase phase) const {
+    switch (phase) {
+        case PomodoroPhase::Work: return session.durations.work;
+        case PomodoroPhase::ShortBreak: return session.durations.shortBreak;
+        case PomodoroPhase::LongBreak: return session.durations.longBreak;
+    }
+    return session.durations.work;
+}
+
+void PomodoroEngine::scheduleLocked(Session& session) {
+    session.generation++;
+    deadlines.push(Deadline{session.deadline, session.id, session.generation});
+}
+
+void PomodoroEngine::beginPhaseLocked(Session& session, PomodoroPhase phase) {
+    auto now = Clock::now();
+    session.phase = phase;
+    session.state = PomodoroState::Running;
+    session.phaseStart = now;
+    session.deadline = now + phaseLength(session, phase);
+    session.remaining = Clock::duration::zero();
+    session.phaseStartTime = currentTimestamp();
+    scheduleLocked(session);
+}
+
+void PomodoroEngine::onDeadlineLocked(Session& session, Clock::time_point /*now*/) {
+    recordLocked(session, true, false, "");
+
+    if (session.phase != PomodoroPhase::Work) {
+        session.state = PomodoroState::Finished;
+        return;
+    }
+
+    session.completedCycles++;
+    completedWorkByUser[session.userId]++;
+    completions.push_back(pendingWrites.back());
+
+    if (!session.durations.autoStartBreak) {
+        session.state = PomodoroState::Finished;
+        return;
+    }
+
+    int every = session.durations.longBreakEvery > 0 ? session.durations.longBreakEvery : 4;
+    beginPhaseLocked(session, session.completedCycles % every == 0
+                                  ? PomodoroPhase::LongBreak
+                                  : PomodoroPhase::ShortBreak);
+}
+
+void PomodoroEngine::recordLocked(const Session& session, bool completed, bool interrupted,
+                                  const std::string& reason) {
+    PomodoroRecord record;
+    record.sessionId = session.id;
+    record.userId = session.userId;
+    record.taskId = session.taskId;
+    record.phase = session.phase;
+    record.completed = completed;
+    record.interrupted = interrupted;
+    record.reason = reason;
+    record.startTime = session.phaseStartTime;
+    record.endTime = currentTimestamp();
+
+    // 完成的阶段记计划时长，中断的阶段记实际已进行的时长
+    auto length = phaseLength(session, session.phase);
+    Clock::duration elapsed = length;
+    if (!completed) {
+        Clock::duration left = session.state == PomodoroState::Paused
+                                   ? session.remaining
+                                   : session.deadline - Clock::now();
+        elapsed = length - left;
+    }
+    record.durationMinutes = static_cast<int>(
+        (std::chrono::duration_cast<std::chrono::seconds>(elapsed).count() + 30) / 60);
+
+    pendingWrites.push_back(std::move(record));
+}
+
+// === 会话控制 ===
+
+int PomodoroEngine::startSession(int userId, int taskId, PomodoroPhase phase) {
+    PomodoroDurations durations;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        durations = defaultDurations;
+    }
+    return startSession(userId, taskId, phase, durations);
+}
+
+int PomodoroEngine::startSession(int userId, int taskId, PomodoroPhase phase,
+                                 const PomodoroDurations& durations) {
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        id = nextSessionId++;
+
+        Session& session = sessions[id];
+        session.id = id;
+        session.userId = userId;
+        session.taskId = taskId;
+        session.durations = durations;
+        beginPhaseLocked(session, phase);
+    }
+    wakeup.notify_all();
+    return id;
+}
+
+bool PomodoroEngine::pause(int sessionId) {
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    auto it = sessions.find(sessionId);
+    if (it == sessions.end() || it->second.state != PomodoroState::Running) return false;
+
+    Session& session = it->second;
+    session.remaining = session.deadline - Clock::now();
+    session.state = PomodoroState::Paused;
+    session.generation++;  // 堆里的截止时间作废
+    return true;
+}
+
+bool PomodoroEngine::resume(int sessionId) {
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+
+        auto it = sessions.find(sessionId);
+        if (it == sessions.end() || it->second.state != PomodoroState::Paused) return false;
+
+        Session& session = it->second;
+        session.deadline = Clock::now() + session.remaining;
+        session.remaining = Clock::duration::zero();
+        session.state = PomodoroState::Running;
+        scheduleLocked(session);
+    }
+    wakeup.notify_all();
+    return true;
+}
+
+bool PomodoroEngine::interrupt(int sessionId, const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+
+        auto it = sessions.find(sessionId);
+        if (it == sessions.end()) return false;
+
+        recordLocked(it->second, false, true, reason);
+        sessions.erase(it);
+    }
+    wakeup.notify_all();
+    return true;
+}
+
+// === 查询 ===
+
+PomodoroSessionInfo PomodoroEngine::toInfo(const Session& session, Clock::time_point now) const {
+    PomodoroSessionInfo info;
+    info.id = session.id;
+    info.userId = session.userId;
+    info.taskId = session.taskId;
+    info.phase = session.phase;
+    info.state = session.state;
+    info.completedCycles = session.completedCycles;
+
+    Clock::duration left = session.state == PomodoroState::Paused
+                               ? session.remaining
+                               : session.deadline - now;
+    if (left < Clock::duration::zero()) left = Clock::duration::zero();
+    info.remaining = std::chrono::ceil<std::chrono::seconds>(left);
+    return info;
+}
+
+bool PomodoroEngine::getSession(int sessionId, PomodoroSessionInfo& info) const {
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    auto it = sessions.find(sessionId);
+    if (it == sessions.end()) return false;
+
+    info = toInfo(it->second, Clock::now());
+    return true;
+}
+
+std::vector<PomodoroSessionInfo> PomodoroEngine::listSessions(int userId) const {
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    std::vector<PomodoroSessionInfo> result;
+    auto now = Clock::now();
+    for (const auto& entry : sessions) {
+        if (entry.second.userId == userId) {
+            result.push_back(toInfo(entry.second, now));
+        }
+    }
+    return result;
+}
+
+size_t PomodoroEngine::activeSessionCount() const {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    return sessions.size();
+}
+
+int PomodoroEngine::getCompletedWorkCount(int userId) const {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    auto it = completedWorkByUser.find(userId);
+    return it == completedWorkByUser.end() ? 0 : it->second;
+}
+
+std::vector<PomodoroRecord> PomodoroEngine::drainCompletions() {
+    std::lock_guard<std::mutex> lock(engineMutex);
+    std::vector<PomodoroRecord> drained;
+    drained.swap(completions);
+    return drained;
+}
+
+// === 持久化 ===
+
+bool PomodoroEngine::flush() {
+    std::vector<PomodoroRecord> batch;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        batch.swap(pendingWrites);
+        lastFlush = Clock::now();
+    }
+    if (batch.empty()) return true;
+
+    if (writeBatch(batch)) return true;
+
+    std::lock_guard<std::mutex> lock(engineMutex);
+    pendingWrites.insert(pendingWrites.begin(), batch.begin(), batch.end());
+    return false;
+}
+
+bool PomodoroEngine::openWriterLocked(const std::string& dbPath) {
+    if (writer && writerPath == dbPath) return true;
+    if (writer) {
+        ChangeFeed::getInstance().detach(writer);
+        sqlite3_close(writer);
+        writer = nullptr;
+    }
+
+    if (sqlite3_open_v2(dbPath.c_str(), &writer, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX,
+                        nullptr) != SQLITE_OK) {
+        std::cerr << "❌ 番茄钟无法打开数据库: " << sqlite3_errmsg(writer) << std::endl;
+        sqlite3_close(writer);
+        writer = nullptr;
+        return false;
+    }
+    // 与共享连接一样等待写锁；提交照常发布到 ChangeFeed
+    sqlite3_busy_timeout(writer, 5000);
+    sqlite3_exec(writer, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
+    ChangeFeed::getInstance().attach(writer);
+    writerPath = dbPath;
+    return true;
+}
+
+void PomodoroEngine::closeWriter() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (!writer) return;
+    ChangeFeed::getInstance().detach(writer);
+    sqlite3_close(writer);
+    writer = nullptr;
+    writerPath.clear();
+}
+
+bool PomodoroEngine::writeBatch(const std::vector<PomodoroRecord>& batch) {
+    TRACE_SCOPE("pomodoro", "PomodoroEngine::writeBatch");
+    auto& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) return false;
+
+    // 循环线程和 flush() 可能同时写，专用连接一次只给一批用
+    std::lock_guard<std::mutex> writerLock(writerMutex);
+    if (!openWriterLocked(dbManager.getDatabasePath())) return false;
+    sqlite3* db = writer;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "❌ 番茄钟记录写入失败: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    // 任务可能已被归档硬删除：子查询查不到时 task_id 写成 NULL，不触发外键错误
+    const char* insertSql =
+        "INSERT INTO pomodoro_sessions (task_id, user_id, session_type, start_time, end_time, "
+        "duration, completed, interrupted, interruption_reason) "
+        "VALUES ((SELECT id FROM tasks WHERE id = ?), ?, ?, ?, ?, ?, ?, ?, ?);";
+
+    std::map<std::pair<int, int>, int> perTask;  // (user_id, task_id) -> 完成的工作番茄数
+    std::map<int, int> perUser;
+
+    // 每行一个 SAVEPOINT：写不进去的单行记录后丢弃，不拖住整批
+    bool ok = sqlite3_prepare_v2(db, insertSql, -1, &stmt, nullptr) == SQLITE_OK;
+    if (ok) {
+        for (const auto& record : batch) {
+            if (record.taskId > 0) {
+                sqlite3_bind_int(stmt, 1, record.taskId);
+            } else {
+                sqlite3_bind_null(stmt, 1);
+            }
+            sqlite3_bind_int(stmt, 2, record.userId);
+            sqlite3_bind_text(stmt, 3, phaseName(record.phase).c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 4, record.startTime.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 5, record.endTime.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 6, record.durationMinutes);
+            sqlite3_bind_int(stmt, 7, record.completed ? 1 : 0);
+            sqlite3_bind_int(stmt, 8, record.interrupted ? 1 : 0);
+            sqlite3_bind_text(stmt, 9, record.reason.c_str(), -1, SQLITE_TRANSIENT);
+
+            sqlite3_exec(db, "SAVEPOINT pomodoro_row;", nullptr, nullptr, nullptr);
+            int rc = sqlite3_step(stmt);
+            if (rc != SQLITE_DONE) {
+                if (isTransientError(rc)) {
+                    ok = false;
+                    break;
+                }
+                std::cerr << "❌ 番茄钟记录 #" << record.sessionId << " 写入失败，已丢弃: "
+                          << sqlite3_errmsg(db) << std::endl;
+                sqlite3_reset(stmt);
+                sqlite3_exec(db, "ROLLBACK TO pomodoro_row;", nullptr, nullptr, nullptr);
+                sqlite3_exec(db, "RELEASE pomodoro_row;", nullptr, nullptr, nullptr);
+                continue;
+            }
+            sqlite3_reset(stmt);
+            sqlite3_exec(db, "RELEASE pomodoro_row;", nullptr, nullptr, nullptr);
+
+            if (record.completed && record.phase == PomodoroPhase::Work) {
+                perUser[record.userId]++;
+                if (record.taskId > 0) {
+                    perTask[{record.userId, record.taskId}]++;
+                }
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // 同一任务/用户的多个番茄合并成一条 UPDATE
+    const char* taskSql = "UPDATE tasks SET pomodoro_count = pomodoro_count + ?, "
+                          "updated_date = datetime('now') WHERE id = ? AND user_id = ?;";
+    if (ok && !perTask.empty() && sqlite3_prepare_v2(db, taskSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& entry : perTask) {
+            sqlite3_bind_int(stmt, 1, entry.second);
+            sqlite3_bind_int(stmt, 2, entry.first.second);
+            sqlite3_bind_int(stmt, 3, entry.first.first);
+            ok = stepCounter(db, stmt);
+            sqlite3_reset(stmt);
+            if (!ok) break;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    const char* userSql = "UPDATE user_stats SET total_pomodoros = total_pomodoros + ?, "
+                          "updated_date = datetime('now') WHERE user_id = ?;";
+    if (ok && !perUser.empty() && sqlite3_prepare_v2(db, userSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        for (const auto& entry : perUser) {
+            sqlite3_bind_int(stmt, 1, entry.second);
+            sqlite3_bind_int(stmt, 2, entry.first);
+            ok = stepCounter(db, stmt);
+            sqlite3_reset(stmt);
+            if (!ok) break;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    if (!ok) {
+        std::cerr << "❌ 番茄钟记录写入失败: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "❌ 番茄钟记录提交失败: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
@@ -1,30 +1,64 @@
 #include "Pomodoro/pomodoro.h"
 #include <iostream>
-#include <thread>
-#include <chrono>
 
-Pomodoro::Pomodoro(int work, int brk, int longBrk)
-    : workDuration(work), breakDuration(brk), longBreakDuration(longBrk), cycleCount(0) {}
+Pomodoro::Pomodoro(int work, int brk, int longBrk, int userId)
+    : workDuration(work), breakDuration(brk), longBreakDuration(longBrk),
+      userId(userId), currentSessionId(0) {}
 
-void Pomodoro::startWork() {
+PomodoroDurations Pomodoro::durations() const {
+    PomodoroDurations config;
+    config.work = std::chrono::minutes(workDuration);
+    config.shortBreak = std::chrono::minutes(breakDuration);
+    config.longBreak = std::chrono::minutes(longBreakDuration);
+    return config;
+}
+
+int Pomodoro::startPhase(PomodoroPhase phase, int taskId) {
+    PomodoroEngine& engine = PomodoroEngine::getInstance();
+    engine.start();
+
+    // 同一句柄同时只跟踪一个会话
+    if (currentSessionId != 0) {
+        engine.interrupt(currentSessionId, "开始新的番茄钟");
+    }
+    currentSessionId = engine.startSession(userId, taskId, phase, durations());
+    return currentSessionId;
+}
+
+int Pomodoro::startWork(int taskId) {
     std::cout << "Work session started for " << workDuration << " minutes." << std::endl;
-    std::this_thread::sleep_for(std::chrono::minutes(workDuration));
-    cycleCount++;
-    std::cout << "Work session completed!" << std::endl;
+    return startPhase(PomodoroPhase::Work, taskId);
 }
 
-void Pomodoro::startBreak() {
+int Pomodoro::startBreak() {
     std::cout << "Break started for " << breakDuration << " minutes." << std::endl;
-    std::this_thread::sleep_for(std::chrono::minutes(breakDuration));
-    std::cout << "Break finished!" << std::endl;
+    return startPhase(PomodoroPhase::ShortBreak, 0);
 }
 
-void Pomodoro::startLongBreak() {
+int Pomodoro::startLongBreak() {
     std::cout << "Long break started for " << longBreakDuration << " minutes." << std::endl;
-    std::this_thread::sleep_for(std::chrono::minutes(longBreakDuration));
-    std::cout << "Long break finished!" << std::endl;
+    return startPhase(PomodoroPhase::LongBreak, 0);
+}
+
+bool Pomodoro::pause() {
+    return currentSessionId != 0 && PomodoroEngine::getInstance().pause(currentSessionId);
+}
+
+bool Pomodoro::resume() {
+    return currentSessionId != 0 && PomodoroEngine::getInstance().resume(currentSessionId);
+}
+
+bool Pomodoro::interrupt(const std::string& reason) {
+    if (currentSessionId == 0) return false;
+    bool ok = PomodoroEngine::getInstance().interrupt(currentSessionId, reason);
+    currentSessionId = 0;
+    return ok;
+}
+
+int Pomodoro::getCurrentSessionId() const {
+    return currentSessionId;
 }
 
 int Pomodoro::getCycleCount() const {
-    return cycleCount;
+    return PomodoroEngine::getInstance().getCompletedWorkCount(userId);
 }
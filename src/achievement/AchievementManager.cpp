@@ -10,7 +10,7 @@
 // 构造函数接收 AchievementDAO 和用户ID
 AchievementManager::AchievementManager(std::unique_ptr<AchievementDAO> dao, int userId)
     : achievementDAO(std::move(dao)),
-      statisticsAnalyzer(std::make_unique<StatisticsAnalyzer>()),
+      statisticsAnalyzer(std::make_unique<StatisticsAnalyzer>(userId)),
       currentUserId(userId) {
     initialize();
 }
@@ -443,7 +443,7 @@ int AchievementManager::getDailyTaskCount(const std::string& date) const {
         return 0;
     }
 
-    const auto& dbManager = DatabaseManager::getInstance();
+    auto& dbManager = DatabaseManager::getInstance();
     if (!dbManager.isOpen()) {
         std::cerr << "数据库未打开，无法统计指定日期任务\n";
         return 0;
@@ -452,11 +452,12 @@ int AchievementManager::getDailyTaskCount(const std::string& date) const {
     sqlite3* db = dbManager.getRawConnection();
     sqlite3_stmt* stmt = nullptr;
     const std::string sql =
-        "SELECT COUNT(*) FROM tasks WHERE completed = 1 AND DATE(completed_date) = ?;";
+        "SELECT SUM(task_count) FROM task_history WHERE user_id = ? AND completed = 1 AND completed_day = ?;";
 
     int count = 0;
     if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-        sqlite3_bind_text(stmt, 1, date.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 1, currentUserId);
+        sqlite3_bind_text(stmt, 2, date.c_str(), -1, SQLITE_TRANSIENT);
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             count = sqlite3_column_int(stmt, 0);
         }
@@ -475,6 +476,9 @@ int AchievementManager::getTotalPomodoroCount() const {
 
 void AchievementManager::setCurrentUserId(int userId) {
     currentUserId = userId;
+    if (statisticsAnalyzer) {
+        statisticsAnalyzer->setCurrentUserId(userId);
+    }
     // 切换用户时重新加载成就
     loadUserAchievements();
 }
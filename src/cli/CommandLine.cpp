@@ -0,0 +1,902 @@
+#include "cli/CommandLine.h"
+#include "database/DatabaseManager.h"
+#include "database/MaintenanceScheduler.h"
+#include "database/DAO/TaskDAO.h"
+#include "database/QueryPlanChecker.h"
+#include "database/TaskArchiver.h"
+#include "database/ChangeNotifier.h"
+#include "rpc/RpcServer.h"
+#include "task/TaskManager.h"
+#include "gamification/XPSystem.h"
+#include "gamification/XPLedger.h"
+#include "statistics/StatisticsAnalyzer.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <csignal>
+#include <pthread.h>
+
+namespace {
+
+enum ExitCode { EXIT_OK = 0, EXIT_FAILED = 1, EXIT_USAGE = 2 };
+
+bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+std::string csvEscape(const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) return field;
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// 读取一条 CSV 记录；带引号的字段可以跨行
+bool readCsvRecord(std::istream& in, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string line;
+    if (!std::getline(in, line)) return false;
+
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0;; ++i) {
+        if (i == line.size()) {
+            if (quoted && std::getline(in, line)) {
+                field += '\n';
+                i = static_cast<size_t>(-1);
+                continue;
+            }
+            break;
+        }
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return true;
+}
+
+// "-" 表示标准输入/输出
+std::istream* openInput(const std::string& path, std::ifstream& file) {
+    if (path == "-") return &std::cin;
+    file.open(path);
+    if (!file) {
+        std::cerr << "无法打开文件: " << path << std::endl;
+        return nullptr;
+    }
+    return &file;
+}
+
+} // namespace
+
+CommandLine::CommandLine() : userId(DatabaseManager::DEFAULT_USER_ID) {}
+
+CommandLine::~CommandLine() {
+    shutdown();
+}
+
+std::vector<std::string> CommandLine::tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool inToken = false;
+    char quote = '\0';
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quote) {
+            if (c == quote) {
+                quote = '\0';
+            } else if (c == '\\' && quote == '"' && i + 1 < line.size()) {
+                current += line[++i];
+            } else {
+                current += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            inToken = true;
+        } else if (c == '\\' && i + 1 < line.size()) {
+            current += line[++i];
+            inToken = true;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (inToken) {
+                tokens.push_back(current);
+                current.clear();
+                inToken = false;
+            }
+        } else if (c == '#' && !inToken) {
+            break;  // 行尾注释
+        } else {
+            current += c;
+            inToken = true;
+        }
+    }
+    if (inToken) tokens.push_back(current);
+    return tokens;
+}
+
+int CommandLine::run(int argc, char* argv[]) {
+    out = std::make_unique<std::ostream>(std::cout.rdbuf());
+
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (!args.empty()) {
+            args.push_back(arg);
+        } else if (arg == "--verbose" || arg == "-v") {
+            verbose = true;
+        } else if (arg == "--db" || arg == "--user") {
+            if (i + 1 >= argc) {
+                std::cerr << "参数缺少取值: " << arg << std::endl;
+                return EXIT_USAGE;
+            }
+            std::string value = argv[++i];
+            if (arg == "--db") {
+                dbPath = value;
+            } else if (!parseInt(value, userId) || userId <= 0) {
+                std::cerr << "无效的用户ID: " << value << std::endl;
+                return EXIT_USAGE;
+            }
+        } else if (arg.rfind("--", 0) == 0 && arg != "--help") {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return EXIT_USAGE;
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (!verbose) {
+        savedCoutBuffer = std::cout.rdbuf(&nullBuffer);
+    }
+
+    int code = dispatch(args);
+    shutdown();
+    return code;
+}
+
+bool CommandLine::openDatabase() {
+    if (db) return true;
+
+    DatabaseManager& manager = DatabaseManager::getInstance();
+    if (!manager.isOpen() && !manager.initialize(dbPath)) {
+        std::cerr << "无法打开数据库: " << dbPath << std::endl;
+        return false;
+    }
+    if (!manager.ensureUser(userId)) {
+        std::cerr << "无法创建用户: " << userId << std::endl;
+        return false;
+    }
+    db = &manager;
+
+    // 一次性命令只发送：本次的提交通知正在运行的界面进程；
+    // 守护进程常驻并持有缓存，也要接收其他进程的提交
+    const char* notify = std::getenv("TASK_MANAGER_NOTIFY");
+    if (!notify || std::strcmp(notify, "0") != 0) {
+        ChangeNotifierOptions notifyOptions;
+        notifyOptions.receive = serving;
+        ChangeNotifier::getInstance().start(dbPath, notifyOptions);
+    }
+
+    taskDao = std::make_unique<TaskDAOImpl>(dbPath, userId);
+    taskManager = std::make_unique<TaskManager>(taskDao.get());
+    xpSystem = std::make_unique<XPSystem>(userId);
+    return true;
+}
+
+void CommandLine::shutdown() {
+    if (db) {
+        if (db->isInTransaction()) {
+            db->rollbackTransaction();
+        }
+        xpSystem.reset();
+        taskManager.reset();
+        taskDao.reset();
+        XPLedger::destroyInstance();
+        ChangeNotifier::destroyInstance();
+        DatabaseManager::destroyInstance();
+        db = nullptr;
+    }
+    if (savedCoutBuffer) {
+        std::cout.rdbuf(savedCoutBuffer);
+        savedCoutBuffer = nullptr;
+    }
+}
+
+bool CommandLine::beginWork() {
+    // 用 SAVEPOINT 而不是 BEGIN：单独执行时它就是一个事务，在 batch 里则只回滚本条命令
+    return db->execute("SAVEPOINT cli_command;");
+}
+
+bool CommandLine::finishWork(bool commit) {
+    if (!commit) {
+        taskManager->reloadDependencies();  // 内存中的依赖图可能含有被撤销的修改
+        taskManager->reloadSchedule();
+        taskManager->reloadTags();
+        if (!db->execute("ROLLBACK TO cli_command;")) return false;
+    }
+    return db->execute("RELEASE cli_command;");
+}
+
+int CommandLine::dispatch(const std::vector<std::string>& args) {
+    if (args.empty() || args[0] == "help" || args[0] == "--help") {
+        printUsage(*out);
+        return args.empty() ? EXIT_USAGE : EXIT_OK;
+    }
+
+    const std::string& command = args[0];
+    TRACE_SCOPE_DETAIL("cli", "CommandLine::dispatch", command);
+
+    if (command == "add") return cmdAdd(args);
+    if (command == "complete") return cmdComplete(args);
+    if (command == "delete") return cmdDelete(args);
+    if (command == "list") return cmdList(args);
+    if (command == "report") return cmdReport(args);
+    if (command == "import") return cmdImport(args);
+    if (command == "export") return cmdExport(args);
+    if (command == "batch") return cmdBatch(args);
+    if (command == "backup") return cmdBackup(args);
+    if (command == "restore") return cmdRestore(args);
+    if (command == "maintain") return cmdMaintain(args);
+    if (command == "depend") return cmdDepend(args);
+    if (command == "ready") return cmdReady(args);
+    if (command == "critical-path") return cmdCriticalPath(args);
+    if (command == "next") return cmdNext(args);
+    if (command == "tag") return cmdTag(args);
+    if (command == "tagged") return cmdTagged(args);
+    if (command == "check-plans") return cmdCheckPlans(args);
+    if (command == "serve") return cmdServe(args);
+
+    std::cerr << "未知命令: " << command << "（task_manager help 查看用法）" << std::endl;
+    return EXIT_USAGE;
+}
+
+// add <名称> [--desc 描述] [--project ID]
+int CommandLine::cmdAdd(const std::vector<std::string>& args) {
+    std::string name;
+    std::string description;
+    int projectId = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if ((args[i] == "--desc" || args[i] == "--project") && i + 1 < args.size()) {
+            if (args[i] == "--desc") {
+                description = args[++i];
+            } else if (!parseInt(args[++i], projectId)) {
+                std::cerr << "无效的项目ID: " << args[i] << std::endl;
+                return EXIT_USAGE;
+            }
+        } else if (name.empty()) {
+            name = args[i];
+        } else {
+            std::cerr << "多余的参数: " << args[i] << std::endl;
+            return EXIT_USAGE;
+        }
+    }
+    if (name.empty()) {
+        std::cerr << "用法: add <名称> [--desc 描述] [--project ID]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    int id = taskManager->createTask(Task(name, description, projectId));
+    if (id <= 0) {
+        std::cerr << "创建任务失败: " << name << std::endl;
+        return EXIT_FAILED;
+    }
+    *out << id << "\n";
+    return EXIT_OK;
+}
+
+// complete <ID>...，与界面一样发放完成任务的经验值；已完成的任务不重复发放
+int CommandLine::cmdComplete(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cerr << "用法: complete <ID>..." << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    int code = EXIT_OK;
+    for (size_t i = 1; i < args.size(); ++i) {
+        int id = 0;
+        if (!parseInt(args[i], id)) {
+            std::cerr << "无效的任务ID: " << args[i] << std::endl;
+            code = EXIT_USAGE;
+            continue;
+        }
+        auto task = taskManager->getTask(id);
+        if (!task) {
+            std::cerr << "任务不存在: " << id << std::endl;
+            code = EXIT_FAILED;
+            continue;
+        }
+        if (task->isCompleted()) {
+            *out << id << " already completed\n";
+            continue;
+        }
+        // 完成状态和经验值一起提交：任何一步失败，这个任务保持未完成
+        if (!beginWork()) return EXIT_FAILED;
+        int xp = xpSystem->getXPForTaskCompletion(1);
+        bool completed = taskManager->completeTask(id);
+        bool awarded = completed && xpSystem->awardXP(userId, xp, "任务完成");
+        if (!finishWork(awarded)) return EXIT_FAILED;
+        if (!completed) {
+            std::cerr << "完成任务失败: " << id << std::endl;
+            code = EXIT_FAILED;
+            continue;
+        }
+        if (!awarded) {
+            std::cerr << "发放经验值失败，任务未完成: " << id << std::endl;
+            code = EXIT_FAILED;
+            continue;
+        }
+        *out << id << " completed +" << xp << "xp\n";
+    }
+    return code;
+}
+
+// delete <ID>...
+int CommandLine::cmdDelete(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        std::cerr << "用法: delete <ID>..." << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    int code = EXIT_OK;
+    for (size_t i = 1; i < args.size(); ++i) {
+        int id = 0;
+        if (!parseInt(args[i], id) || !taskManager->getTask(id) || !taskManager->deleteTask(id)) {
+            std::cerr << "删除任务失败: " << args[i] << std::endl;
+            code = EXIT_FAILED;
+        }
+    }
+    return code;
+}
+
+// list [--pending | --done] [--project ID] [--csv]
+int CommandLine::cmdList(const std::vector<std::string>& args) {
+    int filter = -1;  // -1 全部，0 未完成，1 已完成
+    int projectId = 0;
+    bool csv = false;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--pending") filter = 0;
+        else if (args[i] == "--done") filter = 1;
+        else if (args[i] == "--csv") csv = true;
+        else if (args[i] == "--project" && i + 1 < args.size() && parseInt(args[i + 1], projectId)) ++i;
+        else {
+            std::cerr << "用法: list [--pending | --done] [--project ID] [--csv]" << std::endl;
+            return EXIT_USAGE;
+        }
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    std::vector<Task> tasks;
+    if (projectId > 0) tasks = taskManager->getTasksByProject(projectId);
+    else if (filter >= 0) tasks = taskManager->getTasksByCompletion(filter == 1);
+    else tasks = taskManager->getAllTasks();
+
+    if (csv) *out << "id,name,description,project_id,completed\n";
+    for (const auto& task : tasks) {
+        if (filter >= 0 && task.isCompleted() != (filter == 1)) continue;
+        if (csv) {
+            *out << task.getId() << "," << csvEscape(task.getName()) << ","
+                 << csvEscape(task.getDescription()) << "," << task.getProjectId() << ","
+                 << (task.isCompleted() ? 1 : 0) << "\n";
+        } else {
+            *out << (task.isCompleted() ? "[x] " : "[ ] ") << task.getId() << "\t" << task.getName() << "\n";
+        }
+    }
+    out->flush();
+    return EXIT_OK;
+}
+
+// report [summary | daily | weekly | monthly]
+int CommandLine::cmdReport(const std::vector<std::string>& args) {
+    std::string kind = args.size() > 1 ? args[1] : "summary";
+    if (kind != "summary" && kind != "daily" && kind != "weekly" && kind != "monthly") {
+        std::cerr << "用法: report [summary | daily | weekly | monthly]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    StatisticsAnalyzer analyzer(userId);
+    if (kind == "daily") *out << analyzer.generateDailyReport();
+    else if (kind == "weekly") *out << analyzer.generateWeeklyReport();
+    else if (kind == "monthly") *out << analyzer.generateMonthlyReport();
+    else *out << analyzer.generateSummary();
+    out->flush();
+    return EXIT_OK;
+}
+
+// import <文件|->，CSV 格式与 export 相同；id 列被忽略，任务按新 ID 插入
+int CommandLine::cmdImport(const std::vector<std::string>& args) {
+    if (args.size() != 2) {
+        std::cerr << "用法: import <文件.csv | ->" << std::endl;
+        return EXIT_USAGE;
+    }
+    std::ifstream file;
+    std::istream* in = openInput(args[1], file);
+    if (!in || !openDatabase()) return EXIT_FAILED;
+
+    if (!beginWork()) return EXIT_FAILED;
+    int code = importRows(*in);
+    if (!finishWork(code == EXIT_OK)) return EXIT_FAILED;
+    return code;
+}
+
+int CommandLine::importRows(std::istream& in) {
+    std::vector<std::string> fields;
+    if (!readCsvRecord(in, fields)) return EXIT_OK;
+
+    // 按表头定位各列，列的顺序和多少都不要求
+    int nameCol = -1, descCol = -1, projectCol = -1, completedCol = -1;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i] == "name") nameCol = static_cast<int>(i);
+        else if (fields[i] == "description") descCol = static_cast<int>(i);
+        else if (fields[i] == "project_id") projectCol = static_cast<int>(i);
+        else if (fields[i] == "completed") completedCol = static_cast<int>(i);
+    }
+    if (nameCol < 0) {
+        std::cerr << "CSV 缺少 name 列" << std::endl;
+        return EXIT_FAILED;
+    }
+
+    auto column = [&](int col) -> std::string {
+        return col >= 0 && col < static_cast<int>(fields.size()) ? fields[col] : std::string();
+    };
+
+    long long imported = 0;
+    long long lineNo = 1;
+    while (readCsvRecord(in, fields)) {
+        ++lineNo;
+        if (fields.size() == 1 && fields[0].empty()) continue;
+
+        int projectId = 0;
+        parseInt(column(projectCol), projectId);
+        Task task(column(nameCol), column(descCol), projectId);
+        task.setCompleted(column(completedCol) == "1");
+
+        if (task.getName().empty() || taskManager->createTask(task) <= 0) {
+            std::cerr << "第 " << lineNo << " 行导入失败，本次导入已回滚" << std::endl;
+            return EXIT_FAILED;
+        }
+        ++imported;
+    }
+    *out << imported << " imported\n";
+    return EXIT_OK;
+}
+
+// export [文件|-]
+int CommandLine::cmdExport(const std::vector<std::string>& args) {
+    if (args.size() > 2) {
+        std::cerr << "用法: export [文件.csv | -]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (args.size() == 1 || args[1] == "-") {
+        return cmdList({"list", "--csv"});
+    }
+
+    std::ofstream file(args[1]);
+    if (!file) {
+        std::cerr << "无法写入文件: " << args[1] << std::endl;
+        return EXIT_FAILED;
+    }
+    std::unique_ptr<std::ostream> console = std::move(out);
+    out = std::make_unique<std::ostream>(file.rdbuf());
+    int code = cmdList({"list", "--csv"});
+    out = std::move(console);
+    return code;
+}
+
+// batch [--atomic] [--commit-every N] [文件|-]
+int CommandLine::cmdBatch(const std::vector<std::string>& args) {
+    if (inBatch) {
+        std::cerr << "batch 不能嵌套" << std::endl;
+        return EXIT_USAGE;
+    }
+    bool atomic = false;
+    long long commitEvery = 0;
+    std::string path = "-";
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--atomic") atomic = true;
+        else if (args[i] == "--commit-every" && i + 1 < args.size()) commitEvery = std::atoll(args[++i].c_str());
+        else path = args[i];
+    }
+    std::ifstream file;
+    std::istream* in = openInput(path, file);
+    if (!in || !openDatabase()) return EXIT_FAILED;
+
+    return runBatch(*in, atomic, atomic ? 0 : commitEvery);
+}
+
+int CommandLine::runBatch(std::istream& in, bool atomic, long long commitEvery) {
+    if (!db->beginTransaction()) return EXIT_FAILED;
+    inBatch = true;
+
+    std::string line;
+    long long lineNo = 0;
+    long long executed = 0;
+    long long failed = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        std::vector<std::string> args = tokenize(line);
+        if (args.empty()) continue;
+
+        ++executed;
+        if (dispatch(args) != EXIT_OK) {
+            ++failed;
+            std::cerr << "第 " << lineNo << " 行执行失败: " << line << std::endl;
+            if (atomic) break;
+        }
+        // 定期提交，避免超大事务让 WAL 无限增长；经验值流水随同一事务落库
+        if (commitEvery > 0 && executed % commitEvery == 0) {
+            if (!db->commitTransaction() || !db->beginTransaction()) {
+                inBatch = false;
+                return EXIT_FAILED;
+            }
+        }
+    }
+
+    inBatch = false;
+    bool commit = !(atomic && failed > 0);
+    if (!commit) {
+        taskManager->reloadDependencies();
+        taskManager->reloadSchedule();
+        taskManager->reloadTags();
+    }
+    if (!(commit ? db->commitTransaction() : db->rollbackTransaction())) return EXIT_FAILED;
+
+    std::cerr << executed << " commands, " << failed << " failed"
+              << (commit ? "" : ", rolled back") << std::endl;
+    return failed > 0 ? EXIT_FAILED : EXIT_OK;
+}
+
+int CommandLine::cmdBackup(const std::vector<std::string>& args) {
+    BackupOptions options;
+    std::string path;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--compact") {
+            options.compact = true;
+        } else if (path.empty()) {
+            path = args[i];
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "用法: backup <文件> [--compact]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (inBatch) {
+        std::cerr << "backup 不能在 batch 中使用" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    if (!db->backupDatabase(path, options)) return EXIT_FAILED;
+    *out << path << std::endl;
+    return EXIT_OK;
+}
+
+int CommandLine::cmdRestore(const std::vector<std::string>& args) {
+    if (args.size() != 2) {
+        std::cerr << "用法: restore <文件>" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (inBatch) {
+        std::cerr << "restore 不能在 batch 中使用" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    return db->restoreDatabase(args[1]) ? EXIT_OK : EXIT_FAILED;
+}
+
+int CommandLine::cmdMaintain(const std::vector<std::string>& args) {
+    bool fullVacuum = args.size() == 2 && args[1] == "--vacuum";
+    if (args.size() > 2 || (args.size() == 2 && !fullVacuum)) {
+        std::cerr << "用法: maintain [--vacuum]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (inBatch) {
+        std::cerr << "maintain 不能在 batch 中使用" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    // --vacuum：一次完整 VACUUM，同时把旧库切换为增量回收模式
+    if (fullVacuum && !db->vacuumDatabase()) return EXIT_FAILED;
+
+    // 命令行没有并发写入，给每一步更宽的预算，一次做完
+    MaintenanceOptions options;
+    options.stepBudget = std::chrono::milliseconds(5000);
+    options.vacuumPagesPerStep = 1 << 20;
+    options.vacuumMinFreePages = 1;
+    options.truncateWalBytes = 0;
+
+    MaintenanceScheduler& scheduler = MaintenanceScheduler::getInstance();
+    if (!scheduler.start(options)) return EXIT_FAILED;
+    scheduler.runNow();
+    MaintenanceScheduler::Stats stats = scheduler.getStats();
+    MaintenanceScheduler::destroyInstance();
+
+    *out << "checkpoints\t" << stats.passiveCheckpoints + stats.truncateCheckpoints << "\n"
+         << "tables_analyzed\t" << stats.tablesAnalyzed << "\n"
+         << "pages_vacuumed\t" << stats.pagesVacuumed << "\n"
+         << "tasks_archived\t" << stats.tasksArchived << "\n"
+         << "wal_bytes\t" << stats.walBytes << "\n"
+         << "skipped\t" << stats.skippedBusy + stats.interrupted << std::endl;
+    return EXIT_OK;
+}
+
+// depend <ID> <前置ID>... [--remove]
+int CommandLine::cmdDepend(const std::vector<std::string>& args) {
+    bool remove = !args.empty() && args.back() == "--remove";
+    size_t end = args.size() - (remove ? 1 : 0);
+    int taskId = 0;
+    if (end < 3 || !parseInt(args[1], taskId)) {
+        std::cerr << "用法: depend <ID> <前置ID>... [--remove]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    int code = EXIT_OK;
+    for (size_t i = 2; i < end; ++i) {
+        int dependsOn = 0;
+        if (!parseInt(args[i], dependsOn)) {
+            std::cerr << "无效的任务ID: " << args[i] << std::endl;
+            code = EXIT_USAGE;
+            continue;
+        }
+        if (remove) {
+            if (!taskManager->removeDependency(taskId, dependsOn)) code = EXIT_FAILED;
+            continue;
+        }
+        std::vector<int> cycle;
+        if (!taskManager->addDependency(taskId, dependsOn, &cycle)) {
+            if (!cycle.empty()) {
+                std::cerr << "环:";
+                for (int id : cycle) std::cerr << " " << id;
+                std::cerr << std::endl;
+            }
+            code = EXIT_FAILED;
+        }
+    }
+    return code;
+}
+
+// ready [N]
+int CommandLine::cmdReady(const std::vector<std::string>& args) {
+    int limit = 10;
+    if (args.size() > 2 || (args.size() == 2 && (!parseInt(args[1], limit) || limit <= 0))) {
+        std::cerr << "用法: ready [N]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    for (int id : taskManager->getReadyTasks(static_cast<size_t>(limit))) {
+        auto task = taskManager->getTask(id);
+        *out << id << "\t" << (task ? task->getName() : "") << "\n";
+    }
+    return EXIT_OK;
+}
+
+// critical-path <项目ID>
+int CommandLine::cmdCriticalPath(const std::vector<std::string>& args) {
+    int projectId = 0;
+    if (args.size() != 2 || !parseInt(args[1], projectId)) {
+        std::cerr << "用法: critical-path <项目ID>" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    DependencyGraph::CriticalPath path = taskManager->getCriticalPath(projectId);
+    *out << "length\t" << path.length << "\n";
+    for (int id : path.taskIds) {
+        auto task = taskManager->getTask(id);
+        *out << id << "\t" << (task ? task->getName() : "") << "\n";
+    }
+    return EXIT_OK;
+}
+
+// next [K]
+int CommandLine::cmdNext(const std::vector<std::string>& args) {
+    int k = 5;
+    if (args.size() > 2 || (args.size() == 2 && (!parseInt(args[1], k) || k <= 0))) {
+        std::cerr << "用法: next [K]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    for (const auto& entry : taskManager->nextTasks(static_cast<size_t>(k))) {
+        auto task = taskManager->getTask(entry.taskId);
+        std::ostringstream score;
+        score << std::fixed << std::setprecision(1) << entry.score;
+        *out << entry.taskId << "\t" << score.str() << "\t" << (task ? task->getName() : "") << "\n";
+    }
+    return EXIT_OK;
+}
+
+// tag <ID> [标签...] [--remove]，不给标签时输出任务当前的标签
+int CommandLine::cmdTag(const std::vector<std::string>& args) {
+    bool remove = !args.empty() && args.back() == "--remove";
+    size_t end = args.size() - (remove ? 1 : 0);
+    int taskId = 0;
+    if (end < 2 || !parseInt(args[1], taskId) || (remove && end < 3)) {
+        std::cerr << "用法: tag <ID> [标签...] [--remove]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    std::vector<std::string> tags(args.begin() + 2, args.begin() + end);
+    if (!tags.empty()) {
+        bool ok = remove ? taskManager->removeTaskTags(taskId, tags) : taskManager->addTaskTags(taskId, tags);
+        if (!ok) return EXIT_FAILED;
+    }
+    std::string joined;
+    for (const auto& tag : taskManager->getTaskTags(taskId)) {
+        if (!joined.empty()) joined += ",";
+        joined += tag;
+    }
+    *out << taskId << "\t" << joined << "\n";
+    return EXIT_OK;
+}
+
+// tagged [标签...] [--any a,b] [--not c,d] [--pending | --done] [--project ID] [--limit N]
+int CommandLine::cmdTagged(const std::vector<std::string>& args) {
+    auto split = [](const std::string& list, std::vector<std::string>& into) {
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) into.push_back(item);
+        }
+    };
+
+    TagQuery query;
+    int limit = 0;
+    int projectId = 0;
+    bool valid = true;
+    for (size_t i = 1; i < args.size() && valid; ++i) {
+        bool hasValue = i + 1 < args.size();
+        if (args[i] == "--pending") query.completed = false;
+        else if (args[i] == "--done") query.completed = true;
+        else if (args[i] == "--any" && hasValue) split(args[++i], query.any);
+        else if (args[i] == "--not" && hasValue) split(args[++i], query.none);
+        else if (args[i] == "--project" && hasValue && parseInt(args[i + 1], projectId)) query.projectId = projectId, ++i;
+        else if (args[i] == "--limit" && hasValue && parseInt(args[i + 1], limit) && limit > 0) ++i;
+        else if (args[i].rfind("--", 0) == 0) valid = false;
+        else split(args[i], query.all);
+    }
+    if (!valid) {
+        std::cerr << "用法: tagged [标签...] [--any a,b] [--not c,d] [--pending | --done] [--project ID] [--limit N]"
+                  << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    std::vector<int> ids = taskManager->findTasksByTags(query, static_cast<size_t>(limit));
+    for (const auto& task : taskManager->getTasksByIds(ids)) {
+        *out << (task.isCompleted() ? "[x] " : "[ ] ") << task.getId() << "\t" << task.getName() << "\n";
+    }
+    out->flush();
+    return EXIT_OK;
+}
+
+// check-plans [--all]
+int CommandLine::cmdCheckPlans(const std::vector<std::string>& args) {
+    bool all = args.size() == 2 && args[1] == "--all";
+    if (args.size() > 2 || (args.size() == 2 && !all)) {
+        std::cerr << "用法: check-plans [--all]" << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!openDatabase()) return EXIT_FAILED;
+
+    std::vector<PlannedQuery> queries = TaskDAOImpl::queryCatalog();
+    for (auto& query : TaskArchiver::queryCatalog()) queries.push_back(std::move(query));
+
+    QueryPlanChecker checker(db->getRawConnection());
+    bool ok = checker.checkAll(queries, *out, all);
+    out->flush();
+    return ok ? EXIT_OK : EXIT_FAILED;
+}
+
+// serve [--listen 地址] [--reminders 文件]
+int CommandLine::cmdServe(const std::vector<std::string>& args) {
+    RpcServerOptions options;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--listen" && i + 1 < args.size()) {
+            options.address = args[++i];
+        } else if (args[i] == "--reminders" && i + 1 < args.size()) {
+            options.reminderDbPath = args[++i];
+        } else {
+            std::cerr << "用法: serve [--listen 地址] [--reminders 文件]" << std::endl;
+            return EXIT_USAGE;
+        }
+    }
+    if (inBatch) {
+        std::cerr << "serve 不能在 batch 中使用" << std::endl;
+        return EXIT_USAGE;
+    }
+
+    // 在启动任何后台线程之前屏蔽 SIGINT/SIGTERM，线程继承屏蔽字，信号统一由 sigwait 取走
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    sigset_t savedMask;
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &savedMask);
+
+    serving = true;
+    bool started = openDatabase();
+    MaintenanceScheduler& maintenance = MaintenanceScheduler::getInstance();
+    if (started && !maintenance.start()) {
+        std::cerr << "后台维护不可用，继续运行" << std::endl;
+    }
+    started = started && RpcServer::getInstance().start(options);
+
+    if (started) {
+        *out << "listening\t" << options.address << std::endl;
+        int signal = 0;
+        sigwait(&stopSignals, &signal);
+    }
+
+    RpcServer::destroyInstance();
+    MaintenanceScheduler::destroyInstance();
+    pthread_sigmask(SIG_SETMASK, &savedMask, nullptr);
+    return started ? EXIT_OK : EXIT_FAILED;
+}
+
+void CommandLine::printUsage(std::ostream& os) const {
+    os << "用法: task_manager [--db FILE] [--user N] [--verbose] <命令> [参数...]\n"
+       << "不带参数启动时进入交互界面。\n\n"
+       << "命令:\n"
+       << "  add <名称> [--desc 描述] [--project ID]   创建任务，输出新任务ID\n"
+       << "  complete <ID>...                         完成任务并发放经验值\n"
+       << "  delete <ID>...                           删除任务\n"
+       << "  list [--pending|--done] [--project ID] [--csv]\n"
+       << "  report [summary|daily|weekly|monthly]    输出统计报告\n"
+       << "  import <文件.csv|->                      在一个事务中批量导入任务\n"
+       << "  export [文件.csv|-]                      导出任务为 CSV\n"
+       << "  batch [--atomic] [--commit-every N] [文件|-]\n"
+       << "                                           逐行执行命令，共用一个事务\n"
+       << "  backup <文件> [--compact]                在线备份数据库，不阻塞其他写入者\n"
+       << "  restore <文件>                           用备份覆盖当前数据库\n"
+       << "  maintain [--vacuum]                      检查点、optimize、更新过期统计、归档旧任务并回收空闲页\n"
+       << "  depend <ID> <前置ID>... [--remove]       设置任务依赖（前置任务完成后才能开始）\n"
+       << "  ready [N]                                列出前置任务均已完成的任务，按优先级排序\n"
+       << "  critical-path <项目ID>                   输出项目剩余工作的关键路径\n"
+       << "  tag <ID> [标签...] [--remove]            给任务添加/移除标签，不带标签时输出当前标签\n"
+       << "  tagged [标签...] [--any a,b] [--not c,d] [--pending|--done] [--project ID] [--limit N]\n"
+       << "                                           按标签组合查询任务（位图索引）\n"
+       << "  next [K]                                 综合优先级、截止日期和剩余番茄推荐接下来做的 K 个任务\n"
+       << "  check-plans [--all]                      检查 DAO 语句的执行计划，出现全表扫描或临时排序时失败\n"
+       << "  serve [--listen 地址] [--reminders 文件]\n"
+       << "                                           以守护进程运行，界面设置 TASK_MANAGER_SERVER=地址 后连接\n"
+       << "  help                                     显示本帮助\n";
+}
@@ -0,0 +1,246 @@
+#include "database/ChangeFeed.h"
+#include <algorithm>
+#include <cstring>
+
+std::unique_ptr<ChangeFeed> ChangeFeed::instance = nullptr;
+std::mutex ChangeFeed::instanceMutex;
+
+// =====================
+// ChangeBatch
+// =====================
+
+bool ChangeBatch::touches(const std::string& table) const {
+    return truncated ||
+           std::find(truncatedTables.begin(), truncatedTables.end(), table) != truncatedTables.end() ||
+           std::any_of(changes.begin(), changes.end(),
+                       [&](const RowChange& change) { return change.table == table; });
+}
+
+std::vector<sqlite3_int64> ChangeBatch::rowids(const std::string& table) const {
+    std::vector<sqlite3_int64> ids;
+    for (const auto& change : changes) {
+        if (change.table == table) ids.push_back(change.rowid);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+// =====================
+// ChangeFeed
+// =====================
+
+ChangeFeed& ChangeFeed::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<ChangeFeed>();
+    }
+    return *instance;
+}
+
+void ChangeFeed::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+void ChangeFeed::attach(sqlite3* db) {
+    if (!db) return;
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto& conn = connections[db];
+    if (conn) return;
+
+    conn = std::make_unique<Connection>();
+    conn->feed = this;
+    conn->db = db;
+    sqlite3_update_hook(db, &ChangeFeed::updateHook, conn.get());
+    sqlite3_commit_hook(db, &ChangeFeed::commitHook, conn.get());
+    sqlite3_rollback_hook(db, &ChangeFeed::rollbackHook, conn.get());
+    sqlite3_wal_hook(db, &ChangeFeed::walHook, conn.get());
+}
+
+void ChangeFeed::detach(sqlite3* db) {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto it = connections.find(db);
+    if (it == connections.end()) return;
+
+    sqlite3_update_hook(db, nullptr, nullptr);
+    sqlite3_commit_hook(db, nullptr, nullptr);
+    sqlite3_rollback_hook(db, nullptr, nullptr);
+    // 交还给 SQLite 自己的自动检查点
+    sqlite3_wal_autocheckpoint(db, it->second->autocheckpointPages);
+    connections.erase(it);
+}
+
+void ChangeFeed::setAutocheckpoint(sqlite3* db, int pages) {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    auto it = connections.find(db);
+    if (it != connections.end()) {
+        it->second->autocheckpointPages = pages;
+    } else if (db) {
+        sqlite3_wal_autocheckpoint(db, pages);
+    }
+}
+
+int ChangeFeed::subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    int id = nextListenerId++;
+    listeners.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void ChangeFeed::unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                   [id](const auto& entry) { return entry.first == id; }),
+                    listeners.end());
+}
+
+void ChangeFeed::notifyAllChanged() {
+    ChangeBatch batch;
+    batch.truncated = true;
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    for (const auto& [id, listener] : listeners) {
+        listener(batch);
+    }
+}
+
+void ChangeFeed::publishRemote(ChangeBatch batch) {
+    batch.remote = true;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.remoteBatches++;
+    }
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    for (const auto& [id, listener] : listeners) {
+        listener(batch);
+    }
+}
+
+ChangeFeed::Stats ChangeFeed::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void ChangeFeed::updateHook(void* self, int op, const char* dbName, const char* table, sqlite3_int64 rowid) {
+    // 临时表（如归档用的 archive_batch）和 ATTACH 的库不对外发布
+    if (std::strcmp(dbName, "main") != 0) return;
+
+    auto* conn = static_cast<Connection*>(self);
+    RowChange change;
+    change.op = op == SQLITE_INSERT ? ChangeOp::Insert
+              : op == SQLITE_DELETE ? ChangeOp::Delete
+              : ChangeOp::Update;
+    change.table = table;
+    change.rowid = rowid;
+    conn->pending.push_back(std::move(change));
+}
+
+int ChangeFeed::commitHook(void* self) {
+    // 此刻还没真正提交，也不能使用连接；先移到已提交列表，等 wal_hook 再发布
+    auto* conn = static_cast<Connection*>(self);
+    if (conn->committed.empty()) {
+        conn->committed.swap(conn->pending);
+    } else {
+        conn->committed.insert(conn->committed.end(),
+                               std::make_move_iterator(conn->pending.begin()),
+                               std::make_move_iterator(conn->pending.end()));
+        conn->pending.clear();
+    }
+    return 0;
+}
+
+void ChangeFeed::rollbackHook(void* self) {
+    auto* conn = static_cast<Connection*>(self);
+    if (conn->pending.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(conn->feed->statsMutex);
+        conn->feed->stats.rolledBack += conn->pending.size();
+    }
+    conn->pending.clear();
+}
+
+int ChangeFeed::walHook(void* self, sqlite3* db, const char* dbName, int frames) {
+    auto* conn = static_cast<Connection*>(self);
+    conn->feed->publish(*conn);
+
+    // 与 SQLite 默认的 wal_hook 相同：WAL 帧数达到阈值时做一次 PASSIVE 检查点
+    if (conn->autocheckpointPages > 0 && frames >= conn->autocheckpointPages) {
+        sqlite3_wal_checkpoint(db, dbName);
+    }
+    return SQLITE_OK;
+}
+
+void ChangeFeed::publish(Connection& conn) {
+    if (conn.committed.empty()) return;
+
+    ChangeBatch batch;
+    batch.changes.swap(conn.committed);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.batches++;
+        stats.rows += batch.changes.size();
+    }
+
+    // 持锁回调：unsubscribe() 返回后不会再有回调落到已析构的订阅者上
+    std::lock_guard<std::mutex> lock(listenersMutex);
+    for (const auto& [id, listener] : listeners) {
+        listener(batch);
+    }
+}
+
+// =====================
+// ChangeSubscription
+// =====================
+
+ChangeSubscription::ChangeSubscription(std::vector<std::string> watched)
+    : tables(std::move(watched)) {
+    id = ChangeFeed::getInstance().subscribe([this](const ChangeBatch& batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto watched = [this](const std::string& table) {
+            return std::find(tables.begin(), tables.end(), table) != tables.end();
+        };
+        if (collected.truncated) return;
+        if (!batch.remote && std::this_thread::get_id() == mutedThread) return;
+        if (batch.truncated || std::any_of(batch.truncatedTables.begin(), batch.truncatedTables.end(), watched)) {
+            collected.changes.clear();
+            collected.truncated = true;
+            return;
+        }
+        for (const auto& change : batch.changes) {
+            if (!watched(change.table)) continue;
+            if (collected.changes.size() >= MAX_PENDING) {
+                collected.changes.clear();
+                collected.truncated = true;
+                return;
+            }
+            collected.changes.push_back(change);
+        }
+    });
+}
+
+ChangeSubscription::~ChangeSubscription() {
+    ChangeFeed::getInstance().unsubscribe(id);
+}
+
+bool ChangeSubscription::hasChanges() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return collected.truncated || !collected.changes.empty();
+}
+
+ChangeBatch ChangeSubscription::take() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ChangeBatch batch;
+    std::swap(batch, collected);
+    return batch;
+}
+
+ChangeSubscription::Mute::Mute(ChangeSubscription& subscription) : subscription(subscription) {
+    std::lock_guard<std::mutex> lock(subscription.mutex);
+    previous = subscription.mutedThread;
+    subscription.mutedThread = std::this_thread::get_id();
+}
+
+ChangeSubscription::Mute::~Mute() {
+    std::lock_guard<std::mutex> lock(subscription.mutex);
+    subscription.mutedThread = previous;
+}
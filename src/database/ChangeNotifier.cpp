@@ -0,0 +1,400 @@
+#include "database/ChangeNotifier.h"
+#include "metrics/Metrics.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+std::unique_ptr<ChangeNotifier> ChangeNotifier::instance = nullptr;
+std::mutex ChangeNotifier::instanceMutex;
+
+namespace {
+    const char* MAGIC = "TMCF1";
+    const char* SOCKET_SUFFIX = ".sock";
+    const int RECEIVE_BUFFER_BYTES = 1024 * 1024;
+
+    bool endsWith(const std::string& value, const std::string& suffix) {
+        return value.size() >= suffix.size() &&
+               value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+ChangeNotifier& ChangeNotifier::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<ChangeNotifier>();
+    }
+    return *instance;
+}
+
+void ChangeNotifier::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+ChangeNotifier::~ChangeNotifier() {
+    stop();
+}
+
+bool ChangeNotifier::start(const std::string& dbPath, const ChangeNotifierOptions& opts) {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (running) return true;
+
+    options = opts;
+    dirPath = dbPath + "-notify";
+    if (mkdir(dirPath.c_str(), 0700) < 0 && errno != EEXIST) {
+        std::cerr << "ChangeNotifier: 无法创建通知目录 " << dirPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sockFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (sockFd < 0) {
+        std::cerr << "ChangeNotifier: 创建套接字失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    auto fail = [this]() {
+        if (versionConn) sqlite3_close(versionConn);
+        versionConn = nullptr;
+        if (!socketPath.empty()) unlink(socketPath.c_str());
+        socketPath.clear();
+        close(sockFd);
+        sockFd = -1;
+        return false;
+    };
+
+    if (options.receive) {
+        sockaddr_un addr{};
+        std::string path = dirPath + "/" + std::to_string(getpid()) + SOCKET_SUFFIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "ChangeNotifier: 套接字路径过长: " << path << std::endl;
+            return fail();
+        }
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());  // 同一 pid 上次异常退出留下的文件
+        if (bind(sockFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::cerr << "ChangeNotifier: 绑定 " << path << " 失败: " << std::strerror(errno) << std::endl;
+            return fail();
+        }
+        socketPath = path;
+        setsockopt(sockFd, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER_BYTES, sizeof(RECEIVE_BUFFER_BYTES));
+
+        if (sqlite3_open_v2(dbPath.c_str(), &versionConn, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+            std::cerr << "ChangeNotifier: 无法打开数据库: " << sqlite3_errmsg(versionConn) << std::endl;
+            return fail();
+        }
+        // 非阻塞：提交线程写入唤醒字节时不能被卡住
+        if (pipe2(wakePipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+            std::cerr << "ChangeNotifier: 创建唤醒管道失败: " << std::strerror(errno) << std::endl;
+            return fail();
+        }
+        syncDataVersion();
+    }
+
+    scanPeers();
+    listenerId = ChangeFeed::getInstance().subscribe([this](const ChangeBatch& batch) {
+        // 收到的通知不再转发，否则两个进程之间会来回反弹
+        if (batch.remote) return;
+        activity++;
+        broadcast(encode(batch));
+        // 让接收线程尽快重新取 data_version 基线
+        if (wakePipe[1] >= 0) {
+            char byte = 1;
+            if (write(wakePipe[1], &byte, 1) < 0) {
+                // 管道已满：接收线程本来就有待处理的唤醒
+            }
+        }
+    });
+
+    MetricsRegistry::getInstance().addCollector("change_notifier", [this](std::ostream& out) {
+        Stats s = getStats();
+        const char* messages = "taskmgr_change_notifications_total";
+        MetricsRegistry::writeHeader(out, messages, "Cross-process change notifications", "counter");
+        MetricsRegistry::writeSample(out, messages, "direction=\"sent\"", static_cast<double>(s.sent));
+        MetricsRegistry::writeSample(out, messages, "direction=\"received\"", static_cast<double>(s.received));
+        MetricsRegistry::writeSample(out, messages, "direction=\"dropped\"", static_cast<double>(s.dropped));
+        MetricsRegistry::writeHeader(out, "taskmgr_change_notifier_fallback_total",
+                                     "Unexplained data_version changes that invalidated every cache", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_change_notifier_fallback_total", "",
+                                     static_cast<double>(s.fallbackInvalidations));
+        MetricsRegistry::writeHeader(out, "taskmgr_change_notifier_peers",
+                                     "Other processes receiving notifications for this database", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_change_notifier_peers", "", static_cast<double>(s.peers));
+    });
+
+    running = true;
+    if (options.receive) {
+        receiver = std::thread(&ChangeNotifier::run, this);
+        std::string hello = std::string(MAGIC) + "\nH\n";
+        broadcast(hello);
+    }
+    return true;
+}
+
+void ChangeNotifier::stop() {
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (!running) return;
+
+    // 先退订：unsubscribe() 返回后提交线程不会再用到套接字
+    ChangeFeed::getInstance().unsubscribe(listenerId);
+    listenerId = 0;
+    running = false;
+
+    if (receiver.joinable()) {
+        char byte = 1;
+        if (write(wakePipe[1], &byte, 1) < 0) {
+            shutdown(sockFd, SHUT_RDWR);
+        }
+        receiver.join();
+    }
+    if (wakePipe[0] >= 0) {
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+        wakePipe[0] = wakePipe[1] = -1;
+    }
+    close(sockFd);
+    sockFd = -1;
+    if (!socketPath.empty()) {
+        unlink(socketPath.c_str());
+        socketPath.clear();
+    }
+    if (versionConn) {
+        sqlite3_close(versionConn);
+        versionConn = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> peersLock(peersMutex);
+        peers.clear();
+    }
+    MetricsRegistry::getInstance().removeCollector("change_notifier");
+}
+
+ChangeNotifier::Stats ChangeNotifier::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void ChangeNotifier::run() {
+    pollfd fds[2] = {{sockFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+    std::vector<char> buffer(64 * 1024);
+    auto nextCheck = std::chrono::steady_clock::now() + options.pollInterval;
+
+    while (running) {
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextCheck - std::chrono::steady_clock::now());
+        int ready = poll(fds, 2, static_cast<int>(std::max<long long>(0, wait.count())));
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "ChangeNotifier: poll 失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        bool explained = false;
+        if (fds[1].revents & POLLIN) {
+            char bytes[64];
+            while (read(wakePipe[0], bytes, sizeof(bytes)) > 0) {}
+            if (!running) break;
+            explained = true;   // 本进程的提交
+        }
+
+        if (fds[0].revents & POLLIN) {
+            while (true) {
+                sockaddr_un from{};
+                socklen_t fromLen = sizeof(from);
+                ssize_t n = recvfrom(sockFd, buffer.data(), buffer.size(), 0,
+                                     reinterpret_cast<sockaddr*>(&from), &fromLen);
+                if (n < 0) break;   // 非阻塞套接字，EAGAIN 表示已读空
+                std::string sender;
+                if (fromLen > offsetof(sockaddr_un, sun_path)) {
+                    sender.assign(from.sun_path, strnlen(from.sun_path, sizeof(from.sun_path)));
+                }
+                handleDatagram(std::string(buffer.data(), static_cast<size_t>(n)), sender);
+            }
+            explained = true;
+        }
+        if (explained) syncDataVersion();
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextCheck) {
+            scanPeers();
+            checkDataVersion();
+            nextCheck = now + options.pollInterval;
+        }
+    }
+}
+
+void ChangeNotifier::scanPeers() {
+    std::vector<std::string> found;
+    if (DIR* dir = opendir(dirPath.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (!endsWith(name, SOCKET_SUFFIX)) continue;
+            std::string path = dirPath + "/" + name;
+            if (path != socketPath) found.push_back(path);
+        }
+        closedir(dir);
+    }
+
+    std::lock_guard<std::mutex> lock(peersMutex);
+    peers.swap(found);
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    stats.peers = peers.size();
+}
+
+void ChangeNotifier::broadcast(const std::string& message) {
+    std::lock_guard<std::mutex> lock(peersMutex);
+    std::uint64_t sent = 0;
+    std::uint64_t dropped = 0;
+
+    for (auto it = peers.begin(); it != peers.end();) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, it->c_str(), sizeof(addr.sun_path) - 1);
+        ssize_t n = sendto(sockFd, message.data(), message.size(), MSG_DONTWAIT | MSG_NOSIGNAL,
+                           reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        if (n >= 0) {
+            sent++;
+        } else if (errno == ECONNREFUSED || errno == ENOENT) {
+            // 进程已退出（或崩溃后留下的文件），不再发给它
+            if (errno == ECONNREFUSED) unlink(it->c_str());
+            it = peers.erase(it);
+            continue;
+        } else {
+            // 对端接收缓冲区已满：这次提交由对端的 data_version 兜底检查发现
+            dropped++;
+        }
+        ++it;
+    }
+
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    stats.sent += sent;
+    stats.dropped += dropped;
+    stats.peers = peers.size();
+}
+
+void ChangeNotifier::handleDatagram(const std::string& message, const std::string& sender) {
+    ChangeBatch batch;
+    bool hello = false;
+    if (!decode(message, batch, hello)) return;
+
+    if (hello) {
+        if (sender.empty() || sender == socketPath) return;
+        std::lock_guard<std::mutex> lock(peersMutex);
+        if (std::find(peers.begin(), peers.end(), sender) == peers.end()) {
+            peers.push_back(sender);
+        }
+        std::lock_guard<std::mutex> statsLock(statsMutex);
+        stats.peers = peers.size();
+        return;
+    }
+
+    activity++;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.received++;
+    }
+    ChangeFeed::getInstance().publishRemote(std::move(batch));
+}
+
+void ChangeNotifier::syncDataVersion() {
+    // 先取计数再读版本：两者之间的提交计数会变，下一次检查时不会被误判
+    lastActivity = activity;
+    lastDataVersion = readDataVersion();
+}
+
+void ChangeNotifier::checkDataVersion() {
+    // 计数变了说明有还没来得及取基线的已通知提交，只更新基线
+    std::uint64_t seen = activity;
+    long long version = readDataVersion();
+    if (version < 0) return;
+
+    if (lastDataVersion >= 0 && version != lastDataVersion && seen == lastActivity) {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.fallbackInvalidations++;
+        }
+        // 以 remote 身份发布，避免被本进程的监听器当成本地提交再广播出去
+        ChangeBatch batch;
+        batch.truncated = true;
+        ChangeFeed::getInstance().publishRemote(std::move(batch));
+    }
+    lastDataVersion = version;
+    lastActivity = seen;
+}
+
+long long ChangeNotifier::readDataVersion() {
+    sqlite3_stmt* stmt = nullptr;
+    long long version = -1;
+    if (sqlite3_prepare_v2(versionConn, "PRAGMA data_version;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return version;
+}
+
+std::string ChangeNotifier::encode(const ChangeBatch& batch) const {
+    std::string header = std::string(MAGIC) + "\n";
+    if (batch.truncated) return header + "*\n";
+
+    std::vector<std::string> tables;
+    for (const auto& change : batch.changes) {
+        if (std::find(tables.begin(), tables.end(), change.table) == tables.end()) {
+            tables.push_back(change.table);
+        }
+    }
+
+    std::ostringstream rows;
+    for (const auto& table : tables) {
+        rows << "R " << table;
+        for (sqlite3_int64 rowid : batch.rowids(table)) rows << ' ' << rowid;
+        rows << '\n';
+    }
+    std::ostringstream truncatedRows;
+    for (const auto& table : batch.truncatedTables) truncatedRows << "T " << table << '\n';
+
+    std::string message = header + rows.str() + truncatedRows.str();
+    if (message.size() <= options.maxDatagramBytes) return message;
+
+    // 大批量写入（导入、归档）只报表名，接收方作废整张表
+    std::ostringstream tablesOnly;
+    tablesOnly << header;
+    for (const auto& table : tables) tablesOnly << "T " << table << '\n';
+    tablesOnly << truncatedRows.str();
+    return tablesOnly.str();
+}
+
+bool ChangeNotifier::decode(const std::string& message, ChangeBatch& batch, bool& hello) {
+    std::istringstream in(message);
+    std::string line;
+    if (!std::getline(in, line) || line != MAGIC) return false;
+
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        std::string tag;
+        std::string table;
+        fields >> tag;
+        if (tag == "H") {
+            hello = true;
+        } else if (tag == "*") {
+            batch.truncated = true;
+        } else if (tag == "T" && fields >> table) {
+            batch.truncatedTables.push_back(table);
+        } else if (tag == "R" && fields >> table) {
+            sqlite3_int64 rowid = 0;
+            while (fields >> rowid) {
+                batch.changes.push_back(RowChange{ChangeOp::Update, table, rowid});
+            }
+        }
+    }
+    return true;
+}
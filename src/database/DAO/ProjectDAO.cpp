@@ -1,14 +1,27 @@
 #include "database/DAO/ProjectDAO.h"
+#include "database/QueryProfiler.h"
+#include "database/ChangeFeed.h"
+#include "database/SchemaMigrator.h"
 #include <iostream>
 #include <sstream>
 
+namespace {
+    // 可空的 TEXT 列（如 target_date）读成空串，避免用 nullptr 构造 string
+    const char* columnText(sqlite3_stmt* stmt, int col) {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        return text ? text : "";
+    }
+}
+
 ProjectDAO::ProjectDAO() {
     dbPath = "task_manager.db";
+    userId = DatabaseManager::DEFAULT_USER_ID;
     db = nullptr;
 }
 
-ProjectDAO::ProjectDAO(string dbPath) {
+ProjectDAO::ProjectDAO(string dbPath, int userId) {
     this->dbPath = dbPath;
+    this->userId = userId;
     db = nullptr;
 }
 
@@ -22,11 +35,15 @@ bool ProjectDAO::openDatabase() {
         cerr << "Cannot open database: " << sqlite3_errmsg(db) << endl;
         return false;
     }
+    QueryProfiler::getInstance().attach(db);
+    ChangeFeed::getInstance().attach(db);
     return true;
 }
 
 void ProjectDAO::closeDatabase() {
     if (db != nullptr) {
+        QueryProfiler::getInstance().detach(db);
+        ChangeFeed::getInstance().detach(db);
         sqlite3_close(db);
         db = nullptr;
     }
@@ -35,27 +52,8 @@ void ProjectDAO::closeDatabase() {
 bool ProjectDAO::createTable() {
     if (!openDatabase()) return false;
     
-    const char* sql = 
-        "CREATE TABLE IF NOT EXISTS projects ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-        "name TEXT NOT NULL, "
-        "description TEXT, "
-        "color_label TEXT, "
-        "progress REAL DEFAULT 0.0, "
-        "total_tasks INTEGER DEFAULT 0, "
-        "completed_tasks INTEGER DEFAULT 0, "
-        "target_date TEXT, "
-        "archived INTEGER DEFAULT 0, "
-        "created_date TEXT DEFAULT CURRENT_TIMESTAMP, "
-        "updated_date TEXT DEFAULT CURRENT_TIMESTAMP"
-        ");";
-    
-    char* errMsg = nullptr;
-    int result = sqlite3_exec(db, sql, nullptr, nullptr, &errMsg);
-    
-    if (result != SQLITE_OK) {
-        cerr << "Create table failed: " << errMsg << endl;
-        sqlite3_free(errMsg);
+    if (!SchemaMigrator(db).migrate()) {
+        cerr << "Create table failed" << endl;
         closeDatabase();
         return false;
     }
@@ -68,8 +66,8 @@ int ProjectDAO::insert(const Project& project) {
     if (!openDatabase()) return -1;
     
     const char* sql = 
-        "INSERT INTO projects (name, description, color_label, target_date) "
-        "VALUES (?, ?, ?, ?);";
+        "INSERT INTO projects (name, description, color_label, target_date, user_id) "
+        "VALUES (?, ?, ?, ?, ?);";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -84,6 +82,7 @@ int ProjectDAO::insert(const Project& project) {
     sqlite3_bind_text(stmt, 2, project.getDescription().c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 3, project.getColorLabel().c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(stmt, 4, project.getTargetDate().c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 5, userId);
     
     result = sqlite3_step(stmt);
     int lastId = -1;
@@ -107,7 +106,7 @@ Project* ProjectDAO::selectById(int id) {
     const char* sql = 
         "SELECT id, name, description, color_label, progress, "
         "total_tasks, completed_tasks, target_date, archived, "
-        "created_date, updated_date FROM projects WHERE id = ?;";
+        "created_date, updated_date FROM projects WHERE id = ? AND user_id = ?;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -119,22 +118,23 @@ Project* ProjectDAO::selectById(int id) {
     }
     
     sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, userId);
     
     Project* project = nullptr;
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         project = new Project();
         project->setId(sqlite3_column_int(stmt, 0));
-        project->setName((char*)sqlite3_column_text(stmt, 1));
-        project->setDescription((char*)sqlite3_column_text(stmt, 2));
-        project->setColorLabel((char*)sqlite3_column_text(stmt, 3));
+        project->setName(columnText(stmt, 1));
+        project->setDescription(columnText(stmt, 2));
+        project->setColorLabel(columnText(stmt, 3));
         project->setProgress(sqlite3_column_double(stmt, 4));
         project->setTotalTasks(sqlite3_column_int(stmt, 5));
         project->setCompletedTasks(sqlite3_column_int(stmt, 6));
-        project->setTargetDate((char*)sqlite3_column_text(stmt, 7));
+        project->setTargetDate(columnText(stmt, 7));
         project->setArchived(sqlite3_column_int(stmt, 8) == 1);
-        project->setCreatedDate((char*)sqlite3_column_text(stmt, 9));
-        project->setUpdatedDate((char*)sqlite3_column_text(stmt, 10));
+        project->setCreatedDate(columnText(stmt, 9));
+        project->setUpdatedDate(columnText(stmt, 10));
     }
     
     sqlite3_finalize(stmt);
@@ -151,7 +151,7 @@ vector<Project*> ProjectDAO::selectAll() {
     const char* sql = 
         "SELECT id, name, description, color_label, progress, "
         "total_tasks, completed_tasks, target_date, archived, "
-        "created_date, updated_date FROM projects WHERE archived = 0;";
+        "created_date, updated_date FROM projects WHERE user_id = ? AND archived = 0;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -161,20 +161,21 @@ vector<Project*> ProjectDAO::selectAll() {
         closeDatabase();
         return projects;
     }
+    sqlite3_bind_int(stmt, 1, userId);
     
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         Project* project = new Project();
         project->setId(sqlite3_column_int(stmt, 0));
-        project->setName((char*)sqlite3_column_text(stmt, 1));
-        project->setDescription((char*)sqlite3_column_text(stmt, 2));
-        project->setColorLabel((char*)sqlite3_column_text(stmt, 3));
+        project->setName(columnText(stmt, 1));
+        project->setDescription(columnText(stmt, 2));
+        project->setColorLabel(columnText(stmt, 3));
         project->setProgress(sqlite3_column_double(stmt, 4));
         project->setTotalTasks(sqlite3_column_int(stmt, 5));
         project->setCompletedTasks(sqlite3_column_int(stmt, 6));
-        project->setTargetDate((char*)sqlite3_column_text(stmt, 7));
+        project->setTargetDate(columnText(stmt, 7));
         project->setArchived(sqlite3_column_int(stmt, 8) == 1);
-        project->setCreatedDate((char*)sqlite3_column_text(stmt, 9));
-        project->setUpdatedDate((char*)sqlite3_column_text(stmt, 10));
+        project->setCreatedDate(columnText(stmt, 9));
+        project->setUpdatedDate(columnText(stmt, 10));
         
         projects.push_back(project);
     }
@@ -193,7 +194,7 @@ vector<Project*> ProjectDAO::selectAllIncludingArchived() {
     const char* sql = 
         "SELECT id, name, description, color_label, progress, "
         "total_tasks, completed_tasks, target_date, archived, "
-        "created_date, updated_date FROM projects;";
+        "created_date, updated_date FROM projects WHERE user_id = ?;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -202,20 +203,21 @@ vector<Project*> ProjectDAO::selectAllIncludingArchived() {
         closeDatabase();
         return projects;
     }
+    sqlite3_bind_int(stmt, 1, userId);
     
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         Project* project = new Project();
         project->setId(sqlite3_column_int(stmt, 0));
-        project->setName((char*)sqlite3_column_text(stmt, 1));
-        project->setDescription((char*)sqlite3_column_text(stmt, 2));
-        project->setColorLabel((char*)sqlite3_column_text(stmt, 3));
+        project->setName(columnText(stmt, 1));
+        project->setDescription(columnText(stmt, 2));
+        project->setColorLabel(columnText(stmt, 3));
         project->setProgress(sqlite3_column_double(stmt, 4));
         project->setTotalTasks(sqlite3_column_int(stmt, 5));
         project->setCompletedTasks(sqlite3_column_int(stmt, 6));
-        project->setTargetDate((char*)sqlite3_column_text(stmt, 7));
+        project->setTargetDate(columnText(stmt, 7));
         project->setArchived(sqlite3_column_int(stmt, 8) == 1);
-        project->setCreatedDate((char*)sqlite3_column_text(stmt, 9));
-        project->setUpdatedDate((char*)sqlite3_column_text(stmt, 10));
+        project->setCreatedDate(columnText(stmt, 9));
+        project->setUpdatedDate(columnText(stmt, 10));
         
         projects.push_back(project);
     }
@@ -233,7 +235,7 @@ bool ProjectDAO::update(const Project& project) {
         "UPDATE projects SET name = ?, description = ?, color_label = ?, "
         "progress = ?, total_tasks = ?, completed_tasks = ?, "
         "target_date = ?, archived = ?, updated_date = CURRENT_TIMESTAMP "
-        "WHERE id = ?;";
+        "WHERE id = ? AND user_id = ?;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -252,6 +254,7 @@ bool ProjectDAO::update(const Project& project) {
     sqlite3_bind_text(stmt, 7, project.getTargetDate().c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 8, project.isArchived() ? 1 : 0);
     sqlite3_bind_int(stmt, 9, project.getId());
+    sqlite3_bind_int(stmt, 10, userId);
     
     result = sqlite3_step(stmt);
     bool success = (result == SQLITE_DONE);
@@ -265,7 +268,7 @@ bool ProjectDAO::update(const Project& project) {
 bool ProjectDAO::deleteById(int id) {
     if (!openDatabase()) return false;
     
-    const char* sql = "UPDATE projects SET archived = 1 WHERE id = ?;";
+    const char* sql = "UPDATE projects SET archived = 1 WHERE id = ? AND user_id = ?;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -276,6 +279,7 @@ bool ProjectDAO::deleteById(int id) {
     }
     
     sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, userId);
     result = sqlite3_step(stmt);
     bool success = (result == SQLITE_DONE);
     
@@ -288,7 +292,7 @@ bool ProjectDAO::deleteById(int id) {
 bool ProjectDAO::hardDeleteById(int id) {
     if (!openDatabase()) return false;
     
-    const char* sql = "DELETE FROM projects WHERE id = ?;";
+    const char* sql = "DELETE FROM projects WHERE id = ? AND user_id = ?;";
     
     sqlite3_stmt* stmt;
     int result = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
@@ -299,6 +303,7 @@ bool ProjectDAO::hardDeleteById(int id) {
     }
     
     sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, userId);
     result = sqlite3_step(stmt);
     bool success = (result == SQLITE_DONE);
     
@@ -311,10 +316,11 @@ bool ProjectDAO::hardDeleteById(int id) {
 int ProjectDAO::count() {
     if (!openDatabase()) return 0;
     
-    const char* sql = "SELECT COUNT(*) FROM projects;";
+    const char* sql = "SELECT COUNT(*) FROM projects WHERE user_id = ?;";
     sqlite3_stmt* stmt;
     
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, userId);
     int count = 0;
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -330,10 +336,11 @@ int ProjectDAO::count() {
 int ProjectDAO::countActive() {
     if (!openDatabase()) return 0;
     
-    const char* sql = "SELECT COUNT(*) FROM projects WHERE archived = 0;";
+    const char* sql = "SELECT COUNT(*) FROM projects WHERE user_id = ? AND archived = 0;";
     sqlite3_stmt* stmt;
     
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    sqlite3_bind_int(stmt, 1, userId);
     int count = 0;
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -1,30 +1,20 @@
-#include "ReminderDAO.h"
+#include "database/DAO/ReminderDAO.h"
+#include "database/QueryProfiler.h"
+#include "database/ChangeFeed.h"
+#include "database/SchemaMigrator.h"
 #include <sqlite3.h>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <memory>
 
 class SQLiteReminderDAO : public ReminderDAO {
 private:
     sqlite3* db;
     std::string dbPath;
 
-    // SQL 语句常量
-    static constexpr const char* CREATE_TABLE_SQL = 
-        "CREATE TABLE IF NOT EXISTS reminders ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "title TEXT NOT NULL,"
-        "message TEXT NOT NULL,"
-        "trigger_time TEXT NOT NULL,"           // 存储为 ISO8601 字符串
-        "reminder_type INTEGER NOT NULL,"       // ReminderType 枚举值
-        "status INTEGER NOT NULL,"              // ReminderStatus 枚举值
-        "task_id INTEGER DEFAULT 0,"
-        "recurrence_rule TEXT DEFAULT '',"      // 重复规则
-        "created_at TEXT DEFAULT CURRENT_TIMESTAMP,"
-        "updated_at TEXT DEFAULT CURRENT_TIMESTAMP"
-        ");";
-
+    // SQL 语句常量（表结构由 SchemaMigrator 维护）
     static constexpr const char* INSERT_REMINDER_SQL =
         "INSERT INTO reminders (title, message, trigger_time, reminder_type, status, task_id, recurrence_rule) "
         "VALUES (?, ?, ?, ?, ?, ?, ?);";
@@ -56,6 +46,11 @@ private:
         "SELECT id, title, message, trigger_time, reminder_type, status, task_id, recurrence_rule "
         "FROM reminders WHERE reminder_type=? ORDER BY trigger_time ASC;";
 
+    static constexpr const char* SELECT_BY_RECURRENCE_SQL =
+        "SELECT id, title, message, trigger_time, reminder_type, status, task_id, recurrence_rule "
+        "FROM reminders WHERE recurrence_rule=?1 OR (?1='once' AND recurrence_rule='') "
+        "ORDER BY trigger_time ASC;";
+
     static constexpr const char* SELECT_DUE_SQL =
         "SELECT id, title, message, trigger_time, reminder_type, status, task_id, recurrence_rule "
         "FROM reminders WHERE trigger_time <= ? AND status = ? ORDER BY trigger_time ASC;";
@@ -105,6 +100,8 @@ public:
 
     ~SQLiteReminderDAO() override {
         if (db) {
+            QueryProfiler::getInstance().detach(db);
+            ChangeFeed::getInstance().detach(db);
             sqlite3_close(db);
         }
     }
@@ -115,12 +112,11 @@ public:
             std::cerr << "无法打开数据库: " << sqlite3_errmsg(db) << std::endl;
             return false;
         }
+        QueryProfiler::getInstance().attach(db);
+        ChangeFeed::getInstance().attach(db);
 
-        char* errMsg = nullptr;
-        rc = sqlite3_exec(db, CREATE_TABLE_SQL, nullptr, nullptr, &errMsg);
-        if (rc != SQLITE_OK) {
-            std::cerr << "创建表失败: " << errMsg << std::endl;
-            sqlite3_free(errMsg);
+        if (!SchemaMigrator(db).migrate()) {
+            std::cerr << "创建表失败" << std::endl;
             return false;
         }
 
@@ -140,7 +136,8 @@ public:
         std::tm tm = {};
         std::stringstream ss(timeStr);
         ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-        auto time_t = std::mktime(&tm);
+        // 写入时用的是 gmtime，读回时也按 UTC 解析
+        auto time_t = timegm(&tm);
         return std::chrono::system_clock::from_time_t(time_t);
     }
 
@@ -159,7 +156,11 @@ public:
         sqlite3_bind_text(stmt, 3, triggerTimeStr.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 4, static_cast<int>(reminder.type));
         sqlite3_bind_int(stmt, 5, static_cast<int>(reminder.status));
-        sqlite3_bind_int(stmt, 6, reminder.taskId);
+        if (reminder.taskId > 0) {
+            sqlite3_bind_int(stmt, 6, reminder.taskId);
+        } else {
+            sqlite3_bind_null(stmt, 6);  // 未关联任务
+        }
         sqlite3_bind_text(stmt, 7, reminder.recurrenceRule.c_str(), -1, SQLITE_TRANSIENT);
 
         bool success = (sqlite3_step(stmt) == SQLITE_DONE);
@@ -185,7 +186,11 @@ public:
         sqlite3_bind_text(stmt, 3, triggerTimeStr.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 4, static_cast<int>(reminder.type));
         sqlite3_bind_int(stmt, 5, static_cast<int>(reminder.status));
-        sqlite3_bind_int(stmt, 6, reminder.taskId);
+        if (reminder.taskId > 0) {
+            sqlite3_bind_int(stmt, 6, reminder.taskId);
+        } else {
+            sqlite3_bind_null(stmt, 6);  // 未关联任务
+        }
         sqlite3_bind_text(stmt, 7, reminder.recurrenceRule.c_str(), -1, SQLITE_TRANSIENT);
         sqlite3_bind_int(stmt, 8, reminder.id);
 
@@ -270,6 +275,20 @@ public:
         return reminders;
     }
 
+    std::vector<Reminder> getRemindersByRecurrence(const std::string& recurrence) override {
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db, SELECT_BY_RECURRENCE_SQL, -1, &stmt, nullptr) != SQLITE_OK) {
+            return {};
+        }
+
+        // 一次性提醒可能存成 "once" 也可能是空规则
+        sqlite3_bind_text(stmt, 1, recurrence.c_str(), -1, SQLITE_TRANSIENT);
+        auto reminders = extractRemindersFromStatement(stmt);
+        sqlite3_finalize(stmt);
+        
+        return reminders;
+    }
+
     std::vector<Reminder> getDueReminders(
         const std::chrono::system_clock::time_point& currentTime) override {
         
@@ -296,7 +315,7 @@ public:
         }
 
         sqlite3_bind_int(stmt, 1, static_cast<int>(ReminderStatus::PENDING));
-        sqlite3_bind_int(stmt, 2, static_cast<int>(ReminderStatus::OVERDUE));
+        sqlite3_bind_int(stmt, 2, static_cast<int>(ReminderStatus::TRIGGERED));
 
         auto reminders = extractRemindersFromStatement(stmt);
         sqlite3_finalize(stmt);
@@ -311,7 +330,7 @@ public:
         }
 
         sqlite3_bind_int(stmt, 1, static_cast<int>(ReminderStatus::PENDING));
-        sqlite3_bind_int(stmt, 2, static_cast<int>(ReminderStatus::OVERDUE));
+        sqlite3_bind_int(stmt, 2, static_cast<int>(ReminderStatus::TRIGGERED));
 
         auto reminders = extractRemindersFromStatement(stmt);
         sqlite3_finalize(stmt);
@@ -469,11 +488,16 @@ private:
         
         std::string triggerTimeStr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
         reminder.triggerTime = stringToTimePoint(triggerTimeStr);
+        reminder.trigger_time = triggerTimeStr;
         
         reminder.type = static_cast<ReminderType>(sqlite3_column_int(stmt, 4));
         reminder.status = static_cast<ReminderStatus>(sqlite3_column_int(stmt, 5));
         reminder.taskId = sqlite3_column_int(stmt, 6);
+        reminder.task_id = reminder.taskId;
         reminder.recurrenceRule = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 7));
+        // ReminderSystem 按 recurrence 判断是否重复，空规则视为一次性
+        reminder.recurrence = reminder.recurrenceRule.empty() ? "once" : reminder.recurrenceRule;
+        reminder.triggered = reminder.status != ReminderStatus::PENDING;
         
         return reminder;
     }
@@ -510,7 +534,7 @@ private:
 };
 
 // 工厂函数
-std::unique_ptr<ReminderDAO> createReminderDAO(const std::string& dbPath = "reminders.db") {
+std::unique_ptr<ReminderDAO> createReminderDAO(const std::string& dbPath) {
     auto dao = std::make_unique<SQLiteReminderDAO>(dbPath);
     if (dao->initialize()) {
         return dao;
@@ -5,11 +5,121 @@
 #include <sstream>
 #include <ctime>
 #include <optional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    // DAO 语句集中定义在这里，queryCatalog() 把同一批语句交给 check-plans 检查执行计划
+    const char* SQL_GET_BY_ID =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE id = ? AND user_id = ? AND deleted = 0";
+    const char* SQL_GET_ALL =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE user_id = ? AND deleted = 0 ORDER BY created_date DESC";
+    const char* SQL_BY_IDS_PREFIX =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE user_id = ? AND deleted = 0 AND id IN (";
+    const char* SQL_UPDATE = R"(
+        UPDATE tasks
+        SET title = ?,
+            description = ?,
+            completed = ?,
+            project_id = ?,
+            updated_date = datetime('now'),
+            completed_date = CASE WHEN ? = 1 THEN COALESCE(completed_date, datetime('now')) ELSE completed_date END
+        WHERE id = ? AND user_id = ?
+    )";
+    const char* SQL_SOFT_DELETE =
+        "UPDATE tasks SET deleted = 1, updated_date = datetime('now') WHERE id = ? AND user_id = ?";
+    const char* SQL_BY_STATUS =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE user_id = ? AND completed = ? AND deleted = 0 ORDER BY created_date DESC";
+    const char* SQL_BY_PROJECT =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE project_id = ? AND user_id = ? AND deleted = 0 ORDER BY created_date DESC";
+    const char* SQL_OVERDUE =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE user_id = ? AND due_date < date('now') AND completed = 0 AND deleted = 0 ORDER BY due_date ASC";
+    const char* SQL_TODAY =
+        "SELECT id, title, description, completed, project_id, user_id FROM tasks WHERE user_id = ? AND due_date = date('now') AND deleted = 0 ORDER BY created_date DESC";
+    const char* SQL_COUNT_ALL =
+        "SELECT COUNT(*) FROM tasks WHERE user_id = ? AND deleted = 0";
+    const char* SQL_COUNT_COMPLETED =
+        "SELECT COUNT(*) FROM tasks WHERE user_id = ? AND completed = 1 AND deleted = 0";
+    const char* SQL_ASSIGN_PROJECT =
+        "UPDATE tasks SET project_id = ?, updated_date = datetime('now') WHERE id = ? AND user_id = ?";
+    const char* SQL_INCREMENT_POMODORO =
+        "UPDATE tasks SET pomodoro_count = pomodoro_count + 1, updated_date = datetime('now') WHERE id = ? AND user_id = ?";
+    const char* SQL_POMODORO_COUNT =
+        "SELECT pomodoro_count FROM tasks WHERE id = ? AND user_id = ? AND deleted = 0";
+    const char* SQL_ADD_DEPENDENCY = R"(
+        INSERT OR IGNORE INTO task_dependencies (task_id, depends_on)
+        SELECT ?1, ?2
+        WHERE EXISTS (SELECT 1 FROM tasks WHERE id = ?1 AND user_id = ?3 AND deleted = 0)
+          AND EXISTS (SELECT 1 FROM tasks WHERE id = ?2 AND user_id = ?3 AND deleted = 0)
+    )";
+    const char* SQL_REMOVE_DEPENDENCY = R"(
+        DELETE FROM task_dependencies
+        WHERE task_id = ? AND depends_on = ?
+          AND task_id IN (SELECT id FROM tasks WHERE user_id = ?)
+    )";
+    const char* SQL_DEPENDENCY_NODES = R"(
+        SELECT id, priority, due_date, completed, COALESCE(project_id, 0), estimated_pomodoros
+        FROM tasks WHERE user_id = ? AND deleted = 0
+    )";
+    const char* SQL_DEPENDENCY_EDGES = R"(
+        SELECT d.task_id, d.depends_on
+        FROM task_dependencies d
+        JOIN tasks t ON t.id = d.task_id
+        WHERE t.user_id = ? AND t.deleted = 0
+    )";
+    const char* SQL_CLEAR_TASK_TAGS =
+        "DELETE FROM task_tags WHERE task_id = ?;";
+    const char* SQL_TAG_ID =
+        "SELECT id FROM tags WHERE name = ?;";
+    const char* SQL_TASK_TAGS = R"(
+        SELECT g.name FROM task_tags tt
+        JOIN tags g ON g.id = tt.tag_id
+        JOIN tasks t ON t.id = tt.task_id
+        WHERE tt.task_id = ? AND t.user_id = ? AND t.deleted = 0
+    )";
+    const char* SQL_TAG_INDEX_TASKS = R"(
+        SELECT t.id, t.completed, COALESCE(t.project_id, 0),
+               (SELECT group_concat(tag_id) FROM task_tags WHERE task_id = t.id)
+        FROM tasks t
+        WHERE t.user_id = ? AND t.deleted = 0
+    )";
+    const char* SCHEDULE_SELECT = R"(
+        SELECT t.id, t.priority, t.due_date, p.target_date,
+               t.estimated_pomodoros, t.pomodoro_count, COALESCE(t.project_id, 0)
+        FROM tasks t
+        LEFT JOIN projects p ON p.id = t.project_id AND p.archived = 0
+        WHERE t.user_id = ? AND t.completed = 0 AND t.deleted = 0
+    )";
+
+    // 所有 SELECT 都使用相同的列顺序: id, title, description, completed, project_id, user_id
+    Task readTaskRow(sqlite3_stmt* stmt) {
+        Task task;
+        task.setId(sqlite3_column_int(stmt, 0));
+        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        const char* desc = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        task.setDescription(desc ? desc : "");
+        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
+        task.setProjectId(sqlite3_column_int(stmt, 4));
+        task.setUserId(sqlite3_column_int(stmt, 5));
+        return task;
+    }
+
+    // project_id 有外键约束，0 表示"未归属项目"，必须存成 NULL
+    void bindProjectId(sqlite3_stmt* stmt, int index, int projectId) {
+        if (projectId > 0) {
+            sqlite3_bind_int(stmt, index, projectId);
+        } else {
+            sqlite3_bind_null(stmt, index);
+        }
+    }
+}
 
 // =====================
 // 构造函数
 // =====================
-TaskDAOImpl::TaskDAOImpl(const std::string& dbPath) {
+TaskDAOImpl::TaskDAOImpl(const std::string& dbPath, int userId)
+    : userId(userId) {
     databasePath = dbPath.empty() ? "task_manager.db" : dbPath;
 
     // 确保与全局 DatabaseManager 使用同一个数据库文件，避免 TaskManager 与统计/成就使用不同数据源
@@ -21,7 +131,15 @@ TaskDAOImpl::TaskDAOImpl(const std::string& dbPath) {
     createTable(); // 自动创建表
 }
 
+TaskDAOImpl::TaskDAOImpl(sqlite3* connection, int userId)
+    : userId(userId), connection(connection) {
+    const char* path = connection ? sqlite3_db_filename(connection, "main") : nullptr;
+    databasePath = path ? path : "";
+}
+
 sqlite3* TaskDAOImpl::getDatabaseConnection() {
+    if (connection) return connection;
+
     auto& dbManager = DatabaseManager::getInstance();
     if (!dbManager.isOpen() && !dbManager.initialize(databasePath)) {
         std::cerr << "无法初始化数据库: " << databasePath << std::endl;
@@ -61,17 +179,18 @@ int TaskDAOImpl::insertTask(const Task& task) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return -1;
 
-    const char* sql = "INSERT INTO tasks (title, description, completed, project_id) VALUES (?, ?, ?, ?)";
+    const char* sql = "INSERT INTO tasks (title, description, completed, project_id, user_id) VALUES (?, ?, ?, ?, ?)";
     sqlite3_stmt* stmt;
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
         std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
         return -1;
     }
 
-    sqlite3_bind_text(stmt, 1, task.getName().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.getDescription().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 1, task.getName().c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, task.getDescription().c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 3, task.isCompleted() ? 1 : 0);
-    sqlite3_bind_int(stmt, 4, task.getProjectId());
+    bindProjectId(stmt, 4, task.getProjectId());
+    sqlite3_bind_int(stmt, 5, userId);
 
     int id = -1;
     if (sqlite3_step(stmt) == SQLITE_DONE) {
@@ -89,7 +208,7 @@ std::optional<Task> TaskDAOImpl::getTaskById(int id) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return std::nullopt;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE id = ? AND deleted = 0";
+    const char* sql = SQL_GET_BY_ID;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -98,16 +217,11 @@ std::optional<Task> TaskDAOImpl::getTaskById(int id) {
     }
 
     sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, userId);
 
     std::optional<Task> result = std::nullopt;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        result = task;
+        result = readTaskRow(stmt);
     }
 
     sqlite3_finalize(stmt);
@@ -120,7 +234,7 @@ std::vector<Task> TaskDAOImpl::getAllTasks() {
     std::vector<Task> tasks;
     if (!db) return tasks;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE deleted = 0 ORDER BY created_date DESC";
+    const char* sql = SQL_GET_ALL;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -128,14 +242,10 @@ std::vector<Task> TaskDAOImpl::getAllTasks() {
         return tasks;
     }
 
+    sqlite3_bind_int(stmt, 1, userId);
+
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        tasks.push_back(task);
+        tasks.push_back(readTaskRow(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -143,20 +253,47 @@ std::vector<Task> TaskDAOImpl::getAllTasks() {
     return tasks;
 }
 
+std::vector<Task> TaskDAOImpl::getTasksByIds(const std::vector<int>& ids) {
+    sqlite3* db = getDatabaseConnection();
+    std::vector<Task> tasks;
+    if (!db || ids.empty()) return tasks;
+
+    // 按块拼 IN (?, ?, ...)，不超过 SQLite 的绑定参数上限
+    const size_t chunkSize = 500;
+    for (size_t start = 0; start < ids.size(); start += chunkSize) {
+        size_t count = std::min(chunkSize, ids.size() - start);
+        std::string sql = SQL_BY_IDS_PREFIX;
+        for (size_t i = 0; i < count; ++i) {
+            sql += (i == 0 ? "?" : ", ?");
+        }
+        sql += ")";
+
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+            return tasks;
+        }
+
+        sqlite3_bind_int(stmt, 1, userId);
+        for (size_t i = 0; i < count; ++i) {
+            sqlite3_bind_int(stmt, static_cast<int>(i + 2), ids[start + i]);
+        }
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            tasks.push_back(readTaskRow(stmt));
+        }
+
+        sqlite3_finalize(stmt);
+    }
+
+    return tasks;
+}
+
 bool TaskDAOImpl::updateTask(const Task& task) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return false;
 
-    const char* sql = R"(
-        UPDATE tasks
-        SET title = ?,
-            description = ?,
-            completed = ?,
-            project_id = ?,
-            updated_date = datetime('now'),
-            completed_date = CASE WHEN ? = 1 THEN COALESCE(completed_date, datetime('now')) ELSE completed_date END
-        WHERE id = ?
-    )";
+    const char* sql = SQL_UPDATE;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -164,13 +301,14 @@ bool TaskDAOImpl::updateTask(const Task& task) {
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, task.getName().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, task.getDescription().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 1, task.getName().c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, task.getDescription().c_str(), -1, SQLITE_TRANSIENT);
     const int completed = task.isCompleted() ? 1 : 0;
     sqlite3_bind_int(stmt, 3, completed);
-    sqlite3_bind_int(stmt, 4, task.getProjectId());
+    bindProjectId(stmt, 4, task.getProjectId());
     sqlite3_bind_int(stmt, 5, completed);
     sqlite3_bind_int(stmt, 6, task.getId());
+    sqlite3_bind_int(stmt, 7, userId);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
 
@@ -187,7 +325,7 @@ bool TaskDAOImpl::deleteTask(int id) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return false;
 
-    const char* sql = "UPDATE tasks SET deleted = 1, updated_date = datetime('now') WHERE id = ?";
+    const char* sql = SQL_SOFT_DELETE;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -196,6 +334,7 @@ bool TaskDAOImpl::deleteTask(int id) {
     }
 
     sqlite3_bind_int(stmt, 1, id);
+    sqlite3_bind_int(stmt, 2, userId);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
 
@@ -213,7 +352,7 @@ std::vector<Task> TaskDAOImpl::getTasksByStatus(bool completed) {
     std::vector<Task> tasks;
     if (!db) return tasks;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE completed = ? AND deleted = 0 ORDER BY created_date DESC";
+    const char* sql = SQL_BY_STATUS;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -221,16 +360,11 @@ std::vector<Task> TaskDAOImpl::getTasksByStatus(bool completed) {
         return tasks;
     }
 
-    sqlite3_bind_int(stmt, 1, completed ? 1 : 0);
+    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_bind_int(stmt, 2, completed ? 1 : 0);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        tasks.push_back(task);
+        tasks.push_back(readTaskRow(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -243,7 +377,7 @@ std::vector<Task> TaskDAOImpl::getTasksByProject(int projectId) {
     std::vector<Task> tasks;
     if (!db) return tasks;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE project_id = ? AND deleted = 0 ORDER BY created_date DESC";
+    const char* sql = SQL_BY_PROJECT;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -252,15 +386,10 @@ std::vector<Task> TaskDAOImpl::getTasksByProject(int projectId) {
     }
 
     sqlite3_bind_int(stmt, 1, projectId);
+    sqlite3_bind_int(stmt, 2, userId);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        tasks.push_back(task);
+        tasks.push_back(readTaskRow(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -273,7 +402,7 @@ std::vector<Task> TaskDAOImpl::getOverdueTasks() {
     std::vector<Task> tasks;
     if (!db) return tasks;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE due_date < date('now') AND completed = 0 AND deleted = 0 ORDER BY due_date ASC";
+    const char* sql = SQL_OVERDUE;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -281,14 +410,10 @@ std::vector<Task> TaskDAOImpl::getOverdueTasks() {
         return tasks;
     }
 
+    sqlite3_bind_int(stmt, 1, userId);
+
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        tasks.push_back(task);
+        tasks.push_back(readTaskRow(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -301,7 +426,7 @@ std::vector<Task> TaskDAOImpl::getTodayTasks() {
     std::vector<Task> tasks;
     if (!db) return tasks;
 
-    const char* sql = "SELECT id, title, description, completed, project_id FROM tasks WHERE due_date = date('now') AND deleted = 0 ORDER BY created_date DESC";
+    const char* sql = SQL_TODAY;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -309,14 +434,10 @@ std::vector<Task> TaskDAOImpl::getTodayTasks() {
         return tasks;
     }
 
+    sqlite3_bind_int(stmt, 1, userId);
+
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Task task;
-        task.setId(sqlite3_column_int(stmt, 0));
-        task.setName(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        task.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        task.setCompleted(sqlite3_column_int(stmt, 3) != 0);
-        task.setProjectId(sqlite3_column_int(stmt, 4));
-        tasks.push_back(task);
+        tasks.push_back(readTaskRow(stmt));
     }
 
     sqlite3_finalize(stmt);
@@ -328,7 +449,7 @@ int TaskDAOImpl::countAllTasks() {
     sqlite3* db = getDatabaseConnection();
     if (!db) return 0;
 
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE deleted = 0";
+    const char* sql = SQL_COUNT_ALL;
     sqlite3_stmt* stmt;
     int count = 0;
 
@@ -337,6 +458,8 @@ int TaskDAOImpl::countAllTasks() {
         return 0;
     }
 
+    sqlite3_bind_int(stmt, 1, userId);
+
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
@@ -350,7 +473,7 @@ int TaskDAOImpl::countCompletedTasks() {
     sqlite3* db = getDatabaseConnection();
     if (!db) return 0;
 
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1 AND deleted = 0";
+    const char* sql = SQL_COUNT_COMPLETED;
     sqlite3_stmt* stmt;
     int count = 0;
 
@@ -359,6 +482,8 @@ int TaskDAOImpl::countCompletedTasks() {
         return 0;
     }
 
+    sqlite3_bind_int(stmt, 1, userId);
+
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
@@ -372,7 +497,7 @@ bool TaskDAOImpl::assignTaskToProject(int taskId, int projectId) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return false;
 
-    const char* sql = "UPDATE tasks SET project_id = ?, updated_date = datetime('now') WHERE id = ?";
+    const char* sql = SQL_ASSIGN_PROJECT;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -380,8 +505,9 @@ bool TaskDAOImpl::assignTaskToProject(int taskId, int projectId) {
         return false;
     }
 
-    sqlite3_bind_int(stmt, 1, projectId);
+    bindProjectId(stmt, 1, projectId);
     sqlite3_bind_int(stmt, 2, taskId);
+    sqlite3_bind_int(stmt, 3, userId);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
 
@@ -398,7 +524,7 @@ bool TaskDAOImpl::incrementPomodoro(int taskId) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return false;
 
-    const char* sql = "UPDATE tasks SET pomodoro_count = pomodoro_count + 1, updated_date = datetime('now') WHERE id = ?";
+    const char* sql = SQL_INCREMENT_POMODORO;
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -407,6 +533,7 @@ bool TaskDAOImpl::incrementPomodoro(int taskId) {
     }
 
     sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, userId);
 
     bool success = (sqlite3_step(stmt) == SQLITE_DONE);
 
@@ -423,7 +550,7 @@ int TaskDAOImpl::getPomodoroCount(int taskId) {
     sqlite3* db = getDatabaseConnection();
     if (!db) return 0;
 
-    const char* sql = "SELECT pomodoro_count FROM tasks WHERE id = ? AND deleted = 0";
+    const char* sql = SQL_POMODORO_COUNT;
     sqlite3_stmt* stmt;
     int count = 0;
 
@@ -433,6 +560,7 @@ int TaskDAOImpl::getPomodoroCount(int taskId) {
     }
 
     sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, userId);
 
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
@@ -442,3 +570,396 @@ int TaskDAOImpl::getPomodoroCount(int taskId) {
 
     return count;
 }
+
+// =====================
+// 任务依赖
+// =====================
+
+bool TaskDAOImpl::addDependency(int taskId, int dependsOn) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    // 两端都必须是本用户未删除的任务
+    const char* sql = SQL_ADD_DEPENDENCY;
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, dependsOn);
+    sqlite3_bind_int(stmt, 3, userId);
+
+    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+
+    if (!success) {
+        std::cerr << "Failed to execute statement: " << sqlite3_errmsg(db) << std::endl;
+    }
+
+    sqlite3_finalize(stmt);
+
+    return success;
+}
+
+bool TaskDAOImpl::removeDependency(int taskId, int dependsOn) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    const char* sql = SQL_REMOVE_DEPENDENCY;
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, dependsOn);
+    sqlite3_bind_int(stmt, 3, userId);
+
+    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
+
+    if (!success) {
+        std::cerr << "Failed to execute statement: " << sqlite3_errmsg(db) << std::endl;
+    }
+
+    sqlite3_finalize(stmt);
+
+    return success;
+}
+
+bool TaskDAOImpl::loadDependencyGraph(std::vector<DependencyNode>& nodes,
+                                      std::vector<std::pair<int, int>>& edges) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    const char* taskSql = SQL_DEPENDENCY_NODES;
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, taskSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, userId);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        DependencyNode node;
+        node.taskId = sqlite3_column_int(stmt, 0);
+        node.priority = sqlite3_column_type(stmt, 1) == SQLITE_NULL ? 1 : sqlite3_column_int(stmt, 1);
+        // due_date 为 "YYYY-MM-DD[ ...]"，转成 YYYYMMDD 便于比较
+        const char* due = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        int year = 0, month = 0, day = 0;
+        if (due && std::sscanf(due, "%d-%d-%d", &year, &month, &day) == 3) {
+            node.dueDate = year * 10000 + month * 100 + day;
+        }
+        node.completed = sqlite3_column_int(stmt, 3) != 0;
+        node.projectId = sqlite3_column_int(stmt, 4);
+        node.weight = std::max(1, sqlite3_column_int(stmt, 5));
+        nodes.push_back(node);
+    }
+
+    sqlite3_finalize(stmt);
+
+    // 只取本用户任务之间的依赖；软删除的任务不在 nodes 中，建图时忽略相关的边
+    const char* edgeSql = SQL_DEPENDENCY_EDGES;
+
+    if (sqlite3_prepare_v2(db, edgeSql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, userId);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        edges.emplace_back(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1));
+    }
+
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+// =====================
+// 排程
+// =====================
+
+namespace {
+    ScheduleEntry readScheduleRow(sqlite3_stmt* stmt) {
+        ScheduleEntry entry;
+        entry.taskId = sqlite3_column_int(stmt, 0);
+        entry.priority = sqlite3_column_type(stmt, 1) == SQLITE_NULL ? 1 : sqlite3_column_int(stmt, 1);
+        const char* due = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        entry.dueDate = due ? due : "";
+        const char* target = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        entry.projectTargetDate = target ? target : "";
+        entry.estimatedPomodoros = sqlite3_column_int(stmt, 4);
+        entry.pomodoroCount = sqlite3_column_int(stmt, 5);
+        entry.projectId = sqlite3_column_int(stmt, 6);
+        return entry;
+    }
+}
+
+bool TaskDAOImpl::loadScheduleEntries(std::vector<ScheduleEntry>& entries) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, SCHEDULE_SELECT, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, userId);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        entries.push_back(readScheduleRow(stmt));
+    }
+
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+std::optional<ScheduleEntry> TaskDAOImpl::getScheduleEntry(int taskId) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return std::nullopt;
+
+    std::string sql = std::string(SCHEDULE_SELECT) + " AND t.id = ?";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return std::nullopt;
+    }
+
+    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_bind_int(stmt, 2, taskId);
+
+    std::optional<ScheduleEntry> entry = std::nullopt;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        entry = readScheduleRow(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+
+    return entry;
+}
+
+// =====================
+// 标签
+// =====================
+
+bool TaskDAOImpl::setTaskTags(int taskId, const std::vector<std::string>& tags,
+                              std::vector<std::pair<int, std::string>>& interned) {
+    // 所有调用方（含守护进程的 TaskSetTags）都在这里规范化和去重，"a" 与 "A " 是同一个标签
+    std::vector<std::string> names;
+    for (const auto& tag : tags) {
+        std::string name = TagIndex::normalize(tag);
+        if (name.empty()) {
+            std::cerr << "无效的标签: " << tag << std::endl;
+            return false;
+        }
+        if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+    }
+
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    // 多条语句放在一个 SAVEPOINT 里；用共享连接时持锁，别的线程的语句不会落进来
+    std::unique_lock<std::recursive_mutex> connectionLock;
+    if (!connection) connectionLock = DatabaseManager::getInstance().lockConnection();
+    if (sqlite3_exec(db, "SAVEPOINT task_tags;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to execute statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    const char* checkSql = "SELECT 1 FROM tasks WHERE id = ? AND user_id = ? AND deleted = 0;";
+    const char* clearSql = SQL_CLEAR_TASK_TAGS;
+    const char* internSql = "INSERT OR IGNORE INTO tags (name) VALUES (?);";
+    const char* lookupSql = SQL_TAG_ID;
+    const char* linkSql = "INSERT OR IGNORE INTO task_tags (task_id, tag_id) VALUES (?, ?);";
+    const char* syncSql = "UPDATE tasks SET tags = ?, updated_date = datetime('now') WHERE id = ?;";
+
+    sqlite3_stmt* check = nullptr;
+    sqlite3_stmt* clear = nullptr;
+    sqlite3_stmt* intern = nullptr;
+    sqlite3_stmt* lookup = nullptr;
+    sqlite3_stmt* link = nullptr;
+    sqlite3_stmt* sync = nullptr;
+
+    bool success = sqlite3_prepare_v2(db, checkSql, -1, &check, nullptr) == SQLITE_OK &&
+                   sqlite3_prepare_v2(db, clearSql, -1, &clear, nullptr) == SQLITE_OK &&
+                   sqlite3_prepare_v2(db, internSql, -1, &intern, nullptr) == SQLITE_OK &&
+                   sqlite3_prepare_v2(db, lookupSql, -1, &lookup, nullptr) == SQLITE_OK &&
+                   sqlite3_prepare_v2(db, linkSql, -1, &link, nullptr) == SQLITE_OK &&
+                   sqlite3_prepare_v2(db, syncSql, -1, &sync, nullptr) == SQLITE_OK;
+    if (!success) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+    }
+
+    // 只能给本用户未删除的任务打标签
+    if (success) {
+        sqlite3_bind_int(check, 1, taskId);
+        sqlite3_bind_int(check, 2, userId);
+        success = sqlite3_step(check) == SQLITE_ROW;
+        if (!success) std::cerr << "任务不存在: " << taskId << std::endl;
+    }
+    if (success) {
+        sqlite3_bind_int(clear, 1, taskId);
+        success = sqlite3_step(clear) == SQLITE_DONE;
+    }
+
+    interned.clear();
+    std::string joined;
+    for (size_t i = 0; success && i < names.size(); ++i) {
+        const std::string& name = names[i];
+        sqlite3_reset(intern);
+        sqlite3_bind_text(intern, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_reset(lookup);
+        sqlite3_bind_text(lookup, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(intern) != SQLITE_DONE || sqlite3_step(lookup) != SQLITE_ROW) {
+            success = false;
+            break;
+        }
+        int tagId = sqlite3_column_int(lookup, 0);
+
+        sqlite3_reset(link);
+        sqlite3_bind_int(link, 1, taskId);
+        sqlite3_bind_int(link, 2, tagId);
+        success = sqlite3_step(link) == SQLITE_DONE;
+
+        interned.emplace_back(tagId, name);
+        if (!joined.empty()) joined += ",";
+        joined += name;
+    }
+
+    if (success) {
+        sqlite3_bind_text(sync, 1, joined.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(sync, 2, taskId);
+        success = sqlite3_step(sync) == SQLITE_DONE;
+    }
+
+    for (sqlite3_stmt* stmt : {check, clear, intern, lookup, link, sync}) {
+        sqlite3_finalize(stmt);
+    }
+
+    if (!success) {
+        if (sqlite3_errcode(db) != SQLITE_OK) {
+            std::cerr << "Failed to set tags for task " << taskId << ": " << sqlite3_errmsg(db) << std::endl;
+        }
+        sqlite3_exec(db, "ROLLBACK TO task_tags;", nullptr, nullptr, nullptr);
+        interned.clear();
+    }
+    sqlite3_exec(db, "RELEASE task_tags;", nullptr, nullptr, nullptr);
+
+    return success;
+}
+
+std::vector<std::string> TaskDAOImpl::getTaskTags(int taskId) {
+    std::vector<std::string> names;
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return names;
+
+    const char* sql = SQL_TASK_TAGS;
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return names;
+    }
+
+    sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, userId);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+
+    sqlite3_finalize(stmt);
+
+    // 每个任务只有几个标签，在这里排序，免得 SQLite 为 ORDER BY 建临时 B 树
+    std::sort(names.begin(), names.end());
+
+    return names;
+}
+
+bool TaskDAOImpl::loadTagIndex(std::vector<std::pair<int, std::string>>& tags,
+                               std::vector<TaggedTask>& tasks) {
+    sqlite3* db = getDatabaseConnection();
+    if (!db) return false;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT id, name FROM tags;", -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        tags.emplace_back(sqlite3_column_int(stmt, 0),
+                          reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+    }
+    sqlite3_finalize(stmt);
+
+    // 每个任务一行，标签 ID 拼成逗号分隔串，避免按任务再查一次
+    const char* sql = SQL_TAG_INDEX_TASKS;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, userId);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        TaggedTask task;
+        task.taskId = sqlite3_column_int(stmt, 0);
+        task.completed = sqlite3_column_int(stmt, 1) != 0;
+        task.projectId = sqlite3_column_int(stmt, 2);
+        const char* ids = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        for (const char* p = ids; p && *p;) {
+            char* end = nullptr;
+            task.tagIds.push_back(static_cast<int>(std::strtol(p, &end, 10)));
+            p = (*end == ',') ? end + 1 : end;
+        }
+        tasks.push_back(std::move(task));
+    }
+
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+// =====================
+// 执行计划检查
+// =====================
+
+std::vector<PlannedQuery> TaskDAOImpl::queryCatalog() {
+    std::string byIds = std::string(SQL_BY_IDS_PREFIX) + "?, ?, ?)";
+    return {
+        {"TaskDAO::getTaskById", SQL_GET_BY_ID},
+        {"TaskDAO::getAllTasks", SQL_GET_ALL},
+        {"TaskDAO::getTasksByIds", byIds},
+        {"TaskDAO::updateTask", SQL_UPDATE},
+        {"TaskDAO::deleteTask", SQL_SOFT_DELETE},
+        {"TaskDAO::getTasksByStatus", SQL_BY_STATUS},
+        {"TaskDAO::getTasksByProject", SQL_BY_PROJECT},
+        {"TaskDAO::getOverdueTasks", SQL_OVERDUE},
+        {"TaskDAO::getTodayTasks", SQL_TODAY},
+        {"TaskDAO::countAllTasks", SQL_COUNT_ALL},
+        {"TaskDAO::countCompletedTasks", SQL_COUNT_COMPLETED},
+        {"TaskDAO::assignTaskToProject", SQL_ASSIGN_PROJECT},
+        {"TaskDAO::incrementPomodoro", SQL_INCREMENT_POMODORO},
+        {"TaskDAO::getPomodoroCount", SQL_POMODORO_COUNT},
+        {"TaskDAO::addDependency", SQL_ADD_DEPENDENCY},
+        {"TaskDAO::removeDependency", SQL_REMOVE_DEPENDENCY},
+        {"TaskDAO::getTaskTags", SQL_TASK_TAGS},
+        {"TaskDAO::setTaskTags (clear)", SQL_CLEAR_TASK_TAGS},
+        {"TaskDAO::setTaskTags (tag id)", SQL_TAG_ID},
+        {"TaskDAO::loadScheduleEntries", SCHEDULE_SELECT},
+        {"TaskDAO::getScheduleEntry", std::string(SCHEDULE_SELECT) + " AND t.id = ?"},
+        // 启动时各读一次全部任务，按用户分区读取即可，不要求避开扫描
+        {"TaskDAO::loadDependencyGraph (nodes)", SQL_DEPENDENCY_NODES, false},
+        {"TaskDAO::loadDependencyGraph (edges)", SQL_DEPENDENCY_EDGES, false},
+        {"TaskDAO::loadTagIndex", SQL_TAG_INDEX_TASKS, false},
+    };
+}
@@ -0,0 +1,378 @@
+#include "database/MaintenanceScheduler.h"
+#include "database/DatabaseManager.h"
+#include "database/ChangeFeed.h"
+#include "metrics/Metrics.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+std::unique_ptr<MaintenanceScheduler> MaintenanceScheduler::instance = nullptr;
+std::mutex MaintenanceScheduler::instanceMutex;
+
+namespace {
+
+// SQLite 默认的自动检查点阈值（页）
+constexpr int DEFAULT_WAL_AUTOCHECKPOINT = 1000;
+
+// 只读探测（count(*) 等）不持锁，给它比写操作宽松得多的时间
+constexpr int READ_BUDGET_FACTOR = 20;
+
+// 进度回调的调用间隔（虚拟机指令数）
+constexpr int PROGRESS_OPS = 1000;
+
+bool isBusy(int rc) {
+    return rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+}
+
+} // namespace
+
+MaintenanceScheduler& MaintenanceScheduler::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<MaintenanceScheduler>();
+    }
+    return *instance;
+}
+
+void MaintenanceScheduler::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    stop();
+}
+
+bool MaintenanceScheduler::start(const MaintenanceOptions& opts) {
+    std::lock_guard<std::mutex> lock(workerMutex);
+    if (running) return true;
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        std::cerr << "MaintenanceScheduler: 数据库尚未打开" << std::endl;
+        return false;
+    }
+
+    // 独立连接；不设 busy_timeout，遇到锁立即返回
+    sqlite3* handle = nullptr;
+    dbPath = db.getDatabasePath();
+    if (sqlite3_open_v2(dbPath.c_str(), &handle, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK) {
+        std::cerr << "MaintenanceScheduler: 无法打开数据库: " << sqlite3_errmsg(handle) << std::endl;
+        sqlite3_close(handle);
+        return false;
+    }
+    conn = handle;
+    options = opts;
+    deadline = std::chrono::steady_clock::time_point::max();
+    sqlite3_exec(conn, ("PRAGMA analysis_limit = " + std::to_string(options.analysisLimit) + ";").c_str(),
+                 nullptr, nullptr, nullptr);
+    sqlite3_progress_handler(conn, PROGRESS_OPS, &MaintenanceScheduler::progressCallback, this);
+    // 归档删除任务时靠外键级联清理标签、依赖和提醒
+    sqlite3_exec(conn, "PRAGMA foreign_keys = ON;", nullptr, nullptr, nullptr);
+    // 归档写在这条连接上，同样要发布给变更订阅者
+    ChangeFeed::getInstance().attach(conn);
+    archiveChunkRows = std::max(1, options.archive.chunkSize);
+
+    // 检查点改由本线程负责，主连接的自动检查点只作兜底
+    db.setWalAutocheckpoint(options.walAutocheckpointPages);
+
+    auto now = std::chrono::steady_clock::now();
+    lastActivity = lastOptimize = lastAnalyzeCheck = now;
+    lastQueryCount = -1;
+    lastDataVersion = -1;
+    stopRequested = false;
+    runRequested = false;
+
+    MetricsRegistry::getInstance().addCollector("maintenance", [this](std::ostream& out) {
+        Stats s = getStats();
+        const char* runs = "taskmgr_maintenance_runs_total";
+        MetricsRegistry::writeHeader(out, runs, "Background maintenance operations completed", "counter");
+        MetricsRegistry::writeSample(out, runs, "task=\"checkpoint_passive\"", static_cast<double>(s.passiveCheckpoints));
+        MetricsRegistry::writeSample(out, runs, "task=\"checkpoint_truncate\"", static_cast<double>(s.truncateCheckpoints));
+        MetricsRegistry::writeSample(out, runs, "task=\"optimize\"", static_cast<double>(s.optimizeRuns));
+        MetricsRegistry::writeSample(out, runs, "task=\"analyze\"", static_cast<double>(s.tablesAnalyzed));
+        MetricsRegistry::writeHeader(out, "taskmgr_maintenance_tasks_archived_total",
+                                     "Tasks moved from tasks to tasks_archive", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_maintenance_tasks_archived_total", "",
+                                     static_cast<double>(s.tasksArchived));
+        const char* skipped = "taskmgr_maintenance_skipped_total";
+        MetricsRegistry::writeHeader(out, skipped, "Maintenance steps abandoned to stay out of the way of writers", "counter");
+        MetricsRegistry::writeSample(out, skipped, "reason=\"busy\"", static_cast<double>(s.skippedBusy));
+        MetricsRegistry::writeSample(out, skipped, "reason=\"budget\"", static_cast<double>(s.interrupted));
+        MetricsRegistry::writeHeader(out, "taskmgr_maintenance_pages_vacuumed_total",
+                                     "Pages released by incremental vacuum", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_maintenance_pages_vacuumed_total", "",
+                                     static_cast<double>(s.pagesVacuumed));
+        MetricsRegistry::writeHeader(out, "taskmgr_wal_bytes", "Size of the WAL file at the last check", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_wal_bytes", "", static_cast<double>(s.walBytes));
+    });
+
+    running = true;
+    worker = std::thread(&MaintenanceScheduler::run, this);
+    return true;
+}
+
+void MaintenanceScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        if (!running) return;
+        running = false;          // 进度回调看到后中断正在执行的语句
+        stopRequested = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    MetricsRegistry::getInstance().removeCollector("maintenance");
+    ChangeFeed::getInstance().detach(conn);
+    sqlite3_close(conn);
+    conn = nullptr;
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (db.isOpen()) {
+        db.setWalAutocheckpoint(DEFAULT_WAL_AUTOCHECKPOINT);
+    }
+}
+
+void MaintenanceScheduler::runNow() {
+    std::unique_lock<std::mutex> lock(workerMutex);
+    if (!running) return;
+    runRequested = true;
+    wakeup.notify_all();
+    wakeup.wait(lock, [this] { return !runRequested || stopRequested; });
+}
+
+MaintenanceScheduler::Stats MaintenanceScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void MaintenanceScheduler::run() {
+    std::unique_lock<std::mutex> lock(workerMutex);
+    while (!stopRequested) {
+        wakeup.wait_for(lock, options.tickInterval, [this] { return stopRequested || runRequested; });
+        if (stopRequested) break;
+
+        bool forced = runRequested;
+        lock.unlock();
+        tick(forced);
+        lock.lock();
+
+        if (forced) {
+            runRequested = false;
+            wakeup.notify_all();
+        }
+    }
+}
+
+void MaintenanceScheduler::tick(bool forced) {
+    TRACE_SCOPE("db", "MaintenanceScheduler::tick");
+
+    bool idle = isIdle() || forced;
+    checkpoint(idle);
+    if (!idle) return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (forced || now - lastOptimize >= options.optimizeInterval) {
+        optimize();
+        lastOptimize = now;
+    }
+    if (forced || now - lastAnalyzeCheck >= options.analyzeInterval) {
+        analyzeStaleTables();
+        lastAnalyzeCheck = now;
+    }
+    // 归档删掉的行在下面的增量回收里释放
+    archiveTasks(forced);
+    incrementalVacuum();
+}
+
+bool MaintenanceScheduler::isIdle() {
+    // data_version 只在其他连接提交后变化，本连接自己的维护写入不计入
+    long queries = DatabaseManager::getInstance().getTotalQueryCount();
+    long long version = queryInt("PRAGMA data_version;");
+    auto now = std::chrono::steady_clock::now();
+
+    if (queries != lastQueryCount || version != lastDataVersion) {
+        lastQueryCount = queries;
+        lastDataVersion = version;
+        lastActivity = now;
+        return false;
+    }
+    return now - lastActivity >= options.idleAfter;
+}
+
+void MaintenanceScheduler::checkpoint(bool idle) {
+    int logFrames = 0;
+    int checkpointedFrames = 0;
+
+    // PASSIVE 只回写没有读者再需要的帧，不等锁也不阻塞任何人
+    int rc = sqlite3_wal_checkpoint_v2(conn, nullptr, SQLITE_CHECKPOINT_PASSIVE,
+                                       &logFrames, &checkpointedFrames);
+    std::error_code ec;
+    auto walSize = std::filesystem::file_size(dbPath + "-wal", ec);
+    long long walBytes = ec ? 0 : static_cast<long long>(walSize);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (rc == SQLITE_OK && logFrames > 0) stats.passiveCheckpoints++;
+        else if (isBusy(rc)) stats.skippedBusy++;
+        stats.walBytes = walBytes;
+    }
+
+    // 全部帧都已回写时 TRUNCATE 只需短暂持锁；有读者或写者就下次再试
+    if (!idle || rc != SQLITE_OK || logFrames <= 0 || checkpointedFrames != logFrames ||
+        walBytes < options.truncateWalBytes) {
+        return;
+    }
+    rc = sqlite3_wal_checkpoint_v2(conn, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (rc == SQLITE_OK) {
+        stats.truncateCheckpoints++;
+        stats.walBytes = 0;
+    } else if (isBusy(rc)) {
+        stats.skippedBusy++;
+    }
+}
+
+void MaintenanceScheduler::optimize() {
+    // 0x10000：检查所有表，而不只是本连接用过的表
+    if (execBudgeted("PRAGMA optimize = 0x10002;")) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.optimizeRuns++;
+    }
+}
+
+void MaintenanceScheduler::analyzeStaleTables() {
+    TRACE_SCOPE("db", "MaintenanceScheduler::analyzeStaleTables");
+
+    std::vector<std::string> tables;
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql =
+        "SELECT t.name FROM sqlite_master t WHERE t.type = 'table' AND t.name NOT LIKE 'sqlite_%' "
+        "AND EXISTS (SELECT 1 FROM sqlite_master i WHERE i.type = 'index' AND i.tbl_name = t.name);";
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, nullptr) != SQLITE_OK) return;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        tables.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+
+    bool haveStats = queryInt("SELECT count(*) FROM sqlite_master WHERE name = 'sqlite_stat1';") > 0;
+
+    for (const auto& table : tables) {
+        if (!running) return;
+
+        // sqlite_stat1.stat 的第一个数是 ANALYZE 时的行数
+        long long recorded = -1;
+        if (haveStats) {
+            std::string escaped = table;
+            for (size_t pos = escaped.find('\''); pos != std::string::npos; pos = escaped.find('\'', pos + 2)) {
+                escaped.insert(pos, "'");
+            }
+            recorded = queryInt("SELECT CAST(stat AS INTEGER) FROM sqlite_stat1 WHERE tbl = '" + escaped + "' LIMIT 1;");
+        }
+        long long current = queryInt("SELECT count(*) FROM \"" + table + "\";",
+                                     options.stepBudget * READ_BUDGET_FACTOR);
+        if (current < 0) continue;  // 超出预算，下次再看
+
+        bool stale = recorded < 0
+            ? current > 0
+            : std::abs(current - recorded) > options.staleRatio * std::max(recorded, 1LL);
+        if (stale && execBudgeted("ANALYZE \"" + table + "\";")) {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.tablesAnalyzed++;
+        }
+    }
+}
+
+void MaintenanceScheduler::incrementalVacuum() {
+    // 只有 auto_vacuum=INCREMENTAL(2) 的库才能分步回收；旧库需要先 vacuumDatabase() 一次
+    if (queryInt("PRAGMA auto_vacuum;") != 2) return;
+
+    long long freePages = queryInt("PRAGMA freelist_count;");
+    if (freePages < options.vacuumMinFreePages) return;
+
+    if (execBudgeted("PRAGMA incremental_vacuum(" + std::to_string(options.vacuumPagesPerStep) + ");")) {
+        long long remaining = queryInt("PRAGMA freelist_count;");
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.pagesVacuumed += static_cast<std::uint64_t>(std::max(0LL, freePages - remaining));
+    }
+}
+
+void MaintenanceScheduler::archiveTasks(bool forced) {
+    if (!options.archiveEnabled) return;
+    TRACE_SCOPE("db", "MaintenanceScheduler::archiveTasks");
+
+    TaskArchiver archiver(conn);
+    const int maxRows = std::max(1, options.archive.chunkSize);
+    for (int chunk = 0; running && (forced || chunk < options.archiveChunksPerTick); ++chunk) {
+        ArchivePolicy policy = options.archive;
+        policy.chunkSize = archiveChunkRows;
+
+        deadline = std::chrono::steady_clock::now() + options.stepBudget;
+        int moved = archiver.archiveChunk(policy);
+        deadline = std::chrono::steady_clock::time_point::max();
+
+        if (moved < 0) {
+            int rc = archiver.lastErrorCode();
+            std::lock_guard<std::mutex> lock(statsMutex);
+            if (rc == SQLITE_INTERRUPT) {
+                stats.interrupted++;
+                archiveChunkRows = std::max(1, archiveChunkRows / 2);
+            } else if (isBusy(rc)) {
+                stats.skippedBusy++;
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.tasksArchived += static_cast<std::uint64_t>(moved);
+        }
+        if (moved < policy.chunkSize) return;
+        archiveChunkRows = std::min(maxRows, archiveChunkRows * 2);
+    }
+}
+
+bool MaintenanceScheduler::execBudgeted(const std::string& sql) {
+    deadline = std::chrono::steady_clock::now() + options.stepBudget;
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(conn, sql.c_str(), nullptr, nullptr, &errMsg);
+    deadline = std::chrono::steady_clock::time_point::max();
+    if (rc == SQLITE_OK) return true;
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (isBusy(rc)) stats.skippedBusy++;
+        else if (rc == SQLITE_INTERRUPT) stats.interrupted++;
+    }
+    if (!isBusy(rc) && rc != SQLITE_INTERRUPT) {
+        std::cerr << "维护语句失败: " << (errMsg ? errMsg : sqlite3_errstr(rc)) << " (SQL: " << sql << ")" << std::endl;
+    }
+    sqlite3_free(errMsg);
+    return false;
+}
+
+long long MaintenanceScheduler::queryInt(const std::string& sql) {
+    return queryInt(sql, options.stepBudget);
+}
+
+long long MaintenanceScheduler::queryInt(const std::string& sql, std::chrono::milliseconds budget) {
+    long long value = -1;
+    sqlite3_stmt* stmt = nullptr;
+    deadline = std::chrono::steady_clock::now() + budget;
+    if (sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    deadline = std::chrono::steady_clock::time_point::max();
+    return value;
+}
+
+int MaintenanceScheduler::progressCallback(void* self) {
+    auto* scheduler = static_cast<MaintenanceScheduler*>(self);
+    return (!scheduler->running || std::chrono::steady_clock::now() > scheduler->deadline) ? 1 : 0;
+}
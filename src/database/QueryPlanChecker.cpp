@@ -0,0 +1,54 @@
+#include "database/QueryPlanChecker.h"
+#include <map>
+#include <ostream>
+
+PlanCheckResult QueryPlanChecker::check(const PlannedQuery& query) const {
+    PlanCheckResult result;
+    result.query = query;
+
+    sqlite3_stmt* stmt = nullptr;
+    std::string explainSql = "EXPLAIN QUERY PLAN " + query.sql;
+    if (!db || sqlite3_prepare_v2(db, explainSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        result.problems.push_back(std::string("无法准备语句: ") + (db ? sqlite3_errmsg(db) : "未打开数据库"));
+        sqlite3_finalize(stmt);
+        return result;
+    }
+
+    std::map<int, int> depth;  // 节点 id -> 缩进层级
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        int parent = sqlite3_column_int(stmt, 1);
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        std::string detail = text ? text : "";
+        int level = depth.count(parent) ? depth[parent] + 1 : 0;
+        depth[id] = level;
+        result.plan.push_back(std::string(level * 2, ' ') + detail);
+
+        // 3.36 之前为 "SCAN TABLE x"，之后为 "SCAN x"；INSERT ... SELECT 的 "SCAN CONSTANT ROW" 不读表
+        if (detail.rfind("SCAN ", 0) == 0 && detail != "SCAN CONSTANT ROW") {
+            result.problems.push_back("全量扫描: " + detail);
+        } else if (detail.rfind("USE TEMP B-TREE", 0) == 0) {
+            result.problems.push_back("临时排序: " + detail);
+        }
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+bool QueryPlanChecker::checkAll(const std::vector<PlannedQuery>& queries, std::ostream& report,
+                                bool verbose) const {
+    size_t failed = 0;
+    for (const auto& query : queries) {
+        PlanCheckResult result = check(query);
+        const char* status = !result.passed() ? "FAIL" : (result.problems.empty() ? "ok  " : "info");
+        report << status << "  " << query.name << "\n";
+        if (!result.passed()) failed++;
+
+        if (verbose || !result.problems.empty()) {
+            for (const auto& line : result.plan) report << "        " << line << "\n";
+            for (const auto& problem : result.problems) report << "      ! " << problem << "\n";
+        }
+    }
+    report << queries.size() << " statements, " << failed << " failed\n";
+    return failed == 0;
+}
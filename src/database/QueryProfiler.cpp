@@ -0,0 +1,424 @@
+#include "database/QueryProfiler.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <ctime>
+#include <chrono>
+
+std::unique_ptr<QueryProfiler> QueryProfiler::instance = nullptr;
+std::mutex QueryProfiler::instanceMutex;
+
+namespace {
+
+// 每个线程上正在执行的语句：开始时间与已返回行数，语句结束时取走。
+// SQLite 自带的 PROFILE 耗时只有毫秒精度，这里自己用 steady_clock 计时
+struct InFlight {
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t rows = 0;
+};
+thread_local std::unordered_map<sqlite3_stmt*, InFlight> statementsInFlight;
+
+std::string currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char buf[20];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &utc);
+    return buf;
+}
+
+// 只对会走查询规划的语句抓计划
+bool isPlannable(const std::string& fingerprint) {
+    std::string head = fingerprint.substr(0, 7);
+    std::transform(head.begin(), head.end(), head.begin(), ::toupper);
+    return head.rfind("SELECT", 0) == 0 || head.rfind("INSERT", 0) == 0 ||
+           head.rfind("UPDATE", 0) == 0 || head.rfind("DELETE", 0) == 0 ||
+           head.rfind("WITH", 0) == 0 || head.rfind("REPLACE", 0) == 0;
+}
+
+} // namespace
+
+// === LatencyHistogram ===
+
+int LatencyHistogram::bucketFor(std::uint64_t micros) {
+    if (micros < SUB_BUCKETS) return static_cast<int>(micros);
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent >= MAX_EXPONENT) return BUCKET_COUNT - 1;
+    int sub = static_cast<int>(micros >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+    return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<std::uint64_t>(bucket);
+    int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+    int sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    std::uint64_t width = 1ULL << (exponent - SUB_BUCKET_BITS);
+    return static_cast<std::uint64_t>(SUB_BUCKETS + sub) * width + width - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t micros) {
+    buckets[bucketFor(micros)]++;
+    count++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+}
+
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    if (count == 0) return 0;
+    std::uint64_t target = static_cast<std::uint64_t>(p / 100.0 * count + 0.5);
+    target = std::min(std::max<std::uint64_t>(target, 1), count);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= target) return bucketUpperBound(i);
+    }
+    return bucketUpperBound(BUCKET_COUNT - 1);
+}
+
+// === 单例 ===
+
+QueryProfiler& QueryProfiler::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<QueryProfiler>();
+    }
+    return *instance;
+}
+
+void QueryProfiler::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+// === 挂载 ===
+
+bool QueryProfiler::attach(sqlite3* conn) {
+    if (!conn) return false;
+    int rc = sqlite3_trace_v2(conn, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW,
+                              &QueryProfiler::traceCallback, this);
+    if (rc != SQLITE_OK) {
+        std::cerr << "QueryProfiler: 注册 trace 回调失败: " << sqlite3_errstr(rc) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void QueryProfiler::detach(sqlite3* conn) {
+    if (conn) {
+        sqlite3_trace_v2(conn, 0, nullptr, nullptr);
+    }
+}
+
+int QueryProfiler::traceCallback(unsigned type, void* context, void* p, void* x) {
+    auto* profiler = static_cast<QueryProfiler*>(context);
+    auto* stmt = static_cast<sqlite3_stmt*>(p);
+
+    if (type == SQLITE_TRACE_STMT) {
+        // 触发器子程序会再次触发 STMT，保留最早的开始时间
+        statementsInFlight.try_emplace(stmt, InFlight{std::chrono::steady_clock::now(), 0});
+    } else if (type == SQLITE_TRACE_ROW) {
+        auto it = statementsInFlight.find(stmt);
+        if (it != statementsInFlight.end()) it->second.rows++;
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        auto it = statementsInFlight.find(stmt);
+        if (it == statementsInFlight.end()) {
+            // 剖析开启前就已开始的语句，退回 SQLite 的计时
+            if (profiler->enabled) {
+                profiler->onStatementFinished(stmt, static_cast<std::uint64_t>(*static_cast<sqlite3_int64*>(x)), 0);
+            }
+            return 0;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - it->second.start;
+        std::uint64_t rows = it->second.rows;
+        statementsInFlight.erase(it);
+#ifndef DISABLE_TRACING
+        // 每条语句也作为追踪区间输出，DAO 直接走原始连接的语句同样可见
+        if (Tracer::isEnabled()) {
+            TraceEvent event;
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            event.category = "sql";
+            event.name = "statement";
+            Tracer::copyDetail(event, sqlite3_sql(stmt));
+            event.startNs = Tracer::nowNs() - nanos;
+            event.durationNs = nanos;
+            Tracer::record(event);
+        }
+#endif
+        if (profiler->enabled) {
+            profiler->onStatementFinished(
+                stmt, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                rows);
+        }
+    }
+    return 0;
+}
+
+void QueryProfiler::onStatementFinished(sqlite3_stmt* stmt, std::uint64_t nanos, std::uint64_t rows) {
+    std::uint64_t micros = nanos / 1000;
+    std::string key = fingerprint(sqlite3_sql(stmt));
+    bool slow = micros >= slowThresholdMicros;
+    bool needPlan = false;
+
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        auto it = statsByFingerprint.find(key);
+        if (it == statsByFingerprint.end()) {
+            if (statsByFingerprint.size() >= maxFingerprints) key = "<other>";
+            it = statsByFingerprint.try_emplace(key).first;
+            it->second.fingerprint = key;
+        }
+        QueryStats& stats = it->second;
+        stats.calls++;
+        stats.rows += rows;
+        stats.totalMicros += micros;
+        stats.maxMicros = std::max(stats.maxMicros, micros);
+        stats.histogram.record(micros);
+
+        needPlan = slow && planByFingerprint.find(key) == planByFingerprint.end();
+    }
+
+    if (!slow) return;
+
+    SlowQuery entry;
+    entry.timestamp = currentTimestamp();
+    entry.fingerprint = key;
+    entry.micros = micros;
+    entry.rows = rows;
+    if (char* expanded = sqlite3_expanded_sql(stmt)) {
+        entry.sql = expanded;
+        sqlite3_free(expanded);
+    } else {
+        entry.sql = sqlite3_sql(stmt);
+    }
+
+    // 计划在锁外抓取：要开一个新连接，可能要几百微秒
+    std::string plan = needPlan && isPlannable(key) ? explain(sqlite3_db_handle(stmt), entry.sql) : "";
+
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    if (needPlan) {
+        planByFingerprint.emplace(key, plan);
+    }
+    entry.plan = planByFingerprint[key];
+    appendToSlowLog(entry);
+    slowQueries.push_back(std::move(entry));
+    while (slowQueries.size() > maxSlowQueries) {
+        slowQueries.pop_front();
+    }
+}
+
+std::string QueryProfiler::explain(sqlite3* conn, const std::string& sql) const {
+    // 不能在 trace 回调里复用被剖析的连接，另开一个只读连接
+    const char* filename = sqlite3_db_filename(conn, "main");
+    if (!filename || !*filename) return "";
+
+    sqlite3* planConn = nullptr;
+    if (sqlite3_open_v2(filename, &planConn, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(planConn);
+        return "";
+    }
+
+    std::string plan;
+    sqlite3_stmt* stmt = nullptr;
+    std::string explainSql = "EXPLAIN QUERY PLAN " + sql;
+    if (sqlite3_prepare_v2(planConn, explainSql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        std::map<int, int> depth;  // 节点 id -> 缩进层级
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0);
+            int parent = sqlite3_column_int(stmt, 1);
+            const char* detail = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            int level = depth.count(parent) ? depth[parent] + 1 : 0;
+            depth[id] = level;
+            if (!plan.empty()) plan += "\n";
+            plan += std::string(level * 2, ' ') + (detail ? detail : "");
+        }
+    } else {
+        plan = std::string("(无法获取计划: ") + sqlite3_errmsg(planConn) + ")";
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(planConn);
+    return plan;
+}
+
+void QueryProfiler::appendToSlowLog(const SlowQuery& entry) const {
+    if (slowLogPath.empty()) return;
+    std::ofstream out(slowLogPath, std::ios::app);
+    if (!out) return;
+    out << entry.timestamp << " " << std::fixed << std::setprecision(3) << entry.micros / 1000.0
+        << " ms, " << entry.rows << " rows: " << entry.sql << "\n";
+    if (!entry.plan.empty()) {
+        out << entry.plan << "\n";
+    }
+}
+
+// === 配置 ===
+
+void QueryProfiler::setSlowQueryThreshold(double milliseconds) {
+    slowThresholdMicros = static_cast<std::uint64_t>(std::max(0.0, milliseconds) * 1000.0);
+}
+
+double QueryProfiler::getSlowQueryThreshold() const {
+    return slowThresholdMicros / 1000.0;
+}
+
+void QueryProfiler::setSlowQueryLog(const std::string& path) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    slowLogPath = path;
+}
+
+void QueryProfiler::setMaxSlowQueries(size_t maxEntries) {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    maxSlowQueries = std::max<size_t>(1, maxEntries);
+    while (slowQueries.size() > maxSlowQueries) {
+        slowQueries.pop_front();
+    }
+}
+
+// === 查询 ===
+
+std::vector<QueryStats> QueryProfiler::getTopStatements(size_t n) const {
+    std::vector<QueryStats> result;
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        result.reserve(statsByFingerprint.size());
+        for (const auto& entry : statsByFingerprint) {
+            result.push_back(entry.second);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const QueryStats& a, const QueryStats& b) {
+        return a.totalMicros > b.totalMicros;
+    });
+    if (result.size() > n) result.resize(n);
+    return result;
+}
+
+std::vector<QueryStats> QueryProfiler::getSlowestStatements(size_t n) const {
+    std::vector<QueryStats> result;
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        result.reserve(statsByFingerprint.size());
+        for (const auto& entry : statsByFingerprint) {
+            result.push_back(entry.second);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const QueryStats& a, const QueryStats& b) {
+        return a.maxMicros > b.maxMicros;
+    });
+    if (result.size() > n) result.resize(n);
+    return result;
+}
+
+std::vector<SlowQuery> QueryProfiler::getSlowQueries() const {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    return std::vector<SlowQuery>(slowQueries.begin(), slowQueries.end());
+}
+
+LatencyHistogram QueryProfiler::getOverallHistogram() const {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    LatencyHistogram overall;
+    for (const auto& entry : statsByFingerprint) {
+        overall.merge(entry.second.histogram);
+    }
+    return overall;
+}
+
+void QueryProfiler::dump(std::ostream& out, size_t topN) const {
+    auto top = getSlowestStatements(topN);
+    std::unordered_map<std::string, std::string> plans;
+    {
+        std::lock_guard<std::mutex> lock(profilerMutex);
+        plans = planByFingerprint;
+    }
+
+    out << "\n=== 最慢的 " << top.size() << " 条语句（慢查询阈值 "
+        << getSlowQueryThreshold() << " ms） ===\n";
+    out << std::fixed << std::setprecision(1);
+    for (const auto& stats : top) {
+        out << "\n" << stats.fingerprint << "\n"
+            << "  调用 " << stats.calls << " 次, 返回 " << stats.rows << " 行, 平均 "
+            << stats.meanMicros() << " us"
+            << ", p50 " << std::min(stats.histogram.percentile(50), stats.maxMicros)
+            << " / p90 " << std::min(stats.histogram.percentile(90), stats.maxMicros)
+            << " / p99 " << std::min(stats.histogram.percentile(99), stats.maxMicros)
+            << " / max " << stats.maxMicros << " us\n";
+        auto plan = plans.find(stats.fingerprint);
+        if (plan != plans.end() && !plan->second.empty()) {
+            out << "  计划:\n";
+            size_t start = 0;
+            while (start <= plan->second.size()) {
+                size_t end = plan->second.find('\n', start);
+                if (end == std::string::npos) end = plan->second.size();
+                out << "    " << plan->second.substr(start, end - start) << "\n";
+                start = end + 1;
+            }
+        }
+    }
+    out << std::endl;
+}
+
+void QueryProfiler::reset() {
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    statsByFingerprint.clear();
+    planByFingerprint.clear();
+    slowQueries.clear();
+}
+
+std::string QueryProfiler::fingerprint(const char* sql) {
+    std::string out;
+    if (!sql) return out;
+
+    bool pendingSpace = false;
+    for (const char* c = sql; *c;) {
+        if (std::isspace(static_cast<unsigned char>(*c))) {
+            pendingSpace = !out.empty();
+            ++c;
+            continue;
+        }
+        if (c[0] == '-' && c[1] == '-') {
+            // 注释不参与指纹
+            while (*c && *c != '\n') ++c;
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (c[0] == '/' && c[1] == '*') {
+            c += 2;
+            while (*c && !(c[0] == '*' && c[1] == '/')) ++c;
+            if (*c) c += 2;
+            pendingSpace = !out.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            out += ' ';
+            pendingSpace = false;
+        }
+
+        if (*c == '\'') {
+            // 字符串字面量（'' 为转义的单引号）
+            ++c;
+            while (*c) {
+                if (*c == '\'' && c[1] == '\'') c += 2;
+                else if (*c == '\'') { ++c; break; }
+                else ++c;
+            }
+            out += '?';
+        } else if (std::isdigit(static_cast<unsigned char>(*c)) &&
+                   (out.empty() || !(std::isalnum(static_cast<unsigned char>(out.back())) || out.back() == '_'))) {
+            // 数字字面量；标识符中的数字（如 t1）保留
+            while (std::isalnum(static_cast<unsigned char>(*c)) || *c == '.') ++c;
+            out += '?';
+        } else {
+            out += *c++;
+        }
+    }
+
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) out.pop_back();
+    return out;
+}
@@ -0,0 +1,887 @@
+#include "database/SchemaMigrator.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+std::string replaceTable(std::string sql, const std::string& table) {
+    const std::string token = "$TABLE";
+    for (size_t pos = sql.find(token); pos != std::string::npos; pos = sql.find(token, pos)) {
+        sql.replace(pos, token.size(), table);
+        pos += table.size();
+    }
+    return sql;
+}
+
+std::string quoted(const std::string& identifier) {
+    return "\"" + identifier + "\"";
+}
+
+// ===== 各版本的表结构 =====
+
+// v1 的 tasks：project_id 默认 0，与外键约束冲突（v4 修正）
+const char* TASKS_V1 = R"(
+    CREATE TABLE IF NOT EXISTS $TABLE (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        created_date TEXT NOT NULL DEFAULT (datetime('now')),
+        updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+        title TEXT NOT NULL,
+        description TEXT,
+        priority INTEGER DEFAULT 1 CHECK(priority IN (0, 1, 2)),
+        due_date TEXT,
+        completed BOOLEAN DEFAULT 0,
+        tags TEXT,
+        project_id INTEGER DEFAULT 0,
+        pomodoro_count INTEGER DEFAULT 0,
+        estimated_pomodoros INTEGER DEFAULT 0,
+        completed_date TEXT,
+        reminder_time TEXT,
+        deleted BOOLEAN DEFAULT 0,
+        user_id INTEGER NOT NULL DEFAULT 1,
+        FOREIGN KEY (project_id) REFERENCES projects(id) ON DELETE SET NULL
+    );
+)";
+
+const char* TASKS_V4 = R"(
+    CREATE TABLE IF NOT EXISTS $TABLE (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        created_date TEXT NOT NULL DEFAULT (datetime('now')),
+        updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+        title TEXT NOT NULL,
+        description TEXT,
+        priority INTEGER DEFAULT 1 CHECK(priority IN (0, 1, 2)),
+        due_date TEXT,
+        completed BOOLEAN DEFAULT 0,
+        tags TEXT,
+        project_id INTEGER DEFAULT NULL,
+        pomodoro_count INTEGER DEFAULT 0,
+        estimated_pomodoros INTEGER DEFAULT 0,
+        completed_date TEXT,
+        reminder_time TEXT,
+        deleted BOOLEAN DEFAULT 0,
+        user_id INTEGER NOT NULL DEFAULT 1,
+        FOREIGN KEY (project_id) REFERENCES projects(id) ON DELETE SET NULL
+    );
+)";
+
+const std::vector<std::string> TASK_INDEXES = {
+    "CREATE INDEX IF NOT EXISTS idx_tasks_completed ON tasks(completed);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_priority ON tasks(priority);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_due_date ON tasks(due_date);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_project_id ON tasks(project_id);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_created_date ON tasks(created_date);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_deleted ON tasks(deleted);",
+    // 按用户分区的复合索引：所有统计/列表查询都以 user_id 打头
+    "CREATE INDEX IF NOT EXISTS idx_tasks_user_status ON tasks(user_id, completed, deleted, created_date);",
+    "CREATE INDEX IF NOT EXISTS idx_tasks_user_completed_date ON tasks(user_id, completed, completed_date);",
+};
+
+// v2 起 reminders 只有一种结构，与 SQLiteReminderDAO 的读写一致
+const char* REMINDERS_V2 = R"(
+    CREATE TABLE IF NOT EXISTS $TABLE (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        title TEXT NOT NULL,
+        message TEXT NOT NULL DEFAULT '',
+        trigger_time TEXT NOT NULL,
+        reminder_type INTEGER NOT NULL DEFAULT 0,
+        status INTEGER NOT NULL DEFAULT 0,
+        task_id INTEGER,
+        recurrence_rule TEXT NOT NULL DEFAULT '',
+        created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
+        updated_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
+        FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE CASCADE
+    );
+)";
+
+const std::vector<std::string> REMINDER_INDEXES = {
+    "CREATE INDEX IF NOT EXISTS idx_reminders_status_trigger ON reminders(status, trigger_time);",
+    "CREATE INDEX IF NOT EXISTS idx_reminders_trigger_time ON reminders(trigger_time);",
+    "CREATE INDEX IF NOT EXISTS idx_reminders_task_id ON reminders(task_id);",
+};
+
+const char* ACHIEVEMENTS_V3 = R"(
+    CREATE TABLE IF NOT EXISTS $TABLE (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        created_date TEXT NOT NULL DEFAULT (datetime('now')),
+        updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+        name TEXT NOT NULL,
+        description TEXT,
+        icon TEXT,
+        unlock_condition TEXT,
+        unlocked BOOLEAN DEFAULT 0,
+        unlocked_date TEXT,
+        reward_xp INTEGER DEFAULT 0,
+        category TEXT CHECK(category IN ('task', 'time', 'streak', 'special')),
+        progress INTEGER DEFAULT 0 CHECK(progress >= 0 AND progress <= 100),
+        target_value INTEGER DEFAULT 0,
+        user_id INTEGER NOT NULL DEFAULT 1,
+        UNIQUE (user_id, name)
+    );
+)";
+
+const std::vector<std::string> ACHIEVEMENT_INDEXES = {
+    "CREATE INDEX IF NOT EXISTS idx_achievements_unlocked ON achievements(unlocked);",
+    "CREATE INDEX IF NOT EXISTS idx_achievements_category ON achievements(category);",
+    "CREATE INDEX IF NOT EXISTS idx_achievements_user_unlocked ON achievements(user_id, unlocked);",
+};
+
+// ===== v1：引入版本号之前 DatabaseManager::createTables() 建出的全部表 =====
+
+bool baselineUsers(SchemaMigrator& m) {
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS users (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            username TEXT NOT NULL UNIQUE
+        );
+        INSERT OR IGNORE INTO users (id, username) VALUES (1, 'default');
+    )");
+}
+
+bool baselineTasks(SchemaMigrator& m) {
+    // HeatmapVisualizer 早期会自己建一张只有 4 列的 tasks，先整表补齐
+    if (m.tableExists("tasks") && !m.columnExists("tasks", "priority")) {
+        return m.rewriteTable("tasks", TASKS_V1, {}, TASK_INDEXES);
+    }
+    if (!m.exec(replaceTable(TASKS_V1, "tasks")) ||
+        !m.ensureColumn("tasks", "user_id", "INTEGER NOT NULL DEFAULT 1")) {
+        return false;
+    }
+    for (const auto& index : TASK_INDEXES) {
+        if (!m.exec(index)) return false;
+    }
+    return true;
+}
+
+bool baselineProjects(SchemaMigrator& m) {
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS projects (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            name TEXT NOT NULL,
+            description TEXT,
+            color_label TEXT DEFAULT '#3498db',
+            progress REAL DEFAULT 0.0 CHECK(progress >= 0.0 AND progress <= 1.0),
+            total_tasks INTEGER DEFAULT 0,
+            completed_tasks INTEGER DEFAULT 0,
+            target_date TEXT,
+            archived BOOLEAN DEFAULT 0
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_projects_archived ON projects(archived);
+        CREATE INDEX IF NOT EXISTS idx_projects_target_date ON projects(target_date);
+    )");
+}
+
+bool baselineChallenges(SchemaMigrator& m) {
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS challenges (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            title TEXT NOT NULL,
+            description TEXT,
+            type TEXT NOT NULL CHECK(type IN ('daily', 'weekly', 'monthly')),
+            criteria TEXT,
+            target_value INTEGER DEFAULT 0,
+            current_value INTEGER DEFAULT 0,
+            reward_xp INTEGER DEFAULT 0,
+            completed BOOLEAN DEFAULT 0,
+            claimed BOOLEAN DEFAULT 0,
+            expiry_date TEXT,
+            category TEXT CHECK(category IN ('task', 'pomodoro', 'project'))
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_challenges_type ON challenges(type);
+        CREATE INDEX IF NOT EXISTS idx_challenges_completed ON challenges(completed);
+        CREATE INDEX IF NOT EXISTS idx_challenges_category ON challenges(category);
+    )");
+}
+
+bool baselineReminders(SchemaMigrator& m) {
+    // 已有 SQLiteReminderDAO 建的表时保持原样，由 v2 统一
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS reminders (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            title TEXT NOT NULL,
+            message TEXT,
+            trigger_time TEXT NOT NULL,
+            recurrence TEXT DEFAULT 'once' CHECK(recurrence IN ('once', 'daily', 'weekly', 'monthly')),
+            triggered BOOLEAN DEFAULT 0,
+            task_id INTEGER,
+            enabled BOOLEAN DEFAULT 1,
+            last_triggered TEXT,
+            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE CASCADE
+        );
+    )")) {
+        return false;
+    }
+    if (!m.columnExists("reminders", "enabled")) return true;
+    return m.exec(R"(
+        CREATE INDEX IF NOT EXISTS idx_reminders_trigger_time ON reminders(trigger_time);
+        CREATE INDEX IF NOT EXISTS idx_reminders_enabled ON reminders(enabled);
+        CREATE INDEX IF NOT EXISTS idx_reminders_task_id ON reminders(task_id);
+    )");
+}
+
+bool baselineAchievements(SchemaMigrator& m) {
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS achievements (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            name TEXT NOT NULL UNIQUE,
+            description TEXT,
+            icon TEXT,
+            unlock_condition TEXT,
+            unlocked BOOLEAN DEFAULT 0,
+            unlocked_date TEXT,
+            reward_xp INTEGER DEFAULT 0,
+            category TEXT CHECK(category IN ('task', 'time', 'streak', 'special')),
+            progress INTEGER DEFAULT 0 CHECK(progress >= 0 AND progress <= 100),
+            target_value INTEGER DEFAULT 0,
+            user_id INTEGER NOT NULL DEFAULT 1
+        );
+    )") || !m.ensureColumn("achievements", "user_id", "INTEGER NOT NULL DEFAULT 1")) {
+        return false;
+    }
+    for (const auto& index : ACHIEVEMENT_INDEXES) {
+        if (!m.exec(index)) return false;
+    }
+    return true;
+}
+
+bool baselineUserStats(SchemaMigrator& m) {
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS user_stats (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            total_tasks_created INTEGER DEFAULT 0,
+            total_tasks_completed INTEGER DEFAULT 0,
+            total_pomodoros INTEGER DEFAULT 0,
+            current_streak INTEGER DEFAULT 0,
+            longest_streak INTEGER DEFAULT 0,
+            total_xp INTEGER DEFAULT 0,
+            level INTEGER DEFAULT 1,
+            last_active_date TEXT,
+            completion_rate REAL DEFAULT 0.0,
+            achievements_unlocked INTEGER DEFAULT 0,
+            user_id INTEGER NOT NULL DEFAULT 1
+        );
+    )") || !m.ensureColumn("user_stats", "user_id", "INTEGER NOT NULL DEFAULT 1")) {
+        return false;
+    }
+    // 每个用户一行统计；旧库中 id 即用户ID
+    return m.exec(R"(
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_user_stats_user_id ON user_stats(user_id);
+        INSERT OR IGNORE INTO user_stats (id, user_id, total_xp, level, current_streak, longest_streak)
+        VALUES (1, 1, 0, 1, 0, 0);
+    )");
+}
+
+bool baselineUserSettings(SchemaMigrator& m) {
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS user_settings (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
+            pomodoro_duration INTEGER DEFAULT 25,
+            short_break_duration INTEGER DEFAULT 5,
+            long_break_duration INTEGER DEFAULT 15,
+            pomodoros_until_long_break INTEGER DEFAULT 4,
+            sound_enabled BOOLEAN DEFAULT 1,
+            notifications_enabled BOOLEAN DEFAULT 1,
+            theme TEXT DEFAULT 'default',
+            language TEXT DEFAULT 'zh',
+            auto_start_pomodoros BOOLEAN DEFAULT 0
+        );
+    )");
+}
+
+bool baselinePomodoros(SchemaMigrator& m) {
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS pomodoro_sessions (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            task_id INTEGER,
+            start_time TEXT NOT NULL,
+            end_time TEXT,
+            duration INTEGER,  -- 单位：分钟
+            completed BOOLEAN DEFAULT 0,
+            interrupted BOOLEAN DEFAULT 0,
+            interruption_reason TEXT,
+            session_type TEXT NOT NULL DEFAULT 'work',
+            user_id INTEGER NOT NULL DEFAULT 1,
+            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE SET NULL
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_pomodoro_task_id ON pomodoro_sessions(task_id);
+        CREATE INDEX IF NOT EXISTS idx_pomodoro_start_time ON pomodoro_sessions(start_time);
+        CREATE INDEX IF NOT EXISTS idx_pomodoro_completed ON pomodoro_sessions(completed);
+    )") ||
+        !m.ensureColumn("pomodoro_sessions", "session_type", "TEXT NOT NULL DEFAULT 'work'") ||
+        !m.ensureColumn("pomodoro_sessions", "user_id", "INTEGER NOT NULL DEFAULT 1")) {
+        return false;
+    }
+    return m.exec("CREATE INDEX IF NOT EXISTS idx_pomodoro_user_start ON pomodoro_sessions(user_id, start_time);");
+}
+
+bool baselineLeaderboard(SchemaMigrator& m) {
+    // 排行榜名次快照；没有读取方，v11 删除
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS leaderboard_snapshot (
+            user_id INTEGER PRIMARY KEY,
+            rank INTEGER NOT NULL,
+            total_xp INTEGER NOT NULL,
+            level INTEGER NOT NULL,
+            updated_date TEXT NOT NULL DEFAULT (datetime('now'))
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_leaderboard_rank ON leaderboard_snapshot(rank);
+    )");
+}
+
+bool baselineXPLedger(SchemaMigrator& m) {
+    // 经验值流水（只追加）与按用户的累计快照，由 XPLedger 写入
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS xp_events (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            user_id INTEGER NOT NULL DEFAULT 1,
+            amount INTEGER NOT NULL,
+            source TEXT NOT NULL,
+            description TEXT,
+            created_date TEXT NOT NULL DEFAULT (datetime('now'))
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_xp_events_user_id ON xp_events(user_id, id);
+        CREATE INDEX IF NOT EXISTS idx_xp_events_user_date ON xp_events(user_id, created_date);
+
+        CREATE TABLE IF NOT EXISTS xp_snapshots (
+            user_id INTEGER NOT NULL,
+            last_event_id INTEGER NOT NULL,
+            total_xp INTEGER NOT NULL,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            PRIMARY KEY (user_id, last_event_id)
+        ) WITHOUT ROWID;
+
+        -- 引入流水账之前已有的经验值记为期初快照，保证重放结果与 user_stats 一致
+        INSERT INTO xp_snapshots (user_id, last_event_id, total_xp)
+        SELECT user_id, 0, total_xp FROM user_stats
+        WHERE total_xp > 0
+          AND user_id NOT IN (SELECT user_id FROM xp_snapshots)
+          AND user_id NOT IN (SELECT user_id FROM xp_events);
+    )");
+}
+
+bool baseline(SchemaMigrator& m) {
+    return baselineUsers(m) && baselineTasks(m) && baselineProjects(m) &&
+           baselineChallenges(m) && baselineReminders(m) && baselineAchievements(m) &&
+           baselineUserStats(m) && baselineUserSettings(m) && baselinePomodoros(m) &&
+           baselineLeaderboard(m) && baselineXPLedger(m);
+}
+
+// ===== v2 起的增量步骤 =====
+
+bool unifyReminders(SchemaMigrator& m) {
+    // 两种旧结构：DatabaseManager 的 recurrence/triggered/enabled，
+    // 以及 SQLiteReminderDAO 的 reminder_type/status/recurrence_rule（列名与新表一致）
+    std::map<std::string, std::string> expressions = {
+        {"task_id", "NULLIF(task_id, 0)"},
+    };
+    if (m.tableExists("reminders") && m.columnExists("reminders", "triggered")) {
+        expressions["message"] = "COALESCE(message, '')";
+        expressions["reminder_type"] =
+            "CASE recurrence WHEN 'daily' THEN 1 WHEN 'weekly' THEN 2 WHEN 'monthly' THEN 3 ELSE 0 END";
+        expressions["status"] = "CASE WHEN enabled = 0 THEN 3 WHEN triggered = 1 THEN 1 ELSE 0 END";
+        expressions["recurrence_rule"] =
+            "CASE WHEN recurrence IN ('daily', 'weekly', 'monthly') THEN recurrence ELSE '' END";
+        expressions["created_at"] = "created_date";
+        expressions["updated_at"] = "updated_date";
+    }
+    return m.rewriteTable("reminders", REMINDERS_V2, expressions, REMINDER_INDEXES);
+}
+
+bool achievementsPerUser(SchemaMigrator& m) {
+    // name 全局唯一让多用户无法各自解锁同名成就，改为 (user_id, name) 唯一
+    return m.rewriteTable("achievements", ACHIEVEMENTS_V3, {}, ACHIEVEMENT_INDEXES);
+}
+
+bool tasksNullableProject(SchemaMigrator& m) {
+    // project_id 默认 0 会违反外键；无项目统一存 NULL
+    return m.rewriteTable("tasks", TASKS_V4, {{"project_id", "NULLIF(project_id, 0)"}}, TASK_INDEXES);
+}
+
+bool taskDependencies(SchemaMigrator& m) {
+    // 任务前置依赖：depends_on 完成后 task_id 才能开始，由 TaskManager 的 DependencyGraph 维护
+    return m.exec(R"(
+        CREATE TABLE IF NOT EXISTS task_dependencies (
+            task_id INTEGER NOT NULL REFERENCES tasks(id) ON DELETE CASCADE,
+            depends_on INTEGER NOT NULL REFERENCES tasks(id) ON DELETE CASCADE,
+            created_date TEXT NOT NULL DEFAULT (datetime('now')),
+            PRIMARY KEY (task_id, depends_on),
+            CHECK (task_id <> depends_on)
+        ) WITHOUT ROWID;
+
+        CREATE INDEX IF NOT EXISTS idx_task_dependencies_depends_on ON task_dependencies(depends_on, task_id);
+    )");
+}
+
+bool taskTags(SchemaMigrator& m) {
+    // 规范化的标签：tags 表给每个名称一个固定 ID，task_tags 为任务与标签的多对多关系；
+    // tasks.tags 仍保留逗号分隔的副本，由 TaskDAO::setTaskTags 同步写入
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS tags (
+            id INTEGER PRIMARY KEY,
+            name TEXT NOT NULL UNIQUE
+        );
+
+        CREATE TABLE IF NOT EXISTS task_tags (
+            task_id INTEGER NOT NULL REFERENCES tasks(id) ON DELETE CASCADE,
+            tag_id INTEGER NOT NULL REFERENCES tags(id) ON DELETE CASCADE,
+            PRIMARY KEY (task_id, tag_id)
+        ) WITHOUT ROWID;
+
+        CREATE INDEX IF NOT EXISTS idx_task_tags_tag ON task_tags(tag_id, task_id);
+    )")) {
+        return false;
+    }
+
+    // 把已有的逗号分隔标签拆开导入（名称去空白、转小写，与 TagIndex::normalize 一致）
+    return m.exec(R"(
+        CREATE TEMP TABLE migrate_task_tags AS
+        WITH RECURSIVE split(task_id, tag, rest) AS (
+            SELECT id, '', tags || ',' FROM tasks WHERE tags IS NOT NULL AND tags <> ''
+            UNION ALL
+            SELECT task_id,
+                   lower(trim(substr(rest, 1, instr(rest, ',') - 1))),
+                   substr(rest, instr(rest, ',') + 1)
+            FROM split WHERE rest <> ''
+        )
+        SELECT DISTINCT task_id, tag FROM split WHERE tag <> '';
+
+        INSERT OR IGNORE INTO tags (name) SELECT DISTINCT tag FROM migrate_task_tags ORDER BY tag;
+        INSERT OR IGNORE INTO task_tags (task_id, tag_id)
+            SELECT mt.task_id, t.id FROM migrate_task_tags mt JOIN tags t ON t.name = mt.tag;
+
+        DROP TABLE migrate_task_tags;
+    )");
+}
+
+bool hotQueryIndexes(SchemaMigrator& m) {
+    // 按 TaskDAO 的热点语句设计（check-plans 会检查它们不再全表扫描或临时排序）：
+    // - 部分索引只收 deleted = 0 的行，查询里的 deleted = 0 正好命中，索引更小
+    // - 等值列在前、ORDER BY 列在后，按索引顺序读出即有序，不再排序
+    // - 排程加载只读数值列，整条查询由索引覆盖
+    const std::vector<std::string> indexes = {
+        // getAllTasks / countAllTasks
+        "CREATE INDEX IF NOT EXISTS idx_tasks_live_user_created ON tasks(user_id, created_date) "
+        "WHERE deleted = 0;",
+        // getTasksByProject
+        "CREATE INDEX IF NOT EXISTS idx_tasks_live_project_created ON tasks(project_id, user_id, created_date) "
+        "WHERE deleted = 0;",
+        // getTodayTasks：due_date 等值后按 created_date 有序
+        "CREATE INDEX IF NOT EXISTS idx_tasks_live_user_due ON tasks(user_id, due_date, created_date) "
+        "WHERE deleted = 0;",
+        // getOverdueTasks 按 due_date 范围有序读取；loadScheduleEntries 覆盖
+        "CREATE INDEX IF NOT EXISTS idx_tasks_open_user_due ON tasks(user_id, due_date, priority, project_id, "
+        "estimated_pomodoros, pomodoro_count) WHERE completed = 0 AND deleted = 0;",
+    };
+    for (const auto& index : indexes) {
+        if (!m.createIndex(index)) return false;
+    }
+
+    // 布尔列上的单列索引选择性太低，复合索引建好后不会再被选中，只增加写入开销
+    if (!m.exec("DROP INDEX IF EXISTS idx_tasks_completed;") ||
+        !m.exec("DROP INDEX IF EXISTS idx_tasks_deleted;")) {
+        return false;
+    }
+    // 库里已有统计信息时补上新索引的，否则规划器按过期的统计选索引
+    return !m.tableExists("sqlite_stat1") || m.exec("ANALYZE tasks;");
+}
+
+bool taskArchive(SchemaMigrator& m) {
+    // 归档分区：TaskArchiver 把早已完成或已软删除的任务整行搬到 tasks_archive（ID 不变，
+    // AUTOINCREMENT 保证不会被新任务复用），同时按 (用户, 完成状态, 完成日期) 累加进 task_rollups。
+    // 统计查询读 task_history 视图，它把活跃任务与汇总行拼在一起，归档前后结果一致
+    if (!m.exec(R"(
+        CREATE TABLE IF NOT EXISTS tasks_archive (
+            id INTEGER PRIMARY KEY,
+            created_date TEXT NOT NULL,
+            updated_date TEXT NOT NULL,
+            title TEXT NOT NULL,
+            description TEXT,
+            priority INTEGER,
+            due_date TEXT,
+            completed BOOLEAN,
+            tags TEXT,
+            project_id INTEGER,
+            pomodoro_count INTEGER,
+            estimated_pomodoros INTEGER,
+            completed_date TEXT,
+            reminder_time TEXT,
+            deleted BOOLEAN,
+            user_id INTEGER NOT NULL,
+            archived_date TEXT NOT NULL DEFAULT (datetime('now'))
+        );
+
+        CREATE INDEX IF NOT EXISTS idx_tasks_archive_user ON tasks_archive(user_id, archived_date);
+
+        -- day 为完成日期（YYYY-MM-DD），没有完成日期时为空串
+        CREATE TABLE IF NOT EXISTS task_rollups (
+            user_id INTEGER NOT NULL,
+            completed INTEGER NOT NULL,
+            day TEXT NOT NULL,
+            task_count INTEGER NOT NULL DEFAULT 0,
+            pomodoro_count INTEGER NOT NULL DEFAULT 0,
+            first_created TEXT NOT NULL,
+            PRIMARY KEY (user_id, completed, day)
+        ) WITHOUT ROWID;
+
+        -- 每行代表 task_count 个任务：统计用 SUM(task_count) 代替 COUNT(*)
+        CREATE VIEW IF NOT EXISTS task_history AS
+            SELECT user_id, completed, DATE(completed_date) AS completed_day,
+                   created_date, pomodoro_count, 1 AS task_count
+            FROM tasks
+            UNION ALL
+            SELECT user_id, completed, NULLIF(day, ''), first_created, pomodoro_count, task_count
+            FROM task_rollups;
+    )")) {
+        return false;
+    }
+
+    // 归档候选：两类行在活跃表里都应当很少，部分索引只收它们，按时间有序取一批
+    return m.createIndex("CREATE INDEX IF NOT EXISTS idx_tasks_deleted_updated ON tasks(updated_date) "
+                         "WHERE deleted = 1;") &&
+           m.createIndex("CREATE INDEX IF NOT EXISTS idx_tasks_done_completed_date ON tasks(completed_date) "
+                         "WHERE completed = 1 AND deleted = 0;");
+}
+
+bool projectsPerUser(SchemaMigrator& m) {
+    // 守护进程按连接身份隔离项目；已有项目归默认用户
+    return m.ensureColumn("projects", "user_id", "INTEGER NOT NULL DEFAULT 1") &&
+           m.createIndex("CREATE INDEX IF NOT EXISTS idx_projects_user_archived ON projects(user_id, archived);");
+}
+
+bool dependencyChangeTriggers(SchemaMigrator& m) {
+    // task_dependencies 是 WITHOUT ROWID 表，ChangeFeed 的行钩子看不到它；
+    // 依赖增删时顺带更新后继任务的 tasks 行，订阅 tasks 的缓存就能得知
+    return m.exec(R"(
+        CREATE TRIGGER IF NOT EXISTS task_dependencies_touch_ins AFTER INSERT ON task_dependencies BEGIN
+            UPDATE tasks SET updated_date = datetime('now') WHERE id = NEW.task_id;
+        END;
+        CREATE TRIGGER IF NOT EXISTS task_dependencies_touch_del AFTER DELETE ON task_dependencies BEGIN
+            UPDATE tasks SET updated_date = datetime('now') WHERE id = OLD.task_id;
+        END;
+    )");
+}
+
+bool dropLeaderboardSnapshot(SchemaMigrator& m) {
+    // 排行榜启动时从 user_stats 重建，快照从未被读取，每次写入都是浪费
+    return m.exec("DROP TABLE IF EXISTS leaderboard_snapshot;");
+}
+
+} // namespace
+
+// === SchemaMigrator ===
+
+SchemaMigrator::SchemaMigrator(sqlite3* db) : db(db) {}
+
+const std::vector<Migration>& SchemaMigrator::migrations() {
+    // 只能在末尾追加；已发布的步骤不要再修改
+    static const std::vector<Migration> steps = {
+        {1, "基础表结构", baseline, true},
+        {2, "统一 reminders 表结构", unifyReminders, false},
+        {3, "成就按 (user_id, name) 唯一", achievementsPerUser, false},
+        {4, "tasks.project_id 无项目时存 NULL", tasksNullableProject, false},
+        {5, "任务依赖关系", taskDependencies, true},
+        {6, "任务标签表", taskTags, true},
+        {7, "热点查询的复合/部分索引", hotQueryIndexes, false},
+        {8, "任务归档表与统计汇总", taskArchive, false},
+        {9, "项目按用户划分", projectsPerUser, true},
+        {10, "依赖变更触发任务行更新", dependencyChangeTriggers, true},
+        {11, "删除排行榜快照表", dropLeaderboardSnapshot, true},
+    };
+    return steps;
+}
+
+int SchemaMigrator::latestVersion() {
+    return migrations().back().version;
+}
+
+int SchemaMigrator::currentVersion() {
+    return static_cast<int>(queryInt("PRAGMA user_version;"));
+}
+
+bool SchemaMigrator::migrate(int targetVersion) {
+    if (!db) return false;
+    if (targetVersion < 0) targetVersion = latestVersion();
+
+    int version = currentVersion();
+    if (version >= targetVersion) return true;
+
+    TRACE_SCOPE("db", "SchemaMigrator::migrate");
+
+    // 表重写要 DROP 旧表，外键开着会触发级联删除；这个开关在事务里改不了
+    bool restoreForeignKeys = !inTransaction() && queryInt("PRAGMA foreign_keys;") == 1;
+    if (restoreForeignKeys) exec("PRAGMA foreign_keys = OFF;");
+
+    bool ok = true;
+    for (const auto& step : migrations()) {
+        if (step.version <= version || step.version > targetVersion) continue;
+
+        auto start = std::chrono::steady_clock::now();
+        if (step.transactional) {
+            ok = begin() && step.apply(*this) && setVersion(step.version) && commit();
+            if (!ok) rollback();
+        } else {
+            ok = step.apply(*this) && setVersion(step.version);
+        }
+        if (!ok) {
+            std::cerr << "数据库迁移到 v" << step.version << " 失败（" << step.description << "）" << std::endl;
+            break;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "数据库迁移: v" << step.version << " " << step.description
+                  << " (" << elapsed << " ms)" << std::endl;
+    }
+
+    if (restoreForeignKeys) exec("PRAGMA foreign_keys = ON;");
+    return ok;
+}
+
+bool SchemaMigrator::exec(const std::string& sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "迁移语句执行失败: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+long long SchemaMigrator::queryInt(const std::string& sql) {
+    long long value = 0;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return value;
+}
+
+bool SchemaMigrator::tableExists(const std::string& table) {
+    bool exists = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;",
+                           -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        exists = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+    }
+    return exists;
+}
+
+std::vector<std::string> SchemaMigrator::columns(const std::string& table) {
+    std::vector<std::string> names;
+    sqlite3_stmt* stmt = nullptr;
+    std::string sql = "PRAGMA table_info(" + quoted(table) + ");";
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+        }
+        sqlite3_finalize(stmt);
+    }
+    return names;
+}
+
+bool SchemaMigrator::columnExists(const std::string& table, const std::string& column) {
+    auto names = columns(table);
+    return std::find(names.begin(), names.end(), column) != names.end();
+}
+
+bool SchemaMigrator::ensureColumn(const std::string& table, const std::string& column,
+                                  const std::string& definition) {
+    if (columnExists(table, column)) return true;
+    return exec("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";");
+}
+
+bool SchemaMigrator::inTransaction() const {
+    return sqlite3_get_autocommit(db) == 0;
+}
+
+bool SchemaMigrator::begin() {
+    // 其他连接正在写时稍等重试，而不是让整个迁移失败
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        int rc = sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr);
+        if (rc == SQLITE_OK) return true;
+        if (rc != SQLITE_BUSY && rc != SQLITE_LOCKED) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    }
+    std::cerr << "无法开始迁移事务: " << sqlite3_errmsg(db) << std::endl;
+    return false;
+}
+
+bool SchemaMigrator::commit() {
+    return exec("COMMIT;");
+}
+
+void SchemaMigrator::rollback() {
+    if (inTransaction()) {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+}
+
+bool SchemaMigrator::setVersion(int version) {
+    return exec("PRAGMA user_version = " + std::to_string(version) + ";");
+}
+
+bool SchemaMigrator::createIndex(const std::string& sql) {
+    if (inTransaction()) return exec(sql);
+    bool ok = begin() && exec(sql) && commit();
+    if (!ok) rollback();
+    return ok;
+}
+
+bool SchemaMigrator::rewriteTable(const std::string& table, const std::string& createSql,
+                                  const std::map<std::string, std::string>& expressions,
+                                  const std::vector<std::string>& indexes) {
+    TRACE_SCOPE_DETAIL("db", "SchemaMigrator::rewriteTable", table);
+
+    if (!tableExists(table)) {
+        if (!exec(replaceTable(createSql, table))) return false;
+        for (const auto& index : indexes) {
+            if (!createIndex(index)) return false;
+        }
+        return true;
+    }
+
+    const bool chunked = !inTransaction();
+    const std::string shadow = table + "__migrating";
+    const std::string dropTriggers =
+        "DROP TRIGGER IF EXISTS " + shadow + "_ins; "
+        "DROP TRIGGER IF EXISTS " + shadow + "_upd; "
+        "DROP TRIGGER IF EXISTS " + shadow + "_del; ";
+
+    // 上次中断留下的影子表从头再来
+    if (!exec(dropTriggers + "DROP TABLE IF EXISTS " + shadow + ";") ||
+        !exec(replaceTable(createSql, shadow))) {
+        return false;
+    }
+
+    // 新表每一列的取值：显式表达式 > 旧表同名列 > 新表默认值
+    std::vector<std::string> oldColumns = columns(table);
+    std::string columnList;
+    std::string selectList;
+    for (const auto& column : columns(shadow)) {
+        std::string expression;
+        auto it = expressions.find(column);
+        if (it != expressions.end()) {
+            expression = it->second;
+        } else if (std::find(oldColumns.begin(), oldColumns.end(), column) != oldColumns.end()) {
+            expression = quoted(column);
+        } else {
+            continue;
+        }
+        columnList += (columnList.empty() ? "" : ", ") + quoted(column);
+        selectList += (selectList.empty() ? "" : ", ") + expression;
+    }
+    const std::string copySelect =
+        "INSERT OR REPLACE INTO " + shadow + " (" + columnList + ") SELECT " + selectList + " FROM " + table;
+
+    if (chunked) {
+        // 复制期间旧表上的写入由触发器同步到影子表，其他连接照常读写
+        std::ostringstream triggers;
+        triggers << "CREATE TRIGGER " << shadow << "_ins AFTER INSERT ON " << table << " BEGIN "
+                 << copySelect << " WHERE rowid = NEW.rowid; END; "
+                 << "CREATE TRIGGER " << shadow << "_upd AFTER UPDATE ON " << table << " BEGIN "
+                 << "DELETE FROM " << shadow << " WHERE rowid = OLD.rowid; "
+                 << copySelect << " WHERE rowid = NEW.rowid; END; "
+                 << "CREATE TRIGGER " << shadow << "_del AFTER DELETE ON " << table << " BEGIN "
+                 << "DELETE FROM " << shadow << " WHERE rowid = OLD.rowid; END;";
+        if (!exec(triggers.str())) return false;
+
+        // 已被触发器写过的行更新，OR IGNORE 保留触发器的版本
+        std::string chunkSql = "INSERT OR IGNORE" + copySelect.substr(std::string("INSERT OR REPLACE").size()) +
+                               " WHERE rowid > ?1 AND rowid <= ?2;";
+        std::string boundSql = "SELECT max(rowid) FROM (SELECT rowid FROM " + table +
+                               " WHERE rowid > ?1 ORDER BY rowid LIMIT ?2);";
+        sqlite3_stmt* copyStmt = nullptr;
+        sqlite3_stmt* boundStmt = nullptr;
+        if (sqlite3_prepare_v2(db, chunkSql.c_str(), -1, &copyStmt, nullptr) != SQLITE_OK ||
+            sqlite3_prepare_v2(db, boundSql.c_str(), -1, &boundStmt, nullptr) != SQLITE_OK) {
+            std::cerr << "准备复制语句失败: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_finalize(copyStmt);
+            sqlite3_finalize(boundStmt);
+            return false;
+        }
+
+        bool ok = true;
+        long long copied = 0;
+        sqlite3_int64 last = LLONG_MIN;
+        while (ok) {
+            if (!begin()) {
+                ok = false;
+                break;
+            }
+            sqlite3_bind_int64(boundStmt, 1, last);
+            sqlite3_bind_int(boundStmt, 2, chunkRows);
+            bool more = sqlite3_step(boundStmt) == SQLITE_ROW && sqlite3_column_type(boundStmt, 0) != SQLITE_NULL;
+            sqlite3_int64 upper = more ? sqlite3_column_int64(boundStmt, 0) : last;
+            sqlite3_reset(boundStmt);
+
+            if (more) {
+                sqlite3_bind_int64(copyStmt, 1, last);
+                sqlite3_bind_int64(copyStmt, 2, upper);
+                ok = sqlite3_step(copyStmt) == SQLITE_DONE;
+                copied += sqlite3_changes(db);
+                sqlite3_reset(copyStmt);
+            }
+            if (!ok) {
+                std::cerr << "复制 " << table << " 失败: " << sqlite3_errmsg(db) << std::endl;
+                rollback();
+                break;
+            }
+            ok = commit();
+            last = upper;
+            if (!more) break;
+        }
+        sqlite3_finalize(copyStmt);
+        sqlite3_finalize(boundStmt);
+
+        if (!ok) {
+            exec(dropTriggers + "DROP TABLE IF EXISTS " + shadow + ";");
+            return false;
+        }
+        std::cout << "  " << table << ": 已复制 " << copied << " 行" << std::endl;
+    } else if (!exec(copySelect + ";")) {
+        return false;
+    }
+
+    // 换表只需要一个很短的事务；旧表的索引随 DROP TABLE 一起删除
+    bool swapped = (!chunked || begin()) &&
+                   exec(dropTriggers + "DROP TABLE " + table + "; ALTER TABLE " + shadow + " RENAME TO " + table + ";") &&
+                   (!chunked || commit());
+    if (!swapped) {
+        if (chunked) rollback();
+        return false;
+    }
+
+    // 索引逐个建立，每个一个事务；期间表可读写，只是暂时没有索引
+    for (const auto& index : indexes) {
+        if (!createIndex(index)) return false;
+    }
+    return true;
+}
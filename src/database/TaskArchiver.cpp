@@ -0,0 +1,148 @@
+#include "database/TaskArchiver.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <string>
+
+namespace {
+    const char* SQL_CREATE_BATCH =
+        "CREATE TEMP TABLE IF NOT EXISTS archive_batch (id INTEGER PRIMARY KEY);";
+    const char* SQL_CLEAR_BATCH =
+        "DELETE FROM temp.archive_batch;";
+    // 两类候选分别走 idx_tasks_deleted_updated / idx_tasks_done_completed_date，按时间先后取
+    const char* SQL_DELETED_CANDIDATES = R"(
+        SELECT id FROM tasks
+        WHERE deleted = 1 AND updated_date < datetime('now', ?1)
+        ORDER BY updated_date LIMIT ?2
+    )";
+    const char* SQL_COMPLETED_CANDIDATES = R"(
+        SELECT id FROM tasks
+        WHERE completed = 1 AND deleted = 0 AND completed_date < datetime('now', ?1)
+        ORDER BY completed_date LIMIT ?2
+    )";
+    const std::string SQL_PICK_PREFIX = "INSERT OR IGNORE INTO temp.archive_batch (id) ";
+    const char* SQL_ROLLUP = R"(
+        INSERT INTO task_rollups (user_id, completed, day, task_count, pomodoro_count, first_created)
+        SELECT user_id, COALESCE(completed, 0), COALESCE(DATE(completed_date), ''),
+               COUNT(*), COALESCE(SUM(pomodoro_count), 0), MIN(created_date)
+        FROM tasks
+        WHERE id IN (SELECT id FROM temp.archive_batch)
+        GROUP BY 1, 2, 3
+        ON CONFLICT (user_id, completed, day) DO UPDATE SET
+            task_count = task_count + excluded.task_count,
+            pomodoro_count = pomodoro_count + excluded.pomodoro_count,
+            first_created = MIN(first_created, excluded.first_created)
+    )";
+    const char* SQL_COPY = R"(
+        INSERT INTO tasks_archive (id, created_date, updated_date, title, description, priority, due_date,
+                                   completed, tags, project_id, pomodoro_count, estimated_pomodoros,
+                                   completed_date, reminder_time, deleted, user_id)
+        SELECT id, created_date, updated_date, title, description, priority, due_date,
+               completed, tags, project_id, pomodoro_count, estimated_pomodoros,
+               completed_date, reminder_time, deleted, user_id
+        FROM tasks
+        WHERE id IN (SELECT id FROM temp.archive_batch)
+    )";
+    const char* SQL_DELETE =
+        "DELETE FROM tasks WHERE id IN (SELECT id FROM temp.archive_batch);";
+
+    bool isQuiet(int rc) {
+        return rc == SQLITE_BUSY || rc == SQLITE_LOCKED || rc == SQLITE_INTERRUPT;
+    }
+
+    std::string ageModifier(int days) {
+        return "-" + std::to_string(days) + " days";
+    }
+}
+
+bool TaskArchiver::exec(const char* sql) {
+    char* errMsg = nullptr;
+    lastCode = sqlite3_exec(db, sql, nullptr, nullptr, &errMsg);
+    if (lastCode != SQLITE_OK && !isQuiet(lastCode)) {
+        std::cerr << "归档语句执行失败: " << (errMsg ? errMsg : sqlite3_errstr(lastCode)) << std::endl;
+    }
+    sqlite3_free(errMsg);
+    return lastCode == SQLITE_OK;
+}
+
+int TaskArchiver::archiveChunk(const ArchivePolicy& policy) {
+    TRACE_SCOPE("db", "TaskArchiver::archiveChunk");
+    lastCode = SQLITE_OK;
+    if (!db) return -1;
+
+    // 删除靠外键级联清理子表，没开外键会留下指向不存在任务的标签、依赖和提醒
+    sqlite3_stmt* stmt = nullptr;
+    bool foreignKeys = false;
+    if (sqlite3_prepare_v2(db, "PRAGMA foreign_keys;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        foreignKeys = sqlite3_column_int(stmt, 0) == 1;
+    }
+    sqlite3_finalize(stmt);
+    if (!foreignKeys) {
+        std::cerr << "TaskArchiver: 连接未开启 foreign_keys，拒绝归档" << std::endl;
+        lastCode = SQLITE_MISUSE;
+        return -1;
+    }
+
+    if (!exec(SQL_CREATE_BATCH) || !exec("SAVEPOINT archive_chunk;")) return -1;
+
+    auto fail = [this]() {
+        int code = lastCode;
+        sqlite3_exec(db, "ROLLBACK TO archive_chunk; RELEASE archive_chunk;", nullptr, nullptr, nullptr);
+        lastCode = code;
+        return -1;
+    };
+
+    if (!exec(SQL_CLEAR_BATCH)) return fail();
+
+    int picked = 0;
+    const std::pair<const char*, int> sources[] = {
+        {SQL_DELETED_CANDIDATES, policy.deletedAfterDays},
+        {SQL_COMPLETED_CANDIDATES, policy.completedAfterDays},
+    };
+    for (const auto& [candidates, days] : sources) {
+        if (days < 0 || picked >= policy.chunkSize) continue;
+        std::string sql = SQL_PICK_PREFIX + candidates;
+        std::string age = ageModifier(days);
+        stmt = nullptr;
+        lastCode = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+        if (lastCode == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, age.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 2, policy.chunkSize - picked);
+            lastCode = sqlite3_step(stmt);
+            if (lastCode == SQLITE_DONE) lastCode = SQLITE_OK;
+        }
+        if (lastCode != SQLITE_OK && !isQuiet(lastCode)) {
+            std::cerr << "选取归档任务失败: " << sqlite3_errmsg(db) << std::endl;
+        }
+        sqlite3_finalize(stmt);
+        if (lastCode != SQLITE_OK) return fail();
+        picked += sqlite3_changes(db);
+    }
+
+    if (picked == 0) {
+        exec("RELEASE archive_chunk;");
+        return 0;
+    }
+    if (!exec(SQL_ROLLUP) || !exec(SQL_COPY) || !exec(SQL_DELETE) || !exec("RELEASE archive_chunk;")) {
+        return fail();
+    }
+    return picked;
+}
+
+long long TaskArchiver::archiveAll(const ArchivePolicy& policy) {
+    long long total = 0;
+    while (true) {
+        int moved = archiveChunk(policy);
+        if (moved < 0) return -1;
+        total += moved;
+        if (moved < policy.chunkSize) return total;
+    }
+}
+
+std::vector<PlannedQuery> TaskArchiver::queryCatalog() {
+    // 临时表只在归档连接上存在，这里只检查选取候选的 SELECT
+    return {
+        {"TaskArchiver::deletedCandidates", SQL_DELETED_CANDIDATES},
+        {"TaskArchiver::completedCandidates", SQL_COMPLETED_CANDIDATES},
+    };
+}
@@ -0,0 +1,291 @@
+#include "database/WriteQueue.h"
+#include "database/DatabaseManager.h"
+#include "database/ChangeFeed.h"
+#include "metrics/Metrics.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <algorithm>
+#include <sqlite3.h>
+
+std::unique_ptr<WriteQueue> WriteQueue::instance = nullptr;
+std::mutex WriteQueue::instanceMutex;
+
+namespace {
+
+std::future<bool> readyFuture(bool value) {
+    std::promise<bool> promise;
+    promise.set_value(value);
+    return promise.get_future();
+}
+
+bool execute(sqlite3* db, const char* sql) {
+    char* error = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &error) == SQLITE_OK) return true;
+    std::cerr << "WriteQueue: 执行 " << sql << " 失败: " << (error ? error : sqlite3_errmsg(db)) << std::endl;
+    sqlite3_free(error);
+    return false;
+}
+
+bool executeParameterized(sqlite3* db, const std::string& sql, const std::vector<std::string>& params) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "WriteQueue: 准备参数化SQL失败: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_text(stmt, static_cast<int>(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+    }
+    int result = sqlite3_step(stmt);
+    bool success = result == SQLITE_DONE || result == SQLITE_ROW;
+    if (!success) {
+        std::cerr << "WriteQueue: 执行参数化SQL失败: " << sqlite3_errmsg(db) << std::endl;
+    }
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+bool runWork(const WriteQueue::Work& work, sqlite3* db) {
+    try {
+        return work(db);
+    } catch (const std::exception& e) {
+        std::cerr << "WriteQueue: 写入抛出异常: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "WriteQueue: 写入抛出未知异常" << std::endl;
+    }
+    return false;
+}
+
+} // namespace
+
+WriteQueue& WriteQueue::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<WriteQueue>();
+    }
+    return *instance;
+}
+
+void WriteQueue::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+WriteQueue::~WriteQueue() {
+    stop();
+}
+
+bool WriteQueue::start(const WriteQueueOptions& opts) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (running) return true;
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        std::cerr << "WriteQueue: 数据库尚未打开" << std::endl;
+        return false;
+    }
+    if (sqlite3_open_v2(db.getDatabasePath().c_str(), &conn,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::cerr << "WriteQueue: 无法打开写入连接: " << sqlite3_errmsg(conn) << std::endl;
+        sqlite3_close(conn);
+        conn = nullptr;
+        return false;
+    }
+    // 与共享连接相同的等待和约束设置
+    sqlite3_busy_timeout(conn, 5000);
+    execute(conn, "PRAGMA foreign_keys = ON;");
+    execute(conn, "PRAGMA synchronous = NORMAL;");
+    ChangeFeed::getInstance().attach(conn);
+
+    options = opts;
+    options.maxBatchOps = std::max<size_t>(1, options.maxBatchOps);
+    options.maxQueueDepth = std::max(options.maxBatchOps, options.maxQueueDepth);
+    stopRequested = false;
+
+    MetricsRegistry::getInstance().addCollector("write_queue", [this](std::ostream& out) {
+        Stats s = getStats();
+        MetricsRegistry::writeHeader(out, "taskmgr_write_queue_batches_total",
+                                     "Group-committed write batches", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_write_queue_batches_total", "", static_cast<double>(s.batches));
+        const char* ops = "taskmgr_write_queue_ops_total";
+        MetricsRegistry::writeHeader(out, ops, "Writes executed by the write queue", "counter");
+        MetricsRegistry::writeSample(out, ops, "result=\"ok\"", static_cast<double>(s.ops - s.failedOps));
+        MetricsRegistry::writeSample(out, ops, "result=\"failed\"", static_cast<double>(s.failedOps));
+        MetricsRegistry::writeHeader(out, "taskmgr_write_queue_depth", "Writes waiting for the writer thread", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_write_queue_depth", "", static_cast<double>(s.depth));
+        MetricsRegistry::writeHeader(out, "taskmgr_write_queue_max_batch", "Largest batch committed so far", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_write_queue_max_batch", "", static_cast<double>(s.maxBatch));
+    });
+
+    running = true;
+    writer = std::thread(&WriteQueue::run, this);
+    return true;
+}
+
+void WriteQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!running) return;
+        stopRequested = true;
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        running = false;
+    }
+    ChangeFeed::getInstance().detach(conn);
+    sqlite3_close(conn);
+    conn = nullptr;
+    MetricsRegistry::getInstance().removeCollector("write_queue");
+}
+
+std::future<bool> WriteQueue::submit(const std::string& sql, const std::vector<std::string>& params,
+                                     WriteDurability durability) {
+    return enqueue([sql, params](sqlite3* db) {
+        return executeParameterized(db, sql, params);
+    }, durability, false);
+}
+
+std::future<bool> WriteQueue::submit(Work work, WriteDurability durability) {
+    if (!work) return readyFuture(false);
+    return enqueue(std::move(work), durability, true);
+}
+
+std::future<bool> WriteQueue::enqueue(Work work, WriteDurability durability, bool savepoint) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    notFull.wait(lock, [this] { return stopRequested || queue.size() < options.maxQueueDepth; });
+
+    // 未启动或正在停止：退化为同步写入
+    if (!running || stopRequested) {
+        lock.unlock();
+        DatabaseManager& db = DatabaseManager::getInstance();
+        if (!db.isOpen()) return readyFuture(false);
+        auto connectionLock = db.lockConnection();
+        return readyFuture(runWork(work, db.getRawConnection()));
+    }
+
+    bool wasEmpty = queue.empty();
+    Command command;
+    command.work = std::move(work);
+    command.durability = durability;
+    command.sequence = ++submittedSequence;
+    command.savepoint = savepoint;
+    std::future<bool> result = command.done.get_future();
+    queue.push_back(std::move(command));
+    if (durability == WriteDurability::Immediate) ++immediatePending;
+
+    // 写线程只关心：队列由空变非空、需要提前结束窗口、攒满一批
+    bool wake = wasEmpty || durability == WriteDurability::Immediate
+                || queue.size() >= options.maxBatchOps;
+    lock.unlock();
+    if (wake) notEmpty.notify_one();
+    return result;
+}
+
+void WriteQueue::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (!running) return;
+    std::uint64_t target = submittedSequence;
+    drained.wait(lock, [this, target] { return completedSequence >= target; });
+}
+
+size_t WriteQueue::depth() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return queue.size();
+}
+
+WriteQueue::Stats WriteQueue::getStats() const {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        s = stats;
+    }
+    s.depth = depth();
+    return s;
+}
+
+void WriteQueue::run() {
+    TRACE_THREAD_NAME("write_queue");
+    std::unique_lock<std::mutex> lock(queueMutex);
+
+    while (true) {
+        notEmpty.wait(lock, [this] { return stopRequested || !queue.empty(); });
+        if (queue.empty()) break;  // 停止且已排空
+
+        // 批量窗口：从第一条写入算起，等到超时、攒满或有 Immediate 写入
+        auto windowEnd = std::chrono::steady_clock::now() + options.batchWindow;
+        while (!stopRequested && immediatePending == 0 && queue.size() < options.maxBatchOps) {
+            if (notEmpty.wait_until(lock, windowEnd) == std::cv_status::timeout) break;
+        }
+
+        std::vector<Command> batch;
+        size_t count = std::min(queue.size(), options.maxBatchOps);
+        batch.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (queue.front().durability == WriteDurability::Immediate) --immediatePending;
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        std::uint64_t lastSequence = batch.back().sequence;
+        lock.unlock();
+        notFull.notify_all();
+
+        commitBatch(batch);
+
+        lock.lock();
+        completedSequence = lastSequence;
+        drained.notify_all();
+    }
+}
+
+void WriteQueue::commitBatch(std::vector<Command>& batch) {
+    TRACE_SCOPE("db", "WriteQueue::commitBatch");
+    std::vector<bool> results(batch.size(), false);
+    bool immediate = std::any_of(batch.begin(), batch.end(), [](const Command& c) {
+        return c.durability == WriteDurability::Immediate;
+    });
+    bool committed = false;
+
+    if (immediate) execute(conn, "PRAGMA synchronous = FULL;");
+
+    // IMMEDIATE：开始时就拿写锁，前台或其他进程正在写时由 busy_timeout 等待
+    if (execute(conn, "BEGIN IMMEDIATE;")) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!batch[i].savepoint) {
+                results[i] = runWork(batch[i].work, conn);
+                continue;
+            }
+            if (!execute(conn, "SAVEPOINT write_queue_op;")) continue;
+            results[i] = runWork(batch[i].work, conn);
+            if (!results[i]) execute(conn, "ROLLBACK TO write_queue_op;");
+            execute(conn, "RELEASE write_queue_op;");
+        }
+        committed = execute(conn, "COMMIT;");
+        if (!committed) execute(conn, "ROLLBACK;");
+    }
+
+    if (immediate) execute(conn, "PRAGMA synchronous = NORMAL;");
+
+    if (!committed) {
+        std::cerr << "WriteQueue: 批量提交失败，" << batch.size() << " 条写入未生效" << std::endl;
+    }
+
+    size_t failed = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        bool ok = committed && results[i];
+        if (!ok) ++failed;
+        batch[i].done.set_value(ok);
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.batches++;
+    stats.ops += batch.size();
+    stats.failedOps += failed;
+    if (!committed) stats.failedCommits++;
+    if (immediate) stats.immediateBatches++;
+    stats.maxBatch = std::max(stats.maxBatch, batch.size());
+}
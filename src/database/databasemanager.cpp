@@ -1,9 +1,14 @@
 #include "database/DatabaseManager.h"
+#include "database/QueryProfiler.h"
+#include "database/ChangeFeed.h"
+#include "database/SchemaMigrator.h"
+#include "trace/Tracer.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <filesystem>
+#include <chrono>
 
 // 静态成员初始化
 std::unique_ptr<DatabaseManager> DatabaseManager::instance = nullptr;
@@ -46,7 +51,7 @@ void DatabaseManager::destroyInstance() {
 }
 
 bool DatabaseManager::initialize(const std::string& databasePath) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     
     dbPath = databasePath;
     
@@ -63,14 +68,21 @@ bool DatabaseManager::initialize(const std::string& databasePath) {
     }
     
     db.reset(rawDb);
+    QueryProfiler::getInstance().attach(db.get());
+    // 提交后向订阅者发布行变更（ChangeFeed），供各模块的缓存精确失效
+    ChangeFeed::getInstance().attach(db.get());
+    
+    // 维护线程、备份或其他进程短暂持有写锁时等待，而不是立即报 SQLITE_BUSY
+    sqlite3_busy_timeout(db.get(), 5000);
     
     // 启用外键约束和WAL模式以提高性能
     execute("PRAGMA foreign_keys = ON;");
+    execute("PRAGMA auto_vacuum = INCREMENTAL;");  // 只对还没有表的新库生效，空闲页由维护线程分步回收
     execute("PRAGMA journal_mode = WAL;");
     execute("PRAGMA synchronous = NORMAL;");
     execute("PRAGMA cache_size = -64000;"); // 64MB缓存
     
-    // 创建表
+    // 按 user_version 执行未完成的迁移；已是最新版本时跳过全部 DDL，大库冷启动只剩打开文件的开销
     if (!createTables()) {
         std::cerr << "创建数据库表失败" << std::endl;
         return false;
@@ -81,15 +93,18 @@ bool DatabaseManager::initialize(const std::string& databasePath) {
 }
 
 bool DatabaseManager::close() {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     
     if (isTransactionActive) {
         rollbackTransaction();
     }
     
     cleanupPreparedStatements();
+    stopBackgroundIntegrityCheck();
     
     if (db) {
+        QueryProfiler::getInstance().detach(db.get());
+        ChangeFeed::getInstance().detach(db.get());
         db.reset();
         std::cout << "数据库连接已关闭" << std::endl;
         return true;
@@ -103,236 +118,18 @@ bool DatabaseManager::isOpen() const {
 }
 
 bool DatabaseManager::createTables() {
-    bool success = true;
-    
-    success = success && createTaskTable();
-    success = success && createProjectTable();
-    success = success && createChallengeTable();
-    success = success && createReminderTable();
-    success = success && createAchievementTable();
-    success = success && createUserStatsTable();
-    success = success && createUserSettingsTable();
-    success = success && createPomodoroTable();
-    
-    return success;
-}
-
-bool DatabaseManager::createTaskTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS tasks (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            title TEXT NOT NULL,
-            description TEXT,
-            priority INTEGER DEFAULT 1 CHECK(priority IN (0, 1, 2)),
-            due_date TEXT,
-            completed BOOLEAN DEFAULT 0,
-            tags TEXT,
-            project_id INTEGER DEFAULT 0,
-            pomodoro_count INTEGER DEFAULT 0,
-            estimated_pomodoros INTEGER DEFAULT 0,
-            completed_date TEXT,
-            reminder_time TEXT,
-            deleted BOOLEAN DEFAULT 0,
-            FOREIGN KEY (project_id) REFERENCES projects(id) ON DELETE SET NULL
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_tasks_completed ON tasks(completed);
-        CREATE INDEX IF NOT EXISTS idx_tasks_priority ON tasks(priority);
-        CREATE INDEX IF NOT EXISTS idx_tasks_due_date ON tasks(due_date);
-        CREATE INDEX IF NOT EXISTS idx_tasks_project_id ON tasks(project_id);
-        CREATE INDEX IF NOT EXISTS idx_tasks_created_date ON tasks(created_date);
-        CREATE INDEX IF NOT EXISTS idx_tasks_deleted ON tasks(deleted);
-    )";
-    
-    return execute(sql);
-}
-
-bool DatabaseManager::createProjectTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS projects (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            name TEXT NOT NULL,
-            description TEXT,
-            color_label TEXT DEFAULT '#3498db',
-            progress REAL DEFAULT 0.0 CHECK(progress >= 0.0 AND progress <= 1.0),
-            total_tasks INTEGER DEFAULT 0,
-            completed_tasks INTEGER DEFAULT 0,
-            target_date TEXT,
-            archived BOOLEAN DEFAULT 0
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_projects_archived ON projects(archived);
-        CREATE INDEX IF NOT EXISTS idx_projects_target_date ON projects(target_date);
-    )";
-    
-    return execute(sql);
-}
-
-bool DatabaseManager::createChallengeTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS challenges (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            title TEXT NOT NULL,
-            description TEXT,
-            type TEXT NOT NULL CHECK(type IN ('daily', 'weekly', 'monthly')),
-            criteria TEXT,
-            target_value INTEGER DEFAULT 0,
-            current_value INTEGER DEFAULT 0,
-            reward_xp INTEGER DEFAULT 0,
-            completed BOOLEAN DEFAULT 0,
-            claimed BOOLEAN DEFAULT 0,
-            expiry_date TEXT,
-            category TEXT CHECK(category IN ('task', 'pomodoro', 'project'))
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_challenges_type ON challenges(type);
-        CREATE INDEX IF NOT EXISTS idx_challenges_completed ON challenges(completed);
-        CREATE INDEX IF NOT EXISTS idx_challenges_category ON challenges(category);
-    )";
-    
-    return execute(sql);
-}
-
-bool DatabaseManager::createReminderTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS reminders (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            title TEXT NOT NULL,
-            message TEXT,
-            trigger_time TEXT NOT NULL,
-            recurrence TEXT DEFAULT 'once' CHECK(recurrence IN ('once', 'daily', 'weekly', 'monthly')),
-            triggered BOOLEAN DEFAULT 0,
-            task_id INTEGER,
-            enabled BOOLEAN DEFAULT 1,
-            last_triggered TEXT,
-            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE CASCADE
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_reminders_trigger_time ON reminders(trigger_time);
-        CREATE INDEX IF NOT EXISTS idx_reminders_enabled ON reminders(enabled);
-        CREATE INDEX IF NOT EXISTS idx_reminders_task_id ON reminders(task_id);
-    )";
-    
-    return execute(sql);
-}
-
-bool DatabaseManager::createAchievementTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS achievements (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            name TEXT NOT NULL UNIQUE,
-            description TEXT,
-            icon TEXT,
-            unlock_condition TEXT,
-            unlocked BOOLEAN DEFAULT 0,
-            unlocked_date TEXT,
-            reward_xp INTEGER DEFAULT 0,
-            category TEXT CHECK(category IN ('task', 'time', 'streak', 'special')),
-            progress INTEGER DEFAULT 0 CHECK(progress >= 0 AND progress <= 100),
-            target_value INTEGER DEFAULT 0
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_achievements_unlocked ON achievements(unlocked);
-        CREATE INDEX IF NOT EXISTS idx_achievements_category ON achievements(category);
-    )";
-    
-    return execute(sql);
-}
-
-// Default user ID for the single-user system
-namespace {
-    const int DEFAULT_USER_ID = 1;
-}
-
-bool DatabaseManager::createUserStatsTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS user_stats (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            total_tasks_created INTEGER DEFAULT 0,
-            total_tasks_completed INTEGER DEFAULT 0,
-            total_pomodoros INTEGER DEFAULT 0,
-            current_streak INTEGER DEFAULT 0,
-            longest_streak INTEGER DEFAULT 0,
-            total_xp INTEGER DEFAULT 0,
-            level INTEGER DEFAULT 1,
-            last_active_date TEXT,
-            completion_rate REAL DEFAULT 0.0,
-            achievements_unlocked INTEGER DEFAULT 0
-        );
-    )";
-    
-    if (!execute(sql)) {
-        return false;
-    }
-    
-    // Initialize default user stats row if not exists
-    std::stringstream initSql;
-    initSql << "INSERT OR IGNORE INTO user_stats (id, total_xp, level, current_streak, longest_streak) "
-            << "VALUES (" << DEFAULT_USER_ID << ", 0, 1, 0, 0);";
-    
-    return execute(initSql.str());
-}
-
-bool DatabaseManager::createUserSettingsTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS user_settings (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            updated_date TEXT NOT NULL DEFAULT (datetime('now')),
-            pomodoro_duration INTEGER DEFAULT 25,
-            short_break_duration INTEGER DEFAULT 5,
-            long_break_duration INTEGER DEFAULT 15,
-            pomodoros_until_long_break INTEGER DEFAULT 4,
-            sound_enabled BOOLEAN DEFAULT 1,
-            notifications_enabled BOOLEAN DEFAULT 1,
-            theme TEXT DEFAULT 'default',
-            language TEXT DEFAULT 'zh',
-            auto_start_pomodoros BOOLEAN DEFAULT 0
-        );
-    )";
-    
-    return execute(sql);
-}
-
-bool DatabaseManager::createPomodoroTable() {
-    const char* sql = R"(
-        CREATE TABLE IF NOT EXISTS pomodoro_sessions (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            created_date TEXT NOT NULL DEFAULT (datetime('now')),
-            task_id INTEGER,
-            start_time TEXT NOT NULL,
-            end_time TEXT,
-            duration INTEGER,  -- 单位：分钟
-            completed BOOLEAN DEFAULT 0,
-            interrupted BOOLEAN DEFAULT 0,
-            interruption_reason TEXT,
-            FOREIGN KEY (task_id) REFERENCES tasks(id) ON DELETE SET NULL
-        );
-        
-        CREATE INDEX IF NOT EXISTS idx_pomodoro_task_id ON pomodoro_sessions(task_id);
-        CREATE INDEX IF NOT EXISTS idx_pomodoro_start_time ON pomodoro_sessions(start_time);
-        CREATE INDEX IF NOT EXISTS idx_pomodoro_completed ON pomodoro_sessions(completed);
-    )";
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    if (!db) return false;
     
-    return execute(sql);
+    // 建表、升级统一交给迁移引擎，已是最新版本时什么都不做
+    return SchemaMigrator(db.get()).migrate();
 }
 
 bool DatabaseManager::execute(const std::string& sql) {
     if (!db) return false;
     
-    std::lock_guard<std::mutex> lock(dbMutex);
+    TRACE_SCOPE_DETAIL("db", "DatabaseManager::execute", sql);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     totalQueryCount++;
     
     char* errorMsg = nullptr;
@@ -355,7 +152,8 @@ bool DatabaseManager::executeParameterized(const std::string& sql,
                                          const std::vector<std::string>& params) {
     if (!db) return false;
     
-    std::lock_guard<std::mutex> lock(dbMutex);
+    TRACE_SCOPE_DETAIL("db", "DatabaseManager::executeParameterized", sql);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     totalQueryCount++;
     
     sqlite3_stmt* stmt = nullptr;
@@ -388,7 +186,8 @@ bool DatabaseManager::executeQuery(const std::string& sql,
                                  std::function<bool(sqlite3_stmt*)> rowCallback) {
     if (!db || !rowCallback) return false;
     
-    std::lock_guard<std::mutex> lock(dbMutex);
+    TRACE_SCOPE_DETAIL("db", "DatabaseManager::executeQuery", sql);
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
     totalQueryCount++;
     
     sqlite3_stmt* stmt = nullptr;
@@ -490,42 +289,260 @@ bool DatabaseManager::isInTransaction() const {
     return isTransactionActive;
 }
 
-bool DatabaseManager::backupDatabase(const std::string& backupPath) {
+namespace {
+
+// 连续遇到 SQLITE_BUSY/LOCKED 时最多等待的次数（每次 2ms）
+constexpr int BACKUP_MAX_BUSY_WAITS = 2500;
+
+// 源库被其他连接改写时 sqlite3_backup 会从头再来；超过这个次数就一次复制完
+constexpr int BACKUP_MAX_RESTARTS = 3;
+
+bool isBusy(int rc) {
+    return rc == SQLITE_BUSY || rc == SQLITE_LOCKED;
+}
+
+void pause(int milliseconds) {
+    if (milliseconds > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    }
+}
+
+} // namespace
+
+bool DatabaseManager::backupDatabase(const std::string& backupPath, const BackupOptions& options) {
     if (!db) return false;
+    if (isTransactionActive) {
+        std::cerr << "数据库备份失败: 当前有未提交的事务" << std::endl;
+        return false;
+    }
     
-    try {
-        std::filesystem::copy_file(dbPath, backupPath, 
-                                 std::filesystem::copy_options::overwrite_existing);
-        std::cout << "数据库备份成功: " << backupPath << std::endl;
-        return true;
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "数据库备份失败: " << e.what() << std::endl;
+    TRACE_SCOPE_DETAIL("db", "DatabaseManager::backupDatabase", backupPath);
+    
+    // 先写临时文件，成功后再改名：失败或取消都不会破坏上一份备份
+    const std::string partialPath = backupPath + ".partial";
+    std::error_code ec;
+    std::filesystem::remove(partialPath, ec);
+    
+    bool success = options.compact ? vacuumInto(partialPath) : copyPagesTo(partialPath, options);
+    
+    if (success) {
+        // 同名旧备份留下的 -wal 会在下次打开时被错误地重放
+        std::filesystem::remove(backupPath + "-wal", ec);
+        std::filesystem::remove(backupPath + "-shm", ec);
+        std::filesystem::rename(partialPath, backupPath, ec);
+        if (ec) {
+            std::cerr << "数据库备份失败: " << ec.message() << std::endl;
+            success = false;
+        }
+    }
+    if (!success) {
+        std::filesystem::remove(partialPath, ec);
         return false;
     }
+    
+    std::cout << "数据库备份成功: " << backupPath << std::endl;
+    return true;
 }
 
-bool DatabaseManager::restoreDatabase(const std::string& backupPath) {
+bool DatabaseManager::copyPagesTo(const std::string& path, const BackupOptions& options) {
+    sqlite3* dest = nullptr;
+    if (sqlite3_open(path.c_str(), &dest) != SQLITE_OK) {
+        std::cerr << "数据库备份失败: " << sqlite3_errmsg(dest) << std::endl;
+        sqlite3_close(dest);
+        return false;
+    }
+    
+    // WAL 模式下从独立连接复制，并用一个读事务固定快照：读者不阻塞写者，
+    // 备份是某一时刻的一致副本，也不会因为其他连接写入而从头开始
+    bool isWal = false;
+    executeQuery("PRAGMA journal_mode;", [&](sqlite3_stmt* stmt) {
+        const char* mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        isWal = mode && std::string(mode) == "wal";
+        return false;
+    });
+    sqlite3* snapshot = nullptr;
+    if (isWal) {
+        if (sqlite3_open_v2(dbPath.c_str(), &snapshot, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK ||
+            sqlite3_exec(snapshot, "BEGIN; SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "数据库备份失败: " << sqlite3_errmsg(snapshot) << std::endl;
+            sqlite3_close(snapshot);
+            sqlite3_close(dest);
+            return false;
+        }
+    }
+    
+    // 否则每步只在复制这几页时持有主连接；通过本连接的写入会同步到备份中，
+    // 其他连接的写入则让备份从头开始
+    std::unique_lock<std::recursive_mutex> lock(dbMutex, std::defer_lock);
+    sqlite3* source = snapshot ? snapshot : db.get();
+    
+    sqlite3_backup* backup = nullptr;
+    if (!snapshot) lock.lock();
+    backup = sqlite3_backup_init(dest, "main", source, "main");
+    if (lock.owns_lock()) lock.unlock();
+    if (!backup) {
+        std::cerr << "数据库备份失败: " << sqlite3_errmsg(dest) << std::endl;
+        sqlite3_close(snapshot);
+        sqlite3_close(dest);
+        return false;
+    }
+    
+    const int pagesPerStep = options.pagesPerStep > 0 ? options.pagesPerStep : -1;
+    int rc = SQLITE_OK;
+    int restarts = 0;
+    int busyWaits = 0;
+    int lastRemaining = -1;
+    bool cancelled = false;
+    
+    while (true) {
+        if (!snapshot) lock.lock();
+        rc = sqlite3_backup_step(backup, restarts >= BACKUP_MAX_RESTARTS ? -1 : pagesPerStep);
+        if (lock.owns_lock()) lock.unlock();
+        
+        if (rc == SQLITE_DONE) {
+            if (options.progress) {
+                options.progress(0, sqlite3_backup_pagecount(backup));
+            }
+            break;
+        }
+        if (isBusy(rc)) {
+            if (++busyWaits > BACKUP_MAX_BUSY_WAITS) break;
+            pause(2);
+            continue;
+        }
+        if (rc != SQLITE_OK) break;
+        
+        busyWaits = 0;
+        int remaining = sqlite3_backup_remaining(backup);
+        if (lastRemaining >= 0 && remaining > lastRemaining) {
+            restarts++;
+        }
+        lastRemaining = remaining;
+        
+        if (options.progress && !options.progress(remaining, sqlite3_backup_pagecount(backup))) {
+            cancelled = true;
+            break;
+        }
+        pause(options.pauseMillis);
+    }
+    
+    sqlite3_backup_finish(backup);
+    sqlite3_close(snapshot);  // 关闭连接即结束读事务
+    if (cancelled) {
+        std::cerr << "数据库备份已取消" << std::endl;
+    } else if (rc != SQLITE_DONE) {
+        std::cerr << "数据库备份失败: " << sqlite3_errstr(rc) << std::endl;
+    }
+    sqlite3_close(dest);
+    return rc == SQLITE_DONE && !cancelled;
+}
+
+bool DatabaseManager::vacuumInto(const std::string& path) {
+    // 独立的只读连接：WAL 模式下读事务不阻塞写入，也不占用 dbMutex
+    sqlite3* source = nullptr;
+    if (sqlite3_open_v2(dbPath.c_str(), &source, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::cerr << "数据库备份失败: " << sqlite3_errmsg(source) << std::endl;
+        sqlite3_close(source);
+        return false;
+    }
+    sqlite3_busy_timeout(source, 5000);
+    
+    bool success = false;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(source, "VACUUM INTO ?;", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+        success = sqlite3_step(stmt) == SQLITE_DONE;
+    }
+    if (!success) {
+        std::cerr << "数据库备份失败: " << sqlite3_errmsg(source) << std::endl;
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(source);
+    return success;
+}
+
+bool DatabaseManager::restoreDatabase(const std::string& backupPath, const BackupOptions& options) {
+    if (!db) return false;
     if (!std::filesystem::exists(backupPath)) {
         std::cerr << "备份文件不存在: " << backupPath << std::endl;
         return false;
     }
     
-    close();  // 关闭当前连接
+    TRACE_SCOPE_DETAIL("db", "DatabaseManager::restoreDatabase", backupPath);
     
-    try {
-        std::filesystem::copy_file(backupPath, dbPath, 
-                                 std::filesystem::copy_options::overwrite_existing);
-        
-        // 重新初始化数据库
-        return initialize(dbPath);
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "数据库恢复失败: " << e.what() << std::endl;
+    sqlite3* source = nullptr;
+    if (sqlite3_open_v2(backupPath.c_str(), &source, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::cerr << "数据库恢复失败: " << sqlite3_errmsg(source) << std::endl;
+        sqlite3_close(source);
         return false;
     }
+    
+    // 直接把备份写进当前连接，不必关闭数据库：目标库的写锁一直持有到复制结束，
+    // 期间其他连接的写入会遇到 SQLITE_BUSY，之后看到的就是恢复后的内容；
+    // 中途失败或取消则整体回滚
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    if (isTransactionActive) {
+        std::cerr << "数据库恢复失败: 当前有未提交的事务" << std::endl;
+        sqlite3_close(source);
+        return false;
+    }
+    
+    sqlite3_backup* backup = sqlite3_backup_init(db.get(), "main", source, "main");
+    if (!backup) {
+        std::cerr << "数据库恢复失败: " << sqlite3_errmsg(db.get()) << std::endl;
+        sqlite3_close(source);
+        return false;
+    }
+    
+    const int pagesPerStep = options.pagesPerStep > 0 ? options.pagesPerStep : -1;
+    int rc = SQLITE_OK;
+    int busyWaits = 0;
+    bool cancelled = false;
+    while (true) {
+        rc = sqlite3_backup_step(backup, pagesPerStep);
+        if (rc == SQLITE_DONE) break;
+        if (isBusy(rc)) {
+            if (++busyWaits > BACKUP_MAX_BUSY_WAITS) break;
+            pause(2);
+            continue;
+        }
+        if (rc != SQLITE_OK) break;
+        busyWaits = 0;
+        if (options.progress &&
+            !options.progress(sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup))) {
+            cancelled = true;
+            break;
+        }
+    }
+    sqlite3_backup_finish(backup);
+    sqlite3_close(source);
+    
+    if (rc != SQLITE_DONE || cancelled) {
+        std::cerr << "数据库恢复失败: " << (cancelled ? "已取消" : sqlite3_errstr(rc)) << std::endl;
+        return false;
+    }
+    
+    // 备份可能来自旧版本，补齐迁移
+    if (!createTables()) {
+        return false;
+    }
+    // 页面复制不经过行钩子，订阅者的缓存整体作废
+    ChangeFeed::getInstance().notifyAllChanged();
+    
+    std::cout << "数据库恢复成功: " << backupPath << std::endl;
+    return true;
 }
 
 bool DatabaseManager::vacuumDatabase() {
-    return execute("VACUUM;");
+    // 顺带把旧库切换到增量回收模式，之后由 MaintenanceScheduler 分步 incremental_vacuum
+    return execute("PRAGMA auto_vacuum = INCREMENTAL;") && execute("VACUUM;");
+}
+
+void DatabaseManager::setWalAutocheckpoint(int pages) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    if (db) {
+        ChangeFeed::getInstance().setAutocheckpoint(db.get(), pages);
+    }
 }
 
 bool DatabaseManager::checkDatabaseIntegrity() {
@@ -540,19 +557,86 @@ bool DatabaseManager::checkDatabaseIntegrity() {
     return integrityOk;
 }
 
+bool DatabaseManager::quickCheckIntegrity() {
+    bool integrityOk = false;
+    
+    executeQuery("PRAGMA quick_check;", [&](sqlite3_stmt* stmt) {
+        const char* result = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        integrityOk = (result && std::string(result) == "ok");
+        return false;
+    });
+    
+    return integrityOk;
+}
+
+bool DatabaseManager::startBackgroundIntegrityCheck() {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    if (!db) return false;
+    if (integrityStatus == static_cast<int>(IntegrityStatus::Running)) return true;
+    stopBackgroundIntegrityCheck();  // 回收上一次已结束的线程
+    
+    sqlite3* checkDb = nullptr;
+    if (sqlite3_open_v2(dbPath.c_str(), &checkDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::cerr << "无法打开完整性检查连接: " << sqlite3_errmsg(checkDb) << std::endl;
+        sqlite3_close(checkDb);
+        return false;
+    }
+    
+    integrityDb = checkDb;
+    integrityStatus = static_cast<int>(IntegrityStatus::Running);
+    integrityThread = std::thread([this, checkDb]() {
+        TRACE_THREAD_NAME("integrity-check");
+        TRACE_SCOPE("db", "DatabaseManager::backgroundIntegrityCheck");
+        
+        IntegrityStatus status = IntegrityStatus::Failed;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(checkDb, "PRAGMA integrity_check;", -1, &stmt, nullptr) == SQLITE_OK) {
+            int rc = sqlite3_step(stmt);
+            const char* result = rc == SQLITE_ROW
+                ? reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)) : nullptr;
+            if (result && std::string(result) == "ok") {
+                status = IntegrityStatus::Ok;
+            } else if (rc == SQLITE_INTERRUPT) {
+                status = IntegrityStatus::NotRun;  // 关闭数据库时被中断，不算失败
+            } else {
+                std::cerr << "⚠️  后台完整性检查未通过: "
+                          << (result ? result : sqlite3_errmsg(checkDb)) << std::endl;
+            }
+            sqlite3_finalize(stmt);
+        }
+        integrityStatus = static_cast<int>(status);
+    });
+    return true;
+}
+
+DatabaseManager::IntegrityStatus DatabaseManager::getBackgroundIntegrityStatus() const {
+    return static_cast<IntegrityStatus>(integrityStatus.load());
+}
+
+void DatabaseManager::stopBackgroundIntegrityCheck() {
+    if (!integrityThread.joinable()) return;
+    
+    sqlite3_interrupt(integrityDb);
+    integrityThread.join();
+    sqlite3_close(integrityDb);
+    integrityDb = nullptr;
+}
+
 bool DatabaseManager::dropTables() {
     const char* tables[] = {
         "pomodoro_sessions", "user_settings", "user_stats", 
-        "achievements", "reminders", "challenges", "tasks", "projects"
+        "achievements", "reminders", "challenges", "tasks", "projects", "users",
+        "leaderboard_snapshot", "xp_events", "xp_snapshots", "tasks_archive", "task_rollups"
     };
     
-    bool success = true;
+    bool success = execute("DROP VIEW IF EXISTS task_history;");
     for (const char* table : tables) {
         std::string sql = "DROP TABLE IF EXISTS " + std::string(table) + ";";
         success = success && execute(sql);
     }
     
-    return success;
+    // 表都删掉了，下次 initialize() 需要重新建表
+    return success && execute("PRAGMA user_version = 0;");
 }
 
 bool DatabaseManager::tableExists(const std::string& tableName) {
@@ -574,6 +658,17 @@ bool DatabaseManager::tableExists(const std::string& tableName) {
     return exists;
 }
 
+int DatabaseManager::getSchemaVersion() {
+    int version = 0;
+    
+    executeQuery("PRAGMA user_version;", [&](sqlite3_stmt* stmt) {
+        version = sqlite3_column_int(stmt, 0);
+        return false;
+    });
+    
+    return version;
+}
+
 std::vector<std::string> DatabaseManager::getAllTableNames() {
     std::vector<std::string> tables;
     
@@ -589,6 +684,30 @@ std::vector<std::string> DatabaseManager::getAllTableNames() {
     return tables;
 }
 
+bool DatabaseManager::ensureUser(int userId, const std::string& username) {
+    if (!db || userId <= 0) return false;
+    
+    std::lock_guard<std::recursive_mutex> lock(dbMutex);
+    
+    const std::string name = username.empty() ? "user_" + std::to_string(userId) : username;
+    const std::string id = std::to_string(userId);
+    
+    return executeParameterized("INSERT OR IGNORE INTO users (id, username) VALUES (?, ?);", {id, name})
+        && executeParameterized("INSERT OR IGNORE INTO user_stats (user_id, total_xp, level, current_streak, longest_streak) "
+                                "VALUES (?, 0, 1, 0, 0);", {id});
+}
+
+std::vector<int> DatabaseManager::getAllUserIds() {
+    std::vector<int> ids;
+    
+    executeQuery("SELECT user_id FROM user_stats ORDER BY user_id;", [&](sqlite3_stmt* stmt) {
+        ids.push_back(sqlite3_column_int(stmt, 0));
+        return true;
+    });
+    
+    return ids;
+}
+
 int DatabaseManager::getLastInsertId() const {
     if (!db) return 0;
     return sqlite3_last_insert_rowid(db.get());
@@ -625,12 +744,29 @@ double DatabaseManager::getSuccessRate() const {
 void DatabaseManager::resetStatistics() {
     totalQueryCount = 0;
     failedQueryCount = 0;
+    QueryProfiler::getInstance().reset();
+}
+
+void DatabaseManager::setSlowQueryThreshold(double milliseconds) {
+    QueryProfiler::getInstance().setSlowQueryThreshold(milliseconds);
+}
+
+void DatabaseManager::setSlowQueryLog(const std::string& path) {
+    QueryProfiler::getInstance().setSlowQueryLog(path);
+}
+
+void DatabaseManager::dumpSlowestStatements(std::ostream& out, size_t topN) const {
+    QueryProfiler::getInstance().dump(out, topN);
 }
 
 sqlite3* DatabaseManager::getRawConnection() {
     return db.get();
 }
 
+std::unique_lock<std::recursive_mutex> DatabaseManager::lockConnection() {
+    return std::unique_lock<std::recursive_mutex>(dbMutex);
+}
+
 std::string DatabaseManager::getDatabasePath() const {
     return dbPath;
 }
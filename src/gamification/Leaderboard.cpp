@@ -0,0 +1,362 @@
+#include "gamification/Leaderboard.h"
+#include "database/DatabaseManager.h"
+#include "database/ChangeFeed.h"
+#include <iostream>
+#include <algorithm>
+#include <sqlite3.h>
+
+// 静态成员初始化
+std::unique_ptr<Leaderboard> Leaderboard::instance = nullptr;
+std::mutex Leaderboard::instanceMutex;
+
+namespace {
+    // 一次收到的外部变更超过这么多行时整体重建，而不是逐个重读
+    constexpr size_t ROW_REFRESH_LIMIT = 256;
+}
+
+Leaderboard::Leaderboard() = default;
+Leaderboard::~Leaderboard() = default;
+
+Leaderboard& Leaderboard::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<Leaderboard>();
+    }
+    return *instance;
+}
+
+void Leaderboard::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+// === treap 基本操作 ===
+
+bool Leaderboard::before(int xpA, int idA, int xpB, int idB) {
+    if (xpA != xpB) return xpA > xpB;
+    return idA < idB;
+}
+
+int Leaderboard::sizeOf(const std::unique_ptr<Node>& node) {
+    return node ? node->size : 0;
+}
+
+void Leaderboard::update(Node* node) {
+    if (node) {
+        node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+    }
+}
+
+void Leaderboard::split(std::unique_ptr<Node> node, int xp, int id,
+                        std::unique_ptr<Node>& left, std::unique_ptr<Node>& right) {
+    if (!node) {
+        left.reset();
+        right.reset();
+        return;
+    }
+    
+    // left 收集排在 (xp, id) 之前的节点，right 收集其余节点
+    if (before(node->totalXP, node->userId, xp, id)) {
+        std::unique_ptr<Node> rest;
+        split(std::move(node->right), xp, id, rest, right);
+        node->right = std::move(rest);
+        update(node.get());
+        left = std::move(node);
+    } else {
+        std::unique_ptr<Node> rest;
+        split(std::move(node->left), xp, id, left, rest);
+        node->left = std::move(rest);
+        update(node.get());
+        right = std::move(node);
+    }
+}
+
+std::unique_ptr<Leaderboard::Node> Leaderboard::merge(std::unique_ptr<Node> left,
+                                                      std::unique_ptr<Node> right) {
+    if (!left) return right;
+    if (!right) return left;
+    
+    if (left->priority > right->priority) {
+        left->right = merge(std::move(left->right), std::move(right));
+        update(left.get());
+        return left;
+    }
+    
+    right->left = merge(std::move(left), std::move(right->left));
+    update(right.get());
+    return right;
+}
+
+void Leaderboard::insertNode(int xp, int id) {
+    std::unique_ptr<Node> left, right;
+    split(std::move(root), xp, id, left, right);
+    auto node = std::make_unique<Node>(xp, id, static_cast<unsigned>(rng()));
+    root = merge(merge(std::move(left), std::move(node)), std::move(right));
+}
+
+void Leaderboard::eraseNode(int xp, int id) {
+    std::unique_ptr<Node>* cursor = &root;
+    
+    // 先确认节点存在，再沿路径递减子树大小
+    const Node* probe = root.get();
+    while (probe && !(probe->totalXP == xp && probe->userId == id)) {
+        probe = before(xp, id, probe->totalXP, probe->userId) ? probe->left.get() : probe->right.get();
+    }
+    if (!probe) return;
+    
+    while (*cursor) {
+        Node* node = cursor->get();
+        if (node->totalXP == xp && node->userId == id) {
+            *cursor = merge(std::move(node->left), std::move(node->right));
+            return;
+        }
+        node->size--;
+        cursor = before(xp, id, node->totalXP, node->userId) ? &node->left : &node->right;
+    }
+}
+
+int Leaderboard::rankOf(int xp, int id) const {
+    int rank = 0;
+    const Node* node = root.get();
+    
+    while (node) {
+        if (before(xp, id, node->totalXP, node->userId)) {
+            node = node->left.get();
+        } else {
+            rank += sizeOf(node->left) + 1;
+            if (node->totalXP == xp && node->userId == id) {
+                return rank;
+            }
+            node = node->right.get();
+        }
+    }
+    
+    return 0;
+}
+
+const Leaderboard::Node* Leaderboard::nodeAt(int rank) const {
+    const Node* node = root.get();
+    
+    while (node) {
+        int leftSize = sizeOf(node->left);
+        if (rank <= leftSize) {
+            node = node->left.get();
+        } else if (rank == leftSize + 1) {
+            return node;
+        } else {
+            rank -= leftSize + 1;
+            node = node->right.get();
+        }
+    }
+    
+    return nullptr;
+}
+
+UserRanking Leaderboard::toRanking(const Node* node, int rank) const {
+    UserRanking ranking;
+    ranking.rank = rank;
+    ranking.userId = node->userId;
+    ranking.totalXP = node->totalXP;
+    
+    auto it = entries.find(node->userId);
+    if (it != entries.end()) {
+        ranking.username = it->second.username;
+        ranking.level = it->second.level;
+    }
+    
+    return ranking;
+}
+
+void Leaderboard::collectTop(const Node* node, int& remaining,
+                             std::vector<UserRanking>& out) const {
+    if (!node || remaining <= 0) return;
+    
+    collectTop(node->left.get(), remaining, out);
+    if (remaining <= 0) return;
+    
+    out.push_back(toRanking(node, static_cast<int>(out.size()) + 1));
+    remaining--;
+    
+    collectTop(node->right.get(), remaining, out);
+}
+
+// === 重建与更新 ===
+
+bool Leaderboard::rebuild() {
+    auto& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) {
+        std::cerr << "数据库未打开，无法重建排行榜" << std::endl;
+        return false;
+    }
+    
+    // 先订阅再读取，读取期间的提交之后会再应用一次
+    if (!changes) {
+        changes = std::make_unique<ChangeSubscription>(std::vector<std::string>{"user_stats", "users"});
+    } else {
+        changes->take();
+    }
+    
+    std::unordered_map<int, Entry> fresh;
+    bool ok = dbManager.executeQuery(
+        "SELECT s.user_id, s.total_xp, s.level, COALESCE(u.username, 'user_' || s.user_id) "
+        "FROM user_stats s LEFT JOIN users u ON u.id = s.user_id;",
+        [&](sqlite3_stmt* stmt) {
+            Entry entry;
+            entry.totalXP = sqlite3_column_int(stmt, 1);
+            entry.level = sqlite3_column_int(stmt, 2);
+            const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+            entry.username = name ? name : "";
+            fresh[sqlite3_column_int(stmt, 0)] = std::move(entry);
+            return true;
+        });
+    
+    if (!ok) return false;
+    
+    std::lock_guard<std::mutex> lock(treeMutex);
+    root.reset();
+    entries = std::move(fresh);
+    for (const auto& [userId, entry] : entries) {
+        insertNode(entry.totalXP, userId);
+    }
+    
+    loaded = true;
+    return true;
+}
+
+bool Leaderboard::isLoaded() {
+    applyChanges();
+    std::lock_guard<std::mutex> lock(treeMutex);
+    return loaded;
+}
+
+void Leaderboard::clearLocked() {
+    root.reset();
+    entries.clear();
+    loaded = false;
+}
+
+void Leaderboard::applyChanges() {
+    if (!changes || !changes->hasChanges()) return;
+    
+    ChangeBatch batch = changes->take();
+    std::vector<sqlite3_int64> statsRows = batch.rowids("user_stats");
+    std::vector<sqlite3_int64> userRows = batch.rowids("users");
+    {
+        std::lock_guard<std::mutex> lock(treeMutex);
+        if (!loaded) return;   // 下次 rebuild() 本来就会读到最新数据
+        if (batch.truncated || statsRows.size() + userRows.size() > ROW_REFRESH_LIMIT) {
+            clearLocked();
+            return;
+        }
+    }
+    
+    auto& dbManager = DatabaseManager::getInstance();
+    bool missing = false;
+    for (sqlite3_int64 rowid : statsRows) {
+        bool found = false;
+        dbManager.executeQuery(
+            "SELECT user_id, total_xp, level FROM user_stats WHERE id = " + std::to_string(rowid) + ";",
+            [&](sqlite3_stmt* stmt) {
+                updateUser(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                           sqlite3_column_int(stmt, 2));
+                found = true;
+                return false;
+            });
+        // 行被删除时不知道是哪个用户，整体重建
+        missing = missing || !found;
+    }
+    for (sqlite3_int64 userId : userRows) {
+        dbManager.executeQuery(
+            "SELECT username FROM users WHERE id = " + std::to_string(userId) + ";",
+            [&](sqlite3_stmt* stmt) {
+                const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+                std::lock_guard<std::mutex> lock(treeMutex);
+                auto it = entries.find(static_cast<int>(userId));
+                if (it != entries.end() && name) it->second.username = name;
+                return false;
+            });
+    }
+    if (missing) {
+        std::lock_guard<std::mutex> lock(treeMutex);
+        clearLocked();
+    }
+}
+
+void Leaderboard::updateUser(int userId, int totalXP, int level) {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    
+    auto it = entries.find(userId);
+    if (it != entries.end()) {
+        if (it->second.totalXP != totalXP) {
+            eraseNode(it->second.totalXP, userId);
+            insertNode(totalXP, userId);
+        }
+        it->second.totalXP = totalXP;
+        it->second.level = level;
+    } else {
+        Entry entry;
+        entry.totalXP = totalXP;
+        entry.level = level;
+        entry.username = "user_" + std::to_string(userId);
+        entries[userId] = entry;
+        insertNode(totalXP, userId);
+    }
+}
+
+void Leaderboard::removeUser(int userId) {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    
+    auto it = entries.find(userId);
+    if (it == entries.end()) return;
+    
+    eraseNode(it->second.totalXP, userId);
+    entries.erase(it);
+}
+
+// === 查询 ===
+
+std::vector<UserRanking> Leaderboard::getTopK(int k) const {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    
+    std::vector<UserRanking> result;
+    if (k <= 0) return result;
+    
+    result.reserve(std::min(k, sizeOf(root)));
+    int remaining = k;
+    collectTop(root.get(), remaining, result);
+    return result;
+}
+
+int Leaderboard::getRank(int userId) const {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    
+    auto it = entries.find(userId);
+    if (it == entries.end()) return 0;
+    
+    return rankOf(it->second.totalXP, userId);
+}
+
+std::vector<UserRanking> Leaderboard::getNeighbors(int userId, int radius) const {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    
+    std::vector<UserRanking> result;
+    auto it = entries.find(userId);
+    if (it == entries.end()) return result;
+    
+    int rank = rankOf(it->second.totalXP, userId);
+    int first = std::max(1, rank - radius);
+    int last = std::min(sizeOf(root), rank + radius);
+    
+    for (int r = first; r <= last; ++r) {
+        if (const Node* node = nodeAt(r)) {
+            result.push_back(toRanking(node, r));
+        }
+    }
+    
+    return result;
+}
+
+int Leaderboard::size() const {
+    std::lock_guard<std::mutex> lock(treeMutex);
+    return sizeOf(root);
+}
@@ -0,0 +1,273 @@
+#include "gamification/XPLedger.h"
+#include "database/DatabaseManager.h"
+#include <iostream>
+#include <ctime>
+#include <sqlite3.h>
+
+// 静态成员初始化
+std::unique_ptr<XPLedger> XPLedger::instance = nullptr;
+std::mutex XPLedger::instanceMutex;
+
+XPLedger& XPLedger::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<XPLedger>();
+    }
+    return *instance;
+}
+
+void XPLedger::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+XPLedger::~XPLedger() = default;
+
+std::string XPLedger::currentTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc{};
+    gmtime_r(&now, &utc);
+    char buf[20];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &utc);
+    return buf;
+}
+
+// === 写入 ===
+
+bool XPLedger::append(int userId, int amount, const std::string& source,
+                      const std::string& description) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    auto& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) return false;
+
+    sqlite3* db = dbManager.getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "INSERT INTO xp_events (user_id, amount, source, description, created_date) "
+                      "VALUES (?, ?, ?, ?, ?);";
+
+    bool ok = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK;
+    if (ok) {
+        std::string timestamp = currentTimestamp();
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_int(stmt, 2, amount);
+        sqlite3_bind_text(stmt, 3, source.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, description.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 5, timestamp.c_str(), -1, SQLITE_TRANSIENT);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    }
+    if (!ok) {
+        std::cerr << "❌ 经验值流水写入失败: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    if (++appendsSinceCheck[userId] >= snapshotInterval) {
+        appendsSinceCheck[userId] = 0;
+        snapshotIfDueLocked(userId);
+    }
+    return true;
+}
+
+void XPLedger::snapshotIfDueLocked(int userId) {
+    ReplayResult state = replayLocked(userId);
+    if (state.replayedEvents >= snapshotInterval) {
+        writeSnapshotLocked(userId, state);
+    }
+}
+
+bool XPLedger::writeSnapshotLocked(int userId, const ReplayResult& state) {
+    if (state.lastEventId <= state.snapshotEventId) return true;  // 没有新事件
+
+    sqlite3* db = DatabaseManager::getInstance().getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "INSERT OR REPLACE INTO xp_snapshots (user_id, last_event_id, total_xp) "
+                      "VALUES (?, ?, ?);";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+
+    sqlite3_bind_int(stmt, 1, userId);
+    sqlite3_bind_int64(stmt, 2, state.lastEventId);
+    sqlite3_bind_int(stmt, 3, state.totalXP);
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+
+    return ok;
+}
+
+bool XPLedger::snapshotAll() {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    auto& dbManager = DatabaseManager::getInstance();
+    std::vector<int> users;
+    dbManager.executeQuery("SELECT DISTINCT user_id FROM xp_events;", [&](sqlite3_stmt* stmt) {
+        users.push_back(sqlite3_column_int(stmt, 0));
+        return true;
+    });
+
+    bool ok = true;
+    for (int userId : users) {
+        ok = writeSnapshotLocked(userId, replayLocked(userId)) && ok;
+    }
+    return ok;
+}
+
+void XPLedger::setSnapshotInterval(int events) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+    snapshotInterval = events > 0 ? events : 1;
+}
+
+// === 重建 ===
+
+XPLedger::ReplayResult XPLedger::replay(int userId) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+    return replayLocked(userId);
+}
+
+XPLedger::ReplayResult XPLedger::replayLocked(int userId) {
+    ReplayResult result;
+    auto& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) return result;
+
+    sqlite3* db = dbManager.getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+
+    // 最近一次快照（主键 (user_id, last_event_id) 倒序取一行）
+    const char* snapSql = "SELECT last_event_id, total_xp FROM xp_snapshots "
+                          "WHERE user_id = ? ORDER BY last_event_id DESC LIMIT 1;";
+    if (sqlite3_prepare_v2(db, snapSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            result.snapshotEventId = sqlite3_column_int64(stmt, 0);
+            result.totalXP = sqlite3_column_int(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+    result.lastEventId = result.snapshotEventId;
+
+    // 快照之后的尾部，走 idx_xp_events_user_id 范围扫描
+    const char* tailSql = "SELECT COALESCE(SUM(amount), 0), COUNT(*), COALESCE(MAX(id), 0) "
+                          "FROM xp_events WHERE user_id = ? AND id > ?;";
+    if (sqlite3_prepare_v2(db, tailSql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_int64(stmt, 2, result.snapshotEventId);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            result.totalXP += sqlite3_column_int(stmt, 0);
+            result.replayedEvents = sqlite3_column_int(stmt, 1);
+            if (result.replayedEvents > 0) {
+                result.lastEventId = sqlite3_column_int64(stmt, 2);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return result;
+}
+
+// === 查询 ===
+
+namespace {
+
+ExperienceRecord readEventRow(sqlite3_stmt* stmt) {
+    ExperienceRecord record;
+    record.id = sqlite3_column_int(stmt, 0);
+    record.userId = sqlite3_column_int(stmt, 1);
+    record.amount = sqlite3_column_int(stmt, 2);
+
+    const char* source = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    const char* description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+    const char* created = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+    record.source = source ? source : "";
+    record.description = description ? description : "";
+    record.timestamp = created ? created : "";
+    return record;
+}
+
+} // namespace
+
+std::vector<ExperienceRecord> XPLedger::getHistory(int userId, int limit) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    std::vector<ExperienceRecord> records;
+    sqlite3* db = DatabaseManager::getInstance().getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT id, user_id, amount, source, description, created_date "
+                      "FROM xp_events WHERE user_id = ? ORDER BY id DESC LIMIT ?;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_int(stmt, 2, limit);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            records.push_back(readEventRow(stmt));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return records;
+}
+
+std::vector<ExperienceRecord> XPLedger::getHistoryBetween(int userId, const std::string& from,
+                                                         const std::string& to) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    std::vector<ExperienceRecord> records;
+    sqlite3* db = DatabaseManager::getInstance().getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT id, user_id, amount, source, description, created_date "
+                      "FROM xp_events WHERE user_id = ? AND created_date >= ? AND created_date < ? "
+                      "ORDER BY created_date, id;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_text(stmt, 2, from.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, to.c_str(), -1, SQLITE_TRANSIENT);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            records.push_back(readEventRow(stmt));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return records;
+}
+
+int XPLedger::getXPBetween(int userId, const std::string& from, const std::string& to) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    int total = 0;
+    sqlite3* db = DatabaseManager::getInstance().getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT COALESCE(SUM(amount), 0) FROM xp_events "
+                      "WHERE user_id = ? AND created_date >= ? AND created_date < ?;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        sqlite3_bind_text(stmt, 2, from.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, to.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            total = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return total;
+}
+
+std::map<std::string, int> XPLedger::getXPBySource(int userId) {
+    std::lock_guard<std::mutex> lock(ledgerMutex);
+
+    std::map<std::string, int> bySource;
+    sqlite3* db = DatabaseManager::getInstance().getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT source, SUM(amount) FROM xp_events WHERE user_id = ? GROUP BY source;";
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, userId);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* source = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            bySource[source ? source : ""] = sqlite3_column_int(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return bySource;
+}
@@ -1,110 +1,208 @@
 #include "gamification/XPSystem.h"
+#include "trace/Tracer.h"
+#include "metrics/Metrics.h"
+#include "gamification/Leaderboard.h"
+#include "gamification/XPLedger.h"
+#include "gamification/LevelTable.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 #include <sqlite3.h>
 
-XPSystem::XPSystem() {
+XPSystem::XPSystem(int userId) : currentUserId(userId) {
     dbManager = &DatabaseManager::getInstance();
+    userStatsChanges = make_unique<ChangeSubscription>(vector<string>{"user_stats"});
     if (!dbManager->isOpen()) {
         cerr << "⚠️  警告: 数据库未打开，XPSystem可能无法正常工作" << endl;
     }
-    
-    initializeLevelSystem();
 }
 
 XPSystem::~XPSystem() {
     // DatabaseManager是单例，不需要在这里删除
 }
 
-void XPSystem::initializeLevelSystem() {
-    // 等级阈值配置（指数增长）
-    levelThresholds[1] = 0;
-    levelThresholds[2] = 100;
-    levelThresholds[3] = 250;
-    levelThresholds[4] = 500;
-    levelThresholds[5] = 1000;
-    levelThresholds[6] = 1750;
-    levelThresholds[7] = 2750;
-    levelThresholds[8] = 4000;
-    levelThresholds[9] = 5500;
-    levelThresholds[10] = 7500;
-    levelThresholds[11] = 10000;
-    levelThresholds[12] = 13000;
-    levelThresholds[13] = 16500;
-    levelThresholds[14] = 20500;
-    levelThresholds[15] = 25000;
-    levelThresholds[16] = 30000;
-    levelThresholds[17] = 36000;
-    levelThresholds[18] = 43000;
-    levelThresholds[19] = 51000;
-    levelThresholds[20] = 60000;
-    
-    // 等级称号
-    levelTitles[1] = "新手";
-    levelTitles[2] = "初学者";
-    levelTitles[3] = "学徒";
-    levelTitles[4] = "实践者";
-    levelTitles[5] = "熟练者";
-    levelTitles[6] = "资深者";
-    levelTitles[7] = "精英";
-    levelTitles[8] = "专家";
-    levelTitles[9] = "大师";
-    levelTitles[10] = "宗师";
-    levelTitles[11] = "传奇";
-    levelTitles[12] = "史诗";
-    levelTitles[13] = "神话";
-    levelTitles[14] = "不朽";
-    levelTitles[15] = "永恒";
-    levelTitles[16] = "至尊";
-    levelTitles[17] = "主宰";
-    levelTitles[18] = "神圣";
-    levelTitles[19] = "超凡";
-    levelTitles[20] = "传说";
+int XPSystem::calculateLevel(int totalXP) {
+    return LevelTable::levelForXP(totalXP);
 }
 
-int XPSystem::calculateLevel(int totalXP) {
-    int level = 1;
+bool XPSystem::updateUserStats(int userId, int totalXP, int level) {
+    if (!dbManager->isOpen()) return false;
     
-    // 从高到低查找对应等级
-    for (int l = 20; l >= 1; l--) {
-        if (totalXP >= levelThresholds[l]) {
-            level = l;
-            break;
-        }
+    stringstream sql;
+    sql << "UPDATE user_stats SET "
+        << "total_xp = " << totalXP << ", "
+        << "level = " << level << ", "
+        << "updated_date = datetime('now') "
+        << "WHERE user_id = " << userId << ";";
+    
+    if (dbManager->execute(sql.str())) {
+        UserXPState& state = userCache[userId];
+        state.totalXP = totalXP;
+        state.level = level;
+        return true;
+    }
+    userCache.erase(userId);
+    return false;
+}
+
+bool XPSystem::addUserXP(int userId, int amount, int& oldLevel, int& newTotal, int& newLevel) {
+    sqlite3* db = dbManager->getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    
+    const char* addSql = "UPDATE user_stats SET total_xp = total_xp + ?, "
+                         "updated_date = datetime('now') WHERE user_id = ?;";
+    if (sqlite3_prepare_v2(db, addSql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int(stmt, 1, amount);
+    sqlite3_bind_int(stmt, 2, userId);
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE && sqlite3_changes(db) == 1;
+    sqlite3_finalize(stmt);
+    if (!ok) return false;
+    
+    // 同一事务内回读：level 列仍是累加前的等级
+    UserXPState state;
+    const char* readSql = "SELECT total_xp, level, id FROM user_stats WHERE user_id = ?;";
+    if (sqlite3_prepare_v2(db, readSql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int(stmt, 1, userId);
+    ok = sqlite3_step(stmt) == SQLITE_ROW;
+    if (ok) {
+        state.totalXP = sqlite3_column_int(stmt, 0);
+        oldLevel = sqlite3_column_int(stmt, 1);
+        state.rowid = sqlite3_column_int64(stmt, 2);
+    }
+    sqlite3_finalize(stmt);
+    if (!ok) return false;
+    
+    state.level = calculateLevel(state.totalXP);
+    if (state.level != oldLevel) {
+        const char* levelSql = "UPDATE user_stats SET level = ? WHERE user_id = ?;";
+        if (sqlite3_prepare_v2(db, levelSql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+        sqlite3_bind_int(stmt, 1, state.level);
+        sqlite3_bind_int(stmt, 2, userId);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        if (!ok) return false;
     }
     
-    return level;
+    newTotal = state.totalXP;
+    newLevel = state.level;
+    userCache[userId] = state;
+    return true;
 }
 
-void XPSystem::updateUserStats(int totalXP, int level) {
-    if (!dbManager->isOpen()) return;
+const XPSystem::UserXPState& XPSystem::loadUserState(int userId) {
+    static MetricCounter& hits = MetricsRegistry::getInstance().counter(
+        "taskmgr_cache_requests_total", "Lookups in per-user in-memory caches", "cache=\"xp_user\",result=\"hit\"");
+    static MetricCounter& misses = MetricsRegistry::getInstance().counter(
+        "taskmgr_cache_requests_total", "Lookups in per-user in-memory caches", "cache=\"xp_user\",result=\"miss\"");
+
+    applyChanges();
+    auto it = userCache.find(userId);
+    if (it != userCache.end()) {
+        hits.inc();
+        return it->second;
+    }
+    misses.inc();
     
-    stringstream sql;
-    sql << "UPDATE user_stats SET "
-        << "total_xp = " << totalXP << ", "
-        << "level = " << level << " "
-        << "WHERE id = 1;";
+    UserXPState state;
+    if (dbManager->isOpen()) {
+        string sql = "SELECT total_xp, level, id FROM user_stats WHERE user_id = ?;";
+        sqlite3* db = dbManager->getRawConnection();
+        sqlite3_stmt* stmt;
+        
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, userId);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                state.totalXP = sqlite3_column_int(stmt, 0);
+                state.level = sqlite3_column_int(stmt, 1);
+                state.rowid = sqlite3_column_int64(stmt, 2);
+            } else {
+                // 新用户首次出现时补齐 user_stats 行，后续 UPDATE 才能生效
+                dbManager->ensureUser(userId);
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
     
-    dbManager->execute(sql.str());
+    return userCache[userId] = state;
+}
+
+// === 多用户 ===
+
+void XPSystem::setCurrentUserId(int userId) {
+    currentUserId = userId;
+}
+
+int XPSystem::getCurrentUserId() const {
+    return currentUserId;
+}
+
+void XPSystem::invalidateCache(int userId) {
+    userCache.erase(userId);
+}
+
+void XPSystem::clearCache() {
+    userCache.clear();
+}
+
+void XPSystem::applyChanges() {
+    if (!userStatsChanges->hasChanges()) return;
+    
+    ChangeBatch batch = userStatsChanges->take();
+    if (batch.truncated) {
+        userCache.clear();
+        return;
+    }
+    vector<sqlite3_int64> rows = batch.rowids("user_stats");
+    for (auto it = userCache.begin(); it != userCache.end();) {
+        bool stale = it->second.rowid == 0 || binary_search(rows.begin(), rows.end(), it->second.rowid);
+        it = stale ? userCache.erase(it) : next(it);
+    }
 }
 
 // === 经验值管理 ===
 
 bool XPSystem::awardXP(int amount, const string& source) {
+    return awardXP(currentUserId, amount, source);
+}
+
+bool XPSystem::awardXP(int userId, int amount, const string& source) {
+    TRACE_SCOPE_DETAIL("xp", "XPSystem::awardXP", source);
     if (!dbManager->isOpen() || amount <= 0) return false;
     
-    // 获取当前总经验值
-    int currentTotal = getTotalXP();
-    int oldLevel = getCurrentLevel();
+    // 流水和 user_stats 在同一个 SAVEPOINT 里提交，任何一步失败两者都不生效；
+    // 持有连接锁直到 RELEASE，其他线程在共享连接上的语句不会落进这个 SAVEPOINT
+    int oldLevel = 1, newTotal = 0, newLevel = 1;
+    {
+        auto guard = dbManager->lockConnection();
+        loadUserState(userId);  // 确保 user_stats 行存在
+        if (!dbManager->execute("SAVEPOINT xp_award;")) return false;
+        if (!XPLedger::getInstance().append(userId, amount, source) ||
+            !addUserXP(userId, amount, oldLevel, newTotal, newLevel)) {
+            dbManager->execute("ROLLBACK TO xp_award;");
+            dbManager->execute("RELEASE xp_award;");
+            userCache.erase(userId);
+            return false;
+        }
+        if (!dbManager->execute("RELEASE xp_award;")) {
+            userCache.erase(userId);
+            return false;
+        }
+    }
     
-    // 增加经验值
-    int newTotal = currentTotal + amount;
-    int newLevel = calculateLevel(newTotal);
+    // 同步排行榜（未加载时由启动阶段的 rebuild 从数据库读取）
+    Leaderboard& leaderboard = Leaderboard::getInstance();
+    if (leaderboard.isLoaded()) {
+        leaderboard.updateUser(userId, newTotal, newLevel);
+    }
     
-    // 更新数据库
-    updateUserStats(newTotal, newLevel);
+    static MetricCounter& awardedTotal = MetricsRegistry::getInstance().counter(
+        "taskmgr_xp_awarded_total", "XP awarded to all users");
+    static MetricWindow& awardedLastMinute = MetricsRegistry::getInstance().window(
+        "taskmgr_xp_awarded_last_minute", "XP awarded to all users in the last 60 seconds");
+    awardedTotal.inc(static_cast<std::uint64_t>(amount));
+    awardedLastMinute.add(amount);
     
     // 显示获得经验值的消息
     cout << "\n✨ 获得 " << amount << " 经验值! ";
@@ -122,63 +220,63 @@ bool XPSystem::awardXP(int amount, const string& source) {
     return true;
 }
 
+bool XPSystem::rebuildFromLedger(int userId) {
+    TRACE_SCOPE("xp", "XPSystem::rebuildFromLedger");
+    if (!dbManager->isOpen()) return false;
+    
+    XPLedger::ReplayResult state = XPLedger::getInstance().replay(userId);
+    loadUserState(userId);  // 确保 user_stats 行存在
+    
+    int level = calculateLevel(state.totalXP);
+    updateUserStats(userId, state.totalXP, level);
+    
+    Leaderboard& leaderboard = Leaderboard::getInstance();
+    if (leaderboard.isLoaded()) {
+        leaderboard.updateUser(userId, state.totalXP, level);
+    }
+    
+    return true;
+}
+
 int XPSystem::getCurrentXP() {
     int totalXP = getTotalXP();
     int level = getCurrentLevel();
     
     // 当前等级的起始经验值
-    int levelStartXP = levelThresholds[level];
+    int levelStartXP = LevelTable::thresholdFor(level);
     
     // 当前等级内的经验值
     return totalXP - levelStartXP;
 }
 
 int XPSystem::getTotalXP() {
+    return getTotalXP(currentUserId);
+}
+
+int XPSystem::getTotalXP(int userId) {
     if (!dbManager->isOpen()) return 0;
-    
-    string sql = "SELECT total_xp FROM user_stats WHERE id = 1;";
-    sqlite3* db = dbManager->getRawConnection();
-    sqlite3_stmt* stmt;
-    int result = 0;
-    
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            result = sqlite3_column_int(stmt, 0);
-        }
-        sqlite3_finalize(stmt);
-    }
-    
-    return result;
+    return loadUserState(userId).totalXP;
 }
 
 // === 等级管理 ===
 
 int XPSystem::getCurrentLevel() {
+    return getCurrentLevel(currentUserId);
+}
+
+int XPSystem::getCurrentLevel(int userId) {
     if (!dbManager->isOpen()) return 1;
-    
-    string sql = "SELECT level FROM user_stats WHERE id = 1;";
-    sqlite3* db = dbManager->getRawConnection();
-    sqlite3_stmt* stmt;
-    int result = 1;
-    
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            result = sqlite3_column_int(stmt, 0);
-        }
-        sqlite3_finalize(stmt);
-    }
-    
-    return result;
+    return loadUserState(userId).level;
 }
 
 int XPSystem::getXPForNextLevel() {
     int level = getCurrentLevel();
     
-    if (level >= 20) {
-        return levelThresholds[20]; // 已满级
+    if (level >= LevelTable::MAX_LEVEL) {
+        return LevelTable::thresholdFor(LevelTable::MAX_LEVEL); // 已满级
     }
     
-    return levelThresholds[level + 1];
+    return LevelTable::thresholdFor(level + 1);
 }
 
 int XPSystem::getXPProgressToNextLevel() {
@@ -191,13 +289,13 @@ int XPSystem::getXPProgressToNextLevel() {
 double XPSystem::getLevelProgress() {
     int level = getCurrentLevel();
     
-    if (level >= 20) {
+    if (level >= LevelTable::MAX_LEVEL) {
         return 1.0; // 已满级
     }
     
     int totalXP = getTotalXP();
-    int currentLevelXP = levelThresholds[level];
-    int nextLevelXP = levelThresholds[level + 1];
+    int currentLevelXP = LevelTable::thresholdFor(level);
+    int nextLevelXP = LevelTable::thresholdFor(level + 1);
     
     int xpInLevel = totalXP - currentLevelXP;
     int xpNeeded = nextLevelXP - currentLevelXP;
@@ -208,10 +306,8 @@ double XPSystem::getLevelProgress() {
 }
 
 string XPSystem::getLevelTitle(int level) {
-    if (levelTitles.find(level) != levelTitles.end()) {
-        return levelTitles[level];
-    }
-    return "未知";
+    if (level > LevelTable::MAX_LEVEL) return "未知";
+    return LevelTable::titleFor(level);
 }
 
 string XPSystem::getCurrentLevelTitle() {
@@ -266,12 +362,12 @@ string XPSystem::displayLevelInfo() {
     info << "等级: " << level << " (" << title << ")\n";
     info << "总经验值: " << totalXP << " XP\n";
     
-    if (level < 20) {
+    if (level < LevelTable::MAX_LEVEL) {
         int nextLevelXP = getXPForNextLevel();
         int needed = getXPProgressToNextLevel();
         double progress = getLevelProgress() * 100;
         
-        info << "当前进度: " << currentXP << " / " << (nextLevelXP - levelThresholds[level]) << " XP\n";
+        info << "当前进度: " << currentXP << " / " << (nextLevelXP - LevelTable::thresholdFor(level)) << " XP\n";
         info << "距离下级: " << needed << " XP\n";
         info << "进度: " << fixed << setprecision(1) << progress << "%\n";
         
@@ -306,9 +402,5 @@ string XPSystem::displayXPBar(int width) {
 }
 
 string XPSystem::getLevelBadge(int level) {
-    if (level >= 20) return "👑";
-    if (level >= 15) return "💎";
-    if (level >= 10) return "🏆";
-    if (level >= 5) return "⭐";
-    return "🌟";
+    return LevelTable::badgeFor(level);
 }
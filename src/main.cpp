@@ -23,21 +23,68 @@
 #include <string>
 #include <thread> // 动画支持
 #include <chrono> // 时间控制
+#include <cstdlib>
+#include <cstring>
 #include "database/DatabaseManager.h"
+#include "database/QueryProfiler.h"
+#include "database/MaintenanceScheduler.h"
+#include "database/ChangeNotifier.h"
+#include "trace/Tracer.h"
+#include "metrics/MetricsServer.h"
+#include "cli/CommandLine.h"
 #include "ui/UIManager.h"
 #include "statistics/StatisticsAnalyzer.h"
 #include "gamification/XPSystem.h"
+#include "gamification/Leaderboard.h"
+#include "gamification/XPLedger.h"
+#include "Pomodoro/PomodoroEngine.h"
 
 using namespace std;
 
+// === 启动选项 ===
+
+// TASK_MANAGER_FAST_START=1：跳过动画和开始前的确认、逐表检查，完整性检查转入后台，
+// 排行榜和番茄钟事件循环首次使用时再加载；维护线程和变更通知照常启动（只开连接，不做扫描）
+bool fastStartEnabled() {
+    static const bool enabled = [] {
+        const char* value = std::getenv("TASK_MANAGER_FAST_START");
+        return value && std::strcmp(value, "0") != 0;
+    }();
+    return enabled;
+}
+
+// TASK_MANAGER_INTEGRITY_CHECK=full|quick|background|off，快速启动时默认 background
+string integrityCheckMode() {
+    const char* value = std::getenv("TASK_MANAGER_INTEGRITY_CHECK");
+    if (value && *value) return value;
+    return fastStartEnabled() ? "background" : "full";
+}
+
+// TASK_MANAGER_MAINTENANCE=0：不启动后台维护线程（检查点交回 SQLite 自动处理）
+bool maintenanceEnabled() {
+    const char* value = std::getenv("TASK_MANAGER_MAINTENANCE");
+    return !value || std::strcmp(value, "0") != 0;
+}
+
+// TASK_MANAGER_NOTIFY=0：不与同一数据库上的其他进程互通变更通知
+bool notifyEnabled() {
+    const char* value = std::getenv("TASK_MANAGER_NOTIFY");
+    return !value || std::strcmp(value, "0") != 0;
+}
+
 // === 视觉辅助工具 (本地静态函数) ===
 
 void sleepMs(int ms) {
+    if (fastStartEnabled()) return;
     this_thread::sleep_for(chrono::milliseconds(ms));
 }
 
 // 打字机效果：逐字输出
 void typewriterPrint(const string& text, int speedMs = 20, string color = "\033[1;37m") {
+    if (fastStartEnabled()) {
+        cout << color << text << "\033[0m" << endl;
+        return;
+    }
     cout << color;
     for (char c : text) {
         cout << c << flush;
@@ -48,6 +95,7 @@ void typewriterPrint(const string& text, int speedMs = 20, string color = "\033[
 
 // 模拟加载进度条
 void simulateLoading(const string& taskName) {
+    if (fastStartEnabled()) return;
     cout << "  " << taskName << " [";
     for (int i = 0; i < 20; ++i) {
         cout << "\033[1;36m#\033[0m" << flush; // 青色进度块
@@ -61,6 +109,7 @@ void simulateLoading(const string& taskName) {
  * @brief 显示欢迎横幅 (增强版)
  */
 void displayWelcomeBanner() {
+    if (fastStartEnabled()) return;
     sleepMs(500);
     cout << "\033[2J\033[H"; // 清屏
     
@@ -102,8 +151,11 @@ bool initializeSystem() {
         cerr << "Error: " << db.getLastErrorMessage() << endl;
         return false;
     }
+    // 超过阈值的语句连同查询计划记入慢查询日志
+    db.setSlowQueryLog("slow_queries.log");
     
     // 2. 验证数据库表 -> "Verifying World State"
+    //    initialize() 已按 user_version 保证 schema 完整，快速启动时不再逐表确认
     simulateLoading("Verifying World State    ");
     
     bool allTablesExist = true;
@@ -113,6 +165,7 @@ bool initializeSystem() {
     };
     
     for (const string& table : requiredTables) {
+        if (fastStartEnabled()) break;
         if (!db.tableExists(table)) {
             cerr << "\033[1;31m[MISSING] Artifact '" << table << "' not found.\033[0m" << endl;
             allTablesExist = false;
@@ -126,11 +179,52 @@ bool initializeSystem() {
     // 3. 检查完整性 -> "Syncing with Server"
     simulateLoading("Syncing Player Stats     ");
     
-    if (!db.checkDatabaseIntegrity()) {
+    //    完整检查要扫全库，大库上可能要几秒；background 模式下问题只会以警告形式报告
+    string integrityMode = integrityCheckMode();
+    bool integrityOk = true;
+    if (integrityMode == "full") {
+        integrityOk = db.checkDatabaseIntegrity();
+    } else if (integrityMode == "quick") {
+        integrityOk = db.quickCheckIntegrity();
+    } else if (integrityMode == "background") {
+        db.startBackgroundIntegrityCheck();
+    } else if (integrityMode != "off") {
+        cerr << "\033[1;33m[WARN] Unknown TASK_MANAGER_INTEGRITY_CHECK '" << integrityMode
+             << "', skipping.\033[0m" << endl;
+    }
+    
+    if (!integrityOk) {
         cerr << "\033[1;31m[ERROR] Data integrity breach detected!\033[0m" << endl;
         return false;
     }
     
+    // 4. 重建排行榜 -> 内存中的名次索引（快速启动时推迟到第一次查看排行榜）
+    if (!fastStartEnabled() && !Leaderboard::getInstance().rebuild()) {
+        cerr << "\033[1;33m[WARN] Leaderboard unavailable.\033[0m" << endl;
+    }
+    
+    // 5. 启动番茄钟事件循环（后台线程；快速启动时推迟到第一个会话开始）
+    if (!fastStartEnabled()) {
+        PomodoroEngine::getInstance().start();
+    }
+    
+    // 6. 设置了 TASK_MANAGER_METRICS_SOCKET 时在该 Unix 套接字上导出指标
+    if (const char* metricsSocket = std::getenv("TASK_MANAGER_METRICS_SOCKET")) {
+        if (!MetricsServer::getInstance().start(metricsSocket)) {
+            cerr << "\033[1;33m[WARN] Metrics endpoint unavailable.\033[0m" << endl;
+        }
+    }
+    
+    // 7. 后台维护线程：空闲时做检查点、更新统计信息、分步回收空闲页
+    if (maintenanceEnabled() && !MaintenanceScheduler::getInstance().start()) {
+        cerr << "\033[1;33m[WARN] Background maintenance unavailable.\033[0m" << endl;
+    }
+    
+    // 8. 跨进程变更通知：其他实例（命令行、另一个终端）提交后让本进程的缓存失效
+    if (notifyEnabled() && !ChangeNotifier::getInstance().start(db.getDatabasePath())) {
+        cerr << "\033[1;33m[WARN] Cross-process change notification unavailable.\033[0m" << endl;
+    }
+    
     cout << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
     typewriterPrint(">> System ready. Let's get things done.", 20, "\033[1;32m");
     cout << "\n";
@@ -141,6 +235,17 @@ bool initializeSystem() {
     return true;
 }
 
+/**
+ * @brief 设置了 TASK_MANAGER_TRACE 时导出本次运行的追踪数据
+ */
+void exportTraceIfRequested() {
+    if (const char* tracePath = std::getenv("TASK_MANAGER_TRACE")) {
+        if (Tracer::writeChromeTrace(tracePath)) {
+            cerr << ">> Trace written to " << tracePath << "\n";
+        }
+    }
+}
+
 /**
  * @brief 清理系统资源
  */
@@ -148,8 +253,20 @@ void cleanupSystem() {
     cout << "\n\033[1;33m>> Saving progress...\033[0m\n";
     sleepMs(500);
     
-    // 关闭数据库连接
+    // 指标回调会访问数据库，先于其他单例停掉；维护线程的连接也要在数据库关闭前断开
+    MetricsServer::destroyInstance();
+    MaintenanceScheduler::destroyInstance();
+    ChangeNotifier::destroyInstance();
+    
+    // 停止番茄钟并写入剩余记录，然后关闭数据库连接
+    PomodoroEngine::getInstance().stop();
+    PomodoroEngine::destroyInstance();
+    XPLedger::destroyInstance();
+    Leaderboard::destroyInstance();
     DatabaseManager::destroyInstance();
+    QueryProfiler::destroyInstance();
+    
+    exportTraceIfRequested();
     
     simulateLoading("Closing Quest Log        ");
 }
@@ -157,8 +274,22 @@ void cleanupSystem() {
 /**
  * @brief 主函数
  */
-int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
+int main(int argc, char* argv[]) {
     try {
+        // TASK_MANAGER_TRACE=trace.json 时开启追踪，退出时导出为 Chrome trace JSON
+        if (std::getenv("TASK_MANAGER_TRACE")) {
+            Tracer::setEnabled(true);
+            TRACE_THREAD_NAME("main");
+        }
+        
+        // 带参数时走无界面的命令行模式：没有动画，按需打开数据库，执行完立即退出
+        if (argc > 1) {
+            int code = CommandLine().run(argc, argv);
+            QueryProfiler::destroyInstance();
+            exportTraceIfRequested();
+            return code;
+        }
+        
         // 1. 酷炫的开场
         displayWelcomeBanner();
         
@@ -170,8 +301,10 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
         
         // 3. 启动 UI (将控制权交给 UIManager)
         // 这里的 "Press Enter" 增加了一点互动感
-        cout << "\033[1;36m>> Press ENTER to Start Session <<\033[0m";
-        cin.get(); 
+        if (!fastStartEnabled()) {
+            cout << "\033[1;36m>> Press ENTER to Start Session <<\033[0m";
+            cin.get();
+        }
         
         UIManager* ui = new UIManager();
         ui->run();
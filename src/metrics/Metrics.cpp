@@ -0,0 +1,236 @@
+#include "metrics/Metrics.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+std::unique_ptr<MetricsRegistry> MetricsRegistry::instance = nullptr;
+std::mutex MetricsRegistry::instanceMutex;
+
+namespace {
+
+std::int64_t currentSecond() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string joinLabels(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) return extra;
+    if (extra.empty()) return labels;
+    return labels + "," + extra;
+}
+
+std::string formatBound(double bound) {
+    std::ostringstream out;
+    out << std::setprecision(10) << bound;
+    return out.str();
+}
+
+} // namespace
+
+// === MetricHistogram ===
+
+MetricHistogram::MetricHistogram(std::vector<double> upperBounds)
+    : bounds(std::move(upperBounds)) {
+    std::sort(bounds.begin(), bounds.end());
+    counts = std::make_unique<std::atomic<std::uint64_t>[]>(bounds.size() + 1);
+    for (size_t i = 0; i <= bounds.size(); ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double value) {
+    size_t bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    double current = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+// === MetricWindow ===
+
+void MetricWindow::add(std::int64_t n) {
+    std::int64_t now = currentSecond();
+    Slot& slot = slots[now % SLOTS];
+    std::int64_t seen = slot.second.load(std::memory_order_relaxed);
+    if (seen != now && slot.second.compare_exchange_strong(seen, now, std::memory_order_relaxed)) {
+        // 这个槽上一次用是一分钟以前，先清零
+        slot.value.store(0, std::memory_order_relaxed);
+    }
+    slot.value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::int64_t MetricWindow::lastMinute() const {
+    std::int64_t now = currentSecond();
+    std::int64_t total = 0;
+    for (const auto& slot : slots) {
+        std::int64_t second = slot.second.load(std::memory_order_relaxed);
+        if (second >= 0 && now - second < SLOTS) {
+            total += slot.value.load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+// === MetricsRegistry ===
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<MetricsRegistry>();
+    }
+    return *instance;
+}
+
+MetricsRegistry::Series* MetricsRegistry::findSeries(const std::string& name, const std::string& labels) {
+    auto it = families.find(name);
+    if (it == families.end()) return nullptr;
+    for (auto& series : it->second.series) {
+        if (series.labels == labels) return &series;
+    }
+    return nullptr;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Kind kind) {
+    auto it = families.find(name);
+    if (it == families.end()) {
+        familyOrder.push_back(name);
+        it = families.emplace(name, Family{help, kind, {}}).first;
+    } else if (it->second.kind != kind) {
+        std::cerr << "MetricsRegistry: 指标 " << name << " 以不同类型重复注册" << std::endl;
+    }
+    return it->second;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                        const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (Series* series = findSeries(name, labels)) {
+        return *static_cast<MetricCounter*>(series->metric);
+    }
+    counters.emplace_back();
+    family(name, help, Kind::Counter).series.push_back(Series{labels, Kind::Counter, &counters.back()});
+    return counters.back();
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                                    const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (Series* series = findSeries(name, labels)) {
+        return *static_cast<MetricGauge*>(series->metric);
+    }
+    gauges.emplace_back();
+    family(name, help, Kind::Gauge).series.push_back(Series{labels, Kind::Gauge, &gauges.back()});
+    return gauges.back();
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                            const std::vector<double>& upperBounds,
+                                            const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (Series* series = findSeries(name, labels)) {
+        return *static_cast<MetricHistogram*>(series->metric);
+    }
+    histograms.emplace_back(upperBounds);
+    family(name, help, Kind::Histogram).series.push_back(Series{labels, Kind::Histogram, &histograms.back()});
+    return histograms.back();
+}
+
+MetricWindow& MetricsRegistry::window(const std::string& name, const std::string& help,
+                                      const std::string& labels) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (Series* series = findSeries(name, labels)) {
+        return *static_cast<MetricWindow*>(series->metric);
+    }
+    windows.emplace_back();
+    family(name, help, Kind::Window).series.push_back(Series{labels, Kind::Window, &windows.back()});
+    return windows.back();
+}
+
+void MetricsRegistry::addCollector(const std::string& name, std::function<void(std::ostream&)> collector) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto& entry : collectors) {
+        if (entry.first == name) {
+            entry.second = std::move(collector);
+            return;
+        }
+    }
+    collectors.emplace_back(name, std::move(collector));
+}
+
+void MetricsRegistry::removeCollector(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    collectors.erase(std::remove_if(collectors.begin(), collectors.end(),
+                                    [&](const auto& entry) { return entry.first == name; }),
+                     collectors.end());
+}
+
+void MetricsRegistry::writeHeader(std::ostream& out, const std::string& name,
+                                  const std::string& help, const std::string& type) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+void MetricsRegistry::writeSample(std::ostream& out, const std::string& name,
+                                  const std::string& labels, double value) {
+    out << name;
+    if (!labels.empty()) out << "{" << labels << "}";
+    out << " ";
+    if (std::isinf(value)) out << (value > 0 ? "+Inf" : "-Inf");
+    else out << std::setprecision(15) << value;
+    out << "\n";
+}
+
+void MetricsRegistry::render(std::ostream& out) const {
+    std::vector<std::pair<std::string, std::function<void(std::ostream&)>>> pendingCollectors;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& name : familyOrder) {
+            const Family& fam = families.at(name);
+            static const char* typeNames[] = {"counter", "gauge", "histogram", "gauge"};
+            writeHeader(out, name, fam.help, typeNames[static_cast<int>(fam.kind)]);
+
+            for (const auto& series : fam.series) {
+                switch (series.kind) {
+                    case Kind::Counter:
+                        writeSample(out, name, series.labels,
+                                    static_cast<double>(static_cast<MetricCounter*>(series.metric)->get()));
+                        break;
+                    case Kind::Gauge:
+                        writeSample(out, name, series.labels,
+                                    static_cast<double>(static_cast<MetricGauge*>(series.metric)->get()));
+                        break;
+                    case Kind::Window:
+                        writeSample(out, name, series.labels,
+                                    static_cast<double>(static_cast<MetricWindow*>(series.metric)->lastMinute()));
+                        break;
+                    case Kind::Histogram: {
+                        auto* hist = static_cast<MetricHistogram*>(series.metric);
+                        std::uint64_t cumulative = 0;
+                        for (size_t i = 0; i < hist->getBounds().size(); ++i) {
+                            cumulative += hist->getBucket(i);
+                            writeSample(out, name + "_bucket",
+                                        joinLabels(series.labels, "le=\"" + formatBound(hist->getBounds()[i]) + "\""),
+                                        static_cast<double>(cumulative));
+                        }
+                        cumulative += hist->getBucket(hist->getBounds().size());
+                        writeSample(out, name + "_bucket", joinLabels(series.labels, "le=\"+Inf\""),
+                                    static_cast<double>(cumulative));
+                        writeSample(out, name + "_sum", series.labels, hist->getSum());
+                        writeSample(out, name + "_count", series.labels, static_cast<double>(hist->getCount()));
+                        break;
+                    }
+                }
+            }
+        }
+        pendingCollectors = collectors;
+    }
+
+    // 回调可能要查数据库，放在锁外执行
+    for (const auto& entry : pendingCollectors) {
+        entry.second(out);
+    }
+}
@@ -0,0 +1,266 @@
+#include "metrics/MetricsServer.h"
+#include "metrics/Metrics.h"
+#include "database/DatabaseManager.h"
+#include "database/QueryProfiler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+std::unique_ptr<MetricsServer> MetricsServer::instance = nullptr;
+std::mutex MetricsServer::instanceMutex;
+
+namespace {
+
+const auto processStart = std::chrono::steady_clock::now();
+
+// /proc/self/statm 第二列是常驻页数
+long residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    long totalPages = 0;
+    long residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) return 0;
+    return residentPages * sysconf(_SC_PAGESIZE);
+}
+
+// 单个抓取方最多占用服务线程这么久，之后放弃该连接，不拖住后面的抓取
+constexpr int SEND_TIMEOUT_MS = 1000;
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsServer& MetricsServer::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<MetricsServer>();
+    }
+    return *instance;
+}
+
+void MetricsServer::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    if (running) return true;
+
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "MetricsServer: 套接字路径过长: " << path << std::endl;
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "MetricsServer: 创建套接字失败: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // 只清理上次异常退出留下的套接字文件；路径写错时不能删掉普通文件
+    struct stat info;
+    if (lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            std::cerr << "MetricsServer: " << path << " 已存在且不是套接字" << std::endl;
+            close(fd);
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        if (probe >= 0) close(probe);
+        if (live) {
+            std::cerr << "MetricsServer: " << path << " 上已有进程在导出指标" << std::endl;
+            close(fd);
+            return false;
+        }
+        unlink(path.c_str());
+    }
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        std::cerr << "MetricsServer: 监听 " << path << " 失败: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+    if (pipe2(wakePipe, O_CLOEXEC) < 0) {
+        std::cerr << "MetricsServer: 创建唤醒管道失败: " << std::strerror(errno) << std::endl;
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    registerBuiltinCollectors();
+    listenFd = fd;
+    socketPath = path;
+    running = true;
+    serverThread = std::thread(&MetricsServer::serve, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    if (!running) return;
+
+    running = false;
+    char byte = 1;
+    if (write(wakePipe[1], &byte, 1) < 0) {
+        // 退而求其次：关闭监听端也会让 poll 返回
+        shutdown(listenFd, SHUT_RDWR);
+    }
+    if (serverThread.joinable()) {
+        serverThread.join();
+    }
+
+    close(listenFd);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    listenFd = -1;
+    wakePipe[0] = wakePipe[1] = -1;
+    unlink(socketPath.c_str());
+
+    // 内置回调引用了 DatabaseManager 等单例，停止后不再需要
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+    registry.removeCollector("database");
+    registry.removeCollector("process");
+}
+
+std::string MetricsServer::getSocketPath() const {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    return socketPath;
+}
+
+void MetricsServer::serve() {
+    pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+
+    while (running) {
+        int ready = poll(fds, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "MetricsServer: poll 失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
+        if (fds[0].revents & (POLLERR | POLLHUP)) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        // 连上却不读的抓取方：发送超时后 sendAll 失败并断开
+        timeval timeout{SEND_TIMEOUT_MS / 1000, (SEND_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        handleClient(client);
+        close(client);
+    }
+}
+
+void MetricsServer::handleClient(int clientFd) {
+    // 给对方一点时间发请求行；什么都不发也照样返回指标
+    std::string request;
+    pollfd pfd{clientFd, POLLIN, 0};
+    if (poll(&pfd, 1, 100) > 0 && (pfd.revents & POLLIN)) {
+        char buf[1024];
+        ssize_t n = recv(clientFd, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) request.assign(buf, static_cast<size_t>(n));
+    }
+
+    scrapeCount++;
+    std::ostringstream body;
+    MetricsRegistry::getInstance().render(body);
+    std::string payload = body.str();
+
+    if (request.rfind("GET ", 0) == 0 || request.rfind("HEAD ", 0) == 0) {
+        std::ostringstream header;
+        header << "HTTP/1.0 200 OK\r\n"
+               << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+               << "Content-Length: " << payload.size() << "\r\n"
+               << "Connection: close\r\n\r\n";
+        bool headOnly = request.rfind("HEAD ", 0) == 0;
+        if (!sendAll(clientFd, header.str()) || headOnly) return;
+    }
+    sendAll(clientFd, payload);
+}
+
+void MetricsServer::registerBuiltinCollectors() {
+    MetricsRegistry& registry = MetricsRegistry::getInstance();
+
+    registry.addCollector("database", [](std::ostream& out) {
+        DatabaseManager& db = DatabaseManager::getInstance();
+        MetricsRegistry::writeHeader(out, "taskmgr_db_queries_total",
+                                     "Statements run through DatabaseManager", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_db_queries_total", "",
+                                     static_cast<double>(db.getTotalQueryCount()));
+        MetricsRegistry::writeHeader(out, "taskmgr_db_query_failures_total",
+                                     "Failed statements run through DatabaseManager", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_db_query_failures_total", "",
+                                     static_cast<double>(db.getFailedQueryCount()));
+
+        // 所有被剖析连接上的语句，按指纹合并成一份延迟分布
+        QueryProfiler& profiler = QueryProfiler::getInstance();
+        LatencyHistogram overall;
+        double totalMicros = 0.0;
+        double rows = 0.0;
+        for (const auto& stats : profiler.getTopStatements(std::numeric_limits<size_t>::max())) {
+            overall.merge(stats.histogram);
+            totalMicros += static_cast<double>(stats.totalMicros);
+            rows += static_cast<double>(stats.rows);
+        }
+        const char* latency = "taskmgr_db_statement_latency_microseconds";
+        MetricsRegistry::writeHeader(out, latency, "Statement latency across all profiled connections", "summary");
+        for (double q : {0.5, 0.9, 0.99}) {
+            std::ostringstream label;
+            label << "quantile=\"" << q << "\"";
+            MetricsRegistry::writeSample(out, latency, label.str(),
+                                         static_cast<double>(overall.percentile(q * 100.0)));
+        }
+        MetricsRegistry::writeSample(out, std::string(latency) + "_sum", "", totalMicros);
+        MetricsRegistry::writeSample(out, std::string(latency) + "_count", "",
+                                     static_cast<double>(overall.getCount()));
+        MetricsRegistry::writeHeader(out, "taskmgr_db_rows_returned_total",
+                                     "Rows returned by profiled statements", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_db_rows_returned_total", "", rows);
+        MetricsRegistry::writeHeader(out, "taskmgr_db_slow_queries", "Entries in the slow-query log", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_db_slow_queries", "",
+                                     static_cast<double>(profiler.getSlowQueries().size()));
+    });
+
+    registry.addCollector("process", [this](std::ostream& out) {
+        MetricsRegistry::writeHeader(out, "process_resident_memory_bytes", "Resident set size", "gauge");
+        MetricsRegistry::writeSample(out, "process_resident_memory_bytes", "",
+                                     static_cast<double>(residentBytes()));
+        MetricsRegistry::writeHeader(out, "taskmgr_uptime_seconds", "Seconds since process start", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_uptime_seconds", "",
+                                     std::chrono::duration<double>(std::chrono::steady_clock::now() - processStart).count());
+        MetricsRegistry::writeHeader(out, "taskmgr_metrics_scrapes_total", "Metrics requests served", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_metrics_scrapes_total", "",
+                                     static_cast<double>(getScrapeCount()));
+    });
+}
@@ -5,8 +5,8 @@ ProjectManager::ProjectManager() {
     dao = new ProjectDAO();
 }
 
-ProjectManager::ProjectManager(string dbPath) {
-    dao = new ProjectDAO(dbPath);
+ProjectManager::ProjectManager(string dbPath, int userId) {
+    dao = new ProjectDAO(dbPath, userId);
 }
 
 ProjectManager::~ProjectManager() {
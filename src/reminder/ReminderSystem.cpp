@@ -1,4 +1,5 @@
 #include "reminder/ReminderSystem.h"
+#include "metrics/Metrics.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -46,6 +47,15 @@ void ReminderSystem::checkDueReminders() {
     
     auto currentTime = std::chrono::system_clock::now();
     
+    static MetricsRegistry& metrics = MetricsRegistry::getInstance();
+    static MetricHistogram& fireLag = metrics.histogram(
+        "taskmgr_reminder_fire_lag_seconds", "Delay between a reminder's trigger time and when it fired",
+        {0.5, 1, 5, 15, 30, 60, 120, 300, 900, 3600});
+    static MetricCounter& firedTotal = metrics.counter(
+        "taskmgr_reminders_fired_total", "Reminders marked as triggered");
+    static MetricGauge& queueDepth = metrics.gauge(
+        "taskmgr_reminder_queue_depth", "Pending reminders after the last check");
+    
     std::cout << "=== 检查到期提醒 (" << getCurrentTime() << ") ===\n";
     
     try {
@@ -60,6 +70,8 @@ void ReminderSystem::checkDueReminders() {
             // 标记为已触发
             if (markReminderAsTriggered(reminder.id)) {
                 triggeredCount++;
+                firedTotal.inc();
+                fireLag.observe(std::chrono::duration<double>(std::chrono::system_clock::now() - reminder.triggerTime).count());
 
                 // 处理重复提醒
                 if (reminder.recurrence != "once") {
@@ -68,6 +80,8 @@ void ReminderSystem::checkDueReminders() {
             }
         }
         
+        queueDepth.set(reminderDAO->getReminderCountByStatus(ReminderStatus::PENDING));
+        
         if (triggeredCount == 0) {
             std::cout << "暂无到期提醒\n";
         } else {
@@ -0,0 +1,181 @@
+#include "rpc/RemoteTaskDAO.h"
+#include <iostream>
+
+bool RemoteTaskDAO::call(RpcOp op, const RpcWriter& args, RpcResponse& response) {
+    if (!client.isConnected()) {
+        std::cerr << "RemoteTaskDAO: 未连接到守护进程" << std::endl;
+        return false;
+    }
+    if (!client.call(op, args.data(), response)) {
+        std::cerr << "RemoteTaskDAO: 请求失败: " << client.getLastError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<Task> RemoteTaskDAO::callTasks(RpcOp op, const RpcWriter& args) {
+    RpcResponse response;
+    if (!call(op, args, response)) return {};
+    RpcReader reader(response.payload);
+    std::vector<Task> tasks = reader.tasks();
+    return reader.atEnd() ? tasks : std::vector<Task>();
+}
+
+bool RemoteTaskDAO::callBool(RpcOp op, const RpcWriter& args) {
+    RpcResponse response;
+    if (!call(op, args, response)) return false;
+    RpcReader reader(response.payload);
+    bool result = reader.boolean();
+    return reader.atEnd() && result;
+}
+
+int RemoteTaskDAO::callInt(RpcOp op, const RpcWriter& args, int failed) {
+    RpcResponse response;
+    if (!call(op, args, response)) return failed;
+    RpcReader reader(response.payload);
+    int result = reader.i32();
+    return reader.atEnd() ? result : failed;
+}
+
+int RemoteTaskDAO::insertTask(const Task& task) {
+    return callInt(RpcOp::TaskInsert, RpcWriter().task(task), -1);
+}
+
+std::optional<Task> RemoteTaskDAO::getTaskById(int id) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskGet, RpcWriter().i32(id), response)) return std::nullopt;
+    RpcReader reader(response.payload);
+    if (!reader.boolean()) return std::nullopt;
+    Task task = reader.task();
+    if (!reader.atEnd()) return std::nullopt;
+    return task;
+}
+
+std::vector<Task> RemoteTaskDAO::getAllTasks() {
+    return callTasks(RpcOp::TaskGetAll, RpcWriter());
+}
+
+std::vector<Task> RemoteTaskDAO::getTasksByIds(const std::vector<int>& ids) {
+    if (ids.empty()) return {};
+    return callTasks(RpcOp::TaskGetByIds, RpcWriter().ints(ids));
+}
+
+bool RemoteTaskDAO::updateTask(const Task& task) {
+    return callBool(RpcOp::TaskUpdate, RpcWriter().task(task));
+}
+
+bool RemoteTaskDAO::deleteTask(int id) {
+    return callBool(RpcOp::TaskDelete, RpcWriter().i32(id));
+}
+
+std::vector<Task> RemoteTaskDAO::getTasksByStatus(bool completed) {
+    return callTasks(RpcOp::TaskByStatus, RpcWriter().boolean(completed));
+}
+
+std::vector<Task> RemoteTaskDAO::getTasksByProject(int projectId) {
+    return callTasks(RpcOp::TaskByProject, RpcWriter().i32(projectId));
+}
+
+std::vector<Task> RemoteTaskDAO::getOverdueTasks() {
+    return callTasks(RpcOp::TaskOverdue, RpcWriter());
+}
+
+std::vector<Task> RemoteTaskDAO::getTodayTasks() {
+    return callTasks(RpcOp::TaskToday, RpcWriter());
+}
+
+int RemoteTaskDAO::countAllTasks() {
+    return callInt(RpcOp::TaskCount, RpcWriter(), 0);
+}
+
+int RemoteTaskDAO::countCompletedTasks() {
+    return callInt(RpcOp::TaskCountCompleted, RpcWriter(), 0);
+}
+
+bool RemoteTaskDAO::assignTaskToProject(int taskId, int projectId) {
+    return callBool(RpcOp::TaskAssignProject, RpcWriter().i32(taskId).i32(projectId));
+}
+
+bool RemoteTaskDAO::incrementPomodoro(int taskId) {
+    return callBool(RpcOp::TaskIncrementPomodoro, RpcWriter().i32(taskId));
+}
+
+int RemoteTaskDAO::getPomodoroCount(int taskId) {
+    return callInt(RpcOp::TaskPomodoroCount, RpcWriter().i32(taskId), 0);
+}
+
+bool RemoteTaskDAO::addDependency(int taskId, int dependsOn) {
+    return callBool(RpcOp::TaskAddDependency, RpcWriter().i32(taskId).i32(dependsOn));
+}
+
+bool RemoteTaskDAO::removeDependency(int taskId, int dependsOn) {
+    return callBool(RpcOp::TaskRemoveDependency, RpcWriter().i32(taskId).i32(dependsOn));
+}
+
+bool RemoteTaskDAO::loadDependencyGraph(std::vector<DependencyNode>& nodes,
+                                        std::vector<std::pair<int, int>>& edges) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskDependencyGraph, RpcWriter(), response)) return false;
+    RpcReader reader(response.payload);
+    bool ok = reader.boolean();
+    nodes = reader.list<DependencyNode>([&] { return reader.dependencyNode(); });
+    edges = reader.list<std::pair<int, int>>([&] {
+        int taskId = reader.i32();
+        return std::make_pair(taskId, reader.i32());
+    });
+    return reader.atEnd() && ok;
+}
+
+bool RemoteTaskDAO::loadScheduleEntries(std::vector<ScheduleEntry>& entries) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskScheduleEntries, RpcWriter(), response)) return false;
+    RpcReader reader(response.payload);
+    bool ok = reader.boolean();
+    entries = reader.list<ScheduleEntry>([&] { return reader.scheduleEntry(); });
+    return reader.atEnd() && ok;
+}
+
+std::optional<ScheduleEntry> RemoteTaskDAO::getScheduleEntry(int taskId) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskScheduleEntry, RpcWriter().i32(taskId), response)) return std::nullopt;
+    RpcReader reader(response.payload);
+    if (!reader.boolean()) return std::nullopt;
+    ScheduleEntry entry = reader.scheduleEntry();
+    if (!reader.atEnd()) return std::nullopt;
+    return entry;
+}
+
+bool RemoteTaskDAO::setTaskTags(int taskId, const std::vector<std::string>& names,
+                                std::vector<std::pair<int, std::string>>& interned) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskSetTags, RpcWriter().i32(taskId).strings(names), response)) return false;
+    RpcReader reader(response.payload);
+    bool ok = reader.boolean();
+    interned = reader.list<std::pair<int, std::string>>([&] {
+        int tagId = reader.i32();
+        return std::make_pair(tagId, reader.str());
+    });
+    return reader.atEnd() && ok;
+}
+
+std::vector<std::string> RemoteTaskDAO::getTaskTags(int taskId) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskGetTags, RpcWriter().i32(taskId), response)) return {};
+    RpcReader reader(response.payload);
+    std::vector<std::string> tags = reader.strings();
+    return reader.atEnd() ? tags : std::vector<std::string>();
+}
+
+bool RemoteTaskDAO::loadTagIndex(std::vector<std::pair<int, std::string>>& tags,
+                                 std::vector<TaggedTask>& tasks) {
+    RpcResponse response;
+    if (!call(RpcOp::TaskTagIndex, RpcWriter(), response)) return false;
+    RpcReader reader(response.payload);
+    bool ok = reader.boolean();
+    tags = reader.list<std::pair<int, std::string>>([&] {
+        int tagId = reader.i32();
+        return std::make_pair(tagId, reader.str());
+    });
+    tasks = reader.list<TaggedTask>([&] { return reader.taggedTask(); });
+    return reader.atEnd() && ok;
+}
@@ -0,0 +1,121 @@
+#include "rpc/RpcClient.h"
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+
+RpcClient::~RpcClient() {
+    close();
+}
+
+bool RpcClient::fail(const std::string& message) {
+    lastError = message;
+    close();
+    return false;
+}
+
+bool RpcClient::connect(const std::string& address) {
+    close();
+    fd = rpcConnect(address, lastError);
+    return fd >= 0;
+}
+
+void RpcClient::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    outBuffer.clear();
+    inBuffer.clear();
+    inPos = 0;
+    userId = 0;
+}
+
+bool RpcClient::login(int requestedUserId) {
+    RpcResponse response;
+    if (!call(RpcOp::Login, RpcWriter().i32(requestedUserId).data(), response)) return false;
+    RpcReader reader(response.payload);
+    int granted = reader.i32();
+    if (!reader.atEnd() || granted <= 0) {
+        lastError = "登录响应无效";
+        return false;
+    }
+    userId = granted;
+    return true;
+}
+
+std::uint32_t RpcClient::send(RpcOp op, const std::string& payload) {
+    std::uint32_t requestId = nextRequestId++;
+    outBuffer += RpcFrame::request(requestId, op, payload);
+    return requestId;
+}
+
+bool RpcClient::flush() {
+    if (fd < 0) return fail("未连接");
+
+    size_t sent = 0;
+    while (sent < outBuffer.size()) {
+        ssize_t n = ::send(fd, outBuffer.data() + sent, outBuffer.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return fail(std::string("发送失败: ") + std::strerror(errno));
+        }
+        sent += static_cast<size_t>(n);
+    }
+    outBuffer.clear();
+    return true;
+}
+
+bool RpcClient::receive(RpcResponse& response) {
+    if (fd < 0) return fail("未连接");
+
+    while (true) {
+        size_t available = inBuffer.size() - inPos;
+        if (available >= RpcFrame::LENGTH_BYTES) {
+            std::uint32_t length = RpcFrame::readLength(inBuffer.data() + inPos);
+            if (length < RpcFrame::RESPONSE_HEADER || length > RpcFrame::MAX_FRAME) {
+                return fail("响应帧长度无效");
+            }
+            if (available >= RpcFrame::LENGTH_BYTES + length) {
+                RpcReader header(inBuffer.data() + inPos + RpcFrame::LENGTH_BYTES, RpcFrame::RESPONSE_HEADER);
+                response.requestId = header.u32();
+                response.status = static_cast<RpcStatus>(header.u16());
+                const char* payload = inBuffer.data() + inPos + RpcFrame::LENGTH_BYTES + RpcFrame::RESPONSE_HEADER;
+                response.payload.assign(payload, length - RpcFrame::RESPONSE_HEADER);
+                inPos += RpcFrame::LENGTH_BYTES + length;
+                if (inPos == inBuffer.size()) {
+                    inBuffer.clear();
+                    inPos = 0;
+                }
+                return true;
+            }
+        }
+
+        // 已消费的部分占了大半时再整理，避免每帧都搬移
+        if (inPos > 0 && inPos * 2 >= inBuffer.size()) {
+            inBuffer.erase(0, inPos);
+            inPos = 0;
+        }
+        char chunk[64 * 1024];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n == 0) return fail("服务端关闭了连接");
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return fail(std::string("接收失败: ") + std::strerror(errno));
+        }
+        inBuffer.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+bool RpcClient::call(RpcOp op, const std::string& payload, RpcResponse& response) {
+    std::uint32_t requestId = send(op, payload);
+    if (!flush() || !receive(response)) return false;
+    if (response.requestId != requestId) {
+        return fail("响应与请求不匹配");
+    }
+    if (response.status != RpcStatus::Ok) {
+        lastError = response.payload;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,454 @@
+#include "rpc/RpcProtocol.h"
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+void putU16(std::string& out, std::uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void putU32(std::string& out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+struct Endpoint {
+    bool isUnix = false;
+    std::string path;
+    int family = AF_INET;
+    std::string host;
+    int port = 0;
+};
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() &&
+           value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool parseAddress(const std::string& address, Endpoint& endpoint, std::string& error) {
+    std::string hostPort;
+    if (address.rfind("unix:", 0) == 0) {
+        endpoint.isUnix = true;
+        endpoint.path = address.substr(5);
+    } else if (address.rfind("tcp:", 0) == 0) {
+        hostPort = address.substr(4);
+    } else if (address.find('/') != std::string::npos || endsWith(address, ".sock")) {
+        endpoint.isUnix = true;
+        endpoint.path = address;
+    } else {
+        hostPort = address;
+    }
+
+    if (endpoint.isUnix) {
+        if (endpoint.path.empty() || endpoint.path.size() >= sizeof(sockaddr_un::sun_path)) {
+            error = "套接字路径为空或过长: " + endpoint.path;
+            return false;
+        }
+        return true;
+    }
+
+    size_t colon = hostPort.rfind(':');
+    if (colon == std::string::npos) {
+        error = "缺少端口: " + address;
+        return false;
+    }
+    std::string host = hostPort.substr(0, colon);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    try {
+        endpoint.port = std::stoi(hostPort.substr(colon + 1));
+    } catch (...) {
+        endpoint.port = 0;
+    }
+    if (endpoint.port <= 0 || endpoint.port > 65535) {
+        error = "端口无效: " + address;
+        return false;
+    }
+
+    // 没有认证和加密，只允许回环地址
+    if (host == "127.0.0.1" || host == "localhost") {
+        endpoint.family = AF_INET;
+        endpoint.host = "127.0.0.1";
+    } else if (host == "::1") {
+        endpoint.family = AF_INET6;
+        endpoint.host = host;
+    } else {
+        error = "只允许监听/连接回环地址: " + host;
+        return false;
+    }
+    return true;
+}
+
+// 按内核在 /proc/net/tcp{,6} 里的格式输出地址：IP 按 32 位字原样以 %08X 打印，端口为主机序
+std::string procNetAddress(const sockaddr_storage& addr) {
+    char text[48];
+    if (addr.ss_family == AF_INET) {
+        const auto* in = reinterpret_cast<const sockaddr_in*>(&addr);
+        std::snprintf(text, sizeof(text), "%08X:%04X", in->sin_addr.s_addr, ntohs(in->sin_port));
+    } else {
+        const auto* in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+        std::uint32_t words[4];
+        std::memcpy(words, &in6->sin6_addr, sizeof(words));
+        std::snprintf(text, sizeof(text), "%08X%08X%08X%08X:%04X",
+                      words[0], words[1], words[2], words[3], ntohs(in6->sin6_port));
+    }
+    return text;
+}
+
+// 在 /proc/net/tcp{,6} 里找本地端为 local、远端为 remote 的连接，取其 uid 列
+bool procNetTcpUid(const sockaddr_storage& local, const sockaddr_storage& remote, uid_t& uid) {
+    std::ifstream table(local.ss_family == AF_INET ? "/proc/net/tcp" : "/proc/net/tcp6");
+    std::string localText = procNetAddress(local);
+    std::string remoteText = procNetAddress(remote);
+    std::string line;
+    std::getline(table, line);  // 表头
+    while (std::getline(table, line)) {
+        // sl local_address rem_address st tx_queue:rx_queue tr:tm->when retrnsmt uid ...
+        std::istringstream fields(line);
+        std::string slot, localField, remoteField, state, queues, timer, retransmits;
+        unsigned long owner = 0;
+        if (!(fields >> slot >> localField >> remoteField >> state >> queues >> timer >> retransmits >> owner)) {
+            continue;
+        }
+        if (localField == localText && remoteField == remoteText) {
+            uid = static_cast<uid_t>(owner);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 填好地址并创建套接字，返回 fd
+int openSocket(const Endpoint& endpoint, sockaddr_storage& addr, socklen_t& length, std::string& error) {
+    std::memset(&addr, 0, sizeof(addr));
+    int fd = -1;
+    if (endpoint.isUnix) {
+        auto* un = reinterpret_cast<sockaddr_un*>(&addr);
+        un->sun_family = AF_UNIX;
+        std::strncpy(un->sun_path, endpoint.path.c_str(), sizeof(un->sun_path) - 1);
+        length = sizeof(sockaddr_un);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    } else if (endpoint.family == AF_INET) {
+        auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+        in->sin_family = AF_INET;
+        in->sin_port = htons(static_cast<std::uint16_t>(endpoint.port));
+        inet_pton(AF_INET, endpoint.host.c_str(), &in->sin_addr);
+        length = sizeof(sockaddr_in);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    } else {
+        auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(static_cast<std::uint16_t>(endpoint.port));
+        inet_pton(AF_INET6, endpoint.host.c_str(), &in6->sin6_addr);
+        length = sizeof(sockaddr_in6);
+        fd = socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    }
+    if (fd < 0) {
+        error = std::string("创建套接字失败: ") + std::strerror(errno);
+    }
+    return fd;
+}
+
+} // namespace
+
+// =====================
+// 帧
+// =====================
+
+std::string RpcFrame::request(std::uint32_t requestId, RpcOp op, const std::string& payload) {
+    std::string frame;
+    frame.reserve(LENGTH_BYTES + REQUEST_HEADER + payload.size());
+    putU32(frame, static_cast<std::uint32_t>(REQUEST_HEADER + payload.size()));
+    putU32(frame, requestId);
+    putU16(frame, static_cast<std::uint16_t>(op));
+    frame += payload;
+    return frame;
+}
+
+std::string RpcFrame::response(std::uint32_t requestId, RpcStatus status, const std::string& payload) {
+    std::string frame;
+    frame.reserve(LENGTH_BYTES + RESPONSE_HEADER + payload.size());
+    putU32(frame, static_cast<std::uint32_t>(RESPONSE_HEADER + payload.size()));
+    putU32(frame, requestId);
+    putU16(frame, static_cast<std::uint16_t>(status));
+    frame += payload;
+    return frame;
+}
+
+std::uint32_t RpcFrame::readLength(const char* data) {
+    RpcReader reader(data, LENGTH_BYTES);
+    return reader.u32();
+}
+
+// =====================
+// RpcWriter
+// =====================
+
+RpcWriter& RpcWriter::u8(std::uint8_t value) {
+    buffer.push_back(static_cast<char>(value));
+    return *this;
+}
+
+RpcWriter& RpcWriter::u16(std::uint16_t value) {
+    putU16(buffer, value);
+    return *this;
+}
+
+RpcWriter& RpcWriter::u32(std::uint32_t value) {
+    putU32(buffer, value);
+    return *this;
+}
+
+RpcWriter& RpcWriter::str(const std::string& value) {
+    u32(static_cast<std::uint32_t>(value.size()));
+    buffer += value;
+    return *this;
+}
+
+RpcWriter& RpcWriter::task(const Task& value) {
+    return i32(value.getId()).str(value.getName()).str(value.getDescription())
+          .i32(value.getProjectId()).boolean(value.isCompleted()).i32(value.getUserId());
+}
+
+RpcWriter& RpcWriter::tasks(const std::vector<Task>& values) {
+    u32(static_cast<std::uint32_t>(values.size()));
+    for (const auto& value : values) task(value);
+    return *this;
+}
+
+RpcWriter& RpcWriter::ints(const std::vector<int>& values) {
+    u32(static_cast<std::uint32_t>(values.size()));
+    for (int value : values) i32(value);
+    return *this;
+}
+
+RpcWriter& RpcWriter::strings(const std::vector<std::string>& values) {
+    u32(static_cast<std::uint32_t>(values.size()));
+    for (const auto& value : values) str(value);
+    return *this;
+}
+
+RpcWriter& RpcWriter::dependencyNode(const DependencyNode& value) {
+    return i32(value.taskId).i32(value.priority).i32(value.dueDate)
+          .boolean(value.completed).i32(value.projectId).i32(value.weight);
+}
+
+RpcWriter& RpcWriter::scheduleEntry(const ScheduleEntry& value) {
+    return i32(value.taskId).i32(value.priority).str(value.dueDate).str(value.projectTargetDate)
+          .i32(value.estimatedPomodoros).i32(value.pomodoroCount).i32(value.projectId);
+}
+
+RpcWriter& RpcWriter::taggedTask(const TaggedTask& value) {
+    return i32(value.taskId).boolean(value.completed).i32(value.projectId).ints(value.tagIds);
+}
+
+RpcWriter& RpcWriter::project(const RpcProject& value) {
+    return i32(value.id).str(value.name).str(value.description).str(value.colorLabel)
+          .i32(value.totalTasks).i32(value.completedTasks).str(value.targetDate);
+}
+
+// =====================
+// RpcReader
+// =====================
+
+bool RpcReader::need(std::size_t bytes) {
+    if (!valid || static_cast<std::size_t>(end - pos) < bytes) {
+        valid = false;
+        return false;
+    }
+    return true;
+}
+
+std::uint8_t RpcReader::u8() {
+    if (!need(1)) return 0;
+    return static_cast<std::uint8_t>(*pos++);
+}
+
+std::uint16_t RpcReader::u16() {
+    if (!need(2)) return 0;
+    auto* bytes = reinterpret_cast<const unsigned char*>(pos);
+    pos += 2;
+    return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+std::uint32_t RpcReader::u32() {
+    if (!need(4)) return 0;
+    auto* bytes = reinterpret_cast<const unsigned char*>(pos);
+    pos += 4;
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+std::string RpcReader::str() {
+    std::uint32_t size = u32();
+    if (!need(size)) return {};
+    std::string value(pos, size);
+    pos += size;
+    return value;
+}
+
+Task RpcReader::task() {
+    Task value;
+    value.setId(i32());
+    value.setName(str());
+    value.setDescription(str());
+    value.setProjectId(i32());
+    value.setCompleted(boolean());
+    value.setUserId(i32());
+    return value;
+}
+
+std::vector<Task> RpcReader::tasks() {
+    return list<Task>([this] { return task(); });
+}
+
+std::vector<int> RpcReader::ints() {
+    return list<int>([this] { return i32(); });
+}
+
+std::vector<std::string> RpcReader::strings() {
+    return list<std::string>([this] { return str(); });
+}
+
+DependencyNode RpcReader::dependencyNode() {
+    DependencyNode value;
+    value.taskId = i32();
+    value.priority = i32();
+    value.dueDate = i32();
+    value.completed = boolean();
+    value.projectId = i32();
+    value.weight = i32();
+    return value;
+}
+
+ScheduleEntry RpcReader::scheduleEntry() {
+    ScheduleEntry value;
+    value.taskId = i32();
+    value.priority = i32();
+    value.dueDate = str();
+    value.projectTargetDate = str();
+    value.estimatedPomodoros = i32();
+    value.pomodoroCount = i32();
+    value.projectId = i32();
+    return value;
+}
+
+TaggedTask RpcReader::taggedTask() {
+    TaggedTask value;
+    value.taskId = i32();
+    value.completed = boolean();
+    value.projectId = i32();
+    value.tagIds = ints();
+    return value;
+}
+
+RpcProject RpcReader::project() {
+    RpcProject value;
+    value.id = i32();
+    value.name = str();
+    value.description = str();
+    value.colorLabel = str();
+    value.totalTasks = i32();
+    value.completedTasks = i32();
+    value.targetDate = str();
+    return value;
+}
+
+// =====================
+// 套接字
+// =====================
+
+int rpcListen(const std::string& address, std::string& error) {
+    Endpoint endpoint;
+    if (!parseAddress(address, endpoint, error)) return -1;
+
+    sockaddr_storage addr;
+    socklen_t length = 0;
+    int fd = openSocket(endpoint, addr, length, error);
+    if (fd < 0) return -1;
+
+    if (endpoint.isUnix) {
+        // 只清理上次异常退出留下的套接字文件；路径写错时不能删掉普通文件（比如数据库）
+        struct stat info;
+        if (lstat(endpoint.path.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                error = "监听 " + address + " 失败: 路径已存在且不是套接字";
+                close(fd);
+                return -1;
+            }
+            int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), length) == 0;
+            if (probe >= 0) close(probe);
+            if (live) {
+                error = "监听 " + address + " 失败: 已有进程在此地址上服务";
+                close(fd);
+                return -1;
+            }
+            unlink(endpoint.path.c_str());
+        }
+    } else {
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0 || listen(fd, 128) < 0) {
+        error = "监听 " + address + " 失败: " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int rpcConnect(const std::string& address, std::string& error) {
+    Endpoint endpoint;
+    if (!parseAddress(address, endpoint, error)) return -1;
+
+    sockaddr_storage addr;
+    socklen_t length = 0;
+    int fd = openSocket(endpoint, addr, length, error);
+    if (fd < 0) return -1;
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), length) < 0) {
+        error = "连接 " + address + " 失败: " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+    if (!endpoint.isUnix) {
+        // 流水线由调用方自己攒批，小包不要等 Nagle
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return fd;
+}
+
+bool rpcPeerUid(int fd, uid_t& uid) {
+    sockaddr_storage local{};
+    sockaddr_storage peer{};
+    socklen_t localLength = sizeof(local);
+    socklen_t peerLength = sizeof(peer);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &localLength) < 0) return false;
+
+    if (local.ss_family == AF_UNIX) {
+        ucred credentials{};
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0) return false;
+        uid = credentials.uid;
+        return true;
+    }
+    // TCP 没有对端凭据；回环连接的两端都在本机的连接表里，对端那一行的属主就是对方进程的用户
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &peerLength) < 0) return false;
+    return procNetTcpUid(peer, local, uid);
+}
@@ -0,0 +1,672 @@
+#include "rpc/RpcServer.h"
+#include "database/DatabaseManager.h"
+#include "database/DAO/TaskDAO.h"
+#include "database/DAO/ReminderDAO.h"
+#include "gamification/XPSystem.h"
+#include "statistics/StatisticsAnalyzer.h"
+#include "project/ProjectManager.h"
+#include "reminder/ReminderSystem.h"
+#include "metrics/Metrics.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <pwd.h>
+#include <sqlite3.h>
+
+std::unique_ptr<RpcServer> RpcServer::instance = nullptr;
+std::mutex RpcServer::instanceMutex;
+
+namespace {
+    const size_t READ_BUDGET = 1024 * 1024;             // 每轮最多从一个连接读这么多，其余连接不会被饿死
+    const size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;  // 对方不读响应时先停止读它的请求
+
+    // 参数必须恰好读完，多余或缺少都算解码失败
+    bool argsOk(const RpcReader& in) {
+        return in.atEnd();
+    }
+}
+
+RpcServer& RpcServer::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance = std::make_unique<RpcServer>();
+    }
+    return *instance;
+}
+
+void RpcServer::destroyInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    instance.reset();
+}
+
+RpcServer::~RpcServer() {
+    stop();
+}
+
+bool RpcServer::start(const RpcServerOptions& opts) {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    if (running) return true;
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    if (!db.isOpen()) {
+        std::cerr << "RpcServer: 数据库尚未打开" << std::endl;
+        return false;
+    }
+
+    std::string error;
+    int fd = rpcListen(opts.address, error);
+    if (fd < 0) {
+        std::cerr << "RpcServer: " << error << std::endl;
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    if (pipe2(wakePipe, O_CLOEXEC) < 0) {
+        std::cerr << "RpcServer: 创建唤醒管道失败: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // 连接按对端系统用户鉴权，套接字文件本身对所有本机用户开放
+    sockaddr_un local{};
+    socklen_t localLength = sizeof(local);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &localLength) == 0 &&
+        local.sun_family == AF_UNIX && local.sun_path[0] != '\0') {
+        chmod(local.sun_path, 0666);
+    }
+
+    options = opts;
+    dbPath = db.getDatabasePath();
+    ownerUid = geteuid();
+    listenFd = fd;
+    xpSystem = std::make_unique<XPSystem>();
+    if (!options.reminderDbPath.empty()) {
+        reminderSystem = std::make_unique<ReminderSystem>(createReminderDAO(options.reminderDbPath));
+    }
+
+    MetricsRegistry::getInstance().addCollector("rpc_server", [this](std::ostream& out) {
+        Stats s = getStats();
+        MetricsRegistry::writeHeader(out, "taskmgr_rpc_requests_total", "Requests handled by the daemon", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_rpc_requests_total", "", static_cast<double>(s.requests));
+        MetricsRegistry::writeHeader(out, "taskmgr_rpc_errors_total", "Requests answered with a non-Ok status", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_rpc_errors_total", "", static_cast<double>(s.errors));
+        MetricsRegistry::writeHeader(out, "taskmgr_rpc_rejected_total", "Connections refused because the peer could not be identified", "counter");
+        MetricsRegistry::writeSample(out, "taskmgr_rpc_rejected_total", "", static_cast<double>(s.rejected));
+        MetricsRegistry::writeHeader(out, "taskmgr_rpc_clients", "Connected clients", "gauge");
+        MetricsRegistry::writeSample(out, "taskmgr_rpc_clients", "", static_cast<double>(s.activeClients));
+    });
+
+    running = true;
+    serverThread = std::thread(&RpcServer::serve, this);
+    return true;
+}
+
+void RpcServer::stop() {
+    std::lock_guard<std::mutex> lock(serverMutex);
+    if (!running) return;
+
+    running = false;
+    char byte = 1;
+    if (write(wakePipe[1], &byte, 1) < 0) {
+        shutdown(listenFd, SHUT_RDWR);
+    }
+    if (serverThread.joinable()) {
+        serverThread.join();
+    }
+
+    for (auto& client : clients) {
+        close(client.fd);
+    }
+    clients.clear();
+
+    // Unix 域套接字要删掉文件，下次启动和客户端才不会连到失效的路径
+    sockaddr_un local{};
+    socklen_t localLength = sizeof(local);
+    if (getsockname(listenFd, reinterpret_cast<sockaddr*>(&local), &localLength) == 0 &&
+        local.sun_family == AF_UNIX && local.sun_path[0] != '\0') {
+        unlink(local.sun_path);
+    }
+    close(listenFd);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    listenFd = -1;
+    wakePipe[0] = wakePipe[1] = -1;
+
+    reminderSystem.reset();
+    xpSystem.reset();
+    users.clear();
+    MetricsRegistry::getInstance().removeCollector("rpc_server");
+}
+
+RpcServer::Stats RpcServer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void RpcServer::serve() {
+    TRACE_THREAD_NAME("rpc-server");
+    std::vector<pollfd> fds;
+    auto nextReminderCheck = std::chrono::steady_clock::now();
+
+    while (running) {
+        fds.clear();
+        short acceptEvents = clients.size() < options.maxClients ? POLLIN : 0;
+        fds.push_back({listenFd, acceptEvents, 0});
+        fds.push_back({wakePipe[0], POLLIN, 0});
+        for (const auto& client : clients) {
+            size_t pending = client.outBuffer.size() - client.outPos;
+            short events = pending < MAX_PENDING_OUTPUT ? POLLIN : 0;
+            if (pending > 0) events |= POLLOUT;
+            fds.push_back({client.fd, events, 0});
+        }
+
+        int timeout = -1;
+        if (reminderSystem) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextReminderCheck - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::max<long long>(0, wait.count()));
+        }
+
+        int ready = poll(fds.data(), fds.size(), timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "RpcServer: poll 失败: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (fds[1].revents & POLLIN) break;
+
+        // 先处理已有连接，新连接追加在末尾，下一轮再 poll
+        size_t polledClients = fds.size() - 2;
+        for (size_t i = 0; i < polledClients; ++i) {
+            Client& client = clients[i];
+            short revents = fds[i + 2].revents;
+            bool alive = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                alive = readClient(client);
+            }
+            // 这一轮读到的所有请求的响应一次写出
+            if (client.outPos < client.outBuffer.size()) {
+                alive = writeClient(client) && alive;
+            }
+            if (!alive) {
+                close(client.fd);
+                client.fd = -1;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Client& client) { return client.fd < 0; }),
+                      clients.end());
+
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.activeClients = clients.size();
+        }
+
+        if (reminderSystem && std::chrono::steady_clock::now() >= nextReminderCheck) {
+            reminderSystem->checkDueReminders();
+            nextReminderCheck = std::chrono::steady_clock::now() + options.reminderInterval;
+        }
+    }
+}
+
+void RpcServer::acceptClients() {
+    while (clients.size() < options.maxClients) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "RpcServer: accept 失败: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        Client client;
+        client.fd = fd;
+        if (!rpcPeerUid(fd, client.peerUid)) {
+            std::cerr << "RpcServer: 无法确定对端身份，拒绝连接" << std::endl;
+            close(fd);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.rejected++;
+            continue;
+        }
+        clients.push_back(std::move(client));
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.connections++;
+    }
+}
+
+bool RpcServer::readClient(Client& client) {
+    bool open = true;
+    size_t readBytes = 0;
+    char chunk[64 * 1024];
+    while (readBytes < READ_BUDGET) {
+        ssize_t n = recv(client.fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            client.inBuffer.append(chunk, static_cast<size_t>(n));
+            readBytes += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        // 对方关闭写端时仍然处理已收到的请求并尽量把响应发回去
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) open = false;
+        break;
+    }
+
+    while (true) {
+        size_t available = client.inBuffer.size() - client.inPos;
+        if (available < RpcFrame::LENGTH_BYTES) break;
+        std::uint32_t length = RpcFrame::readLength(client.inBuffer.data() + client.inPos);
+        if (length < RpcFrame::REQUEST_HEADER || length > RpcFrame::MAX_FRAME) {
+            std::cerr << "RpcServer: 请求帧长度无效，断开连接" << std::endl;
+            return false;
+        }
+        if (available < RpcFrame::LENGTH_BYTES + length) break;
+        handleFrame(client, client.inBuffer.data() + client.inPos + RpcFrame::LENGTH_BYTES, length);
+        client.inPos += RpcFrame::LENGTH_BYTES + length;
+    }
+
+    if (client.inPos == client.inBuffer.size()) {
+        client.inBuffer.clear();
+        client.inPos = 0;
+    } else if (client.inPos * 2 >= client.inBuffer.size()) {
+        client.inBuffer.erase(0, client.inPos);
+        client.inPos = 0;
+    }
+    return open;
+}
+
+bool RpcServer::writeClient(Client& client) {
+    while (client.outPos < client.outBuffer.size()) {
+        ssize_t n = send(client.fd, client.outBuffer.data() + client.outPos,
+                         client.outBuffer.size() - client.outPos, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.outPos += static_cast<size_t>(n);
+    }
+    client.outBuffer.clear();
+    client.outPos = 0;
+    return true;
+}
+
+void RpcServer::handleFrame(Client& client, const char* frame, size_t length) {
+    RpcReader header(frame, RpcFrame::REQUEST_HEADER);
+    std::uint32_t requestId = header.u32();
+    auto op = static_cast<RpcOp>(header.u16());
+
+    RpcReader in(frame + RpcFrame::REQUEST_HEADER, length - RpcFrame::REQUEST_HEADER);
+    RpcWriter out;
+    RpcStatus status;
+    std::string error;
+    try {
+        status = dispatch(op, client, in, out);
+    } catch (const std::exception& e) {
+        status = RpcStatus::Error;
+        error = e.what();
+    }
+
+    if (status != RpcStatus::Ok && error.empty()) {
+        switch (status) {
+            case RpcStatus::BadRequest: error = "参数解码失败"; break;
+            case RpcStatus::UnknownOp: error = "未知操作码 " + std::to_string(static_cast<int>(op)); break;
+            case RpcStatus::Forbidden: error = "未登录或无权代表该用户"; break;
+            default: error = "操作失败"; break;
+        }
+    }
+    client.outBuffer += RpcFrame::response(requestId, status, status == RpcStatus::Ok ? out.data() : error);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.requests++;
+    if (status != RpcStatus::Ok) stats.errors++;
+}
+
+RpcServer::UserContext* RpcServer::userContext(int userId) {
+    auto it = users.find(userId);
+    if (it != users.end()) return &it->second;
+
+    if (userId <= 0 || !DatabaseManager::getInstance().ensureUser(userId)) return nullptr;
+    UserContext& context = users[userId];
+    context.tasks = std::make_unique<TaskDAOImpl>(dbPath, userId);
+    context.stats = std::make_unique<StatisticsAnalyzer>(userId);
+    context.projects = std::make_unique<ProjectManager>(dbPath, userId);
+    return &context;
+}
+
+int RpcServer::accountUserId(uid_t uid) {
+    passwd entry{};
+    passwd* result = nullptr;
+    char buffer[4096];
+    if (getpwuid_r(uid, &entry, buffer, sizeof(buffer), &result) != 0 || !result) {
+        std::cerr << "RpcServer: 找不到系统用户 " << uid << std::endl;
+        return 0;
+    }
+    std::string username = result->pw_name;
+
+    DatabaseManager& db = DatabaseManager::getInstance();
+    auto lock = db.lockConnection();
+    sqlite3* conn = db.getRawConnection();
+    sqlite3_stmt* stmt = nullptr;
+    int userId = 0;
+    if (sqlite3_prepare_v2(conn, "SELECT id FROM users WHERE username = ?", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            userId = sqlite3_column_int(stmt, 0);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (userId == 0) {
+        stmt = nullptr;
+        if (sqlite3_prepare_v2(conn, "INSERT INTO users (username) VALUES (?)", -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(stmt) == SQLITE_DONE) {
+                userId = static_cast<int>(sqlite3_last_insert_rowid(conn));
+            }
+        }
+        if (userId == 0) {
+            std::cerr << "RpcServer: 创建用户 " << username << " 失败: " << sqlite3_errmsg(conn) << std::endl;
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (userId > 0 && !db.ensureUser(userId)) return 0;
+    return userId;
+}
+
+RpcStatus RpcServer::login(Client& client, RpcReader& in, RpcWriter& out) {
+    int requested = in.i32();
+    if (!argsOk(in) || requested < 0) return RpcStatus::BadRequest;
+
+    int userId;
+    if (client.peerUid == ownerUid || client.peerUid == 0) {
+        // 守护进程的属主和 root 本来就能直接读写数据库文件，可以代表任意用户
+        userId = requested > 0 ? requested : DatabaseManager::DEFAULT_USER_ID;
+        if (!DatabaseManager::getInstance().ensureUser(userId)) return RpcStatus::Error;
+    } else {
+        userId = accountUserId(client.peerUid);
+        if (userId == 0) return RpcStatus::Error;
+        if (requested != 0 && requested != userId) return RpcStatus::Forbidden;
+    }
+
+    client.userId = userId;
+    out.i32(userId);
+    return RpcStatus::Ok;
+}
+
+RpcStatus RpcServer::awardXP(int userId, RpcReader& in, RpcWriter& out) {
+    auto reason = static_cast<RpcXPReason>(in.u8());
+    int subject = in.i32();
+    if (!argsOk(in)) return RpcStatus::BadRequest;
+    if (reason != RpcXPReason::TaskCompleted) return RpcStatus::BadRequest;
+
+    UserContext* context = userContext(userId);
+    if (!context) return RpcStatus::Error;
+    // 任务由该用户的 DAO 读出，别人的任务查不到；已完成的任务不再发放
+    auto task = context->tasks->getTaskById(subject);
+    if (!task) return RpcStatus::Error;
+    if (task->isCompleted()) {
+        out.i32(0);
+        return RpcStatus::Ok;
+    }
+
+    // awardXP 自己会加连接锁，但那只覆盖 xp_award；外层 rpc_task_xp 还包着 updateTask，
+    // 这里的锁（递归锁，可重入）要一直持有到 RELEASE rpc_task_xp
+    DatabaseManager& db = DatabaseManager::getInstance();
+    auto lock = db.lockConnection();
+    if (!db.execute("SAVEPOINT rpc_task_xp")) return RpcStatus::Error;
+    int amount = xpSystem->getXPForTaskCompletion(1);
+    task->markCompleted();
+    bool ok = context->tasks->updateTask(*task) &&
+              xpSystem->awardXP(userId, amount, "任务完成");
+    if (!ok) {
+        db.execute("ROLLBACK TO rpc_task_xp");
+        db.execute("RELEASE rpc_task_xp");
+        return RpcStatus::Error;
+    }
+    db.execute("RELEASE rpc_task_xp");
+    out.i32(amount);
+    return RpcStatus::Ok;
+}
+
+RpcStatus RpcServer::dispatch(RpcOp op, Client& client, RpcReader& in, RpcWriter& out) {
+    switch (op) {
+        case RpcOp::Ping:
+            return argsOk(in) ? RpcStatus::Ok : RpcStatus::BadRequest;
+        case RpcOp::Login:
+            return login(client, in, out);
+        default:
+            break;
+    }
+
+    int userId = client.userId;
+    if (userId == 0) return RpcStatus::Forbidden;
+
+    switch (op) {
+        case RpcOp::XPAward:
+            return awardXP(userId, in, out);
+        case RpcOp::XPState:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.i32(xpSystem->getTotalXP(userId)).i32(xpSystem->getCurrentLevel(userId));
+            return RpcStatus::Ok;
+
+        case RpcOp::StatsReport: {
+            auto kind = static_cast<RpcReportKind>(in.u8());
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            UserContext* context = userContext(userId);
+            if (!context) return RpcStatus::Error;
+            switch (kind) {
+                case RpcReportKind::Summary: out.str(context->stats->generateSummary()); break;
+                case RpcReportKind::Daily: out.str(context->stats->generateDailyReport()); break;
+                case RpcReportKind::Weekly: out.str(context->stats->generateWeeklyReport()); break;
+                case RpcReportKind::Monthly: out.str(context->stats->generateMonthlyReport()); break;
+                default: return RpcStatus::BadRequest;
+            }
+            return RpcStatus::Ok;
+        }
+
+        case RpcOp::ProjectList: {
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            UserContext* context = userContext(userId);
+            if (!context) return RpcStatus::Error;
+            std::vector<RpcProject> rows;
+            for (Project* project : context->projects->getAllProjects()) {
+                RpcProject row;
+                row.id = project->getId();
+                row.name = project->getName();
+                row.description = project->getDescription();
+                row.colorLabel = project->getColorLabel();
+                row.totalTasks = project->getTotalTasks();
+                row.completedTasks = project->getCompletedTasks();
+                row.targetDate = project->getTargetDate();
+                rows.push_back(std::move(row));
+                delete project;
+            }
+            out.list(rows, [](RpcWriter& w, const RpcProject& row) { w.project(row); });
+            return RpcStatus::Ok;
+        }
+        case RpcOp::ProjectCreate: {
+            RpcProject row = in.project();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            UserContext* context = userContext(userId);
+            if (!context) return RpcStatus::Error;
+            Project project(row.name, row.description, row.colorLabel);
+            project.setTargetDate(row.targetDate);
+            out.i32(context->projects->createProject(project));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::ProjectDelete: {
+            int id = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            UserContext* context = userContext(userId);
+            if (!context) return RpcStatus::Error;
+            out.boolean(context->projects->deleteProject(id));
+            return RpcStatus::Ok;
+        }
+
+        default:
+            break;
+    }
+
+    auto code = static_cast<std::uint16_t>(op);
+    if (code < static_cast<std::uint16_t>(RpcOp::TaskInsert) ||
+        code > static_cast<std::uint16_t>(RpcOp::TaskTagIndex)) {
+        return RpcStatus::UnknownOp;
+    }
+    UserContext* context = userContext(userId);
+    if (!context) return RpcStatus::Error;
+    return dispatchTask(op, *context->tasks, in, out);
+}
+
+RpcStatus RpcServer::dispatchTask(RpcOp op, TaskDAOImpl& dao, RpcReader& in, RpcWriter& out) {
+    auto writeTasks = [&](const std::vector<Task>& tasks) {
+        out.tasks(tasks);
+        return RpcStatus::Ok;
+    };
+
+    switch (op) {
+        case RpcOp::TaskInsert: {
+            Task task = in.task();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.i32(dao.insertTask(task));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskGet: {
+            int id = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            auto task = dao.getTaskById(id);
+            out.boolean(task.has_value());
+            if (task) out.task(*task);
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskGetAll:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getAllTasks());
+        case RpcOp::TaskGetByIds: {
+            std::vector<int> ids = in.ints();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getTasksByIds(ids));
+        }
+        case RpcOp::TaskUpdate: {
+            Task task = in.task();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.boolean(dao.updateTask(task));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskDelete: {
+            int id = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.boolean(dao.deleteTask(id));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskByStatus: {
+            bool completed = in.boolean();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getTasksByStatus(completed));
+        }
+        case RpcOp::TaskByProject: {
+            int projectId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getTasksByProject(projectId));
+        }
+        case RpcOp::TaskOverdue:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getOverdueTasks());
+        case RpcOp::TaskToday:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            return writeTasks(dao.getTodayTasks());
+        case RpcOp::TaskCount:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.i32(dao.countAllTasks());
+            return RpcStatus::Ok;
+        case RpcOp::TaskCountCompleted:
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.i32(dao.countCompletedTasks());
+            return RpcStatus::Ok;
+        case RpcOp::TaskAssignProject: {
+            int taskId = in.i32();
+            int projectId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.boolean(dao.assignTaskToProject(taskId, projectId));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskIncrementPomodoro: {
+            int taskId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.boolean(dao.incrementPomodoro(taskId));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskPomodoroCount: {
+            int taskId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.i32(dao.getPomodoroCount(taskId));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskAddDependency:
+        case RpcOp::TaskRemoveDependency: {
+            int taskId = in.i32();
+            int dependsOn = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.boolean(op == RpcOp::TaskAddDependency ? dao.addDependency(taskId, dependsOn)
+                                                       : dao.removeDependency(taskId, dependsOn));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskDependencyGraph: {
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            std::vector<DependencyNode> nodes;
+            std::vector<std::pair<int, int>> edges;
+            out.boolean(dao.loadDependencyGraph(nodes, edges));
+            out.list(nodes, [](RpcWriter& w, const DependencyNode& node) { w.dependencyNode(node); });
+            out.list(edges, [](RpcWriter& w, const std::pair<int, int>& edge) { w.i32(edge.first).i32(edge.second); });
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskScheduleEntries: {
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            std::vector<ScheduleEntry> entries;
+            out.boolean(dao.loadScheduleEntries(entries));
+            out.list(entries, [](RpcWriter& w, const ScheduleEntry& entry) { w.scheduleEntry(entry); });
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskScheduleEntry: {
+            int taskId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            auto entry = dao.getScheduleEntry(taskId);
+            out.boolean(entry.has_value());
+            if (entry) out.scheduleEntry(*entry);
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskSetTags: {
+            int taskId = in.i32();
+            std::vector<std::string> names = in.strings();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            std::vector<std::pair<int, std::string>> interned;
+            out.boolean(dao.setTaskTags(taskId, names, interned));
+            out.list(interned, [](RpcWriter& w, const std::pair<int, std::string>& tag) { w.i32(tag.first).str(tag.second); });
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskGetTags: {
+            int taskId = in.i32();
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            out.strings(dao.getTaskTags(taskId));
+            return RpcStatus::Ok;
+        }
+        case RpcOp::TaskTagIndex: {
+            if (!argsOk(in)) return RpcStatus::BadRequest;
+            std::vector<std::pair<int, std::string>> tags;
+            std::vector<TaggedTask> tasks;
+            out.boolean(dao.loadTagIndex(tags, tasks));
+            out.list(tags, [](RpcWriter& w, const std::pair<int, std::string>& tag) { w.i32(tag.first).str(tag.second); });
+            out.list(tasks, [](RpcWriter& w, const TaggedTask& task) { w.taggedTask(task); });
+            return RpcStatus::Ok;
+        }
+        default:
+            return RpcStatus::UnknownOp;
+    }
+}
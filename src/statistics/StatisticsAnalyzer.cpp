@@ -1,12 +1,16 @@
 #include "statistics/StatisticsAnalyzer.h"
+#include "trace/Tracer.h"
+#include "metrics/Metrics.h"
 #include <iostream>
 #include <sstream>
 #include <ctime>
 #include <iomanip>
+#include <algorithm>
 #include <sqlite3.h>
 
-StatisticsAnalyzer::StatisticsAnalyzer() {
+StatisticsAnalyzer::StatisticsAnalyzer(int userId) : currentUserId(userId) {
     dbManager = &DatabaseManager::getInstance();
+    userStatsChanges = make_unique<ChangeSubscription>(vector<string>{"user_stats"});
     if (!dbManager->isOpen()) {
         cerr << "⚠️  警告: 数据库未打开，StatisticsAnalyzer可能无法正常工作" << endl;
     }
@@ -16,6 +20,81 @@ StatisticsAnalyzer::~StatisticsAnalyzer() {
     // DatabaseManager是单例，不需要在这里删除
 }
 
+// === 多用户 ===
+
+void StatisticsAnalyzer::setCurrentUserId(int userId) {
+    currentUserId = userId;
+}
+
+int StatisticsAnalyzer::getCurrentUserId() const {
+    return currentUserId;
+}
+
+void StatisticsAnalyzer::invalidateCache(int userId) {
+    userStatsCache.erase(userId);
+}
+
+void StatisticsAnalyzer::clearCache() {
+    userStatsCache.clear();
+}
+
+void StatisticsAnalyzer::applyChanges() {
+    if (!userStatsChanges->hasChanges()) return;
+    
+    ChangeBatch batch = userStatsChanges->take();
+    if (batch.truncated) {
+        userStatsCache.clear();
+        return;
+    }
+    vector<sqlite3_int64> rows = batch.rowids("user_stats");
+    for (auto it = userStatsCache.begin(); it != userStatsCache.end();) {
+        bool stale = it->second.rowid == 0 || binary_search(rows.begin(), rows.end(), it->second.rowid);
+        it = stale ? userStatsCache.erase(it) : next(it);
+    }
+}
+
+string StatisticsAnalyzer::userFilter() const {
+    return "user_id = " + to_string(currentUserId);
+}
+
+const StatisticsAnalyzer::UserStatsRow& StatisticsAnalyzer::loadUserStats(int userId) {
+    static MetricCounter& hits = MetricsRegistry::getInstance().counter(
+        "taskmgr_cache_requests_total", "Lookups in per-user in-memory caches", "cache=\"stats_user\",result=\"hit\"");
+    static MetricCounter& misses = MetricsRegistry::getInstance().counter(
+        "taskmgr_cache_requests_total", "Lookups in per-user in-memory caches", "cache=\"stats_user\",result=\"miss\"");
+
+    applyChanges();
+    auto it = userStatsCache.find(userId);
+    if (it != userStatsCache.end()) {
+        hits.inc();
+        return it->second;
+    }
+    misses.inc();
+    
+    UserStatsRow row;
+    if (dbManager->isOpen()) {
+        string sql = "SELECT current_streak, longest_streak, total_pomodoros, last_active_date, id "
+                     "FROM user_stats WHERE user_id = ?;";
+        sqlite3* db = dbManager->getRawConnection();
+        sqlite3_stmt* stmt;
+        
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, userId);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                row.currentStreak = sqlite3_column_int(stmt, 0);
+                row.longestStreak = sqlite3_column_int(stmt, 1);
+                row.totalPomodoros = sqlite3_column_int(stmt, 2);
+                const char* date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+                if (date) row.lastActiveDate = date;
+                row.rowid = sqlite3_column_int64(stmt, 4);
+            }
+            sqlite3_finalize(stmt);
+        }
+    }
+    
+    return userStatsCache[userId] = row;
+}
+
 // === 辅助方法 ===
 
 int StatisticsAnalyzer::queryInt(const string& sql) {
@@ -90,12 +169,12 @@ string StatisticsAnalyzer::getMonthStartDate() {
 // === 任务统计 ===
 
 int StatisticsAnalyzer::getTotalTasksCompleted() {
-    string sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1;";
+    string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + " AND completed = 1;";
     return queryInt(sql);
 }
 
 int StatisticsAnalyzer::getTotalTasksCreated() {
-    string sql = "SELECT COUNT(*) FROM tasks;";
+    string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + ";";
     return queryInt(sql);
 }
 
@@ -111,30 +190,27 @@ double StatisticsAnalyzer::getCompletionRate() {
 
 int StatisticsAnalyzer::getTasksCompletedToday() {
     string today = getCurrentDate();
-    string sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1 AND DATE(completed_date) = '" + today + "';";
+    string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + " AND completed = 1 AND completed_day = '" + today + "';";
     return queryInt(sql);
 }
 
 int StatisticsAnalyzer::getTasksCompletedThisWeek() {
     string weekStart = getWeekStartDate();
-    string sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1 AND DATE(completed_date) >= '" + weekStart + "';";
+    string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + " AND completed = 1 AND completed_day >= '" + weekStart + "';";
     return queryInt(sql);
 }
 
 int StatisticsAnalyzer::getTasksCompletedThisMonth() {
     string monthStart = getMonthStartDate();
-    string sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1 AND DATE(completed_date) >= '" + monthStart + "';";
+    string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + " AND completed = 1 AND completed_day >= '" + monthStart + "';";
     return queryInt(sql);
 }
 
 // === 生产力分析 ===
 
 double StatisticsAnalyzer::getAverageTasksPerDay() {
-    string sql = R"(
-        SELECT COUNT(*) / (julianday('now') - julianday(MIN(created_date))) 
-        FROM tasks 
-        WHERE completed = 1;
-    )";
+    string sql = "SELECT SUM(task_count) / (julianday('now') - julianday(MIN(created_date))) "
+                 "FROM task_history WHERE " + userFilter() + " AND completed = 1;";
     return queryDouble(sql);
 }
 
@@ -159,9 +235,9 @@ vector<int> StatisticsAnalyzer::getWeeklyTrends(int weeks) {
               << setfill('0') << setw(2) << (1 + endTm->tm_mon) << "-"
               << setfill('0') << setw(2) << endTm->tm_mday;
         
-        string sql = "SELECT COUNT(*) FROM tasks WHERE completed = 1 "
-                    "AND DATE(completed_date) >= '" + startSs.str() + "' "
-                    "AND DATE(completed_date) < '" + endSs.str() + "';";
+        string sql = "SELECT SUM(task_count) FROM task_history WHERE " + userFilter() + " AND completed = 1 "
+                    "AND completed_day >= '" + startSs.str() + "' "
+                    "AND completed_day < '" + endSs.str() + "';";
         
         trends.push_back(queryInt(sql));
     }
@@ -172,33 +248,21 @@ vector<int> StatisticsAnalyzer::getWeeklyTrends(int weeks) {
 // === 连续打卡统计 ===
 
 int StatisticsAnalyzer::getCurrentStreak() {
-    string sql = "SELECT current_streak FROM user_stats WHERE id = 1;";
-    return queryInt(sql);
+    return loadUserStats(currentUserId).currentStreak;
 }
 
 int StatisticsAnalyzer::getLongestStreak() {
-    string sql = "SELECT longest_streak FROM user_stats WHERE id = 1;";
-    return queryInt(sql);
+    return loadUserStats(currentUserId).longestStreak;
 }
 
 void StatisticsAnalyzer::updateStreak() {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::updateStreak");
     if (!dbManager->isOpen()) return;
     
     string today = getCurrentDate();
     
     // 获取上次活跃日期
-    string sql = "SELECT last_active_date FROM user_stats WHERE id = 1;";
-    sqlite3* db = dbManager->getRawConnection();
-    sqlite3_stmt* stmt;
-    string lastActiveDate;
-    
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            const char* date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-            if (date) lastActiveDate = date;
-        }
-        sqlite3_finalize(stmt);
-    }
+    string lastActiveDate = loadUserStats(currentUserId).lastActiveDate;
     
     // 如果今天已经更新过，直接返回
     if (lastActiveDate == today) return;
@@ -231,46 +295,45 @@ void StatisticsAnalyzer::updateStreak() {
               << "current_streak = " << currentStreak << ", "
               << "longest_streak = " << longestStreak << ", "
               << "last_active_date = '" << today << "' "
-              << "WHERE id = 1;";
+              << "WHERE " << userFilter() << ";";
     
     dbManager->execute(updateSql.str());
+    invalidateCache(currentUserId);
 }
 
 // === 番茄钟统计 ===
 
 int StatisticsAnalyzer::getTotalPomodoros() {
-    string sql = "SELECT SUM(pomodoro_count) FROM tasks;";
+    string sql = "SELECT SUM(pomodoro_count) FROM task_history WHERE " + userFilter() + ";";
     return queryInt(sql);
 }
 
 int StatisticsAnalyzer::getPomodorosToday() {
-    string today = getCurrentDate();
-    string sql = "SELECT total_pomodoros FROM user_stats WHERE id = 1;";
     // 注意：这个需要配合Pomodoro模块实时更新
-    return queryInt(sql);
+    return loadUserStats(currentUserId).totalPomodoros;
 }
 
 // === 项目统计 ===
 
 int StatisticsAnalyzer::getTotalProjects() {
-    string sql = "SELECT COUNT(*) FROM projects WHERE archived = 0;";
+    string sql = "SELECT COUNT(*) FROM projects WHERE " + userFilter() + " AND archived = 0;";
     return queryInt(sql);
 }
 
 double StatisticsAnalyzer::getAverageProjectProgress() {
-    string sql = "SELECT AVG(progress) FROM projects WHERE archived = 0;";
+    string sql = "SELECT AVG(progress) FROM projects WHERE " + userFilter() + " AND archived = 0;";
     return queryDouble(sql);
 }
 
 int StatisticsAnalyzer::getCompletedProjects() {
-    string sql = "SELECT COUNT(*) FROM projects WHERE progress >= 1.0 AND archived = 0;";
+    string sql = "SELECT COUNT(*) FROM projects WHERE " + userFilter() + " AND progress >= 1.0 AND archived = 0;";
     return queryInt(sql);
 }
 
 // === 游戏化统计 ===
 
 int StatisticsAnalyzer::getAchievementsUnlocked() {
-    string sql = "SELECT COUNT(*) FROM achievements WHERE unlocked = 1;";
+    string sql = "SELECT COUNT(*) FROM achievements WHERE " + userFilter() + " AND unlocked = 1;";
     return queryInt(sql);
 }
 
@@ -282,6 +345,7 @@ int StatisticsAnalyzer::getChallengesCompleted() {
 // === 报告生成 ===
 
 string StatisticsAnalyzer::generateDailyReport() {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::generateDailyReport");
     stringstream report;
     
     report << "\n";
@@ -313,6 +377,7 @@ string StatisticsAnalyzer::generateDailyReport() {
 }
 
 string StatisticsAnalyzer::generateWeeklyReport() {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::generateWeeklyReport");
     stringstream report;
     
     report << "\n";
@@ -349,6 +414,7 @@ string StatisticsAnalyzer::generateWeeklyReport() {
 }
 
 string StatisticsAnalyzer::generateMonthlyReport() {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::generateMonthlyReport");
     stringstream report;
     
     report << "\n";
@@ -391,6 +457,7 @@ string StatisticsAnalyzer::generateMonthlyReport() {
 }
 
 string StatisticsAnalyzer::generateSummary() {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::generateSummary");
     stringstream summary;
     
     summary << "\n";
@@ -438,17 +505,18 @@ string StatisticsAnalyzer::generateSummary() {
 // === 热力图数据支持 ===
 
 map<string, int> StatisticsAnalyzer::getTaskCompletionData(int days) {
+    TRACE_SCOPE("stats", "StatisticsAnalyzer::getTaskCompletionData");
     map<string, int> data;
     
     if (!dbManager->isOpen()) return data;
     
-    // 查询过去N天的任务完成数据
+    // 查询过去N天的任务完成数据（task_history 含已归档任务的汇总）
     stringstream sql;
-    sql << "SELECT DATE(completed_date) as date, COUNT(*) as count "
-        << "FROM tasks "
-        << "WHERE completed = 1 "
-        << "AND DATE(completed_date) >= DATE('now', '-" << days << " days') "
-        << "GROUP BY DATE(completed_date) "
+    sql << "SELECT completed_day as date, SUM(task_count) as count "
+        << "FROM task_history "
+        << "WHERE " << userFilter() << " AND completed = 1 "
+        << "AND completed_day >= DATE('now', '-" << days << " days') "
+        << "GROUP BY completed_day "
         << "ORDER BY date;";
     
     sqlite3* db = dbManager->getRawConnection();
@@ -0,0 +1,355 @@
+#include "task/AsyncTaskManager.h"
+#include "database/DatabaseManager.h"
+#include "trace/Tracer.h"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+// 只读连接：WAL 下读不阻塞写，也不被写阻塞；回退到共享连接时返回 nullptr
+sqlite3* openReadConnection(const std::string& path) {
+    if (path.empty() || path == ":memory:") return nullptr;
+
+    sqlite3* conn = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &conn, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        std::cerr << "AsyncTaskManager: 无法打开只读连接: " << sqlite3_errmsg(conn) << std::endl;
+        sqlite3_close(conn);
+        return nullptr;
+    }
+    sqlite3_busy_timeout(conn, 5000);
+    return conn;
+}
+
+} // namespace
+
+bool AsyncTaskManager::Job::cancelled() const {
+    return std::all_of(tokens.begin(), tokens.end(), [](const CancellationToken& t) {
+        return t.isCancelled();
+    });
+}
+
+AsyncTaskManager::AsyncTaskManager(int userId, const AsyncTaskOptions& opts)
+    : options(opts), userId(userId) {
+    auto& dbManager = DatabaseManager::getInstance();
+    if (!dbManager.isOpen()) {
+        dbManager.initialize();
+    }
+    databasePath = dbManager.getDatabasePath();
+    options.readers = std::max(1, options.readers);
+    options.maxLookupBatch = std::max<size_t>(1, options.maxLookupBatch);
+
+    for (int i = 0; i < options.readers; ++i) {
+        readConnections.push_back(openReadConnection(databasePath));
+    }
+    for (size_t i = 0; i < readConnections.size(); ++i) {
+        readers.emplace_back(&AsyncTaskManager::readerLoop, this, i);
+    }
+    writer = std::thread(&AsyncTaskManager::writerLoop, this);
+}
+
+AsyncTaskManager::~AsyncTaskManager() {
+    std::deque<JobPtr> abandoned;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        abandoned.swap(readQueue);
+        pendingReads.clear();
+    }
+    readReady.notify_all();
+    writeReady.notify_all();
+
+    for (auto& job : abandoned) job->cancel();
+    countCancelled(abandoned.size());
+
+    for (auto& thread : readers) {
+        if (thread.joinable()) thread.join();
+    }
+    if (writer.joinable()) writer.join();
+
+    for (sqlite3* conn : readConnections) {
+        if (conn) sqlite3_close(conn);
+    }
+}
+
+void AsyncTaskManager::enqueueRead(const JobPtr& job) {
+    bool accepted;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        accepted = !stopping;
+        if (accepted) {
+            readQueue.push_back(job);
+            if (!job->key.empty()) pendingReads[job->key] = job;
+        }
+    }
+    if (!accepted) {
+        job->cancel();
+        countCancelled(1);
+        return;
+    }
+    readReady.notify_one();
+}
+
+void AsyncTaskManager::enqueueWrite(const JobPtr& job) {
+    bool accepted;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        accepted = !stopping;
+        if (accepted) {
+            writeQueue.push_back(job);
+        }
+    }
+    if (!accepted) {
+        job->cancel();
+        countCancelled(1);
+        return;
+    }
+    writeReady.notify_one();
+}
+
+void AsyncTaskManager::countCancelled(size_t n) {
+    if (n == 0) return;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.cancelled += n;
+}
+
+void AsyncTaskManager::readerLoop(size_t index) {
+    TRACE_THREAD_NAME("async_task_reader");
+    sqlite3* conn = readConnections[index];
+    std::unique_ptr<TaskDAOImpl> dao = conn ? std::make_unique<TaskDAOImpl>(conn, userId)
+                                            : std::make_unique<TaskDAOImpl>(databasePath, userId);
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        readReady.wait(lock, [this] { return stopping || !readQueue.empty(); });
+        if (readQueue.empty()) break;
+
+        JobPtr job = readQueue.front();
+        readQueue.pop_front();
+
+        // 同时排队的按 ID 读取一并取出，合成一次 IN 查询
+        std::vector<JobPtr> batch{job};
+        if (job->lookupId > 0) {
+            for (auto it = readQueue.begin(); it != readQueue.end() && batch.size() < options.maxLookupBatch;) {
+                if ((*it)->lookupId > 0) {
+                    batch.push_back(*it);
+                    it = readQueue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        // 开始执行后不再接受合并，之后的同类请求会看到更新的数据
+        for (const auto& taken : batch) {
+            auto it = pendingReads.find(taken->key);
+            if (it != pendingReads.end() && it->second == taken) pendingReads.erase(it);
+        }
+        lock.unlock();
+
+        std::vector<JobPtr> live;
+        for (auto& taken : batch) {
+            if (taken->cancelled()) {
+                taken->cancel();
+            } else {
+                live.push_back(taken);
+            }
+        }
+        countCancelled(batch.size() - live.size());
+
+        if (!live.empty()) {
+            // 共享连接上执行时与其他模块的语句互斥
+            std::unique_lock<std::recursive_mutex> connectionLock;
+            if (!conn) connectionLock = DatabaseManager::getInstance().lockConnection();
+
+            if (job->lookupId > 0) {
+                runLookups(*dao, live);
+            } else {
+                TRACE_SCOPE_DETAIL("task", "AsyncTaskManager::read", job->key);
+                job->run(*dao);
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                stats.reads++;
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+void AsyncTaskManager::runLookups(TaskDAO& dao, std::vector<JobPtr>& batch) {
+    TRACE_SCOPE("task", "AsyncTaskManager::runLookups");
+    std::vector<int> ids;
+    ids.reserve(batch.size());
+    for (const auto& job : batch) ids.push_back(job->lookupId);
+
+    std::unordered_map<int, Task> found;
+    if (ids.size() == 1) {
+        if (auto task = dao.getTaskById(ids.front())) found.emplace(ids.front(), *task);
+    } else {
+        for (Task& task : dao.getTasksByIds(ids)) found.emplace(task.getId(), std::move(task));
+    }
+
+    for (const auto& job : batch) {
+        auto it = found.find(job->lookupId);
+        job->deliver(it != found.end() ? std::optional<Task>(it->second) : std::nullopt);
+    }
+
+    std::lock_guard<std::mutex> statsLock(statsMutex);
+    stats.lookupQueries++;
+    stats.lookups += batch.size();
+    stats.reads++;
+}
+
+void AsyncTaskManager::writerLoop() {
+    TRACE_THREAD_NAME("async_task_writer");
+    TaskDAOImpl dao(databasePath, userId);
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        writeReady.wait(lock, [this] { return stopping || !writeQueue.empty(); });
+        if (writeQueue.empty()) break;  // 关闭时写队列已排空
+
+        JobPtr job = writeQueue.front();
+        writeQueue.pop_front();
+        lock.unlock();
+
+        if (job->cancelled()) {
+            job->cancel();
+            countCancelled(1);
+        } else {
+            TRACE_SCOPE("task", "AsyncTaskManager::write");
+            auto connectionLock = DatabaseManager::getInstance().lockConnection();
+            job->run(dao);
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.writes++;
+        }
+
+        lock.lock();
+    }
+}
+
+AsyncTaskManager::Stats AsyncTaskManager::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+// =====================
+// CRUD
+// =====================
+
+AsyncResult<int> AsyncTaskManager::createTask(const Task& task, const CancellationToken& token) {
+    return submitWrite<int>([task](TaskDAO& dao) { return dao.insertTask(task); }, token);
+}
+
+AsyncResult<std::optional<Task>> AsyncTaskManager::getTask(int id, const CancellationToken& token) {
+    std::string key = "task:" + std::to_string(id);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto it = pendingReads.find(key);
+        if (it != pendingReads.end()) {
+            it->second->tokens.push_back(token);
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            stats.coalescedReads++;
+            return std::any_cast<AsyncResult<std::optional<Task>>>(it->second->result);
+        }
+    }
+
+    auto job = std::make_shared<Job>();
+    auto promise = std::make_shared<std::promise<std::optional<Task>>>();
+    AsyncResult<std::optional<Task>> future = promise->get_future().share();
+    job->key = key;
+    job->lookupId = id > 0 ? id : 0;
+    job->tokens.push_back(token);
+    job->result = future;
+    job->run = [promise, id](TaskDAO& dao) { promise->set_value(dao.getTaskById(id)); };
+    job->deliver = [promise](const std::optional<Task>& task) { promise->set_value(task); };
+    job->cancel = [promise] {
+        promise->set_exception(std::make_exception_ptr(OperationCancelled()));
+    };
+    enqueueRead(job);
+    return future;
+}
+
+AsyncResult<std::vector<Task>> AsyncTaskManager::getAllTasks(const CancellationToken& token) {
+    return submitRead<std::vector<Task>>("all", [](TaskDAO& dao) { return dao.getAllTasks(); }, token);
+}
+
+AsyncResult<bool> AsyncTaskManager::updateTask(const Task& task, const CancellationToken& token) {
+    return submitWrite<bool>([task](TaskDAO& dao) { return dao.updateTask(task); }, token);
+}
+
+AsyncResult<bool> AsyncTaskManager::deleteTask(int id, const CancellationToken& token) {
+    return submitWrite<bool>([id](TaskDAO& dao) { return dao.deleteTask(id); }, token);
+}
+
+// =====================
+// 状态处理
+// =====================
+
+AsyncResult<bool> AsyncTaskManager::completeTask(int id, const CancellationToken& token) {
+    // 读-改-写在写线程上、持有连接锁完成，与 TaskManager::completeTask 相同
+    return submitWrite<bool>([id](TaskDAO& dao) {
+        auto task = dao.getTaskById(id);
+        if (!task) return false;
+        task->markCompleted();
+        return dao.updateTask(*task);
+    }, token);
+}
+
+AsyncResult<std::vector<Task>> AsyncTaskManager::getTasksByCompletion(bool completed,
+                                                                      const CancellationToken& token) {
+    return submitRead<std::vector<Task>>(completed ? "status:1" : "status:0",
+        [completed](TaskDAO& dao) { return dao.getTasksByStatus(completed); }, token);
+}
+
+// =====================
+// 项目功能
+// =====================
+
+AsyncResult<std::vector<Task>> AsyncTaskManager::getTasksByProject(int projectId,
+                                                                   const CancellationToken& token) {
+    return submitRead<std::vector<Task>>("project:" + std::to_string(projectId),
+        [projectId](TaskDAO& dao) { return dao.getTasksByProject(projectId); }, token);
+}
+
+AsyncResult<bool> AsyncTaskManager::assignTaskToProject(int taskId, int projectId,
+                                                        const CancellationToken& token) {
+    return submitWrite<bool>([taskId, projectId](TaskDAO& dao) {
+        return dao.assignTaskToProject(taskId, projectId);
+    }, token);
+}
+
+// =====================
+// 查询功能
+// =====================
+
+AsyncResult<std::vector<Task>> AsyncTaskManager::getOverdueTasks(const CancellationToken& token) {
+    return submitRead<std::vector<Task>>("overdue", [](TaskDAO& dao) { return dao.getOverdueTasks(); }, token);
+}
+
+AsyncResult<std::vector<Task>> AsyncTaskManager::getTodayTasks(const CancellationToken& token) {
+    return submitRead<std::vector<Task>>("today", [](TaskDAO& dao) { return dao.getTodayTasks(); }, token);
+}
+
+// =====================
+// 统计
+// =====================
+
+AsyncResult<int> AsyncTaskManager::getTaskCount(const CancellationToken& token) {
+    return submitRead<int>("count:all", [](TaskDAO& dao) { return dao.countAllTasks(); }, token);
+}
+
+AsyncResult<int> AsyncTaskManager::getCompletedTaskCount(const CancellationToken& token) {
+    return submitRead<int>("count:completed", [](TaskDAO& dao) { return dao.countCompletedTasks(); }, token);
+}
+
+// =====================
+// 番茄钟
+// =====================
+
+AsyncResult<bool> AsyncTaskManager::addPomodoro(int taskId, const CancellationToken& token) {
+    return submitWrite<bool>([taskId](TaskDAO& dao) { return dao.incrementPomodoro(taskId); }, token);
+}
+
+AsyncResult<int> AsyncTaskManager::getPomodoroCount(int taskId, const CancellationToken& token) {
+    return submitRead<int>("pomodoro:" + std::to_string(taskId),
+        [taskId](TaskDAO& dao) { return dao.getPomodoroCount(taskId); }, token);
+}
@@ -0,0 +1,441 @@
+#include "task/DependencyGraph.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+namespace {
+
+void eraseValue(std::vector<int>& values, int value) {
+    auto it = std::find(values.begin(), values.end(), value);
+    if (it != values.end()) {
+        *it = values.back();
+        values.pop_back();
+    }
+}
+
+} // namespace
+
+bool DependencyGraph::ReadyKey::operator<(const ReadyKey& other) const {
+    if (priority != other.priority) return priority > other.priority;
+    if (dueDate != other.dueDate) return dueDate < other.dueDate;
+    return taskId < other.taskId;
+}
+
+std::uint64_t DependencyGraph::edgeKey(int from, int to) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(from)) << 32) |
+           static_cast<std::uint32_t>(to);
+}
+
+DependencyGraph::ReadyKey DependencyGraph::readyKey(const Node& node) const {
+    return {node.info.priority, node.info.dueDate > 0 ? node.info.dueDate : INT_MAX, node.info.taskId};
+}
+
+int DependencyGraph::find(int taskId) const {
+    auto it = indexOf.find(taskId);
+    return it == indexOf.end() ? -1 : it->second;
+}
+
+void DependencyGraph::refreshReady(int index) {
+    Node& node = nodes[index];
+    bool shouldBeReady = node.alive && !node.info.completed && node.pending == 0;
+    if (shouldBeReady == node.ready) return;
+    if (shouldBeReady) {
+        readyQueue.insert(readyKey(node));
+    } else {
+        readyQueue.erase(readyKey(node));
+    }
+    node.ready = shouldBeReady;
+}
+
+void DependencyGraph::nextEpoch() {
+    if (mark.size() < nodes.size()) mark.resize(nodes.size(), 0);
+    if (++epoch == 0) {
+        std::fill(mark.begin(), mark.end(), 0);
+        epoch = 1;
+    }
+}
+
+void DependencyGraph::clear() {
+    nodes.clear();
+    indexOf.clear();
+    edgeSet.clear();
+    readyQueue.clear();
+    mark.clear();
+    edges = 0;
+    nextOrd = 0;
+    epoch = 0;
+}
+
+// =====================
+// 建图
+// =====================
+
+void DependencyGraph::build(const std::vector<DependencyNode>& taskNodes,
+                            const std::vector<std::pair<int, int>>& dependencyEdges) {
+    clear();
+    nodes.reserve(taskNodes.size());
+    indexOf.reserve(taskNodes.size());
+    for (const auto& info : taskNodes) {
+        if (indexOf.count(info.taskId)) continue;
+        indexOf.emplace(info.taskId, static_cast<int>(nodes.size()));
+        Node node;
+        node.info = info;
+        nodes.push_back(std::move(node));
+    }
+
+    edgeSet.reserve(dependencyEdges.size());
+    for (const auto& [taskId, dependsOn] : dependencyEdges) {
+        int to = find(taskId);
+        int from = find(dependsOn);
+        if (from < 0 || to < 0 || from == to) continue;
+        if (!edgeSet.insert(edgeKey(from, to)).second) continue;
+        nodes[from].out.push_back(to);
+        nodes[to].in.push_back(from);
+        ++edges;
+    }
+
+    // Kahn 拓扑排序给出初始序号
+    std::vector<int> indegree(nodes.size());
+    std::vector<int> queue;
+    queue.reserve(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        indegree[i] = static_cast<int>(nodes[i].in.size());
+        if (indegree[i] == 0) queue.push_back(static_cast<int>(i));
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int index = queue[head];
+        nodes[index].ord = nextOrd++;
+        for (int next : nodes[index].out) {
+            if (--indegree[next] == 0) queue.push_back(next);
+        }
+    }
+
+    // 剩下的节点在环上或依赖环：补上序号，丢弃所有逆序的边
+    if (queue.size() < nodes.size()) {
+        std::vector<int> leftover;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (indegree[i] > 0) {
+                nodes[i].ord = nextOrd++;
+                leftover.push_back(static_cast<int>(i));
+            }
+        }
+        size_t dropped = 0;
+        for (int from : leftover) {
+            std::vector<int> targets = nodes[from].out;
+            for (int to : targets) {
+                if (nodes[from].ord > nodes[to].ord) {
+                    eraseValue(nodes[from].out, to);
+                    eraseValue(nodes[to].in, from);
+                    edgeSet.erase(edgeKey(from, to));
+                    --edges;
+                    ++dropped;
+                }
+            }
+        }
+        std::cerr << "任务依赖中存在环，已忽略 " << dropped << " 条依赖" << std::endl;
+    }
+
+    for (Node& node : nodes) {
+        if (node.info.completed) continue;
+        for (int next : node.out) nodes[next].pending++;
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        refreshReady(static_cast<int>(i));
+    }
+    mark.assign(nodes.size(), 0);
+}
+
+// =====================
+// 节点
+// =====================
+
+bool DependencyGraph::addTask(const DependencyNode& info) {
+    if (indexOf.count(info.taskId)) return false;
+    int index = static_cast<int>(nodes.size());
+    indexOf.emplace(info.taskId, index);
+    Node node;
+    node.info = info;
+    node.ord = nextOrd++;  // 没有边，放在最后不破坏拓扑序
+    nodes.push_back(std::move(node));
+    refreshReady(index);
+    return true;
+}
+
+bool DependencyGraph::removeTask(int taskId) {
+    int index = find(taskId);
+    if (index < 0) return false;
+
+    std::vector<int> successors = nodes[index].out;
+    for (int next : successors) unlinkEdge(index, next);
+    std::vector<int> predecessors = nodes[index].in;
+    for (int prev : predecessors) unlinkEdge(prev, index);
+
+    nodes[index].alive = false;
+    refreshReady(index);
+    indexOf.erase(taskId);
+    return true;
+}
+
+bool DependencyGraph::updateTask(const DependencyNode& info) {
+    int index = find(info.taskId);
+    if (index < 0) return false;
+
+    Node& node = nodes[index];
+    if (node.ready) {
+        readyQueue.erase(readyKey(node));
+        node.ready = false;
+    }
+    bool wasCompleted = node.info.completed;
+    node.info = info;
+    node.info.completed = wasCompleted;  // 完成状态交给 setCompleted，顺带更新后继
+    return setCompleted(info.taskId, info.completed);
+}
+
+bool DependencyGraph::setCompleted(int taskId, bool completed) {
+    int index = find(taskId);
+    if (index < 0) return false;
+
+    Node& node = nodes[index];
+    if (node.info.completed != completed) {
+        node.info.completed = completed;
+        for (int next : node.out) {
+            nodes[next].pending += completed ? -1 : 1;
+            refreshReady(next);
+        }
+    }
+    refreshReady(index);
+    return true;
+}
+
+bool DependencyGraph::setProject(int taskId, int projectId) {
+    int index = find(taskId);
+    if (index < 0) return false;
+    nodes[index].info.projectId = projectId;
+    return true;
+}
+
+bool DependencyGraph::contains(int taskId) const {
+    return indexOf.count(taskId) > 0;
+}
+
+// =====================
+// 边
+// =====================
+
+void DependencyGraph::linkEdge(int from, int to) {
+    nodes[from].out.push_back(to);
+    nodes[to].in.push_back(from);
+    edgeSet.insert(edgeKey(from, to));
+    ++edges;
+    if (!nodes[from].info.completed) {
+        nodes[to].pending++;
+        refreshReady(to);
+    }
+}
+
+void DependencyGraph::unlinkEdge(int from, int to) {
+    eraseValue(nodes[from].out, to);
+    eraseValue(nodes[to].in, from);
+    edgeSet.erase(edgeKey(from, to));
+    --edges;
+    if (!nodes[from].info.completed) {
+        nodes[to].pending--;
+        refreshReady(to);
+    }
+}
+
+bool DependencyGraph::reorder(int from, int to, std::vector<int>* cycle) {
+    // Pearce-Kelly：ord[from] > ord[to]，只有序号落在 [ord[to], ord[from]] 的节点需要调整
+    const int lower = nodes[to].ord;
+    const int upper = nodes[from].ord;
+    nextEpoch();
+
+    // 前向：从 to 出发、序号小于 upper 的后继；碰到 from 即成环
+    std::vector<int> forward;
+    std::vector<int> stack{to};
+    std::unordered_map<int, int> parent;
+    mark[to] = epoch;
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        forward.push_back(index);
+        for (int next : nodes[index].out) {
+            if (next == from) {
+                if (cycle) {
+                    cycle->clear();
+                    for (int at = index; at != to; at = parent[at]) cycle->push_back(nodes[at].info.taskId);
+                    cycle->push_back(nodes[to].info.taskId);
+                    std::reverse(cycle->begin(), cycle->end());
+                    cycle->push_back(nodes[from].info.taskId);
+                    cycle->push_back(nodes[to].info.taskId);
+                }
+                return false;
+            }
+            if (mark[next] != epoch && nodes[next].ord < upper) {
+                mark[next] = epoch;
+                parent[next] = index;
+                stack.push_back(next);
+            }
+        }
+    }
+
+    // 后向：从 from 出发、序号大于 lower 的前置任务
+    std::vector<int> backward;
+    stack.assign(1, from);
+    mark[from] = epoch;
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        backward.push_back(index);
+        for (int prev : nodes[index].in) {
+            if (mark[prev] != epoch && nodes[prev].ord > lower) {
+                mark[prev] = epoch;
+                stack.push_back(prev);
+            }
+        }
+    }
+
+    // 后向集合整体排到前向集合之前，复用这两组节点原有的序号
+    auto byOrd = [this](int a, int b) { return nodes[a].ord < nodes[b].ord; };
+    std::sort(forward.begin(), forward.end(), byOrd);
+    std::sort(backward.begin(), backward.end(), byOrd);
+
+    std::vector<int> affected;
+    affected.reserve(backward.size() + forward.size());
+    affected.insert(affected.end(), backward.begin(), backward.end());
+    affected.insert(affected.end(), forward.begin(), forward.end());
+
+    std::vector<int> slots;
+    slots.reserve(affected.size());
+    for (int index : affected) slots.push_back(nodes[index].ord);
+    std::sort(slots.begin(), slots.end());
+    for (size_t i = 0; i < affected.size(); ++i) {
+        nodes[affected[i]].ord = slots[i];
+    }
+    return true;
+}
+
+bool DependencyGraph::addDependency(int taskId, int dependsOn, std::vector<int>* cycle) {
+    int to = find(taskId);
+    int from = find(dependsOn);
+    if (from < 0 || to < 0) return false;
+    if (from == to) {
+        if (cycle) *cycle = {taskId, taskId};
+        return false;
+    }
+    if (edgeSet.count(edgeKey(from, to))) return true;
+    if (nodes[from].ord > nodes[to].ord && !reorder(from, to, cycle)) return false;
+
+    linkEdge(from, to);
+    return true;
+}
+
+bool DependencyGraph::removeDependency(int taskId, int dependsOn) {
+    int to = find(taskId);
+    int from = find(dependsOn);
+    if (from < 0 || to < 0 || !edgeSet.count(edgeKey(from, to))) return false;
+    unlinkEdge(from, to);
+    return true;
+}
+
+bool DependencyGraph::hasDependency(int taskId, int dependsOn) const {
+    int to = find(taskId);
+    int from = find(dependsOn);
+    return from >= 0 && to >= 0 && edgeSet.count(edgeKey(from, to)) > 0;
+}
+
+std::vector<int> DependencyGraph::getDependencies(int taskId) const {
+    std::vector<int> ids;
+    int index = find(taskId);
+    if (index < 0) return ids;
+    for (int prev : nodes[index].in) ids.push_back(nodes[prev].info.taskId);
+    return ids;
+}
+
+std::vector<int> DependencyGraph::getDependents(int taskId) const {
+    std::vector<int> ids;
+    int index = find(taskId);
+    if (index < 0) return ids;
+    for (int next : nodes[index].out) ids.push_back(nodes[next].info.taskId);
+    return ids;
+}
+
+// =====================
+// 就绪队列
+// =====================
+
+std::optional<int> DependencyGraph::nextReady() const {
+    if (readyQueue.empty()) return std::nullopt;
+    return readyQueue.begin()->taskId;
+}
+
+std::vector<int> DependencyGraph::readyTasks(size_t limit) const {
+    std::vector<int> ids;
+    for (auto it = readyQueue.begin(); it != readyQueue.end() && ids.size() < limit; ++it) {
+        ids.push_back(it->taskId);
+    }
+    return ids;
+}
+
+bool DependencyGraph::isReady(int taskId) const {
+    int index = find(taskId);
+    return index >= 0 && nodes[index].ready;
+}
+
+// =====================
+// 关键路径 / 拓扑序
+// =====================
+
+DependencyGraph::CriticalPath DependencyGraph::criticalPath(int projectId) const {
+    std::vector<int> members;
+    for (const auto& [taskId, index] : indexOf) {
+        if (nodes[index].info.projectId == projectId) members.push_back(index);
+    }
+    std::sort(members.begin(), members.end(), [this](int a, int b) {
+        return nodes[a].ord < nodes[b].ord;
+    });
+
+    // 按拓扑序最长路：dist[v] = weight(v) + max(dist[u])，u 为项目内的前置任务
+    std::unordered_map<int, std::pair<int, int>> best;  // 下标 -> (dist, 前驱下标)
+    best.reserve(members.size());
+    int endIndex = -1;
+    int longest = 0;
+    for (int index : members) {
+        const Node& node = nodes[index];
+        int weight = node.info.completed ? 0 : std::max(1, node.info.weight);
+        int dist = 0;
+        int prev = -1;
+        for (int before : node.in) {
+            auto it = best.find(before);
+            if (it != best.end() && it->second.first > dist) {
+                dist = it->second.first;
+                prev = before;
+            }
+        }
+        dist += weight;
+        best[index] = {dist, prev};
+        if (dist > longest) {
+            longest = dist;
+            endIndex = index;
+        }
+    }
+
+    CriticalPath path;
+    path.length = longest;
+    for (int at = endIndex; at >= 0; at = best[at].second) {
+        path.taskIds.push_back(nodes[at].info.taskId);
+    }
+    std::reverse(path.taskIds.begin(), path.taskIds.end());
+    return path;
+}
+
+std::vector<int> DependencyGraph::topologicalOrder() const {
+    std::vector<int> order;
+    order.reserve(indexOf.size());
+    for (const auto& [taskId, index] : indexOf) order.push_back(index);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return nodes[a].ord < nodes[b].ord;
+    });
+    for (int& index : order) index = nodes[index].info.taskId;
+    return order;
+}
@@ -0,0 +1,330 @@
+#include "task/RoaringBitmap.h"
+#include <algorithm>
+#include <iterator>
+
+// =====================
+// Container
+// =====================
+
+bool RoaringBitmap::Container::contains(std::uint16_t low) const {
+    if (isBitmap()) return (bits[low >> 6] >> (low & 63)) & 1;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+bool RoaringBitmap::Container::add(std::uint16_t low) {
+    if (isBitmap()) {
+        std::uint64_t mask = std::uint64_t(1) << (low & 63);
+        if (bits[low >> 6] & mask) return false;
+        bits[low >> 6] |= mask;
+        count++;
+        return true;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) return false;
+    array.insert(it, low);
+    count++;
+    if (count > ARRAY_LIMIT) toBitmap();
+    return true;
+}
+
+bool RoaringBitmap::Container::remove(std::uint16_t low) {
+    if (isBitmap()) {
+        std::uint64_t mask = std::uint64_t(1) << (low & 63);
+        if (!(bits[low >> 6] & mask)) return false;
+        bits[low >> 6] &= ~mask;
+        count--;
+        if (count <= ARRAY_LIMIT) toArray();
+        return true;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low) return false;
+    array.erase(it);
+    count--;
+    return true;
+}
+
+void RoaringBitmap::Container::toBitmap() {
+    if (isBitmap()) return;
+    bits.assign(BITMAP_WORDS, 0);
+    for (std::uint16_t low : array) bits[low >> 6] |= std::uint64_t(1) << (low & 63);
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::toArray() {
+    if (!isBitmap()) return;
+    array.clear();
+    array.reserve(count);
+    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        std::uint64_t word = bits[w];
+        while (word) {
+            array.push_back(static_cast<std::uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::normalize() {
+    if (isBitmap()) {
+        count = 0;
+        for (std::uint64_t word : bits) count += static_cast<std::uint32_t>(__builtin_popcountll(word));
+        if (count <= ARRAY_LIMIT) toArray();
+    } else {
+        count = static_cast<std::uint32_t>(array.size());
+        if (count > ARRAY_LIMIT) toBitmap();
+    }
+}
+
+// =====================
+// 桶之间的运算
+// =====================
+
+namespace {
+    inline bool testBit(const std::vector<std::uint64_t>& bits, std::uint16_t low) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+
+    // 逐字运算：结果基数的上界不超过 arrayLimit 时直接展开成数组，
+    // 否则边算位图边计数，结果偏小再转回数组
+    template <typename Op>
+    void combineWords(const std::vector<std::uint64_t>& a, const std::vector<std::uint64_t>& b,
+                      Op op, size_t words, size_t arrayLimit, size_t upperBound,
+                      std::vector<std::uint16_t>& array, std::vector<std::uint64_t>& bits,
+                      std::uint32_t& count) {
+        if (upperBound <= arrayLimit) {
+            array.reserve(upperBound);
+            for (size_t w = 0; w < words; ++w) {
+                std::uint64_t word = op(a[w], b[w]);
+                while (word) {
+                    array.push_back(static_cast<std::uint16_t>(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+            count = static_cast<std::uint32_t>(array.size());
+            return;
+        }
+        bits.resize(words);
+        count = 0;
+        for (size_t w = 0; w < words; ++w) {
+            bits[w] = op(a[w], b[w]);
+            count += static_cast<std::uint32_t>(__builtin_popcountll(bits[w]));
+        }
+    }
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        combineWords(a.bits, b.bits, [](std::uint64_t x, std::uint64_t y) { return x & y; },
+                     BITMAP_WORDS, ARRAY_LIMIT, std::min(a.count, b.count),
+                     result.array, result.bits, result.count);
+        if (result.isBitmap() && result.count <= ARRAY_LIMIT) result.toArray();
+        return result;
+    }
+    if (a.isBitmap() || b.isBitmap()) {
+        const Container& arr = a.isBitmap() ? b : a;
+        const Container& bmp = a.isBitmap() ? a : b;
+        result.array.reserve(arr.array.size());
+        for (std::uint16_t low : arr.array) {
+            if (testBit(bmp.bits, low)) result.array.push_back(low);
+        }
+    } else {
+        result.array.reserve(std::min(a.array.size(), b.array.size()));
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+    }
+    result.count = static_cast<std::uint32_t>(result.array.size());
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::unite(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() || b.isBitmap() || a.count + b.count > ARRAY_LIMIT) {
+        result.bits.assign(BITMAP_WORDS, 0);
+        for (const Container* c : {&a, &b}) {
+            if (c->isBitmap()) {
+                for (size_t w = 0; w < BITMAP_WORDS; ++w) result.bits[w] |= c->bits[w];
+            } else {
+                for (std::uint16_t low : c->array) result.bits[low >> 6] |= std::uint64_t(1) << (low & 63);
+            }
+        }
+    } else {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(result.array));
+    }
+    result.normalize();
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::subtract(const Container& a, const Container& b) {
+    Container result;
+    result.key = a.key;
+    if (a.isBitmap() && b.isBitmap()) {
+        combineWords(a.bits, b.bits, [](std::uint64_t x, std::uint64_t y) { return x & ~y; },
+                     BITMAP_WORDS, ARRAY_LIMIT, a.count, result.array, result.bits, result.count);
+        if (result.isBitmap() && result.count <= ARRAY_LIMIT) result.toArray();
+        return result;
+    }
+    if (a.isBitmap()) {
+        result.bits = a.bits;
+        result.count = a.count;
+        for (std::uint16_t low : b.array) {
+            std::uint64_t mask = std::uint64_t(1) << (low & 63);
+            if (result.bits[low >> 6] & mask) {
+                result.bits[low >> 6] &= ~mask;
+                result.count--;
+            }
+        }
+        if (result.count <= ARRAY_LIMIT) result.toArray();
+        return result;
+    }
+    result.array.reserve(a.array.size());
+    if (b.isBitmap()) {
+        for (std::uint16_t low : a.array) {
+            if (!testBit(b.bits, low)) result.array.push_back(low);
+        }
+    } else {
+        std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                            std::back_inserter(result.array));
+    }
+    result.count = static_cast<std::uint32_t>(result.array.size());
+    return result;
+}
+
+// =====================
+// RoaringBitmap
+// =====================
+
+RoaringBitmap::Container* RoaringBitmap::find(std::uint16_t key) {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, std::uint16_t k) { return c.key < k; });
+    return (it != containers.end() && it->key == key) ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find(std::uint16_t key) const {
+    return const_cast<RoaringBitmap*>(this)->find(key);
+}
+
+bool RoaringBitmap::add(std::uint32_t value) {
+    std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, std::uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        it = containers.insert(it, std::move(c));
+    }
+    return it->add(static_cast<std::uint16_t>(value & 0xffff));
+}
+
+bool RoaringBitmap::remove(std::uint32_t value) {
+    std::uint16_t key = static_cast<std::uint16_t>(value >> 16);
+    Container* c = find(key);
+    if (!c || !c->remove(static_cast<std::uint16_t>(value & 0xffff))) return false;
+    if (c->count == 0) containers.erase(containers.begin() + (c - containers.data()));
+    return true;
+}
+
+bool RoaringBitmap::contains(std::uint32_t value) const {
+    const Container* c = find(static_cast<std::uint16_t>(value >> 16));
+    return c && c->contains(static_cast<std::uint16_t>(value & 0xffff));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& c : containers) total += c.count;
+    return total;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() && b != other.containers.end()) {
+        if (a->key < b->key) {
+            ++a;
+        } else if (b->key < a->key) {
+            ++b;
+        } else {
+            Container c = intersect(*a, *b);
+            if (c.count > 0) result.push_back(std::move(c));
+            ++a;
+            ++b;
+        }
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(containers.size() + other.containers.size());
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() || b != other.containers.end()) {
+        if (b == other.containers.end() || (a != containers.end() && a->key < b->key)) {
+            result.push_back(std::move(*a++));
+        } else if (a == containers.end() || b->key < a->key) {
+            result.push_back(*b++);
+        } else {
+            result.push_back(unite(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    auto b = other.containers.begin();
+    for (auto& a : containers) {
+        while (b != other.containers.end() && b->key < a.key) ++b;
+        if (b == other.containers.end() || b->key != a.key) {
+            result.push_back(std::move(a));
+            continue;
+        }
+        Container c = subtract(a, *b);
+        if (c.count > 0) result.push_back(std::move(c));
+    }
+    containers = std::move(result);
+    return *this;
+}
+
+std::vector<std::uint32_t> RoaringBitmap::toVector(size_t limit) const {
+    std::vector<std::uint32_t> values;
+    size_t total = cardinality();
+    values.reserve(limit > 0 ? std::min(limit, total) : total);
+    for (const auto& c : containers) {
+        const std::uint32_t high = static_cast<std::uint32_t>(c.key) << 16;
+        if (!c.isBitmap()) {
+            for (std::uint16_t low : c.array) {
+                if (limit > 0 && values.size() >= limit) return values;
+                values.push_back(high | low);
+            }
+            continue;
+        }
+        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+            std::uint64_t word = c.bits[w];
+            while (word) {
+                if (limit > 0 && values.size() >= limit) return values;
+                values.push_back(high | static_cast<std::uint32_t>(w * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+    return values;
+}
+
+size_t RoaringBitmap::memoryBytes() const {
+    size_t bytes = sizeof(*this) + containers.capacity() * sizeof(Container);
+    for (const auto& c : containers) {
+        bytes += c.array.capacity() * sizeof(std::uint16_t) + c.bits.capacity() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
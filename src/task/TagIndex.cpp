@@ -0,0 +1,213 @@
+#include "task/TagIndex.h"
+#include <algorithm>
+#include <cctype>
+
+std::string TagIndex::normalize(const std::string& name) {
+    size_t begin = 0, end = name.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(name[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(name[end - 1]))) --end;
+
+    std::string result = name.substr(begin, end - begin);
+    if (result.find(',') != std::string::npos) return "";
+    for (char& c : result) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return result;
+}
+
+// =====================
+// 建立
+// =====================
+
+void TagIndex::build(const std::vector<std::pair<int, std::string>>& tags,
+                     const std::vector<TaggedTask>& taskRows) {
+    clear();
+    for (const auto& [id, name] : tags) {
+        tagIds[name] = id;
+        tagNames[id] = name;
+    }
+    tasks.reserve(taskRows.size());
+    for (const auto& row : taskRows) {
+        addTask(row.taskId, row.completed, row.projectId);
+        TaskInfo& info = tasks[row.taskId];
+        for (int tagId : row.tagIds) {
+            if (!tagNames.count(tagId)) continue;
+            info.tagIds.push_back(tagId);
+            byTag[tagId].add(static_cast<std::uint32_t>(row.taskId));
+        }
+    }
+}
+
+void TagIndex::clear() {
+    tagIds.clear();
+    tagNames.clear();
+    byTag.clear();
+    byProject.clear();
+    allTasks.clear();
+    completedTasks.clear();
+    tasks.clear();
+}
+
+// =====================
+// 任务
+// =====================
+
+void TagIndex::addTask(int taskId, bool completed, int projectId) {
+    if (tasks.count(taskId)) {
+        setCompleted(taskId, completed);
+        setProject(taskId, projectId);
+        return;
+    }
+    tasks[taskId].projectId = projectId;
+    allTasks.add(static_cast<std::uint32_t>(taskId));
+    if (completed) completedTasks.add(static_cast<std::uint32_t>(taskId));
+    if (projectId > 0) byProject[projectId].add(static_cast<std::uint32_t>(taskId));
+}
+
+void TagIndex::removeTask(int taskId) {
+    auto it = tasks.find(taskId);
+    if (it == tasks.end()) return;
+
+    const auto id = static_cast<std::uint32_t>(taskId);
+    for (int tagId : it->second.tagIds) {
+        auto bitmap = byTag.find(tagId);
+        if (bitmap != byTag.end()) bitmap->second.remove(id);
+    }
+    setProject(taskId, 0);
+    allTasks.remove(id);
+    completedTasks.remove(id);
+    tasks.erase(it);
+}
+
+void TagIndex::setCompleted(int taskId, bool completed) {
+    if (!tasks.count(taskId)) return;
+    if (completed) {
+        completedTasks.add(static_cast<std::uint32_t>(taskId));
+    } else {
+        completedTasks.remove(static_cast<std::uint32_t>(taskId));
+    }
+}
+
+void TagIndex::setProject(int taskId, int projectId) {
+    auto it = tasks.find(taskId);
+    if (it == tasks.end() || it->second.projectId == projectId) return;
+
+    const auto id = static_cast<std::uint32_t>(taskId);
+    int old = it->second.projectId;
+    if (old > 0) {
+        auto bitmap = byProject.find(old);
+        if (bitmap != byProject.end()) {
+            bitmap->second.remove(id);
+            if (bitmap->second.empty()) byProject.erase(bitmap);
+        }
+    }
+    if (projectId > 0) byProject[projectId].add(id);
+    it->second.projectId = projectId;
+}
+
+void TagIndex::setTags(int taskId, const std::vector<std::pair<int, std::string>>& tags) {
+    auto it = tasks.find(taskId);
+    if (it == tasks.end()) return;
+
+    const auto id = static_cast<std::uint32_t>(taskId);
+    for (int tagId : it->second.tagIds) byTag[tagId].remove(id);
+    it->second.tagIds.clear();
+
+    for (const auto& [tagId, name] : tags) {
+        tagIds[name] = tagId;
+        tagNames[tagId] = name;
+        if (byTag[tagId].add(id)) it->second.tagIds.push_back(tagId);
+    }
+}
+
+std::vector<std::string> TagIndex::tagsOf(int taskId) const {
+    std::vector<std::string> names;
+    auto it = tasks.find(taskId);
+    if (it == tasks.end()) return names;
+    for (int tagId : it->second.tagIds) names.push_back(tagNames.at(tagId));
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+// =====================
+// 查询
+// =====================
+
+std::optional<int> TagIndex::tagId(const std::string& name) const {
+    auto it = tagIds.find(normalize(name));
+    if (it == tagIds.end()) return std::nullopt;
+    return it->second;
+}
+
+const RoaringBitmap* TagIndex::tagBitmap(const std::string& name) const {
+    auto id = tagId(name);
+    if (!id) return nullptr;
+    auto it = byTag.find(*id);
+    return it == byTag.end() ? nullptr : &it->second;
+}
+
+RoaringBitmap TagIndex::query(const TagQuery& q) const {
+    static const RoaringBitmap EMPTY;
+
+    // all：任何一个标签不存在结果就是空集；先用最小的集合起步，中间结果始终最小
+    std::vector<const RoaringBitmap*> required;
+    for (const auto& name : q.all) {
+        const RoaringBitmap* bitmap = tagBitmap(name);
+        if (!bitmap || bitmap->empty()) return RoaringBitmap();
+        required.push_back(bitmap);
+    }
+    std::sort(required.begin(), required.end(), [](const RoaringBitmap* a, const RoaringBitmap* b) {
+        return a->cardinality() < b->cardinality();
+    });
+
+    RoaringBitmap result;
+    if (!required.empty()) {
+        result = *required.front();
+        for (size_t i = 1; i < required.size() && !result.empty(); ++i) result &= *required[i];
+    }
+
+    if (!q.any.empty()) {
+        RoaringBitmap either;
+        for (const auto& name : q.any) {
+            if (const RoaringBitmap* bitmap = tagBitmap(name)) either |= *bitmap;
+        }
+        if (required.empty()) {
+            result = std::move(either);
+        } else {
+            result &= either;
+        }
+    } else if (required.empty()) {
+        result = allTasks;
+    }
+
+    if (q.projectId) {
+        auto it = byProject.find(*q.projectId);
+        result &= it == byProject.end() ? EMPTY : it->second;
+    }
+    if (q.completed) {
+        if (*q.completed) {
+            result &= completedTasks;
+        } else {
+            result -= completedTasks;
+        }
+    }
+    for (const auto& name : q.none) {
+        if (result.empty()) break;
+        if (const RoaringBitmap* bitmap = tagBitmap(name)) result -= *bitmap;
+    }
+    return result;
+}
+
+std::vector<std::pair<std::string, size_t>> TagIndex::tagCounts() const {
+    std::vector<std::pair<std::string, size_t>> counts;
+    for (const auto& [id, bitmap] : byTag) {
+        if (!bitmap.empty()) counts.emplace_back(tagNames.at(id), bitmap.cardinality());
+    }
+    std::sort(counts.begin(), counts.end());
+    return counts;
+}
+
+size_t TagIndex::memoryBytes() const {
+    size_t bytes = allTasks.memoryBytes() + completedTasks.memoryBytes();
+    for (const auto& [id, bitmap] : byTag) bytes += bitmap.memoryBytes();
+    for (const auto& [id, bitmap] : byProject) bytes += bitmap.memoryBytes();
+    return bytes;
+}
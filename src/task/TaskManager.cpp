@@ -1,6 +1,14 @@
 #include "task/TaskManager.h"
+#include "database/ChangeFeed.h"
+#include "trace/Tracer.h"
 #include <iostream>
 #include <ctime>
+#include <algorithm>
+
+namespace {
+    // 一次收到的外部变更超过这么多行时整体重建排程堆，而不是逐行重读
+    constexpr size_t SCHEDULE_REFRESH_LIMIT = 256;
+}
 
 // =====================
 // 构造 & 析构
@@ -9,10 +17,14 @@
 TaskManager::TaskManager() {
     dao = new TaskDAOImpl();
     ownDAO = true;
+    taskChanges = std::make_unique<ChangeSubscription>(
+        std::vector<std::string>{"tasks", "task_dependencies", "task_tags"});
 }
 
 TaskManager::TaskManager(TaskDAO* externalDao) {
     dao = externalDao;
+    taskChanges = std::make_unique<ChangeSubscription>(
+        std::vector<std::string>{"tasks", "task_dependencies", "task_tags"});
 }
 
 TaskManager::~TaskManager() {
@@ -25,29 +37,149 @@ bool TaskManager::initialize() {
     return dao->createTable();
 }
 
+void TaskManager::applyChanges() {
+    if (!taskChanges->hasChanges()) return;
+
+    ChangeBatch batch = taskChanges->take();
+    if (batch.truncated) {
+        graph.reset();
+        scheduler.reset();
+        tagIndex.reset();
+        return;
+    }
+    // task_dependencies、task_tags 是 WITHOUT ROWID 表，行钩子不触发；
+    // 两者的写入都会更新所属任务的 tasks 行（标签同步列、依赖触发器），按 tasks 判断即可
+    std::vector<sqlite3_int64> rows = batch.rowids("tasks");
+    if (rows.empty()) return;
+
+    // 依赖边和标签无法按行重读，整体丢弃，下次使用时重新加载
+    graph.reset();
+    tagIndex.reset();
+    if (rows.size() > SCHEDULE_REFRESH_LIMIT) {
+        scheduler.reset();
+        return;
+    }
+    for (sqlite3_int64 id : rows) {
+        refreshScheduled(static_cast<int>(id));
+    }
+}
+
+DependencyGraph* TaskManager::loadedGraph() {
+    applyChanges();
+    if (graph) return graph.get();
+
+    TRACE_SCOPE("task", "TaskManager::loadDependencyGraph");
+    std::vector<DependencyNode> nodes;
+    std::vector<std::pair<int, int>> edges;
+    if (!dao->loadDependencyGraph(nodes, edges)) {
+        std::cerr << "加载任务依赖失败" << std::endl;
+        return nullptr;
+    }
+    graph = std::make_unique<DependencyGraph>();
+    graph->build(nodes, edges);
+    return graph.get();
+}
+
+TaskScheduler* TaskManager::loadedScheduler() {
+    applyChanges();
+    if (scheduler) return scheduler.get();
+
+    TRACE_SCOPE("task", "TaskManager::loadSchedule");
+    std::vector<ScheduleEntry> entries;
+    if (!dao->loadScheduleEntries(entries)) {
+        std::cerr << "加载排程数据失败" << std::endl;
+        return nullptr;
+    }
+    scheduler = std::make_unique<TaskScheduler>();
+    scheduler->build(entries);
+    return scheduler.get();
+}
+
+void TaskManager::refreshScheduled(int taskId) {
+    if (!scheduler) return;
+    auto entry = dao->getScheduleEntry(taskId);
+    if (entry) {
+        scheduler->upsert(*entry);
+    } else {
+        scheduler->remove(taskId);
+    }
+}
+
+TagIndex* TaskManager::loadedTagIndex() {
+    applyChanges();
+    if (tagIndex) return tagIndex.get();
+
+    TRACE_SCOPE("task", "TaskManager::loadTagIndex");
+    std::vector<std::pair<int, std::string>> tags;
+    std::vector<TaggedTask> tasks;
+    if (!dao->loadTagIndex(tags, tasks)) {
+        std::cerr << "加载标签索引失败" << std::endl;
+        return nullptr;
+    }
+    tagIndex = std::make_unique<TagIndex>();
+    tagIndex->build(tags, tasks);
+    return tagIndex.get();
+}
+
 // =====================
 // CRUD
 // =====================
 
 int TaskManager::createTask(const Task& task) {
+    TRACE_SCOPE("task", "TaskManager::createTask");
+    ChangeSubscription::Mute mute(*taskChanges);
     auto id = dao->insertTask(task);
+    if (id > 0 && graph) {
+        DependencyNode node;
+        node.taskId = id;
+        node.completed = task.isCompleted();
+        node.projectId = task.getProjectId();
+        graph->addTask(node);
+    }
+    if (id > 0) refreshScheduled(id);
+    if (id > 0 && tagIndex) tagIndex->addTask(id, task.isCompleted(), task.getProjectId());
     return id; // 若失败，DAO 会返回 -1
 }
 
 std::optional<Task> TaskManager::getTask(int id) {
+    TRACE_SCOPE("task", "TaskManager::getTask");
     return dao->getTaskById(id);
 }
 
 std::vector<Task> TaskManager::getAllTasks() {
+    TRACE_SCOPE("task", "TaskManager::getAllTasks");
     return dao->getAllTasks();
 }
 
+std::vector<Task> TaskManager::getTasksByIds(const std::vector<int>& ids) {
+    TRACE_SCOPE("task", "TaskManager::getTasksByIds");
+    return dao->getTasksByIds(ids);
+}
+
 bool TaskManager::updateTask(const Task& task) {
-    return dao->updateTask(task);
+    TRACE_SCOPE("task", "TaskManager::updateTask");
+    ChangeSubscription::Mute mute(*taskChanges);
+    bool ok = dao->updateTask(task);
+    if (ok && graph) {
+        graph->setCompleted(task.getId(), task.isCompleted());
+        graph->setProject(task.getId(), task.getProjectId());
+    }
+    if (ok) refreshScheduled(task.getId());
+    if (ok && tagIndex) {
+        tagIndex->setCompleted(task.getId(), task.isCompleted());
+        tagIndex->setProject(task.getId(), task.getProjectId());
+    }
+    return ok;
 }
 
 bool TaskManager::deleteTask(int id) {
-    return dao->deleteTask(id);
+    TRACE_SCOPE("task", "TaskManager::deleteTask");
+    ChangeSubscription::Mute mute(*taskChanges);
+    bool ok = dao->deleteTask(id);
+    if (ok && graph) graph->removeTask(id);
+    if (ok && scheduler) scheduler->remove(id);
+    if (ok && tagIndex) tagIndex->removeTask(id);
+    return ok;
 }
 
 // =====================
@@ -55,6 +187,8 @@ bool TaskManager::deleteTask(int id) {
 // =====================
 
 bool TaskManager::completeTask(int id) {
+    TRACE_SCOPE("task", "TaskManager::completeTask");
+    ChangeSubscription::Mute mute(*taskChanges);
     auto taskOpt = dao->getTaskById(id);
     if (!taskOpt.has_value()) return false;
 
@@ -65,6 +199,9 @@ bool TaskManager::completeTask(int id) {
 
     // === 奖励 XP（完成任务）===
     if (ok) {
+        if (graph) graph->setCompleted(id, true);  // 后继任务可能因此就绪
+        if (scheduler) scheduler->remove(id);
+        if (tagIndex) tagIndex->setCompleted(id, true);
         // XPSystem::getInstance()->awardXP(20, "Task Completed!");
         std::cout << "Task " << id << " completed successfully.\n";
     }
@@ -72,6 +209,7 @@ bool TaskManager::completeTask(int id) {
 }
 
 std::vector<Task> TaskManager::getTasksByCompletion(bool completed) {
+    TRACE_SCOPE("task", "TaskManager::getTasksByCompletion");
     return dao->getTasksByStatus(completed);
 }
 
@@ -80,11 +218,18 @@ std::vector<Task> TaskManager::getTasksByCompletion(bool completed) {
 // =====================
 
 std::vector<Task> TaskManager::getTasksByProject(int projectId) {
+    TRACE_SCOPE("task", "TaskManager::getTasksByProject");
     return dao->getTasksByProject(projectId);
 }
 
 bool TaskManager::assignTaskToProject(int taskId, int projectId) {
-    return dao->assignTaskToProject(taskId, projectId);
+    TRACE_SCOPE("task", "TaskManager::assignTaskToProject");
+    ChangeSubscription::Mute mute(*taskChanges);
+    bool ok = dao->assignTaskToProject(taskId, projectId);
+    if (ok && graph) graph->setProject(taskId, projectId);
+    if (ok) refreshScheduled(taskId);   // 截止日期可能改由新项目的目标日期决定
+    if (ok && tagIndex) tagIndex->setProject(taskId, projectId);
+    return ok;
 }
 
 // =====================
@@ -92,10 +237,12 @@ bool TaskManager::assignTaskToProject(int taskId, int projectId) {
 // =====================
 
 std::vector<Task> TaskManager::getOverdueTasks() {
+    TRACE_SCOPE("task", "TaskManager::getOverdueTasks");
     return dao->getOverdueTasks();
 }
 
 std::vector<Task> TaskManager::getTodayTasks() {
+    TRACE_SCOPE("task", "TaskManager::getTodayTasks");
     return dao->getTodayTasks();
 }
 
@@ -124,9 +271,149 @@ double TaskManager::getCompletionRate() {
 // =====================
 
 bool TaskManager::addPomodoro(int taskId) {
-    return dao->incrementPomodoro(taskId);
+    TRACE_SCOPE("task", "TaskManager::addPomodoro");
+    ChangeSubscription::Mute mute(*taskChanges);
+    bool ok = dao->incrementPomodoro(taskId);
+    if (ok) refreshScheduled(taskId);
+    return ok;
 }
 
 int TaskManager::getPomodoroCount(int taskId) {
     return dao->getPomodoroCount(taskId);
 }
+
+// =====================
+// 任务依赖
+// =====================
+
+bool TaskManager::addDependency(int taskId, int dependsOnId, std::vector<int>* cycle) {
+    TRACE_SCOPE("task", "TaskManager::addDependency");
+    DependencyGraph* g = loadedGraph();
+    if (!g) return false;
+
+    if (!g->contains(taskId) || !g->contains(dependsOnId)) {
+        std::cerr << "任务不存在: " << (g->contains(taskId) ? dependsOnId : taskId) << std::endl;
+        return false;
+    }
+    if (g->hasDependency(taskId, dependsOnId)) return true;
+
+    ChangeSubscription::Mute mute(*taskChanges);
+    // 先在内存图上检查环，通过后再落库；落库失败则撤销
+    if (!g->addDependency(taskId, dependsOnId, cycle)) {
+        std::cerr << "依赖会形成环: " << dependsOnId << " -> " << taskId << std::endl;
+        return false;
+    }
+    if (!dao->addDependency(taskId, dependsOnId)) {
+        g->removeDependency(taskId, dependsOnId);
+        return false;
+    }
+    return true;
+}
+
+bool TaskManager::removeDependency(int taskId, int dependsOnId) {
+    TRACE_SCOPE("task", "TaskManager::removeDependency");
+    DependencyGraph* g = loadedGraph();
+    if (!g) return false;
+    ChangeSubscription::Mute mute(*taskChanges);
+    if (!dao->removeDependency(taskId, dependsOnId)) return false;
+    g->removeDependency(taskId, dependsOnId);
+    return true;
+}
+
+std::vector<int> TaskManager::getDependencies(int taskId) {
+    DependencyGraph* g = loadedGraph();
+    return g ? g->getDependencies(taskId) : std::vector<int>();
+}
+
+std::optional<int> TaskManager::getNextReadyTask() {
+    DependencyGraph* g = loadedGraph();
+    return g ? g->nextReady() : std::nullopt;
+}
+
+std::vector<int> TaskManager::getReadyTasks(size_t limit) {
+    DependencyGraph* g = loadedGraph();
+    return g ? g->readyTasks(limit) : std::vector<int>();
+}
+
+DependencyGraph::CriticalPath TaskManager::getCriticalPath(int projectId) {
+    TRACE_SCOPE("task", "TaskManager::getCriticalPath");
+    DependencyGraph* g = loadedGraph();
+    return g ? g->criticalPath(projectId) : DependencyGraph::CriticalPath();
+}
+
+void TaskManager::reloadDependencies() {
+    graph.reset();
+}
+
+// =====================
+// 排程
+// =====================
+
+std::vector<TaskScheduler::Scored> TaskManager::nextTasks(size_t k) {
+    TRACE_SCOPE("task", "TaskManager::nextTasks");
+    TaskScheduler* s = loadedScheduler();
+    if (!s) return {};
+
+    // 还有未完成前置任务的跳过；依赖图加载失败时不做过滤
+    DependencyGraph* g = loadedGraph();
+    return s->topK(k, [g](int taskId) {
+        return !g || !g->contains(taskId) || g->isReady(taskId);
+    });
+}
+
+void TaskManager::reloadSchedule() {
+    scheduler.reset();
+}
+
+// =====================
+// 标签
+// =====================
+
+bool TaskManager::setTaskTags(int taskId, const std::vector<std::string>& tags) {
+    TRACE_SCOPE("task", "TaskManager::setTaskTags");
+    // 规范化和去重由 DAO 完成，远程 DAO 则交给守护进程
+    std::vector<std::pair<int, std::string>> interned;
+    ChangeSubscription::Mute mute(*taskChanges);
+    if (!dao->setTaskTags(taskId, tags, interned)) return false;
+    if (tagIndex) tagIndex->setTags(taskId, interned);
+    return true;
+}
+
+bool TaskManager::addTaskTags(int taskId, const std::vector<std::string>& tags) {
+    std::vector<std::string> current = getTaskTags(taskId);
+    current.insert(current.end(), tags.begin(), tags.end());
+    return setTaskTags(taskId, current);
+}
+
+bool TaskManager::removeTaskTags(int taskId, const std::vector<std::string>& tags) {
+    std::vector<std::string> current = getTaskTags(taskId);
+    for (const auto& tag : tags) {
+        current.erase(std::remove(current.begin(), current.end(), TagIndex::normalize(tag)), current.end());
+    }
+    return setTaskTags(taskId, current);
+}
+
+std::vector<std::string> TaskManager::getTaskTags(int taskId) {
+    applyChanges();
+    if (tagIndex && tagIndex->contains(taskId)) return tagIndex->tagsOf(taskId);
+    return dao->getTaskTags(taskId);
+}
+
+std::vector<int> TaskManager::findTasksByTags(const TagQuery& query, size_t limit) {
+    TRACE_SCOPE("task", "TaskManager::findTasksByTags");
+    TagIndex* index = loadedTagIndex();
+    if (!index) return {};
+
+    std::vector<int> ids;
+    for (std::uint32_t id : index->query(query).toVector(limit)) ids.push_back(static_cast<int>(id));
+    return ids;
+}
+
+std::vector<std::pair<std::string, size_t>> TaskManager::getTagCounts() {
+    TagIndex* index = loadedTagIndex();
+    return index ? index->tagCounts() : std::vector<std::pair<std::string, size_t>>();
+}
+
+void TaskManager::reloadTags() {
+    tagIndex.reset();
+}
@@ -0,0 +1,190 @@
+#include "task/TaskScheduler.h"
+#include <chrono>
+#include <cstdio>
+
+TaskScheduler::TaskScheduler(const SchedulerWeights& weights)
+    : weights(weights), today(currentDay()), observedDay(today) {}
+
+// =====================
+// 日期
+// =====================
+
+std::optional<int> TaskScheduler::dayNumber(const std::string& date) {
+    int year = 0, month = 0, day = 0;
+    if (std::sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day) != 3 ||
+        month < 1 || month > 12 || day < 1 || day > 31) {
+        return std::nullopt;
+    }
+    // 公历日期 -> 天数（Howard Hinnant 的 days_from_civil）
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int TaskScheduler::currentDay() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::hours>(now).count() / 24);
+}
+
+void TaskScheduler::setToday(int day) {
+    today = day;
+    heapify();
+}
+
+void TaskScheduler::rebaseIfDayChanged() {
+    int day = currentDay();
+    if (day == observedDay) return;
+    observedDay = day;
+    setToday(day);
+}
+
+// =====================
+// 评分
+// =====================
+
+bool TaskScheduler::before(const Item& a, const Item& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.taskId < b.taskId;
+}
+
+double TaskScheduler::scoreOf(const Item& item) const {
+    double score = item.priority * weights.priorityWeight;
+    if (item.deadline != NO_DATE) {
+        int daysLeft = item.deadline - today;
+        if (daysLeft < 0) {
+            score += weights.overdueBase + weights.overduePerDay * std::min(-daysLeft, 30);
+        } else {
+            score += weights.dueWeight / (daysLeft + 1);
+        }
+        if (item.remaining > 0) {
+            score += std::min(weights.workCap, weights.workWeight * item.remaining / (std::max(daysLeft, 0) + 1));
+        }
+    }
+    if (item.started && item.remaining > 0) score += weights.startedBonus;
+    return score;
+}
+
+TaskScheduler::Item TaskScheduler::makeItem(const ScheduleEntry& entry) const {
+    Item item;
+    item.taskId = entry.taskId;
+    item.priority = entry.priority;
+    item.deadline = std::min(dayNumber(entry.dueDate).value_or(NO_DATE),
+                             dayNumber(entry.projectTargetDate).value_or(NO_DATE));
+    item.remaining = std::max(0, entry.estimatedPomodoros - entry.pomodoroCount);
+    item.started = entry.pomodoroCount > 0;
+    item.score = scoreOf(item);
+    return item;
+}
+
+std::optional<double> TaskScheduler::scoreOf(int taskId) const {
+    auto it = position.find(taskId);
+    if (it == position.end()) return std::nullopt;
+    return heap[it->second].score;
+}
+
+// =====================
+// 4 叉堆
+// =====================
+
+void TaskScheduler::place(size_t index, Item item) {
+    position[item.taskId] = index;
+    heap[index] = std::move(item);
+}
+
+void TaskScheduler::siftUp(size_t index) {
+    Item item = heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / ARITY;
+        if (!before(item, heap[parent])) break;
+        place(index, heap[parent]);
+        index = parent;
+    }
+    place(index, item);
+}
+
+void TaskScheduler::siftDown(size_t index) {
+    Item item = heap[index];
+    const size_t n = heap.size();
+    while (true) {
+        size_t first = index * ARITY + 1;
+        if (first >= n) break;
+        size_t best = first;
+        for (size_t child = first + 1; child < first + ARITY && child < n; ++child) {
+            if (before(heap[child], heap[best])) best = child;
+        }
+        if (!before(heap[best], item)) break;
+        place(index, heap[best]);
+        index = best;
+    }
+    place(index, item);
+}
+
+void TaskScheduler::heapify() {
+    for (Item& item : heap) item.score = scoreOf(item);
+    if (heap.size() > 1) {
+        for (size_t i = (heap.size() - 2) / ARITY + 1; i-- > 0;) siftDown(i);
+    }
+    for (size_t i = 0; i < heap.size(); ++i) position[heap[i].taskId] = i;
+}
+
+void TaskScheduler::build(const std::vector<ScheduleEntry>& entries) {
+    clear();
+    today = observedDay = currentDay();
+    heap.reserve(entries.size());
+    position.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (position.count(entry.taskId)) continue;
+        position[entry.taskId] = heap.size();
+        heap.push_back(makeItem(entry));
+    }
+    heapify();
+}
+
+void TaskScheduler::clear() {
+    heap.clear();
+    position.clear();
+}
+
+void TaskScheduler::upsert(const ScheduleEntry& entry) {
+    Item item = makeItem(entry);
+    auto it = position.find(entry.taskId);
+    if (it == position.end()) {
+        heap.push_back(item);
+        position[item.taskId] = heap.size() - 1;
+        siftUp(heap.size() - 1);
+        return;
+    }
+
+    size_t index = it->second;
+    bool raised = before(item, heap[index]);
+    heap[index] = item;
+    if (raised) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+}
+
+bool TaskScheduler::remove(int taskId) {
+    auto it = position.find(taskId);
+    if (it == position.end()) return false;
+
+    size_t index = it->second;
+    position.erase(it);
+    Item last = heap.back();
+    heap.pop_back();
+    if (index == heap.size()) return true;
+
+    // 末尾元素填到空位，再视情况上浮或下沉
+    bool raised = before(last, heap[index]);
+    place(index, last);
+    if (raised) {
+        siftUp(index);
+    } else {
+        siftDown(index);
+    }
+    return true;
+}
@@ -1,16 +1,17 @@
 #include "task/task.h"
+#include "database/DatabaseManager.h"
 
 // Default constructor
 Task::Task()
-    : id(-1), name(""), description(""), projectId(0), completed(false) {}
+    : id(-1), name(""), description(""), projectId(0), completed(false), userId(DatabaseManager::DEFAULT_USER_ID) {}
 
 // Main constructor
 Task::Task(const std::string &name, const std::string &desc, int projectId)
-    : id(-1), name(name), description(desc), projectId(projectId), completed(false) {}
+    : id(-1), name(name), description(desc), projectId(projectId), completed(false), userId(DatabaseManager::DEFAULT_USER_ID) {}
 
 // Full constructor (used when reading from database)
 Task::Task(int id, const std::string &name, const std::string &desc, bool completed, int projectId)
-    : id(id), name(name), description(desc), projectId(projectId), completed(completed) {}
+    : id(id), name(name), description(desc), projectId(projectId), completed(completed), userId(DatabaseManager::DEFAULT_USER_ID) {}
 
 // ID 相关方法 ⭐ 新增
 int Task::getId() const {
@@ -60,3 +61,12 @@ void Task::setDescription(const std::string& desc) {
 void Task::setProjectId(int projectId) {
     this->projectId = projectId;
 }
+
+// 多用户
+int Task::getUserId() const {
+    return userId;
+}
+
+void Task::setUserId(int userId) {
+    this->userId = userId;
+}
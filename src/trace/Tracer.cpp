@@ -0,0 +1,202 @@
+#include "trace/Tracer.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+
+std::atomic<bool> Tracer::enabledFlag{false};
+
+namespace {
+
+// 单个线程的环形缓冲区；线程结束后仍留在注册表里，事件可以照常导出
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> ring;   // 第一次记录时才分配，setThreadName 不分配
+    size_t next = 0;
+    bool wrapped = false;
+    int tid = 0;
+    std::string threadName;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::atomic<size_t> capacity{16384};
+    int nextTid = 1;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        created->tid = reg.nextTid++;
+        reg.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+const std::chrono::steady_clock::time_point& epoch() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text ? text : ""; *c; ++c) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        switch (ch) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (ch < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(ch)
+                        << std::dec << std::setfill(' ');
+                } else {
+                    out << *c;
+                }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+void Tracer::setBufferCapacity(size_t events) {
+    registry().capacity = std::max<size_t>(1, events);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+void Tracer::copyDetail(TraceEvent& event, const char* detail) {
+    size_t length = std::strlen(detail);
+    if (length >= TraceEvent::DETAIL_SIZE) {
+        // 截断时留意不要切断 UTF-8 多字节字符
+        length = TraceEvent::DETAIL_SIZE - 1;
+        while (length > 0 && (static_cast<unsigned char>(detail[length]) & 0xC0) == 0x80) --length;
+    }
+    std::memcpy(event.detail, detail, length);
+    event.detail[length] = '\0';
+}
+
+void Tracer::record(const TraceEvent& event) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.ring.empty()) {
+        buffer.ring.resize(registry().capacity.load());
+    }
+    buffer.ring[buffer.next] = event;
+    if (++buffer.next == buffer.ring.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+std::int64_t Tracer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch()).count();
+}
+
+size_t Tracer::eventCount() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    size_t total = 0;
+    for (const auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        total += buffer->wrapped ? buffer->ring.size() : buffer->next;
+    }
+    return total;
+}
+
+void Tracer::clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& buffer : reg.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        std::vector<TraceEvent>().swap(buffer->ring);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "无法写入追踪文件: " << path << std::endl;
+        return false;
+    }
+
+    const int pid = static_cast<int>(getpid());
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        out << (first ? "\n    " : ",\n    ");
+        first = false;
+        return out;
+    };
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    out << std::fixed << std::setprecision(3);
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& buffer : reg.buffers) {
+        // 先拷出来再写文件，缩短持有线程缓冲区锁的时间
+        std::vector<TraceEvent> events;
+        std::string threadName;
+        int tid = 0;
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            if (buffer->wrapped) {
+                events.assign(buffer->ring.begin() + buffer->next, buffer->ring.end());
+            }
+            events.insert(events.end(), buffer->ring.begin(), buffer->ring.begin() + buffer->next);
+            threadName = buffer->threadName;
+            tid = buffer->tid;
+        }
+
+        if (!threadName.empty()) {
+            separator() << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid
+                        << ", \"tid\": " << tid << ", \"args\": {\"name\": ";
+            writeJsonString(out, threadName.c_str());
+            out << "}}";
+        }
+
+        for (const auto& event : events) {
+            separator() << "{\"ph\": \"X\", \"cat\": ";
+            writeJsonString(out, event.category);
+            out << ", \"name\": ";
+            writeJsonString(out, event.name);
+            out << ", \"pid\": " << pid << ", \"tid\": " << tid
+                << ", \"ts\": " << event.startNs / 1000.0
+                << ", \"dur\": " << event.durationNs / 1000.0;
+            if (event.detail[0]) {
+                out << ", \"args\": {\"detail\": ";
+                writeJsonString(out, event.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
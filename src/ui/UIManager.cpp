@@ -2,9 +2,15 @@
 #include "database/DatabaseManager.h"
 #include "statistics/StatisticsAnalyzer.h"
 #include "gamification/XPSystem.h"
+#include "gamification/Leaderboard.h"
+#include "Pomodoro/PomodoroEngine.h"
 #include "HeatmapVisualizer/HeatmapVisualizer.h"
 #include "project/ProjectManager.h"
 #include "task/TaskManager.h" // ⭐ 引入任务管理器
+#include "task/AsyncTaskManager.h"
+#include "database/ChangeFeed.h"
+#include "rpc/RemoteTaskDAO.h"
+#include "trace/Tracer.h"
 
 #include <iostream>
 #include <iomanip>
@@ -13,6 +19,7 @@
 #include <chrono> 
 #include <vector>
 #include <random> // ⭐ 随机鼓励语
+#include <cstdlib>
 
 using namespace std;
 
@@ -36,7 +43,21 @@ UIManager::UIManager() {
     xpSystem = new XPSystem();
     heatmap = new HeatmapVisualizer();
     projectManager = new ProjectManager();
-    taskManager = new TaskManager(); // ⭐ 初始化任务管理器
+    // 设置了 TASK_MANAGER_SERVER 时任务走守护进程，连不上则退回直接访问数据库
+    const char* server = std::getenv("TASK_MANAGER_SERVER");
+    if (server && *server) {
+        rpcClient = std::make_unique<RpcClient>();
+        if (rpcClient->connect(server) && rpcClient->login()) {
+            remoteTasks = std::make_unique<RemoteTaskDAO>(*rpcClient);
+            cout << "🔌 已连接守护进程: " << server << endl;
+        } else {
+            cerr << "连接守护进程失败: " << rpcClient->getLastError() << "，改为直接访问数据库" << endl;
+            rpcClient.reset();
+        }
+    }
+    taskManager = remoteTasks ? new TaskManager(remoteTasks.get()) : new TaskManager(); // ⭐ 初始化任务管理器
+    asyncTasks = new AsyncTaskManager();
+    taskChanges = std::make_unique<ChangeSubscription>(vector<string>{"tasks"});
     
     cout << "✅ UI管理器初始化成功" << endl;
 }
@@ -46,7 +67,11 @@ UIManager::~UIManager() {
     delete xpSystem;
     delete heatmap;
     delete projectManager;
+    taskListPrefetch = {};
+    delete asyncTasks;
     delete taskManager; // ⭐ 清理内存
+    remoteTasks.reset();
+    rpcClient.reset();
 }
 
 // === UI辅助方法 ===
@@ -128,6 +153,20 @@ bool UIManager::confirmAction(const string& prompt) {
     return (response == "y" || response == "Y" || response == "yes" || response == "YES");
 }
 
+vector<Task> UIManager::takeTaskList() {
+    auto prefetch = std::move(taskListPrefetch);
+    taskListPrefetch = {};
+    // 预取开始后 tasks 有过提交（后台归档、其他连接的写入），结果可能已过期
+    if (prefetch.valid() && !taskChanges->hasChanges()) {
+        try {
+            return prefetch.get();
+        } catch (const OperationCancelled&) {
+            // 执行器已关闭，改为同步读取
+        }
+    }
+    return taskManager->getAllTasks();
+}
+
 // ==========================================
 // ⭐ 游戏化 UI 增强实现 (New Features)
 // ==========================================
@@ -167,6 +206,7 @@ namespace {
 
 // Replace displayUserStatusBar
 void UIManager::displayHUD() {
+    TRACE_SCOPE("ui", "UIManager::displayHUD");
     int level = xpSystem->getCurrentLevel();
     int currentXP = xpSystem->getCurrentXP();
     int nextLevelXP = xpSystem->getXPForNextLevel(); 
@@ -242,6 +282,7 @@ void UIManager::run() {
     pause();
     
     while (running) {
+        processPomodoroCompletions();
         showMainMenu();
         int choice = getUserChoice(5);
         
@@ -275,11 +316,17 @@ void UIManager::showTaskMenu() {
         "查看所有任务",
         "更新任务",
         "删除任务",
-        "完成任务 (获取XP!)" // 文案优化
+        "完成任务 (获取XP!)", // 文案优化
+        "🍅 番茄钟"
     };
     
     printMenu(options);
-    int choice = getUserChoice(5);
+    
+    // 用户选择期间在后台读任务列表，"查看"和"完成"可以直接使用
+    // 客户端模式下列表由守护进程的缓存提供，不在本地预取
+    taskChanges->take();
+    if (!remoteTasks) taskListPrefetch = asyncTasks->getAllTasks();
+    int choice = getUserChoice(6);
     
     switch (choice) {
         case 1: createTask(); break;
@@ -287,11 +334,13 @@ void UIManager::showTaskMenu() {
         case 3: updateTask(); break;
         case 4: deleteTask(); break;
         case 5: completeTask(); break; // 调用增强版逻辑
+        case 6: showPomodoroMenu(); break;
         case 0: return;
     }
 }
 
 void UIManager::createTask() {
+    TRACE_SCOPE("ui", "UIManager::createTask");
     clearScreen();
     printHeader("✨ 创建新任务");
     
@@ -311,11 +360,12 @@ void UIManager::createTask() {
 }
 
 void UIManager::listTasks() {
+    TRACE_SCOPE("ui", "UIManager::listTasks");
     clearScreen();
     printHeader("📋 任务列表");
     
     // ⭐ 使用真实 Logic
-    auto tasks = taskManager->getAllTasks();
+    auto tasks = takeTaskList();
     if (tasks.empty()) {
         displayInfo("暂无任务。赶快创建一个吧！");
     } else {
@@ -339,6 +389,7 @@ void UIManager::updateTask() {
 }
 
 void UIManager::deleteTask() {
+    TRACE_SCOPE("ui", "UIManager::deleteTask");
     clearScreen();
     printHeader("🗑️  删除任务");
     int id = getIntInput("请输入要删除的任务ID: ");
@@ -353,10 +404,11 @@ void UIManager::deleteTask() {
 }
 
 void UIManager::completeTask() {
+    TRACE_SCOPE("ui", "UIManager::completeTask");
     clearScreen();
     printHeader("✅ 完成任务");
     
-    auto tasks = taskManager->getAllTasks();
+    auto tasks = takeTaskList();
     bool hasPending = false;
     for(const auto& t : tasks) {
         if (!t.isCompleted()) {
@@ -384,6 +436,77 @@ void UIManager::completeTask() {
     }
 }
 
+void UIManager::showPomodoroMenu() {
+    TRACE_SCOPE("ui", "UIManager::showPomodoroMenu");
+    clearScreen();
+    printHeader("🍅 番茄钟");
+    
+    PomodoroEngine& engine = PomodoroEngine::getInstance();
+    int userId = xpSystem->getCurrentUserId();
+    
+    auto sessions = engine.listSessions(userId);
+    if (sessions.empty()) {
+        displayInfo("当前没有进行中的番茄钟");
+    }
+    for (const auto& s : sessions) {
+        long secs = s.remaining.count();
+        cout << COLOR_CYAN << "会话 #" << s.id << COLOR_RESET
+             << " | 任务 " << (s.taskId > 0 ? to_string(s.taskId) : string("-"))
+             << " | " << PomodoroEngine::phaseName(s.phase)
+             << (s.state == PomodoroState::Paused ? " (已暂停)" : "")
+             << " | 剩余 " << setw(2) << setfill('0') << secs / 60 << ":"
+             << setw(2) << secs % 60 << setfill(' ')
+             << " | 已完成 " << s.completedCycles << " 个\n";
+    }
+    
+    vector<string> options = {
+        "开始番茄钟",
+        "暂停",
+        "继续",
+        "中断"
+    };
+    printMenu(options);
+    int choice = getUserChoice(4);
+    if (choice == 0) return;
+    
+    if (choice == 1) {
+        int taskId = getIntInput("关联任务ID (0 表示不关联): ");
+        engine.start();  // 快速启动时事件循环推迟到第一个会话
+        int sessionId = engine.startSession(userId, taskId);
+        displaySuccess("番茄钟 #" + to_string(sessionId) + " 已开始，计时在后台进行");
+        pause();
+        return;
+    }
+    
+    int sessionId = getIntInput("会话ID: ");
+    bool ok = false;
+    switch (choice) {
+        case 2: ok = engine.pause(sessionId); break;
+        case 3: ok = engine.resume(sessionId); break;
+        case 4: ok = engine.interrupt(sessionId, getInput("中断原因: ")); break;
+    }
+    
+    if (ok) {
+        displaySuccess("操作成功！");
+    } else {
+        displayError("会话不存在或状态不允许该操作");
+    }
+    pause();
+}
+
+void UIManager::processPomodoroCompletions() {
+    TRACE_SCOPE("ui", "UIManager::processPomodoroCompletions");
+    // 引擎线程只排队，经验值在 UI 线程发放（XPSystem 非线程安全）
+    auto completed = PomodoroEngine::getInstance().drainCompletions();
+    if (completed.empty()) return;
+    
+    for (const auto& record : completed) {
+        // 写入 user_stats 后统计缓存经由变更流自动失效
+        xpSystem->awardXP(record.userId, xpSystem->getXPForPomodoro(), "番茄钟");
+    }
+    pause();
+}
+
 // === 项目管理界面 (完整保留) ===
 
 void UIManager::showProjectMenu() {
@@ -412,6 +535,7 @@ void UIManager::showProjectMenu() {
 }
 
 void UIManager::createProject() {
+    TRACE_SCOPE("ui", "UIManager::createProject");
     clearScreen();
     printHeader("✨ 创建新项目");
     
@@ -434,6 +558,7 @@ void UIManager::createProject() {
 }
 
 void UIManager::listProjects() {
+    TRACE_SCOPE("ui", "UIManager::listProjects");
     clearScreen();
     printHeader("Project List");
     
@@ -461,6 +586,7 @@ void UIManager::listProjects() {
 }
 
 void UIManager::viewProjectDetails() {
+    TRACE_SCOPE("ui", "UIManager::viewProjectDetails");
     clearScreen();
     printHeader("📊 项目详情");
     
@@ -493,6 +619,7 @@ void UIManager::updateProject() {
 }
 
 void UIManager::deleteProject() {
+    TRACE_SCOPE("ui", "UIManager::deleteProject");
     clearScreen();
     printHeader("🗑️  删除项目");
     
@@ -537,6 +664,7 @@ void UIManager::showStatisticsMenu() {
 }
 
 void UIManager::showStatisticsSummary() {
+    TRACE_SCOPE("ui", "UIManager::showStatisticsSummary");
     clearScreen();
     printHeader("📈 统计数据总览");
     cout << statsAnalyzer->generateSummary();
@@ -544,6 +672,7 @@ void UIManager::showStatisticsSummary() {
 }
 
 void UIManager::showDailyReport() {
+    TRACE_SCOPE("ui", "UIManager::showDailyReport");
     clearScreen();
     printHeader("📅 每日报告");
     cout << statsAnalyzer->generateDailyReport();
@@ -551,6 +680,7 @@ void UIManager::showDailyReport() {
 }
 
 void UIManager::showWeeklyReport() {
+    TRACE_SCOPE("ui", "UIManager::showWeeklyReport");
     clearScreen();
     printHeader("📈 每周报告");
     cout << statsAnalyzer->generateWeeklyReport();
@@ -558,6 +688,7 @@ void UIManager::showWeeklyReport() {
 }
 
 void UIManager::showMonthlyReport() {
+    TRACE_SCOPE("ui", "UIManager::showMonthlyReport");
     clearScreen();
     printHeader("📊 每月报告");
     cout << statsAnalyzer->generateMonthlyReport();
@@ -565,9 +696,11 @@ void UIManager::showMonthlyReport() {
 }
 
 void UIManager::showHeatmap() {
+    TRACE_SCOPE("ui", "UIManager::showHeatmap");
     clearScreen();
     printHeader("🔥 任务完成热力图");
-    // 显示热力图（数据从数据库中获取）
+    // 显示热力图（数据从数据库中获取，只统计当前用户）
+    heatmap->setCurrentUserId(xpSystem->getCurrentUserId());
     cout << heatmap->generateHeatmap(90);
     pause();
 }
@@ -581,21 +714,24 @@ void UIManager::showGamificationMenu() {
     vector<string> options = {
         "经验值和等级",
         "成就系统",
-        "挑战系统"
+        "挑战系统",
+        "经验值排行榜"
     };
     
     printMenu(options);
-    int choice = getUserChoice(3);
+    int choice = getUserChoice(4);
     
     switch (choice) {
         case 1: showXPAndLevel(); break;
         case 2: showAchievements(); break;
         case 3: showChallenges(); break;
+        case 4: showLeaderboard(); break;
         case 0: return;
     }
 }
 
 void UIManager::showXPAndLevel() {
+    TRACE_SCOPE("ui", "UIManager::showXPAndLevel");
     clearScreen();
     printHeader("⭐ 经验值和等级");
     cout << xpSystem->displayLevelInfo();
@@ -603,6 +739,7 @@ void UIManager::showXPAndLevel() {
 }
 
 void UIManager::showAchievements() {
+    TRACE_SCOPE("ui", "UIManager::showAchievements");
     clearScreen();
     printHeader("🏆 成就系统");
     int unlocked = statsAnalyzer->getAchievementsUnlocked();
@@ -613,6 +750,7 @@ void UIManager::showAchievements() {
 }
 
 void UIManager::showChallenges() {
+    TRACE_SCOPE("ui", "UIManager::showChallenges");
     clearScreen();
     printHeader("🎯 挑战系统");
     int completed = statsAnalyzer->getChallengesCompleted();
@@ -622,6 +760,40 @@ void UIManager::showChallenges() {
     pause();
 }
 
+void UIManager::showLeaderboard() {
+    TRACE_SCOPE("ui", "UIManager::showLeaderboard");
+    clearScreen();
+    printHeader("🏅 经验值排行榜");
+    
+    Leaderboard& leaderboard = Leaderboard::getInstance();
+    if (!leaderboard.isLoaded() && !leaderboard.rebuild()) {
+        displayError("排行榜加载失败！");
+        pause();
+        return;
+    }
+    
+    cout << "\n";
+    for (const auto& entry : leaderboard.getTopK(10)) {
+        cout << "  " << COLOR_YELLOW << setw(3) << entry.rank << COLOR_RESET << ". "
+             << left << setw(20) << entry.username << right
+             << " Lv." << setw(2) << entry.level
+             << "  " << COLOR_GREEN << entry.totalXP << " XP" << COLOR_RESET << "\n";
+    }
+    
+    int userId = xpSystem->getCurrentUserId();
+    int rank = leaderboard.getRank(userId);
+    if (rank > 0) {
+        cout << "\n" << BOLD << "你的排名: " << rank << " / " << leaderboard.size() << COLOR_RESET << "\n";
+        for (const auto& entry : leaderboard.getNeighbors(userId, 2)) {
+            cout << (entry.userId == userId ? COLOR_MAGENTA + " ➤ " : string("   "))
+                 << setw(3) << entry.rank << ". " << entry.username
+                 << " (" << entry.totalXP << " XP)" << COLOR_RESET << "\n";
+        }
+    }
+    
+    pause();
+}
+
 // === 设置界面 (完整保留) ===
 
 void UIManager::showSettingsMenu() {
@@ -0,0 +1,488 @@
+#include "workload/WorkloadGenerator.h"
+#include "database/DatabaseManager.h"
+#include "database/DAO/ReminderDAO.h"
+#include "database/QueryProfiler.h"
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <sqlite3.h>
+
+namespace {
+
+// === 可复现的随机数与分布 ===
+
+class Rng {
+    std::mt19937_64 engine;
+public:
+    explicit Rng(std::uint64_t seed) : engine(seed) {}
+
+    // [0, 1)，53 位精度
+    double uniform() { return (engine() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // [0, n)
+    std::uint64_t below(std::uint64_t n) { return n ? engine() % n : 0; }
+
+    bool chance(double p) { return uniform() < p; }
+
+    // 均值为 mean 的几何分布（取值 0, 1, 2, ...）
+    int geometric(double mean) {
+        if (mean <= 0) return 0;
+        double p = 1.0 / (1.0 + mean);
+        return static_cast<int>(std::floor(std::log(1.0 - uniform()) / std::log(1.0 - p)));
+    }
+};
+
+// 按权重查累积分布，Zipf 和日内时段都用它
+class DiscreteSampler {
+    std::vector<double> cdf;
+public:
+    explicit DiscreteSampler(const std::vector<double>& weights) {
+        double sum = 0.0;
+        cdf.reserve(weights.size());
+        for (double w : weights) {
+            sum += w;
+            cdf.push_back(sum);
+        }
+        for (double& c : cdf) c /= sum;
+    }
+
+    size_t sample(Rng& rng) const {
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), rng.uniform());
+        return std::min(static_cast<size_t>(it - cdf.begin()), cdf.size() - 1);
+    }
+};
+
+DiscreteSampler zipf(size_t n, double exponent) {
+    std::vector<double> weights(std::max<size_t>(n, 1));
+    for (size_t k = 0; k < weights.size(); ++k) {
+        weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+    }
+    return DiscreteSampler(weights);
+}
+
+// 0-23 点的相对活跃度：上午、下午、晚间三个高峰
+const std::vector<double> HOURLY_ACTIVITY = {
+    1.0, 0.5, 0.3, 0.2, 0.2, 0.4, 1.0, 2.0, 4.0, 6.0, 7.0, 6.0,
+    4.0, 5.0, 6.0, 6.0, 5.0, 4.0, 4.0, 5.0, 5.0, 4.0, 3.0, 2.0
+};
+
+const std::vector<std::string> TAG_VOCABULARY = {
+    "work", "study", "personal", "urgent", "health", "reading",
+    "coding", "meeting", "review", "errand", "finance", "travel"
+};
+
+const int SECONDS_PER_DAY = 86400;
+
+std::string formatTimestamp(std::time_t ts) {
+    std::tm utc{};
+    gmtime_r(&ts, &utc);
+    char buf[20];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &utc);
+    return buf;
+}
+
+std::string formatDate(std::time_t ts) {
+    std::tm utc{};
+    gmtime_r(&ts, &utc);
+    char buf[11];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d", &utc);
+    return buf;
+}
+
+bool isWeekend(std::time_t ts) {
+    std::tm utc{};
+    gmtime_r(&ts, &utc);
+    return utc.tm_wday == 0 || utc.tm_wday == 6;
+}
+
+// 某天 0 点（UTC）+ 按日内活跃度抽取的时刻
+std::time_t pickTimeOfDay(std::time_t dayStart, Rng& rng, const DiscreteSampler& hours) {
+    return dayStart + static_cast<std::time_t>(hours.sample(rng)) * 3600 +
+           static_cast<std::time_t>(rng.below(3600));
+}
+
+sqlite3_stmt* prepare(sqlite3* conn, const char* sql) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "准备语句失败: " << sqlite3_errmsg(conn) << " (SQL: " << sql << ")" << std::endl;
+        return nullptr;
+    }
+    return stmt;
+}
+
+bool stepAndReset(sqlite3* conn, sqlite3_stmt* stmt) {
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!ok) {
+        std::cerr << "写入失败: " << sqlite3_errmsg(conn) << std::endl;
+    }
+    sqlite3_reset(stmt);
+    return ok;
+}
+
+} // namespace
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config) : config(config) {}
+
+// === 索引处理 ===
+
+bool WorkloadGenerator::dropSecondaryIndexes(DatabaseManager& db, std::vector<SavedIndex>& saved) {
+    // 只动非唯一索引：唯一索引承担约束，删掉会让重复数据混进来
+    db.executeQuery(
+        "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND sql IS NOT NULL "
+        "AND tbl_name IN ('tasks', 'task_tags', 'pomodoro_sessions') AND sql NOT LIKE 'CREATE UNIQUE%';",
+        [&](sqlite3_stmt* stmt) {
+            saved.push_back(SavedIndex{
+                reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)),
+                reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1))});
+            return true;
+        });
+
+    for (const auto& index : saved) {
+        if (!db.execute("DROP INDEX IF EXISTS " + index.name + ";")) return false;
+    }
+    return true;
+}
+
+bool WorkloadGenerator::restoreIndexes(DatabaseManager& db, const std::vector<SavedIndex>& saved) {
+    bool ok = true;
+    for (const auto& index : saved) {
+        ok = db.execute(index.sql + ";") && ok;
+    }
+    return ok;
+}
+
+// === 主流程 ===
+
+bool WorkloadGenerator::generate(DatabaseManager& db, WorkloadStats* statsOut) {
+    if (!db.isOpen()) {
+        std::cerr << "WorkloadGenerator: 数据库未打开" << std::endl;
+        return false;
+    }
+
+    auto startClock = std::chrono::steady_clock::now();
+    WorkloadStats stats;
+    Rng rng(config.seed);
+
+    const std::time_t anchor = config.anchorTime > 0 ? static_cast<std::time_t>(config.anchorTime)
+                                                     : std::time(nullptr);
+    const std::time_t today = anchor - anchor % SECONDS_PER_DAY;
+    const int historyDays = std::max(1, config.historyDays);
+    const int users = std::max(1, config.users);
+
+    DiscreteSampler hours(HOURLY_ACTIVITY);
+    DiscreteSampler projectPick = zipf(static_cast<size_t>(std::max(1, config.projects)), config.projectZipf);
+    DiscreteSampler tagPick = zipf(TAG_VOCABULARY.size(), 1.0);
+
+    // 整个过程独占连接；批量写入期间放宽同步级别
+    auto connectionLock = db.lockConnection();
+    sqlite3* conn = db.getRawConnection();
+    db.execute("PRAGMA synchronous = OFF;");
+
+    // 几百万条 INSERT 不计入语句剖析，既省开销也不冲掉真实业务的统计
+    QueryProfiler& profiler = QueryProfiler::getInstance();
+    const bool profiling = profiler.isEnabled();
+    profiler.setEnabled(false);
+
+    std::vector<SavedIndex> savedIndexes;
+    if (config.rebuildIndexes && !dropSecondaryIndexes(db, savedIndexes)) {
+        db.execute("PRAGMA synchronous = NORMAL;");
+        profiler.setEnabled(profiling);
+        return false;
+    }
+
+    for (int user = 1; user <= users; ++user) {
+        db.ensureUser(user, user == DatabaseManager::DEFAULT_USER_ID ? "" : "user_" + std::to_string(user));
+    }
+    stats.users = users;
+
+    sqlite3_stmt* projectStmt = prepare(conn,
+        "INSERT INTO projects (name, description, color_label, created_date, updated_date) "
+        "VALUES (?, 'synthetic workload', ?, ?, ?);");
+    sqlite3_stmt* taskStmt = prepare(conn,
+        "INSERT INTO tasks (title, description, priority, due_date, completed, tags, project_id, "
+        "pomodoro_count, estimated_pomodoros, completed_date, created_date, updated_date, user_id) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    sqlite3_stmt* taskTagStmt = prepare(conn,
+        "INSERT INTO task_tags (task_id, tag_id) VALUES (?, ?);");
+    sqlite3_stmt* sessionStmt = prepare(conn,
+        "INSERT INTO pomodoro_sessions (task_id, user_id, session_type, start_time, end_time, "
+        "duration, completed, interrupted, interruption_reason, created_date) "
+        "VALUES (?, ?, 'work', ?, ?, ?, ?, ?, ?, ?);");
+    sqlite3_stmt* projectTotalsStmt = prepare(conn,
+        "UPDATE projects SET total_tasks = total_tasks + ?, completed_tasks = completed_tasks + ?, "
+        "progress = CASE WHEN total_tasks + ? > 0 "
+        "THEN CAST(completed_tasks + ? AS REAL) / (total_tasks + ?) ELSE 0 END WHERE id = ?;");
+    sqlite3_stmt* userTotalsStmt = prepare(conn,
+        "UPDATE user_stats SET total_pomodoros = total_pomodoros + ? WHERE user_id = ?;");
+
+    bool ok = projectStmt && taskStmt && taskTagStmt && sessionStmt && projectTotalsStmt && userTotalsStmt;
+    const char* colors[] = {"#3498db", "#e74c3c", "#2ecc71", "#f1c40f", "#9b59b6", "#1abc9c"};
+
+    std::vector<int> projectIds;
+    std::map<int, std::pair<long long, long long>> projectTotals;  // id -> (total, completed)
+    std::map<int, long long> userPomodoros;
+
+    ok = ok && db.execute("BEGIN TRANSACTION;");
+
+    // 标签词表先写入 tags，任务的标签同时写 tasks.tags 和 task_tags
+    std::vector<int> tagIds;
+    for (const auto& tag : TAG_VOCABULARY) {
+        if (!ok) break;
+        ok = db.executeParameterized("INSERT OR IGNORE INTO tags (name) VALUES (?);", {tag});
+        db.executeQuery("SELECT id FROM tags WHERE name = '" + tag + "';", [&](sqlite3_stmt* stmt) {
+            tagIds.push_back(sqlite3_column_int(stmt, 0));
+            return false;
+        });
+    }
+    ok = ok && tagIds.size() == TAG_VOCABULARY.size();
+
+    // 项目早于所有任务创建
+    std::string projectCreated = formatTimestamp(today - static_cast<std::time_t>(historyDays + 1) * SECONDS_PER_DAY);
+    for (int p = 0; ok && p < config.projects; ++p) {
+        std::string name = "Project " + std::to_string(p + 1);
+        sqlite3_bind_text(projectStmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(projectStmt, 2, colors[p % 6], -1, SQLITE_STATIC);
+        sqlite3_bind_text(projectStmt, 3, projectCreated.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(projectStmt, 4, projectCreated.c_str(), -1, SQLITE_TRANSIENT);
+        ok = stepAndReset(conn, projectStmt);
+        projectIds.push_back(static_cast<int>(sqlite3_last_insert_rowid(conn)));
+    }
+    stats.projects = static_cast<long long>(projectIds.size());
+
+    long long rowsInTransaction = 0;
+    long long firstTaskId = 0;
+    long long lastTaskId = 0;
+
+    for (long long t = 0; ok && t < config.tasks; ++t) {
+        int userId = users == 1 ? 1 : 1 + static_cast<int>(rng.below(users));
+
+        // 创建日期：周末的任务少 40%
+        std::time_t createdDay;
+        do {
+            createdDay = today - static_cast<std::time_t>(rng.below(historyDays)) * SECONDS_PER_DAY;
+        } while (isWeekend(createdDay) && rng.chance(0.4));
+        std::time_t createdAt = std::min(pickTimeOfDay(createdDay, rng, hours), anchor);
+
+        int priority = rng.chance(0.3) ? 0 : (rng.chance(0.714) ? 1 : 2);  // 30/50/20
+        int projectId = 0;
+        if (!projectIds.empty() && rng.chance(0.85)) {
+            projectId = projectIds[projectPick.sample(rng)];
+        }
+
+        std::string tags;
+        int tagCount = static_cast<int>(rng.below(4));
+        std::vector<size_t> chosen;
+        for (int k = 0; k < tagCount; ++k) {
+            size_t tag = tagPick.sample(rng);
+            if (std::find(chosen.begin(), chosen.end(), tag) != chosen.end()) continue;
+            chosen.push_back(tag);
+            if (!tags.empty()) tags += ",";
+            tags += TAG_VOCABULARY[tag];
+        }
+
+        std::string dueDate;
+        if (rng.chance(config.dueDateRate)) {
+            dueDate = formatDate(createdDay + static_cast<std::time_t>(1 + rng.below(14)) * SECONDS_PER_DAY);
+        }
+
+        // 最近两天创建的任务完成概率减半
+        double completeP = config.completionRate * (anchor - createdAt < 2 * SECONDS_PER_DAY ? 0.5 : 1.0);
+        bool completed = rng.chance(completeP);
+        std::time_t completedAt = 0;
+        int pomodoros = 0;
+        int estimated = 1 + static_cast<int>(rng.below(6));
+        if (completed) {
+            std::time_t doneDay = createdDay + static_cast<std::time_t>(rng.geometric(2.0)) * SECONDS_PER_DAY;
+            completedAt = pickTimeOfDay(std::min(doneDay, today), rng, hours);
+            completedAt = std::min(std::max(completedAt, createdAt + 1800), anchor);
+            pomodoros = rng.geometric(config.meanPomodoros);
+        }
+
+        std::string title = "Task " + std::to_string(t + 1);
+        std::string createdStr = formatTimestamp(createdAt);
+        std::string completedStr = completed ? formatTimestamp(completedAt) : "";
+
+        // 先算番茄记录，tasks.pomodoro_count 只计未中断的
+        struct Session { std::string start, end; int minutes; bool interrupted; };
+        std::vector<Session> sessions;
+        int finishedPomodoros = 0;
+        std::time_t sessionEnd = completedAt;
+        for (int s = 0; s < pomodoros; ++s) {
+            bool interrupted = rng.chance(config.interruptionRate);
+            int minutes = interrupted ? 5 + static_cast<int>(rng.below(16)) : 25;
+            std::time_t sessionStart = sessionEnd - minutes * 60;
+            sessions.push_back(Session{formatTimestamp(sessionStart), formatTimestamp(sessionEnd),
+                                       minutes, interrupted});
+            if (!interrupted) finishedPomodoros++;
+            sessionEnd = sessionStart - 5 * 60;  // 两个番茄之间的短休息
+        }
+
+        sqlite3_bind_text(taskStmt, 1, title.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(taskStmt, 2, "synthetic", -1, SQLITE_STATIC);
+        sqlite3_bind_int(taskStmt, 3, priority);
+        if (dueDate.empty()) sqlite3_bind_null(taskStmt, 4);
+        else sqlite3_bind_text(taskStmt, 4, dueDate.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(taskStmt, 5, completed ? 1 : 0);
+        sqlite3_bind_text(taskStmt, 6, tags.c_str(), -1, SQLITE_TRANSIENT);
+        if (projectId > 0) sqlite3_bind_int(taskStmt, 7, projectId);
+        else sqlite3_bind_null(taskStmt, 7);
+        sqlite3_bind_int(taskStmt, 8, finishedPomodoros);
+        sqlite3_bind_int(taskStmt, 9, estimated);
+        if (completed) sqlite3_bind_text(taskStmt, 10, completedStr.c_str(), -1, SQLITE_TRANSIENT);
+        else sqlite3_bind_null(taskStmt, 10);
+        sqlite3_bind_text(taskStmt, 11, createdStr.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(taskStmt, 12, (completed ? completedStr : createdStr).c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(taskStmt, 13, userId);
+        if (!(ok = stepAndReset(conn, taskStmt))) break;
+
+        long long taskId = sqlite3_last_insert_rowid(conn);
+        if (firstTaskId == 0) firstTaskId = taskId;
+        lastTaskId = taskId;
+        stats.tasks++;
+        rowsInTransaction++;
+
+        for (size_t tag : chosen) {
+            sqlite3_bind_int64(taskTagStmt, 1, taskId);
+            sqlite3_bind_int(taskTagStmt, 2, tagIds[tag]);
+            if (!(ok = stepAndReset(conn, taskTagStmt))) break;
+            rowsInTransaction++;
+        }
+
+        if (projectId > 0) {
+            auto& totals = projectTotals[projectId];
+            totals.first++;
+            if (completed) totals.second++;
+        }
+        if (completed) stats.completedTasks++;
+
+        for (const auto& session : sessions) {
+            sqlite3_bind_int64(sessionStmt, 1, taskId);
+            sqlite3_bind_int(sessionStmt, 2, userId);
+            sqlite3_bind_text(sessionStmt, 3, session.start.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(sessionStmt, 4, session.end.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(sessionStmt, 5, session.minutes);
+            sqlite3_bind_int(sessionStmt, 6, session.interrupted ? 0 : 1);
+            sqlite3_bind_int(sessionStmt, 7, session.interrupted ? 1 : 0);
+            if (session.interrupted) sqlite3_bind_text(sessionStmt, 8, "distracted", -1, SQLITE_STATIC);
+            else sqlite3_bind_null(sessionStmt, 8);
+            sqlite3_bind_text(sessionStmt, 9, session.end.c_str(), -1, SQLITE_TRANSIENT);
+            if (!(ok = stepAndReset(conn, sessionStmt))) break;
+            stats.pomodoroSessions++;
+            rowsInTransaction++;
+        }
+        userPomodoros[userId] += finishedPomodoros;
+
+        if (ok && rowsInTransaction >= config.batchSize) {
+            ok = db.execute("COMMIT;") && db.execute("BEGIN TRANSACTION;");
+            rowsInTransaction = 0;
+        }
+    }
+
+    // 汇总列一次性回填，而不是每行都 UPDATE
+    for (const auto& entry : projectTotals) {
+        if (!ok) break;
+        long long total = entry.second.first;
+        long long done = entry.second.second;
+        sqlite3_bind_int64(projectTotalsStmt, 1, total);
+        sqlite3_bind_int64(projectTotalsStmt, 2, done);
+        sqlite3_bind_int64(projectTotalsStmt, 3, total);
+        sqlite3_bind_int64(projectTotalsStmt, 4, done);
+        sqlite3_bind_int64(projectTotalsStmt, 5, total);
+        sqlite3_bind_int(projectTotalsStmt, 6, entry.first);
+        ok = stepAndReset(conn, projectTotalsStmt);
+    }
+    for (const auto& entry : userPomodoros) {
+        if (!ok) break;
+        sqlite3_bind_int64(userTotalsStmt, 1, entry.second);
+        sqlite3_bind_int(userTotalsStmt, 2, entry.first);
+        ok = stepAndReset(conn, userTotalsStmt);
+    }
+
+    ok = ok && db.execute("COMMIT;");
+    if (!ok) {
+        db.execute("ROLLBACK;");
+    }
+
+    sqlite3_finalize(projectStmt);
+    sqlite3_finalize(taskStmt);
+    sqlite3_finalize(taskTagStmt);
+    sqlite3_finalize(sessionStmt);
+    sqlite3_finalize(projectTotalsStmt);
+    sqlite3_finalize(userTotalsStmt);
+
+    ok = restoreIndexes(db, savedIndexes) && ok;
+    db.execute("PRAGMA synchronous = NORMAL;");
+    db.execute("ANALYZE;");
+    profiler.setEnabled(profiling);
+
+    if (ok && config.reminders > 0 && !config.reminderDbPath.empty()) {
+        // 提醒关联到本次生成的任务
+        ok = generateReminders(firstTaskId, lastTaskId, stats);
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startClock).count();
+    if (statsOut) *statsOut = stats;
+    return ok;
+}
+
+bool WorkloadGenerator::generateReminders(long long firstTaskId, long long lastTaskId,
+                                          WorkloadStats& stats) {
+    // 通过 DAO 建表，保证与 SQLiteReminderDAO 的表结构一致；写入走原始连接
+    if (!createReminderDAO(config.reminderDbPath)) return false;
+
+    sqlite3* conn = nullptr;
+    if (sqlite3_open(config.reminderDbPath.c_str(), &conn) != SQLITE_OK) {
+        std::cerr << "无法打开提醒数据库: " << config.reminderDbPath << std::endl;
+        sqlite3_close(conn);
+        return false;
+    }
+
+    Rng rng(config.seed + 1);  // 独立的随机流：提醒数量变化不影响任务数据
+    const std::time_t anchor = config.anchorTime > 0 ? static_cast<std::time_t>(config.anchorTime)
+                                                     : std::time(nullptr);
+    const char* rules[] = {"daily", "weekly", "monthly"};
+    const ReminderType types[] = {ReminderType::DAILY, ReminderType::WEEKLY, ReminderType::MONTHLY};
+
+    sqlite3_exec(conn, "PRAGMA synchronous = OFF;", nullptr, nullptr, nullptr);
+    sqlite3_exec(conn, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt = prepare(conn,
+        "INSERT INTO reminders (title, message, trigger_time, reminder_type, status, task_id, recurrence_rule) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?);");
+    bool ok = stmt != nullptr;
+
+    for (long long r = 0; ok && r < config.reminders; ++r) {
+        bool recurring = rng.chance(config.recurringReminderRate);
+        // 一周前到一个月后之间
+        std::time_t trigger = anchor - 7 * SECONDS_PER_DAY +
+                              static_cast<std::time_t>(rng.below(37ULL * SECONDS_PER_DAY));
+        size_t rule = rng.below(3);
+        ReminderStatus status = (!recurring && trigger < anchor) ? ReminderStatus::TRIGGERED
+                                                                 : ReminderStatus::PENDING;
+
+        std::string title = "Reminder " + std::to_string(r + 1);
+        std::string when = formatTimestamp(trigger);
+        sqlite3_bind_text(stmt, 1, title.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, "synthetic", -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, when.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, static_cast<int>(recurring ? types[rule] : ReminderType::ONCE));
+        sqlite3_bind_int(stmt, 5, static_cast<int>(status));
+        long long span = lastTaskId - firstTaskId + 1;
+        sqlite3_bind_int64(stmt, 6, firstTaskId > 0 ? firstTaskId + static_cast<long long>(rng.below(span)) : 0);
+        sqlite3_bind_text(stmt, 7, recurring ? rules[rule] : "once", -1, SQLITE_STATIC);
+        ok = stepAndReset(conn, stmt);
+        if (ok) stats.reminders++;
+
+        if (ok && (r + 1) % config.batchSize == 0) {
+            sqlite3_exec(conn, "COMMIT; BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_exec(conn, ok ? "COMMIT;" : "ROLLBACK;", nullptr, nullptr, nullptr);
+    sqlite3_close(conn);
+    return ok;
+}